@@ -40,5 +40,6 @@
 #define PYBRICKS_STM32_OPT_FLOAT        (0)
 #define PYBRICKS_STM32_OPT_TERSE_ERR    (1)
 #define PYBRICKS_STM32_OPT_EXTRA_MOD    (0)
+#define PYBRICKS_STM32_OPT_NATIVE       (0)
 
 #include "../stm32/configport.h"
@@ -7,3 +7,5 @@
 #define PBIO_CONFIG_LOGGER                  (1)
 #define PBIO_CONFIG_SERIAL                  (1)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_CONTROL_LOOP_TIME_MS    (5)
+#define PBIO_CONFIG_PROFILER                (1)
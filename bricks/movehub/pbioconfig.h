@@ -5,7 +5,9 @@
 #define PBIO_CONFIG_LIGHT                   (1)
 #define PBIO_CONFIG_LOGGER                  (0)
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_CONTROL_LOOP_TIME_MS    (5)
 #define PBIO_CONFIG_CONTROL_MINIMAL         (1)
+#define PBIO_CONFIG_CONTROL_QUEUE_SIZE      (1)
 
 #define PBIO_CONFIG_UARTDEV                 (1)
 #define PBIO_CONFIG_UARTDEV_NUM_DEV         (2)
@@ -5,6 +5,7 @@
 #define PBIO_CONFIG_LOGGER                  (1)
 
 #define PBIO_CONFIG_TACHO                   (1)
+#define PBIO_CONFIG_CONTROL_LOOP_TIME_MS    (5)
 
 #define PBIO_CONFIG_UARTDEV                 (0)
 #define PBIO_CONFIG_UARTDEV_NUM_DEV         (0)
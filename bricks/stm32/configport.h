@@ -12,7 +12,14 @@
 #define MICROPY_ALLOC_PATH_MAX      (256)
 #define MICROPY_ALLOC_PARSE_CHUNK_INIT (16)
 #define MICROPY_EMIT_X64            (0)
-#define MICROPY_EMIT_THUMB          (0)
+// Native code runs from the heap, which is in SRAM. None of the hubs set up
+// the MPU, so SRAM is executable and no special allocator is needed.
+#define MICROPY_EMIT_THUMB          (PYBRICKS_STM32_OPT_NATIVE)
+#if defined(__thumb2__)
+#define MICROPY_EMIT_THUMB_ARMV7M   (1)
+#else
+#define MICROPY_EMIT_THUMB_ARMV7M   (0)
+#endif
 #define MICROPY_EMIT_INLINE_THUMB   (0)
 #define MICROPY_COMP_MODULE_CONST   (0)
 #define MICROPY_COMP_CONST          (0)
@@ -34,7 +41,7 @@
 #define MICROPY_ERROR_REPORTING     (MICROPY_ERROR_REPORTING_DETAILED)
 #endif
 #define MICROPY_BUILTIN_METHOD_CHECK_SELF_ARG (0)
-#define MICROPY_PY_ASYNC_AWAIT      (0)
+#define MICROPY_PY_ASYNC_AWAIT      (PYBRICKS_STM32_OPT_COMPILER)
 #define MICROPY_MULTIPLE_INHERITANCE (0)
 #define MICROPY_PY_ARRAY (0)
 #define MICROPY_PY_BUILTINS_BYTEARRAY       (PYBRICKS_STM32_OPT_EXTRA_MOD)
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2018-2021 The Pybricks Authors
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,6 +10,7 @@
 
 #include <pbio/button.h>
 #include <pbio/main.h>
+#include <pbsys/bluetooth.h>
 #include <pbsys/main.h>
 #include <pbsys/user_program.h>
 
@@ -29,6 +31,8 @@
 #include "py/stackctrl.h"
 #include "py/stream.h"
 
+#include "program_cache.h"
+
 // REVISIT: We could modify the linker script like upstream MicroPython so that
 // we can specify the stack size per hub in the linker scripts. Currently, since
 // the heap is statically allocated here, the stack size is whatever is left in
@@ -80,7 +84,8 @@ static pbio_error_t wait_for_button_release(void) {
     return PBIO_SUCCESS;
 }
 
-// Wait for data from an IDE
+// Wait for data from an IDE. Waiting for the first byte stops with
+// PBIO_ERROR_AGAIN if a whole program arrived on the Pybricks characteristic.
 static pbio_error_t get_message(uint8_t *buf, uint32_t rx_len, int32_t time_out) {
     // Maximum time between two bytes/chunks
     const int32_t time_interval = 500;
@@ -117,6 +122,12 @@ static pbio_error_t get_message(uint8_t *buf, uint32_t rx_len, int32_t time_out)
         // Current time
         time_now = mp_hal_ticks_ms();
 
+        // Check if the program was sent using the windowed download instead
+        uint32_t download_len;
+        if (rx_count == 0 && pbsys_bluetooth_download_is_done(&download_len)) {
+            return PBIO_ERROR_AGAIN;
+        }
+
         // Try to get one byte
         if (mp_hal_stdio_poll(MP_STREAM_POLL_RD)) {
             buf[rx_count] = mp_hal_stdin_rx_chr();
@@ -168,6 +179,12 @@ extern uint8_t _pb_user_mpy_data;
 // spacebar four times, so that no special tools are required.
 static const uint32_t REPL_LEN = 0x20202020;
 
+// If user says they want to send an MPY file this big, they are asking to run
+// a program that is already cached on the hub. The bytes spell "HASH". The
+// SHA-256 hash of the program follows. The hub replies with one byte that is 1
+// if it has the program and runs it, or 0 if the program must be sent as usual.
+static const uint32_t CACHED_LEN = 0x48534148;
+
 // Get user program via serial/bluetooth
 static uint32_t get_user_program(uint8_t **buf, uint32_t *free_len) {
     pbio_error_t err;
@@ -179,9 +196,28 @@ static uint32_t get_user_program(uint8_t **buf, uint32_t *free_len) {
         mp_hal_stdin_rx_chr();
     }
 
-    // Get the program length
+    // Get the program length. Meanwhile, the program may also be sent with
+    // the windowed download on the Pybricks characteristic, which is much
+    // faster. Since we don't know its size yet, it gets a buffer that fits any
+    // program.
     uint32_t len;
+get_length:
+    *buf = m_malloc_maybe(MPY_MAX_BYTES);
+    pbsys_bluetooth_download_init(*buf, *buf ? MPY_MAX_BYTES : 0);
     err = get_message((uint8_t *)&len, sizeof(len), -1);
+    bool downloaded = pbsys_bluetooth_download_is_done(&len);
+    pbsys_bluetooth_download_init(NULL, 0);
+
+    if (downloaded) {
+        // Give back the part of the buffer that we don't need.
+        *buf = m_realloc(*buf, len);
+        program_cache_store(*buf, len);
+        *free_len = len;
+        return len;
+    }
+
+    m_free(*buf);
+    *buf = NULL;
 
     // If button was pressed, return code to run script in flash
     if (err == PBIO_ERROR_CANCELED) {
@@ -199,6 +235,22 @@ static uint32_t get_user_program(uint8_t **buf, uint32_t *free_len) {
         return REPL_LEN;
     }
 
+    // Run a cached program if we have it. If not, wait for the program.
+    if (len == CACHED_LEN) {
+        uint8_t hash[PROGRAM_CACHE_HASH_SIZE];
+        err = get_message(hash, sizeof(hash), 500);
+        if (err != PBIO_SUCCESS) {
+            return 0;
+        }
+        uint8_t found = program_cache_load(hash, buf, &len) == PBIO_SUCCESS;
+        mp_hal_stdout_tx_strn((const char *)&found, 1);
+        if (!found) {
+            goto get_length;
+        }
+        *free_len = len;
+        return len;
+    }
+
     // Assert that the length is allowed
     if (len > MPY_MAX_BYTES) {
         return 0;
@@ -219,6 +271,10 @@ static uint32_t get_user_program(uint8_t **buf, uint32_t *free_len) {
         return 0;
     }
 
+    // Keep it so it doesn't have to be sent again next time. If this fails,
+    // we can still run it.
+    program_cache_store(*buf, len);
+
     *free_len = len;
     return len;
 }
@@ -263,6 +319,20 @@ static const pbsys_user_program_callbacks_t user_program_callbacks = {
     .stdin_event = user_program_stdin_event_func,
 };
 
+// Native code in a .mpy file only runs on architectures that support all of
+// its instructions, so reject programs that this hub can't run. This uses the
+// same test as the loader, which also accepts subsets such as armv6m code on
+// armv7emsp hubs.
+static void check_mpy_arch(const uint8_t *buf, uint32_t len) {
+    if (len < 3) {
+        return;
+    }
+    uint8_t arch = MPY_FEATURE_DECODE_ARCH(buf[2]);
+    if (arch != MP_NATIVE_ARCH_NONE && !MPY_FEATURE_ARCH_TEST(arch)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("program has native code this hub can't run"));
+    }
+}
+
 static void run_user_program(uint32_t len, uint8_t *buf, uint32_t free_len) {
     bool run_repl = len == REPL_LEN;
 
@@ -293,9 +363,16 @@ restart:
             #endif // MICROPY_ENABLE_COMPILER
         } else {
             // run user .mpy file
+            check_mpy_arch(buf, len);
             mp_reader_t reader;
             mp_reader_new_mem(&reader, buf, len, free_len);
             mp_raw_code_t *raw_code = mp_raw_code_load(&reader);
+            #if MICROPY_EMIT_MACHINE_CODE
+            // Native code was just written to RAM, so make sure it is visible
+            // to instruction fetches before calling into it.
+            __DSB();
+            __ISB();
+            #endif
             mp_obj_t module_fun = mp_make_function_from_raw_code(raw_code, MP_OBJ_NULL, MP_OBJ_NULL);
             mp_hal_set_interrupt_char(CHAR_CTRL_C); // allow ctrl-C to interrupt us
             mp_call_function_0(module_fun);
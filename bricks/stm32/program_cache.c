@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Cache of downloaded user programs in external flash, keyed by their hash.
+//
+// Each program is stored in a littlefs file that is named after the SHA-256
+// hash of its contents in hex. When the region is full, all cached programs
+// are removed to make room for the new one.
+//
+// The external flash may also hold data of other firmware. The last block of
+// the region holds a marker, which is only written if the region was blank.
+// The rest of the region is only formatted if it has this marker. Otherwise
+// the cache is not used at all.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <lfs.h>
+
+#include <pbdrv/block_device.h>
+#include <pbio/error.h>
+#include <pbio/main.h>
+
+#include "lib/crypto-algorithms/sha256.h"
+#include "py/misc.h"
+
+#include "program_cache.h"
+
+// Block that holds the marker, after the blocks of the file system
+#define PROGRAM_CACHE_MARKER_BLOCK (PBDRV_BLOCK_DEVICE_NUM_BLOCKS - 1)
+#define PROGRAM_CACHE_MARKER_OFFSET (PROGRAM_CACHE_MARKER_BLOCK * PBDRV_BLOCK_DEVICE_BLOCK_SIZE)
+
+static const uint8_t program_cache_marker[] = "Pybricks program cache v1";
+
+// Flash operations are blocking. This handles pending events in between, so
+// that Bluetooth and the status light keep working. Unlike pb_stm32_poll(),
+// it doesn't raise pending MicroPython exceptions, since this may be called
+// from within littlefs.
+static void program_cache_yield(void) {
+    while (pbio_do_one_event()) {
+    }
+}
+
+static int program_cache_bd_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size) {
+    pbio_error_t err = pbdrv_block_device_read(block * c->block_size + off, buffer, size);
+    return err == PBIO_SUCCESS ? LFS_ERR_OK : LFS_ERR_IO;
+}
+
+static int program_cache_bd_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size) {
+    // littlefs writes whole cache lines, which are exactly one page
+    pbio_error_t err = pbdrv_block_device_prog(block * c->block_size + off, buffer, size);
+    program_cache_yield();
+    return err == PBIO_SUCCESS ? LFS_ERR_OK : LFS_ERR_IO;
+}
+
+static int program_cache_bd_erase(const struct lfs_config *c, lfs_block_t block) {
+    pbio_error_t err = pbdrv_block_device_erase(block * c->block_size);
+    program_cache_yield();
+    return err == PBIO_SUCCESS ? LFS_ERR_OK : LFS_ERR_IO;
+}
+
+static int program_cache_bd_sync(const struct lfs_config *c) {
+    return LFS_ERR_OK;
+}
+
+// littlefs is built without malloc, so all buffers are static
+static uint8_t read_buffer[PBDRV_BLOCK_DEVICE_PAGE_SIZE];
+static uint8_t prog_buffer[PBDRV_BLOCK_DEVICE_PAGE_SIZE];
+static uint8_t file_buffer[PBDRV_BLOCK_DEVICE_PAGE_SIZE];
+static uint8_t lookahead_buffer[(PBDRV_BLOCK_DEVICE_NUM_BLOCKS + 7) / 8] __attribute__((aligned(4)));
+
+static const struct lfs_config program_cache_lfs_config = {
+    .read = program_cache_bd_read,
+    .prog = program_cache_bd_prog,
+    .erase = program_cache_bd_erase,
+    .sync = program_cache_bd_sync,
+    .read_size = PBDRV_BLOCK_DEVICE_PAGE_SIZE,
+    .prog_size = PBDRV_BLOCK_DEVICE_PAGE_SIZE,
+    .block_size = PBDRV_BLOCK_DEVICE_BLOCK_SIZE,
+    .block_count = PROGRAM_CACHE_MARKER_BLOCK,
+    .block_cycles = 500,
+    .cache_size = PBDRV_BLOCK_DEVICE_PAGE_SIZE,
+    .lookahead_size = sizeof(lookahead_buffer),
+    .read_buffer = read_buffer,
+    .prog_buffer = prog_buffer,
+    .lookahead_buffer = lookahead_buffer,
+};
+
+static const struct lfs_file_config program_cache_file_config = {
+    .buffer = file_buffer,
+};
+
+static lfs_t lfs;
+static bool mounted;
+static bool unusable;
+
+// Tests if the region has the marker of the program cache.
+static bool program_cache_has_marker(void) {
+    uint8_t buf[sizeof(program_cache_marker)];
+    return pbdrv_block_device_read(PROGRAM_CACHE_MARKER_OFFSET, buf, sizeof(buf)) == PBIO_SUCCESS &&
+           memcmp(buf, program_cache_marker, sizeof(buf)) == 0;
+}
+
+// Tests if the whole region is erased, so nothing else uses it.
+static bool program_cache_is_blank(void) {
+    uint8_t buf[PBDRV_BLOCK_DEVICE_PAGE_SIZE];
+
+    for (uint32_t offset = 0; offset < PBDRV_BLOCK_DEVICE_NUM_BLOCKS * PBDRV_BLOCK_DEVICE_BLOCK_SIZE; offset += sizeof(buf)) {
+        if (pbdrv_block_device_read(offset, buf, sizeof(buf)) != PBIO_SUCCESS) {
+            return false;
+        }
+        for (uint32_t i = 0; i < sizeof(buf); i++) {
+            if (buf[i] != 0xff) {
+                return false;
+            }
+        }
+        if (offset % PBDRV_BLOCK_DEVICE_BLOCK_SIZE == 0) {
+            program_cache_yield();
+        }
+    }
+
+    return true;
+}
+
+// Mounts the file system the first time it is needed.
+static pbio_error_t program_cache_mount(void) {
+    if (mounted) {
+        return PBIO_SUCCESS;
+    }
+
+    // Don't check the whole region again if it was in use by something else
+    if (unusable) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+
+    // Only claim the region if nothing else has written to it
+    if (!program_cache_has_marker()) {
+        if (!program_cache_is_blank()) {
+            unusable = true;
+            return PBIO_ERROR_NOT_SUPPORTED;
+        }
+        if (pbdrv_block_device_prog(PROGRAM_CACHE_MARKER_OFFSET, program_cache_marker, sizeof(program_cache_marker)) != PBIO_SUCCESS) {
+            return PBIO_ERROR_IO;
+        }
+    }
+
+    // The region is ours, so it is safe to format if there is no valid file
+    // system yet.
+    if (lfs_mount(&lfs, &program_cache_lfs_config) != LFS_ERR_OK) {
+        if (lfs_format(&lfs, &program_cache_lfs_config) != LFS_ERR_OK ||
+            lfs_mount(&lfs, &program_cache_lfs_config) != LFS_ERR_OK) {
+            return PBIO_ERROR_IO;
+        }
+    }
+
+    mounted = true;
+    return PBIO_SUCCESS;
+}
+
+static void program_cache_hash(const uint8_t *data, uint32_t size, uint8_t *hash) {
+    CRYAL_SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, size);
+    sha256_final(&ctx, hash);
+}
+
+// Gets the file name for a hash.
+static void program_cache_path(const uint8_t *hash, char *path) {
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < PROGRAM_CACHE_HASH_SIZE; i++) {
+        path[i * 2] = hex[hash[i] >> 4];
+        path[i * 2 + 1] = hex[hash[i] & 0xf];
+    }
+    path[PROGRAM_CACHE_HASH_SIZE * 2] = '\0';
+}
+
+// Removes all cached programs.
+static void program_cache_clear(void) {
+    lfs_dir_t dir;
+    struct lfs_info info;
+
+    if (lfs_dir_open(&lfs, &dir, "/") != LFS_ERR_OK) {
+        return;
+    }
+    while (lfs_dir_read(&lfs, &dir, &info) > 0) {
+        if (info.type == LFS_TYPE_REG) {
+            lfs_remove(&lfs, info.name);
+        }
+    }
+    lfs_dir_close(&lfs, &dir);
+}
+
+static int program_cache_write(const char *path, const uint8_t *data, uint32_t size) {
+    lfs_file_t file;
+
+    int ret = lfs_file_opencfg(&lfs, &file, path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC, &program_cache_file_config);
+    if (ret != LFS_ERR_OK) {
+        return ret;
+    }
+
+    lfs_ssize_t written = lfs_file_write(&lfs, &file, data, size);
+    ret = lfs_file_close(&lfs, &file);
+    if (written < 0) {
+        ret = written;
+    }
+
+    // Don't leave a partial program behind
+    if (ret != LFS_ERR_OK) {
+        lfs_remove(&lfs, path);
+    }
+
+    return ret;
+}
+
+/**
+ * Stores a program in the cache, unless it is already there.
+ * @param [in]  data    The program
+ * @param [in]  size    The size of the program
+ * @return              ::PBIO_SUCCESS if the program is in the cache,
+ *                      ::PBIO_ERROR_NOT_SUPPORTED if the flash region is used
+ *                      by something else
+ *                      ::PBIO_ERROR_IO if it could not be stored
+ */
+pbio_error_t program_cache_store(const uint8_t *data, uint32_t size) {
+    pbio_error_t err = program_cache_mount();
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    uint8_t hash[PROGRAM_CACHE_HASH_SIZE];
+    char path[PROGRAM_CACHE_HASH_SIZE * 2 + 1];
+    program_cache_hash(data, size, hash);
+    program_cache_path(hash, path);
+
+    struct lfs_info info;
+    if (lfs_stat(&lfs, path, &info) == LFS_ERR_OK && info.size == size) {
+        return PBIO_SUCCESS;
+    }
+
+    int ret = program_cache_write(path, data, size);
+    if (ret == LFS_ERR_NOSPC) {
+        program_cache_clear();
+        ret = program_cache_write(path, data, size);
+    }
+
+    return ret == LFS_ERR_OK ? PBIO_SUCCESS : PBIO_ERROR_IO;
+}
+
+/**
+ * Loads a program from the cache into a new buffer on the heap.
+ * @param [in]  hash    SHA-256 hash of the program
+ * @param [out] data    The program
+ * @param [out] size    The size of the program
+ * @return              ::PBIO_SUCCESS if the program was loaded,
+ *                      ::PBIO_ERROR_NO_DEV if it is not in the cache,
+ *                      ::PBIO_ERROR_NOT_SUPPORTED if the flash region is used
+ *                      by something else
+ *                      ::PBIO_ERROR_FAILED if there is not enough memory
+ *                      ::PBIO_ERROR_IO if it could not be read
+ */
+pbio_error_t program_cache_load(const uint8_t *hash, uint8_t **data, uint32_t *size) {
+    pbio_error_t err = program_cache_mount();
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    char path[PROGRAM_CACHE_HASH_SIZE * 2 + 1];
+    program_cache_path(hash, path);
+
+    lfs_file_t file;
+    if (lfs_file_opencfg(&lfs, &file, path, LFS_O_RDONLY, &program_cache_file_config) != LFS_ERR_OK) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    lfs_soff_t file_size = lfs_file_size(&lfs, &file);
+    uint8_t *buf = file_size > 0 ? m_malloc_maybe(file_size) : NULL;
+    if (!buf) {
+        lfs_file_close(&lfs, &file);
+        return file_size > 0 ? PBIO_ERROR_FAILED : PBIO_ERROR_IO;
+    }
+
+    lfs_ssize_t read_size = lfs_file_read(&lfs, &file, buf, file_size);
+    lfs_file_close(&lfs, &file);
+
+    // Check that what we read is really the requested program
+    uint8_t actual[PROGRAM_CACHE_HASH_SIZE];
+    if (read_size == file_size) {
+        program_cache_hash(buf, file_size, actual);
+    }
+    if (read_size != file_size || memcmp(hash, actual, PROGRAM_CACHE_HASH_SIZE) != 0) {
+        m_free(buf);
+        lfs_remove(&lfs, path);
+        return PBIO_ERROR_IO;
+    }
+
+    *data = buf;
+    *size = file_size;
+    return PBIO_SUCCESS;
+}
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Cache of downloaded user programs in external flash, keyed by their hash.
+
+#ifndef PYBRICKS_INCLUDED_STM32_PROGRAM_CACHE_H
+#define PYBRICKS_INCLUDED_STM32_PROGRAM_CACHE_H
+
+#include <stdint.h>
+
+#include <pbdrv/config.h>
+#include <pbio/error.h>
+
+// Size of the SHA-256 hash that identifies a program
+#define PROGRAM_CACHE_HASH_SIZE (32)
+
+#if PBDRV_CONFIG_BLOCK_DEVICE
+
+pbio_error_t program_cache_store(const uint8_t *data, uint32_t size);
+pbio_error_t program_cache_load(const uint8_t *hash, uint8_t **data, uint32_t *size);
+
+#else // PBDRV_CONFIG_BLOCK_DEVICE
+
+static inline pbio_error_t program_cache_store(const uint8_t *data, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t program_cache_load(const uint8_t *hash, uint8_t **data, uint32_t *size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE
+
+#endif // PYBRICKS_INCLUDED_STM32_PROGRAM_CACHE_H
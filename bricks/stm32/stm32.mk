@@ -162,12 +162,21 @@ MPY_CROSS = ../../micropython/mpy-cross/mpy-cross
 # TODO: probably only need no-unicode on movehub
 MPY_CROSS_FLAGS += -mno-unicode
 
+# Native code in user programs must match the architecture of the hub
+MPY_CROSS_ARCH_F0 = armv6m
+MPY_CROSS_ARCH_F4 = armv7emsp
+MPY_CROSS_ARCH_L4 = armv7emsp
+ifeq ($(PB_MPY_NATIVE),1)
+MPY_CROSS_FLAGS += -march=$(MPY_CROSS_ARCH_$(PB_MCU_SERIES))
+endif
+
 
 LIBS = "$(shell $(CC) $(CFLAGS) -print-libgcc-file-name)"
 
 SRC_C = $(addprefix bricks/stm32/,\
 	main.c \
 	mphalport.c \
+	program_cache.c \
 	)
 
 # Extra core MicroPython files
@@ -258,6 +267,7 @@ PYBRICKS_PYBRICKS_SRC_C = $(addprefix pybricks/,\
 	robotics/pb_type_spikebase.c \
 	tools/pb_module_tools.c \
 	tools/pb_type_stopwatch.c \
+	tools/pb_type_task.c \
 	util_mp/pb_obj_helper.c \
 	util_mp/pb_type_enum.c \
 	util_pb/pb_color_map.c \
@@ -340,6 +350,9 @@ LITTLEFS_SRC_C = $(addprefix lib/littlefs/,\
 	lfs.c \
 	)
 
+# SHA-256 from MicroPython, used for program cache keys
+LITTLEFS_SRC_C += lib/crypto-algorithms/sha256.c
+
 # Contiki
 
 CONTIKI_SRC_C = $(addprefix lib/contiki-core/,\
@@ -421,6 +434,7 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/adc/adc_stm32_hal.c \
 	drv/adc/adc_stm32f0.c \
 	drv/battery/battery_adc.c \
+	drv/block_device/block_device_w25qxx_stm32.c \
 	drv/bluetooth/bluetooth_btstack_control_gpio.c \
 	drv/bluetooth/bluetooth_btstack_run_loop_contiki.c \
 	drv/bluetooth/bluetooth_btstack_uart_block_stm32_hal.c \
@@ -435,10 +449,12 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/clock/clock_stm32.c \
 	drv/core.c \
 	drv/counter/counter_core.c \
+	drv/counter/counter_rate.c \
 	drv/counter/counter_stm32f0_gpio_quad_enc.c \
 	drv/gpio/gpio_stm32f0.c \
 	drv/gpio/gpio_stm32f4.c \
 	drv/gpio/gpio_stm32l4.c \
+	drv/imu/imu_lsm6ds3tr_c_stm32.c \
 	drv/ioport/ioport_lpf2.c \
 	drv/led/led_array_pwm.c \
 	drv/led/led_array.c \
@@ -446,6 +462,7 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	drv/led/led_dual.c \
 	drv/led/led_pwm.c \
 	drv/pwm/pwm_core.c \
+	drv/pwm/pwm_frame.c \
 	drv/pwm/pwm_lp50xx_stm32.c \
 	drv/pwm/pwm_stm32_tim.c \
 	drv/pwm/pwm_tlc5955_stm32.c \
@@ -463,6 +480,7 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	src/battery.c \
 	src/color/conversion.c \
 	src/control.c \
+	src/control_task.c \
 	src/dcmotor.c \
 	src/drivebase.c \
 	src/error.c \
@@ -477,6 +495,7 @@ PBIO_SRC_C = $(addprefix lib/pbio/,\
 	src/motor_process.c \
 	src/observer.c \
 	src/parent.c \
+	src/profiler.c \
 	src/protocol/lwp3.c \
 	src/protocol/nus.c \
 	src/protocol/pybricks.c \
@@ -565,7 +584,7 @@ ifeq ($(PB_LIB_BTSTACK),1)
 OBJ += $(addprefix $(BUILD)/, $(BTSTACK_SRC_C:.c=.o))
 endif
 ifeq ($(PB_LIB_LITTLEFS),1)
-CFLAGS+= -DLFS_NO_ASSERT -DLFS_NO_MALLOC -DLFS_NO_DEBUG -DLFS_NO_WARN -DLFS_NO_ERROR -DLFS_READONLY
+CFLAGS+= -DLFS_NO_ASSERT -DLFS_NO_MALLOC -DLFS_NO_DEBUG -DLFS_NO_WARN -DLFS_NO_ERROR
 OBJ += $(addprefix $(BUILD)/, $(LITTLEFS_SRC_C:.c=.o))
 endif
 ifeq ($(PB_USE_HAL),1)
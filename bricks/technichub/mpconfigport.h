@@ -43,5 +43,6 @@
 #define PYBRICKS_STM32_OPT_FLOAT        (1)
 #define PYBRICKS_STM32_OPT_TERSE_ERR    (0)
 #define PYBRICKS_STM32_OPT_EXTRA_MOD    (1)
+#define PYBRICKS_STM32_OPT_NATIVE       (1)
 
 #include "../stm32/configport.h"
@@ -82,7 +82,12 @@ bStatus_t ATT_WriteRsp(uint16_t connHandle) {
 }
 
 bStatus_t ATT_HandleValueNoti(uint16_t connHandle, attHandleValueNoti_t *pNoti) {
-    uint8_t buf[32];
+    // Notifications have 3 bytes of overhead
+    uint8_t buf[5 + ATT_MAX_MTU_SIZE - 3];
+
+    if (pNoti->len > sizeof(buf) - 5) {
+        return bleInvalidRange;
+    }
 
     buf[0] = connHandle & 0xFF;
     buf[1] = (connHandle >> 8) & 0xFF;
@@ -172,6 +172,13 @@ exit_process(struct process *p, struct process *fromprocess)
   process_current = old_current;
 }
 /*---------------------------------------------------------------------------*/
+#ifndef PROCESS_CONF_CALL_BEGIN
+#define PROCESS_CONF_CALL_BEGIN(p)
+#endif
+#ifndef PROCESS_CONF_CALL_END
+#define PROCESS_CONF_CALL_END(p)
+#endif
+/*---------------------------------------------------------------------------*/
 static void
 call_process(struct process *p, process_event_t ev, process_data_t data)
 {
@@ -188,7 +195,9 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event 0x%02X\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+    PROCESS_CONF_CALL_BEGIN(p);
     ret = p->thread(&p->pt, ev, data);
+    PROCESS_CONF_CALL_END(p);
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
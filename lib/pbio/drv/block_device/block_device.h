@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Block device drivers
+
+#ifndef _INTERNAL_PBDRV_BLOCK_DEVICE_H_
+#define _INTERNAL_PBDRV_BLOCK_DEVICE_H_
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE
+
+/** Initializes the block device driver. */
+void pbdrv_block_device_init(void);
+
+#else // PBDRV_CONFIG_BLOCK_DEVICE
+
+#define pbdrv_block_device_init()
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE
+
+#endif // _INTERNAL_PBDRV_BLOCK_DEVICE_H_
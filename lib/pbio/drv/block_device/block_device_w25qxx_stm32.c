@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Block device driver for Winbond W25Qxx SPI flash connected to STM32 MCU.
+//
+// All operations are blocking. Reads and writes of a page take well under a
+// millisecond, but erasing a block can take tens of milliseconds, so this
+// should not be used while a user program is running.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include STM32_HAL_H
+
+#include <pbdrv/block_device.h>
+#include <pbio/error.h>
+
+#include "block_device_w25qxx_stm32.h"
+
+// Timeout for SPI transfers (ms)
+#define W25QXX_SPI_TIMEOUT (100)
+
+// Maximum time to program a page or erase a block, from the datasheet (ms)
+#define W25QXX_PROG_TIMEOUT (5)
+#define W25QXX_ERASE_TIMEOUT (500)
+
+/** W25Qxx instructions. */
+enum {
+    W25QXX_WRITE_ENABLE = 0x06,
+    W25QXX_READ_STATUS_1 = 0x05,
+    W25QXX_RELEASE_POWER_DOWN = 0xab,
+    #if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_ADDR_4BYTE
+    W25QXX_READ_DATA = 0x13,
+    W25QXX_PAGE_PROGRAM = 0x12,
+    W25QXX_SECTOR_ERASE = 0x21,
+    #else
+    W25QXX_READ_DATA = 0x03,
+    W25QXX_PAGE_PROGRAM = 0x02,
+    W25QXX_SECTOR_ERASE = 0x20,
+    #endif
+};
+
+/** Status register 1 flag that is set while the chip is busy. */
+#define W25QXX_STATUS_BUSY (1 << 0)
+
+static SPI_HandleTypeDef w25qxx_hspi;
+
+static void w25qxx_select(bool select) {
+    const pbdrv_block_device_w25qxx_stm32_platform_data_t *pdata = &pbdrv_block_device_w25qxx_stm32_platform_data;
+    HAL_GPIO_WritePin(pdata->ncs_gpio, pdata->ncs_gpio_pin, select ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+// Sends an instruction with an optional address and optionally sends or
+// receives data after it, all with chip select held low.
+static pbio_error_t w25qxx_command(uint8_t instruction, bool has_address, uint32_t address,
+    const uint8_t *tx, uint8_t *rx, uint32_t size) {
+
+    uint8_t header[5];
+    uint32_t header_size = 0;
+
+    header[header_size++] = instruction;
+    if (has_address) {
+        address += PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_OFFSET;
+        #if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_ADDR_4BYTE
+        header[header_size++] = address >> 24;
+        #endif
+        header[header_size++] = address >> 16;
+        header[header_size++] = address >> 8;
+        header[header_size++] = address;
+    }
+
+    HAL_StatusTypeDef status;
+
+    w25qxx_select(true);
+    status = HAL_SPI_Transmit(&w25qxx_hspi, header, header_size, W25QXX_SPI_TIMEOUT);
+    if (status == HAL_OK && tx) {
+        status = HAL_SPI_Transmit(&w25qxx_hspi, (uint8_t *)tx, size, W25QXX_SPI_TIMEOUT);
+    }
+    if (status == HAL_OK && rx) {
+        status = HAL_SPI_Receive(&w25qxx_hspi, rx, size, W25QXX_SPI_TIMEOUT);
+    }
+    w25qxx_select(false);
+
+    return status == HAL_OK ? PBIO_SUCCESS : PBIO_ERROR_IO;
+}
+
+// Waits until a program or erase operation is done
+static pbio_error_t w25qxx_wait_ready(uint32_t timeout) {
+    uint32_t start = HAL_GetTick();
+    uint8_t status;
+
+    do {
+        pbio_error_t err = w25qxx_command(W25QXX_READ_STATUS_1, false, 0, NULL, &status, 1);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+        if (!(status & W25QXX_STATUS_BUSY)) {
+            return PBIO_SUCCESS;
+        }
+    } while (HAL_GetTick() - start <= timeout);
+
+    return PBIO_ERROR_TIMEDOUT;
+}
+
+void pbdrv_block_device_init(void) {
+    const pbdrv_block_device_w25qxx_stm32_platform_data_t *pdata = &pbdrv_block_device_w25qxx_stm32_platform_data;
+
+    GPIO_InitTypeDef gpio_init = {
+        .Pin = pdata->ncs_gpio_pin,
+        .Mode = GPIO_MODE_OUTPUT_PP,
+        .Pull = GPIO_NOPULL,
+        .Speed = GPIO_SPEED_FREQ_HIGH,
+    };
+    HAL_GPIO_Init(pdata->ncs_gpio, &gpio_init);
+    w25qxx_select(false);
+
+    w25qxx_hspi.Instance = pdata->spi;
+    w25qxx_hspi.Init.Mode = SPI_MODE_MASTER;
+    w25qxx_hspi.Init.Direction = SPI_DIRECTION_2LINES;
+    w25qxx_hspi.Init.DataSize = SPI_DATASIZE_8BIT;
+    w25qxx_hspi.Init.CLKPolarity = SPI_POLARITY_LOW;
+    w25qxx_hspi.Init.CLKPhase = SPI_PHASE_1EDGE;
+    w25qxx_hspi.Init.NSS = SPI_NSS_SOFT;
+    w25qxx_hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_2;
+    w25qxx_hspi.Init.FirstBit = SPI_FIRSTBIT_MSB;
+    w25qxx_hspi.Init.TIMode = SPI_TIMODE_DISABLE;
+    w25qxx_hspi.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
+    HAL_SPI_Init(&w25qxx_hspi);
+
+    // The chip may have been put in power down mode by the bootloader.
+    w25qxx_command(W25QXX_RELEASE_POWER_DOWN, false, 0, NULL, NULL, 0);
+}
+
+static bool w25qxx_in_range(uint32_t offset, uint32_t size) {
+    return offset <= PBDRV_CONFIG_BLOCK_DEVICE_SIZE && size <= PBDRV_CONFIG_BLOCK_DEVICE_SIZE - offset;
+}
+
+pbio_error_t pbdrv_block_device_read(uint32_t offset, uint8_t *buf, uint32_t size) {
+    if (!w25qxx_in_range(offset, size)) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    return w25qxx_command(W25QXX_READ_DATA, true, offset, NULL, buf, size);
+}
+
+pbio_error_t pbdrv_block_device_prog(uint32_t offset, const uint8_t *buf, uint32_t size) {
+    if (!w25qxx_in_range(offset, size) ||
+        offset / PBDRV_BLOCK_DEVICE_PAGE_SIZE != (offset + size - 1) / PBDRV_BLOCK_DEVICE_PAGE_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbio_error_t err = w25qxx_command(W25QXX_WRITE_ENABLE, false, 0, NULL, NULL, 0);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    err = w25qxx_command(W25QXX_PAGE_PROGRAM, true, offset, buf, NULL, size);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    return w25qxx_wait_ready(W25QXX_PROG_TIMEOUT);
+}
+
+pbio_error_t pbdrv_block_device_erase(uint32_t offset) {
+    if (!w25qxx_in_range(offset, PBDRV_BLOCK_DEVICE_BLOCK_SIZE) || offset % PBDRV_BLOCK_DEVICE_BLOCK_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbio_error_t err = w25qxx_command(W25QXX_WRITE_ENABLE, false, 0, NULL, NULL, 0);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    err = w25qxx_command(W25QXX_SECTOR_ERASE, true, offset, NULL, NULL, 0);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+    return w25qxx_wait_ready(W25QXX_ERASE_TIMEOUT);
+}
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Block device driver for Winbond W25Qxx SPI flash connected to STM32 MCU.
+
+#ifndef _INTERNAL_PBDRV_BLOCK_DEVICE_W25QXX_STM32_H_
+#define _INTERNAL_PBDRV_BLOCK_DEVICE_W25QXX_STM32_H_
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32
+
+#include <stdint.h>
+
+#include STM32_H
+
+/** Platform-specific device information. */
+typedef struct {
+    /** The SPI peripheral to use. */
+    SPI_TypeDef *spi;
+    /** Chip select GPIO bank. */
+    GPIO_TypeDef *ncs_gpio;
+    /** Chip select GPIO pin. */
+    uint16_t ncs_gpio_pin;
+} pbdrv_block_device_w25qxx_stm32_platform_data_t;
+
+/** Platform-specific data - defined in platform.c */
+extern const pbdrv_block_device_w25qxx_stm32_platform_data_t pbdrv_block_device_w25qxx_stm32_platform_data;
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32
+
+#endif // _INTERNAL_PBDRV_BLOCK_DEVICE_W25QXX_STM32_H_
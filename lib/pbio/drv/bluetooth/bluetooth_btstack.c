@@ -91,6 +91,13 @@ static pbdrv_bluetooth_receive_handler_t receive_handler;
 static pbdrv_bluetooth_receive_handler_t notification_handler;
 static pup_handset_t handset;
 static uint8_t *event_packet;
+
+// Notifications that have been handed to us but have not been sent yet
+static pbdrv_bluetooth_send_context_t *send_queue[PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS];
+static uint8_t send_queue_head;
+static uint8_t send_queue_count;
+static btstack_context_callback_registration_t send_request;
+static bool send_request_pending;
 static const pbdrv_bluetooth_btstack_platform_data_t *pdata = &pbdrv_bluetooth_btstack_platform_data;
 
 // note on baud rate: with a 48MHz clock, 3000000 baud is the highest we can
@@ -123,13 +130,6 @@ static pbio_error_t att_error_to_pbio_error(uint8_t status) {
     }
 }
 
-static void pybricks_can_send(void *context) {
-    pbdrv_bluetooth_send_context_t *send = context;
-
-    pybricks_service_server_send(pybricks_con_handle, send->data, send->size);
-    send->done();
-}
-
 static void pybricks_data_received(hci_con_handle_t tx_con_handle, const uint8_t *data, uint16_t size) {
     if (receive_handler) {
         receive_handler(PBDRV_BLUETOOTH_CONNECTION_PYBRICKS, data, size);
@@ -140,13 +140,6 @@ static void pybricks_configured(hci_con_handle_t tx_con_handle, uint16_t value)
     pybricks_con_handle = value ? tx_con_handle : HCI_CON_HANDLE_INVALID;
 }
 
-static void nordic_can_send(void *context) {
-    pbdrv_bluetooth_send_context_t *send = context;
-
-    nordic_spp_service_server_send(uart_con_handle, send->data, send->size);
-    send->done();
-}
-
 static void nordic_spp_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size) {
     switch (packet_type) {
         case HCI_EVENT_PACKET:
@@ -285,6 +278,9 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                 le_con_handle = HCI_CON_HANDLE_INVALID;
                 pybricks_con_handle = HCI_CON_HANDLE_INVALID;
                 uart_con_handle = HCI_CON_HANDLE_INVALID;
+                // Anything that is still queued was for this connection
+                send_queue_count = 0;
+                send_request_pending = false;
             } else if (hci_event_disconnection_complete_get_connection_handle(packet) == handset.con_handle) {
                 gatt_client_stop_listening_for_characteristic_value_updates(&handset.notification);
                 handset.con_handle = HCI_CON_HANDLE_INVALID;
@@ -514,24 +510,67 @@ bool pbdrv_bluetooth_is_connected(pbdrv_bluetooth_connection_t connection) {
     return false;
 }
 
+uint16_t pbdrv_bluetooth_get_max_notification_size(void) {
+    // MTU is 0 when not connected. Notifications have 3 bytes of overhead.
+    uint16_t mtu = att_server_get_mtu(le_con_handle);
+    return mtu > 3 ? mtu - 3 : 0;
+}
+
 void pbdrv_bluetooth_set_on_event(pbdrv_bluetooth_on_event_t on_event) {
     bluetooth_on_event = on_event;
 }
 
-void pbdrv_bluetooth_send(pbdrv_bluetooth_send_context_t *context) {
-    static btstack_context_callback_registration_t send_request;
+static void send_can_send(void *context);
 
-    send_request.context = context;
+// Asks BTStack to call us back when the next queued notification can be sent.
+static void send_request_can_send_now(void) {
+    if (send_request_pending || !send_queue_count) {
+        return;
+    }
+
+    send_request.callback = &send_can_send;
+    send_request_pending = true;
 
-    if (context->connection == PBDRV_BLUETOOTH_CONNECTION_PYBRICKS) {
-        send_request.callback = &pybricks_can_send;
+    if (send_queue[send_queue_head]->connection == PBDRV_BLUETOOTH_CONNECTION_PYBRICKS) {
         pybricks_service_server_request_can_send_now(&send_request, pybricks_con_handle);
-    } else if (context->connection == PBDRV_BLUETOOTH_CONNECTION_UART) {
-        send_request.callback = &nordic_can_send;
+    } else {
         nordic_spp_service_server_request_can_send_now(&send_request, uart_con_handle);
     }
 }
 
+static void send_can_send(void *context) {
+    send_request_pending = false;
+
+    // Send as many notifications as the controller has ACL buffers for. BTStack
+    // copies each one, so the sender can reuse its buffer right away.
+    while (send_queue_count) {
+        pbdrv_bluetooth_send_context_t *send = send_queue[send_queue_head];
+        int ret;
+
+        if (send->connection == PBDRV_BLUETOOTH_CONNECTION_PYBRICKS) {
+            ret = pybricks_service_server_send(pybricks_con_handle, send->data, send->size);
+        } else {
+            ret = nordic_spp_service_server_send(uart_con_handle, send->data, send->size);
+        }
+
+        if (ret == BTSTACK_ACL_BUFFERS_FULL) {
+            break;
+        }
+
+        send_queue_head = (send_queue_head + 1) % PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS;
+        send_queue_count--;
+        send->done();
+    }
+
+    send_request_can_send_now();
+}
+
+void pbdrv_bluetooth_send(pbdrv_bluetooth_send_context_t *context) {
+    send_queue[(send_queue_head + send_queue_count) % PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS] = context;
+    send_queue_count++;
+    send_request_can_send_now();
+}
+
 void pbdrv_bluetooth_set_receive_handler(pbdrv_bluetooth_receive_handler_t handler) {
     receive_handler = handler;
 }
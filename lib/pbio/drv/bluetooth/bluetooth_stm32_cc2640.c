@@ -113,6 +113,8 @@ static bool hci_command_complete;
 static bool advertising_data_received;
 // handle to connected Bluetooth device
 static uint16_t conn_handle = NO_CONNECTION;
+// ATT MTU negotiated with connected Bluetooth device
+static uint16_t conn_mtu = ATT_MTU_SIZE;
 // handle to connected remote control
 static uint16_t remote_handle = NO_CONNECTION;
 // handle to LWP3 characteristic on remote
@@ -132,6 +134,10 @@ static bool pybricks_notify_en;
 static uint16_t uart_service_handle, uart_service_end_handle, uart_rx_char_handle, uart_tx_char_handle;
 // Nordic UART tx notifications enabled
 static bool uart_tx_notify_en;
+// Notifications that have been handed to us but have not been sent yet
+static pbdrv_bluetooth_send_context_t *send_queue[PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS];
+static uint8_t send_queue_head;
+static uint8_t send_queue_count;
 
 PROCESS(pbdrv_bluetooth_spi_process, "Bluetooth SPI");
 
@@ -351,69 +357,103 @@ bool pbdrv_bluetooth_is_connected(pbdrv_bluetooth_connection_t connection) {
     return false;
 }
 
+uint16_t pbdrv_bluetooth_get_max_notification_size(void) {
+    // Only report what ATT_HandleValueNoti() can actually send, even if the
+    // client asked for something else.
+    uint16_t mtu = conn_mtu;
+    if (mtu < ATT_MTU_SIZE) {
+        mtu = ATT_MTU_SIZE;
+    }
+    if (mtu > ATT_MAX_MTU_SIZE) {
+        mtu = ATT_MAX_MTU_SIZE;
+    }
+
+    // Notifications have 3 bytes of overhead
+    return mtu - 3;
+}
+
 void pbdrv_bluetooth_set_on_event(pbdrv_bluetooth_on_event_t on_event) {
     bluetooth_on_event = on_event;
 }
 
 /**
- * Handles sending data via a characteristic value notification.
+ * Handles sending data via characteristic value notifications.
+ *
+ * This sends all queued notifications, so the next one is sent as soon as
+ * the Bluetooth chip has accepted the previous one.
  */
 static PT_THREAD(send_value_notification(struct pt *pt, pbio_task_t *task))
 {
-    pbdrv_bluetooth_send_context_t *send = task->context;
+    static pbdrv_bluetooth_send_context_t *send;
 
     PT_BEGIN(pt);
 
-retry:
-    PT_WAIT_WHILE(pt, write_xfer_size);
+    while (send_queue_count) {
+        send = send_queue[send_queue_head];
 
-    uint16_t attr_handle;
-    if (send->connection == PBDRV_BLUETOOTH_CONNECTION_PYBRICKS) {
-        if (!pybricks_notify_en) {
-            task->status = PBIO_ERROR_INVALID_OP;
-            goto done;
-        }
-        attr_handle = pybricks_char_handle;
-    } else if (send->connection == PBDRV_BLUETOOTH_CONNECTION_UART) {
-        if (!uart_tx_notify_en) {
-            task->status = PBIO_ERROR_INVALID_OP;
+    retry:
+        PT_WAIT_WHILE(pt, write_xfer_size);
+
+        uint16_t attr_handle;
+        if (send->connection == PBDRV_BLUETOOTH_CONNECTION_PYBRICKS) {
+            if (!pybricks_notify_en) {
+                goto done;
+            }
+            attr_handle = pybricks_char_handle;
+        } else if (send->connection == PBDRV_BLUETOOTH_CONNECTION_UART) {
+            if (!uart_tx_notify_en) {
+                goto done;
+            }
+            attr_handle = uart_tx_char_handle;
+        } else {
+            // called with invalid connection
+            assert(0);
             goto done;
         }
-        attr_handle = uart_tx_char_handle;
-    } else {
-        // called with invalid connection
-        assert(0);
-        task->status = PBIO_ERROR_INVALID_ARG;
-        goto done;
-    }
 
-    {
-        attHandleValueNoti_t req;
+        {
+            attHandleValueNoti_t req;
 
-        req.handle = attr_handle;
-        req.len = send->size;
-        req.pValue = send->data;
-        ATT_HandleValueNoti(conn_handle, &req);
-    }
-    PT_WAIT_UNTIL(pt, hci_command_status);
+            req.handle = attr_handle;
+            req.len = send->size;
+            req.pValue = send->data;
+            if (ATT_HandleValueNoti(conn_handle, &req) != bleSUCCESS) {
+                // too big for the ATT layer, so nothing was sent
+                goto done;
+            }
+        }
+        PT_WAIT_UNTIL(pt, hci_command_status);
 
-    HCI_StatusCodes_t status = read_buf[8];
-    if (status == blePending) {
-        goto retry;
+        // The chip can't take it yet, so try again
+        HCI_StatusCodes_t status = read_buf[8];
+        if (status == blePending) {
+            goto retry;
+        }
+
+    done:
+        send_queue_head = (send_queue_head + 1) % PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS;
+        send_queue_count--;
+        send->done();
     }
 
     task->status = PBIO_SUCCESS;
 
-done:
-    send->done();
-
     PT_END(pt);
 }
 
 void pbdrv_bluetooth_send(pbdrv_bluetooth_send_context_t *context) {
     static pbio_task_t task;
-    pbio_task_init(&task, send_value_notification, context);
-    pbio_task_queue_add(task_queue, &task);
+
+    assert(send_queue_count < PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS);
+
+    send_queue[(send_queue_head + send_queue_count) % PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS] = context;
+    send_queue_count++;
+
+    // The task is still running if it has not sent everything yet
+    if (task.status != PBIO_ERROR_AGAIN) {
+        pbio_task_init(&task, send_value_notification, NULL);
+        pbio_task_queue_add(task_queue, &task);
+    }
 }
 
 void pbdrv_bluetooth_set_receive_handler(pbdrv_bluetooth_receive_handler_t handler) {
@@ -798,9 +838,13 @@ static void handle_event(uint8_t *packet) {
             switch (event_code) {
                 case ATT_EVENT_EXCHANGE_MTU_REQ: {
                     attExchangeMTURsp_t rsp;
+                    uint16_t client_rx_mtu = (data[7] << 8) | data[6];
 
-                    rsp.serverRxMTU = 158;
+                    rsp.serverRxMTU = ATT_MAX_MTU_SIZE;
                     ATT_ExchangeMTURsp(connection_handle, &rsp);
+
+                    // Both sides use the smaller of the two
+                    conn_mtu = client_rx_mtu < rsp.serverRxMTU ? client_rx_mtu : rsp.serverRxMTU;
                 }
                 break;
 
@@ -1149,6 +1193,7 @@ static void handle_event(uint8_t *packet) {
                     DBG("bye: %04x", connection_handle);
                     if (conn_handle == connection_handle) {
                         conn_handle = NO_CONNECTION;
+                        conn_mtu = ATT_MTU_SIZE;
                         pybricks_notify_en = false;
                         uart_tx_notify_en = false;
                     } else if (remote_handle == connection_handle) {
@@ -1617,6 +1662,7 @@ PROCESS_THREAD(pbdrv_bluetooth_spi_process, ev, data) {
         bluetooth_reset(RESET_STATE_OUT_LOW);
         bluetooth_ready = pybricks_notify_en = uart_tx_notify_en = false;
         conn_handle = remote_handle = remote_lwp3_char_handle = NO_CONNECTION;
+        conn_mtu = ATT_MTU_SIZE;
         PROCESS_EXIT();
     });
 
@@ -24,4 +24,14 @@ uint32_t pbdrv_clock_get_us(void) {
     return time_val.tv_sec * 1000000 + time_val.tv_nsec / 1000;
 }
 
+uint32_t pbdrv_clock_get_cycles(void) {
+    struct timespec time_val;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time_val);
+    return (uint32_t)time_val.tv_sec * 1000000000 + time_val.tv_nsec;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1000;
+}
+
 #endif // PBDRV_CONFIG_CLOCK_LINUX
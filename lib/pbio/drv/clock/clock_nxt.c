@@ -27,4 +27,12 @@ uint32_t pbdrv_clock_get_us(void) {
     return systick_get_us();
 }
 
+uint32_t pbdrv_clock_get_cycles(void) {
+    return systick_get_us();
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1;
+}
+
 #endif // PBDRV_CONFIG_CLOCK_NXT
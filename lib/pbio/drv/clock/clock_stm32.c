@@ -16,6 +16,13 @@ volatile uint32_t pbdrv_clock_ticks;
 
 void pbdrv_clock_init(void) {
     // STM32 does platform-specific clock init early in SystemInit()
+
+    #if __CORTEX_M >= 3
+    // Start the cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
 }
 
 uint32_t pbdrv_clock_get_ms(void) {
@@ -55,6 +62,30 @@ uint32_t pbdrv_clock_get_us(void) {
     return msec * 1000 + (counter * 1000) / (load + 1);
 }
 
+#if __CORTEX_M >= 3
+
+uint32_t pbdrv_clock_get_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return SystemCoreClock / 1000000;
+}
+
+#else // __CORTEX_M >= 3
+
+// Cortex-M0 does not have a cycle counter, so we use microseconds instead.
+
+uint32_t pbdrv_clock_get_cycles(void) {
+    return pbdrv_clock_get_us();
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1;
+}
+
+#endif // __CORTEX_M >= 3
+
 void SysTick_Handler(void) {
     pbdrv_clock_ticks++;
 
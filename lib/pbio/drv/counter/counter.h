@@ -14,6 +14,7 @@ typedef struct {
     pbio_error_t (*get_count)(pbdrv_counter_dev_t *dev, int32_t *count);
     pbio_error_t (*get_abs_count)(pbdrv_counter_dev_t *dev, int32_t *count);
     pbio_error_t (*get_rate)(pbdrv_counter_dev_t *dev, int32_t *rate);
+    pbio_error_t (*get_rate_confidence)(pbdrv_counter_dev_t *dev, int32_t *rate, uint8_t *confidence);
 } pbdrv_counter_funcs_t;
 
 struct _pbdrv_counter_dev_t {
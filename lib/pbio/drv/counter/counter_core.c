@@ -83,4 +83,23 @@ pbio_error_t pbdrv_counter_get_rate(pbdrv_counter_dev_t *dev, int32_t *rate) {
     return dev->funcs->get_rate(dev, rate);
 }
 
+/**
+ * Gets the counter rate in counts per second and how well it is known, if the
+ * counter supports it.
+ * @param [in]  dev         Pointer to the counter device
+ * @param [out] rate        Returns the rate on success
+ * @param [out] confidence  Returns the confidence from 0 to 100 on success
+ * @return                  ::PBIO_SUCCESS on success, ::PBIO_ERROR_NO_DEV if the
+ *                          counter has not been initialized, ::PBIO_ERROR_NOT_SUPPORTED
+ *                          if this counter does not support it or the counter
+ *                          driver is disabled.
+ */
+pbio_error_t pbdrv_counter_get_rate_confidence(pbdrv_counter_dev_t *dev, int32_t *rate, uint8_t *confidence) {
+    if (!dev->funcs->get_rate_confidence) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+
+    return dev->funcs->get_rate_confidence(dev, rate, confidence);
+}
+
 #endif // PBDRV_CONFIG_COUNTER
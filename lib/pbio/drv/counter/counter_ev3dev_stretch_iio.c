@@ -1,17 +1,26 @@
 // SPDX-License-Identifier: MIT
-// Copyright (c) 2019-2020 The Pybricks Authors
+// Copyright (c) 2019-2021 The Pybricks Authors
 
 // ev3dev-stretch PRU/IIO Quadrature Encoder Counter driver
 //
 // This driver uses the PRU quadrature encoder found in ev3dev-stretch.
+//
+// If the IIO device supports buffered capture, the count and rate of all
+// channels are read from its character device in one binary read per control
+// cycle. Otherwise, each value is read from its own sysfs attribute.
 
 #include <pbdrv/config.h>
 
 #if PBDRV_CONFIG_COUNTER_EV3DEV_STRETCH_IIO
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <libudev.h>
 
@@ -25,48 +34,155 @@
 #define dbg_err(s)
 #endif
 
+#define NUM_DEV PBDRV_CONFIG_COUNTER_EV3DEV_STRETCH_IIO_NUM_DEV
+
+// Maximum number of scans taken from the kernel buffer in one read
+#define MAX_SCANS (16)
+
 typedef struct {
     pbdrv_counter_dev_t *dev;
-    FILE *count;
-    FILE *rate;
+    /** Channel index */
+    uint8_t index;
+    /** File descriptor of the count sysfs attribute */
+    int count;
+    /** File descriptor of the rate sysfs attribute */
+    int rate;
 } private_data_t;
 
-static private_data_t private_data[PBDRV_CONFIG_COUNTER_EV3DEV_STRETCH_IIO_NUM_DEV];
+static private_data_t private_data[NUM_DEV];
 
-static pbio_error_t pbdrv_counter_ev3dev_stretch_iio_get_count(pbdrv_counter_dev_t *dev, int32_t *count) {
-    private_data_t *priv = dev->priv;
+/** Location of one channel value in a scan of the IIO buffer. */
+typedef struct {
+    uint8_t offset;
+    uint8_t bytes;
+    uint8_t bits;
+    uint8_t shift;
+    bool is_signed;
+} scan_element_t;
+
+/** Buffered capture state shared by all channels. */
+static struct {
+    /** File descriptor of the IIO character device, or -1 if not used */
+    int fd;
+    /** Size of one scan in bytes */
+    size_t scan_size;
+    /** Layout of the count (0 to NUM_DEV - 1) and rate (NUM_DEV and up) values */
+    scan_element_t element[NUM_DEV * 2];
+    /** Values from the most recent scan, in the same order as element */
+    int32_t value[NUM_DEV * 2];
+    /** Flags for values that were already read since the last scan */
+    uint32_t consumed;
+    /** Whether at least one scan was received */
+    bool valid;
+    /** Receive buffer for several scans */
+    uint8_t data[MAX_SCANS * NUM_DEV * 2 * sizeof(int64_t)];
+} buffer = { .fd = -1 };
+
+static int32_t scan_element_get(const scan_element_t *e, const uint8_t *scan) {
+    uint64_t raw = 0;
+
+    // Elements are little endian, which was checked when enabling them
+    for (int i = e->bytes - 1; i >= 0; i--) {
+        raw = raw << 8 | scan[e->offset + i];
+    }
+    raw >>= e->shift;
 
-    if (!priv->count) {
-        return PBIO_ERROR_NO_DEV;
+    if (e->bits < 64) {
+        raw &= (UINT64_C(1) << e->bits) - 1;
+        if (e->is_signed && raw & (UINT64_C(1) << (e->bits - 1))) {
+            raw |= ~((UINT64_C(1) << e->bits) - 1);
+        }
     }
 
-    if (fseek(priv->count, 0, SEEK_SET) == -1) {
-        return PBIO_ERROR_IO;
+    return (int32_t)raw;
+}
+
+// Takes the latest scan from the kernel buffer, if there is a new one.
+static void buffer_update(void) {
+    ssize_t max_size = MAX_SCANS * buffer.scan_size;
+    ssize_t size;
+
+    // The kernel buffer is drained so the newest scan is used. Usually this
+    // takes a single read, since we read every control cycle.
+    do {
+        size = read(buffer.fd, buffer.data, max_size);
+        if (size >= (ssize_t)buffer.scan_size) {
+            ssize_t latest = size - size % buffer.scan_size - buffer.scan_size;
+            for (size_t i = 0; i < PBIO_ARRAY_SIZE(buffer.element); i++) {
+                buffer.value[i] = scan_element_get(&buffer.element[i], &buffer.data[latest]);
+            }
+            buffer.valid = true;
+        }
+    } while (size == max_size);
+
+    buffer.consumed = 0;
+}
+
+// Gets a value from the latest scan. A new scan is read when this value was
+// already used since the last one, which happens once per control cycle.
+static bool buffer_get(uint8_t element, int32_t *value) {
+    if (buffer.fd == -1) {
+        return false;
+    }
+
+    if (buffer.consumed & (1 << element)) {
+        buffer_update();
+    }
+
+    if (!buffer.valid) {
+        // Nothing received yet, so the caller uses sysfs this time.
+        buffer_update();
+        if (!buffer.valid) {
+            return false;
+        }
     }
 
-    if (fscanf(priv->count, "%d", count) == EOF) {
+    buffer.consumed |= 1 << element;
+    *value = buffer.value[element];
+    return true;
+}
+
+// Reads an integer from a sysfs attribute with a single system call.
+static pbio_error_t sysfs_read_int(int fd, int32_t *value) {
+    char buf[16];
+
+    ssize_t size = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (size <= 0) {
         return PBIO_ERROR_IO;
     }
+    buf[size] = '\0';
+
+    *value = strtol(buf, NULL, 10);
 
     return PBIO_SUCCESS;
 }
 
-static pbio_error_t pbdrv_counter_ev3dev_stretch_iio_get_rate(pbdrv_counter_dev_t *dev, int32_t *rate) {
+static pbio_error_t pbdrv_counter_ev3dev_stretch_iio_get_count(pbdrv_counter_dev_t *dev, int32_t *count) {
     private_data_t *priv = dev->priv;
 
-    if (!priv->rate) {
+    if (buffer_get(priv->index, count)) {
+        return PBIO_SUCCESS;
+    }
+
+    if (priv->count == -1) {
         return PBIO_ERROR_NO_DEV;
     }
 
-    if (fseek(priv->rate, 0, SEEK_SET) == -1) {
-        return PBIO_ERROR_IO;
+    return sysfs_read_int(priv->count, count);
+}
+
+static pbio_error_t pbdrv_counter_ev3dev_stretch_iio_get_rate(pbdrv_counter_dev_t *dev, int32_t *rate) {
+    private_data_t *priv = dev->priv;
+
+    if (buffer_get(NUM_DEV + priv->index, rate)) {
+        return PBIO_SUCCESS;
     }
 
-    if (fscanf(priv->rate, "%d", rate) == EOF) {
-        return PBIO_ERROR_IO;
+    if (priv->rate == -1) {
+        return PBIO_ERROR_NO_DEV;
     }
 
-    return PBIO_SUCCESS;
+    return sysfs_read_int(priv->rate, rate);
 }
 
 static const pbdrv_counter_funcs_t pbdrv_counter_ev3dev_stretch_iio_funcs = {
@@ -74,6 +190,129 @@ static const pbdrv_counter_funcs_t pbdrv_counter_ev3dev_stretch_iio_funcs = {
     .get_rate = pbdrv_counter_ev3dev_stretch_iio_get_rate,
 };
 
+static bool sysfs_write(const char *syspath, const char *attr, const char *value) {
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/%s", syspath, attr);
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+
+    bool ok = fputs(value, f) >= 0;
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+static bool sysfs_read(const char *syspath, const char *attr, char *value, size_t size) {
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/%s", syspath, attr);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    bool ok = fgets(value, size, f) != NULL;
+    fclose(f);
+    return ok;
+}
+
+// Enables one scan element and gets its type. Offsets are filled in later.
+static bool buffer_enable_element(const char *syspath, const char *name, scan_element_t *e, uint32_t *index) {
+    char attr[64];
+    char value[32];
+    char endian, sign;
+    unsigned int bits, storage, shift = 0;
+
+    snprintf(attr, sizeof(attr), "scan_elements/%s_en", name);
+    if (!sysfs_write(syspath, attr, "1")) {
+        return false;
+    }
+
+    snprintf(attr, sizeof(attr), "scan_elements/%s_index", name);
+    if (!sysfs_read(syspath, attr, value, sizeof(value))) {
+        return false;
+    }
+    *index = strtoul(value, NULL, 10);
+
+    // The type looks like "le:s32/32>>0"
+    snprintf(attr, sizeof(attr), "scan_elements/%s_type", name);
+    if (!sysfs_read(syspath, attr, value, sizeof(value)) ||
+        sscanf(value, "%ce:%c%u/%u>>%u", &endian, &sign, &bits, &storage, &shift) < 4 ||
+        endian != 'l' || storage % 8 || storage > 64 || bits == 0 || bits > storage) {
+        return false;
+    }
+
+    e->bytes = storage / 8;
+    e->bits = bits;
+    e->shift = shift;
+    e->is_signed = sign == 's';
+    return true;
+}
+
+// Sets up buffered capture of all channels. On failure, sysfs is used instead.
+static void buffer_init(struct udev *udev, const char *syspath) {
+    uint32_t index[NUM_DEV * 2];
+    char name[32];
+
+    // We only need the counts and rates, not the timestamp
+    sysfs_write(syspath, "buffer/enable", "0");
+    sysfs_write(syspath, "scan_elements/in_timestamp_en", "0");
+
+    for (size_t i = 0; i < NUM_DEV * 2; i++) {
+        snprintf(name, sizeof(name), i < NUM_DEV ? "in_count%d" : "in_frequency%d", (int)(i % NUM_DEV));
+        if (!buffer_enable_element(syspath, name, &buffer.element[i], &index[i])) {
+            dbg_err("failed to enable scan element");
+            return;
+        }
+    }
+
+    // Elements are stored in order of their index, each aligned to its size
+    size_t offset = 0;
+    for (uint32_t next = 0, placed = 0; placed < NUM_DEV * 2; next++) {
+        for (size_t i = 0; i < NUM_DEV * 2; i++) {
+            if (index[i] != next) {
+                continue;
+            }
+            scan_element_t *e = &buffer.element[i];
+            offset = (offset + e->bytes - 1) / e->bytes * e->bytes;
+            e->offset = offset;
+            offset += e->bytes;
+            placed++;
+        }
+        if (next > 255) {
+            return;
+        }
+    }
+
+    // The whole scan is aligned to its largest element
+    size_t align = 1;
+    for (size_t i = 0; i < NUM_DEV * 2; i++) {
+        align = buffer.element[i].bytes > align ? buffer.element[i].bytes : align;
+    }
+    buffer.scan_size = (offset + align - 1) / align * align;
+    if (buffer.scan_size * MAX_SCANS > sizeof(buffer.data)) {
+        return;
+    }
+
+    struct udev_device *device = udev_device_new_from_syspath(udev, syspath);
+    if (!device) {
+        return;
+    }
+
+    const char *devnode = udev_device_get_devnode(device);
+    if (devnode && sysfs_write(syspath, "buffer/length", "32") && sysfs_write(syspath, "buffer/enable", "1")) {
+        buffer.fd = open(devnode, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (buffer.fd == -1) {
+            dbg_err("failed to open IIO device");
+            sysfs_write(syspath, "buffer/enable", "0");
+        }
+    }
+
+    udev_device_unref(device);
+}
+
 void pbdrv_counter_ev3dev_stretch_iio_init(pbdrv_counter_dev_t *devs) {
     char buf[256];
     struct udev *udev;
@@ -113,28 +352,28 @@ void pbdrv_counter_ev3dev_stretch_iio_init(pbdrv_counter_dev_t *devs) {
         goto free_enumerate;
     }
 
-
+    // The sysfs attributes are always opened, so they can be used until the
+    // first scan arrives or if buffered capture is not available.
     for (size_t i = 0; i < PBIO_ARRAY_SIZE(private_data); i++) {
         private_data_t *priv = &private_data[i];
 
+        priv->index = i;
+        priv->rate = -1;
+
         snprintf(buf, sizeof(buf), "%s/in_count%d_raw", udev_list_entry_get_name(entry), (int)i);
-        priv->count = fopen(buf, "r");
-        if (!priv->count) {
+        priv->count = open(buf, O_RDONLY | O_CLOEXEC);
+        if (priv->count == -1) {
             dbg_err("failed to open count attribute");
             continue;
         }
 
-        setbuf(priv->count, NULL);
-
         snprintf(buf, sizeof(buf), "%s/in_frequency%d_input", udev_list_entry_get_name(entry), (int)i);
-        priv->rate = fopen(buf, "r");
-        if (!priv->rate) {
+        priv->rate = open(buf, O_RDONLY | O_CLOEXEC);
+        if (priv->rate == -1) {
             dbg_err("failed to open rate attribute");
             continue;
         }
 
-        setbuf(priv->rate, NULL);
-
         // FIXME: assuming that these are the only counter devices
         // counter_id should be passed from platform data instead
         _Static_assert(PBDRV_CONFIG_COUNTER_EV3DEV_STRETCH_IIO_NUM_DEV == PBDRV_CONFIG_COUNTER_NUM_DEV,
@@ -144,6 +383,8 @@ void pbdrv_counter_ev3dev_stretch_iio_init(pbdrv_counter_dev_t *devs) {
         priv->dev->priv = priv;
     }
 
+    buffer_init(udev, udev_list_entry_get_name(entry));
+
 free_enumerate:
     udev_enumerate_unref(enumerate);
 free_udev:
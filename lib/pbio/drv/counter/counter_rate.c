@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Rate estimator for counters that timestamp their edges.
+//
+// At high speeds, there are many edges in a short time, so a least squares
+// fit of count over time for the recent edges gives a smooth estimate. At low
+// speeds, there may be only one edge in that time, so the rate comes from the
+// time between the last two edges. Until the next edge arrives, the motor can
+// not be going faster than one edge per time since the last edge, which is
+// used to bring the estimate down smoothly when the motor slows down or stops.
+//
+// The estimate always looks at no more than PBDRV_COUNTER_RATE_NUM_EDGES
+// edges, so it takes the same time at any speed.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_COUNTER_EDGE_RATE
+
+#include <stdint.h>
+
+#include "counter_rate.h"
+
+#define MASK (PBDRV_COUNTER_RATE_NUM_EDGES - 1)
+
+/**
+ * Discards all edges.
+ * @param [in]  est         The estimator.
+ */
+void pbdrv_counter_rate_reset(pbdrv_counter_rate_t *est) {
+    est->head = 0;
+    est->size = 0;
+}
+
+/**
+ * Adds an edge. This can be called in an interrupt handler.
+ *
+ * Edges should be spaced evenly in position, e.g. rising edges only, since the
+ * duty cycle of the encoder signal is not exactly 50%.
+ *
+ * @param [in]  est         The estimator.
+ * @param [in]  count       The count after the edge.
+ * @param [in]  time        The time of the edge in 10 us ticks.
+ */
+void pbdrv_counter_rate_add_edge(pbdrv_counter_rate_t *est, int32_t count, uint32_t time) {
+    uint8_t new_head = (est->head + 1) & MASK;
+
+    est->counts[new_head] = count;
+    est->times[new_head] = time;
+    est->head = new_head;
+
+    if (est->size < PBDRV_COUNTER_RATE_NUM_EDGES) {
+        est->size++;
+    }
+}
+
+/**
+ * Estimates the rate.
+ *
+ * The confidence tells how well the rate is known. It is 100 while edges
+ * arrive as often as expected and drops as more time passes without an edge,
+ * e.g. it is 50 if it has been twice the last time between edges. It is 0 if
+ * there are not enough edges yet to tell the rate. If it has been longer than
+ * ::PBDRV_COUNTER_RATE_TIMEOUT since the last edge, the rate is 0 with full
+ * confidence.
+ *
+ * @param [in]  est         The estimator.
+ * @param [in]  now         The current time in 10 us ticks.
+ * @param [out] rate        The rate in counts per second.
+ * @param [out] confidence  The confidence from 0 to 100.
+ */
+void pbdrv_counter_rate_get(pbdrv_counter_rate_t *est, uint32_t now, int32_t *rate, uint8_t *confidence) {
+    // head can be updated in interrupt, so only read it once
+    uint8_t head = est->head;
+    uint8_t size = est->size;
+
+    *rate = 0;
+    *confidence = 0;
+
+    if (size == 0) {
+        return;
+    }
+
+    int32_t head_count = est->counts[head];
+    uint32_t head_time = est->times[head];
+    uint32_t elapsed = now - head_time;
+
+    // An edge may have been added after now was read
+    if ((int32_t)elapsed < 0) {
+        elapsed = 0;
+    }
+
+    if (elapsed > PBDRV_COUNTER_RATE_TIMEOUT) {
+        *confidence = 100;
+        return;
+    }
+
+    // Least squares fit of count over time, measured back from the newest
+    // edge, so the newest edge is at (0, 0) and adds nothing to the sums.
+    int64_t sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    int32_t num = 1;
+    int32_t last_counts = 0;
+    uint32_t last_period = 0;
+
+    for (uint8_t i = 1; i < size; i++) {
+        uint8_t index = (head - i) & MASK;
+        uint32_t x = head_time - est->times[index];
+        int32_t y = head_count - est->counts[index];
+
+        // The previous edge is always used, unless it is so old that we were
+        // not moving. Older ones only if they are recent enough.
+        if (x > PBDRV_COUNTER_RATE_TIMEOUT || (i > 1 && x > PBDRV_COUNTER_RATE_WINDOW)) {
+            break;
+        }
+
+        if (i == 1) {
+            last_counts = y;
+            last_period = x;
+        }
+
+        sum_x += x;
+        sum_y += y;
+        sum_xx += (int64_t)x * x;
+        sum_xy += (int64_t)x * y;
+        num++;
+    }
+
+    // Need at least two edges to tell the rate
+    if (num < 2 || last_period == 0) {
+        return;
+    }
+
+    int64_t den = num * sum_xx - sum_x * sum_x;
+    if (num > 2 && den > 0) {
+        *rate = (num * sum_xy - sum_x * sum_y) * PBDRV_COUNTER_RATE_TICKS_PER_SEC / den;
+    } else {
+        *rate = (int64_t)last_counts * PBDRV_COUNTER_RATE_TICKS_PER_SEC / last_period;
+    }
+
+    // Slots are not spaced exactly evenly, so the next edge may come a bit
+    // later than the last period even at constant speed.
+    uint32_t expected = last_period + last_period / 4;
+    if (elapsed <= expected) {
+        *confidence = 100;
+        return;
+    }
+
+    // We would have seen another edge by now if we were still going this
+    // fast, so we can't be going faster than one edge in the elapsed time.
+    int32_t limit = (int64_t)(last_counts < 0 ? -last_counts : last_counts) *
+        PBDRV_COUNTER_RATE_TICKS_PER_SEC * expected / last_period / elapsed;
+    if (*rate > limit) {
+        *rate = limit;
+    } else if (*rate < -limit) {
+        *rate = -limit;
+    }
+
+    *confidence = 100 * expected / elapsed;
+}
+
+#endif // PBDRV_CONFIG_COUNTER_EDGE_RATE
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Rate estimator for counters that timestamp their edges.
+
+#ifndef _INTERNAL_PBDRV_COUNTER_RATE_H_
+#define _INTERNAL_PBDRV_COUNTER_RATE_H_
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_COUNTER_EDGE_RATE
+
+#include <stdint.h>
+
+// Number of edges kept for the estimate. Must be power of 2.
+#define PBDRV_COUNTER_RATE_NUM_EDGES (16)
+
+// Timestamps are in units of 10 us
+#define PBDRV_COUNTER_RATE_TICKS_PER_SEC (100000)
+
+// Edges older than this (in ticks) are not used for the regression
+#define PBDRV_COUNTER_RATE_WINDOW (30 * 100)
+
+// If there has not been an edge for this long (in ticks), we are not moving
+#define PBDRV_COUNTER_RATE_TIMEOUT (250 * 100)
+
+typedef struct {
+    /** Count at each edge. */
+    int32_t counts[PBDRV_COUNTER_RATE_NUM_EDGES];
+    /** Time of each edge. */
+    uint32_t times[PBDRV_COUNTER_RATE_NUM_EDGES];
+    /** Index of the newest edge. Can be updated in an interrupt. */
+    volatile uint8_t head;
+    /** Number of valid edges, up to ::PBDRV_COUNTER_RATE_NUM_EDGES. */
+    uint8_t size;
+} pbdrv_counter_rate_t;
+
+void pbdrv_counter_rate_reset(pbdrv_counter_rate_t *est);
+void pbdrv_counter_rate_add_edge(pbdrv_counter_rate_t *est, int32_t count, uint32_t time);
+void pbdrv_counter_rate_get(pbdrv_counter_rate_t *est, uint32_t now, int32_t *rate, uint8_t *confidence);
+
+#endif // PBDRV_CONFIG_COUNTER_EDGE_RATE
+
+#endif // _INTERNAL_PBDRV_COUNTER_RATE_H_
@@ -9,6 +9,9 @@
 // Ideally, this could be made into a generic driver if the following are done:
 // - add IRQ support to the gpio driver
 // - create a generic timer driver
+//
+// The rate is estimated from the times of the rising edges of the interrupt
+// pin, see counter_rate.c.
 
 #include <pbdrv/config.h>
 
@@ -22,20 +25,35 @@
 
 #include "stm32f0xx.h"
 #include "counter.h"
+#include "counter_rate.h"
 #include "counter_stm32f0_gpio_quad_enc.h"
 
-#define RING_BUF_SIZE 32 // must be power of 2!
-
 typedef struct {
     pbdrv_counter_dev_t *dev;
-    int32_t counts[RING_BUF_SIZE];
-    uint16_t timestamps[RING_BUF_SIZE];
+    pbdrv_counter_rate_t rate;
     int32_t count;
-    volatile uint8_t head;
 } private_data_t;
 
 static private_data_t private_data[PBDRV_CONFIG_COUNTER_STM32F0_GPIO_QUAD_ENC_NUM_DEV];
 
+// upper 16 bits of the 32-bit timestamp, incremented when TIM7 wraps
+static volatile uint16_t timer_high;
+
+// Gets the 32-bit timestamp in 10 us ticks. Must be called with the TIM7
+// interrupt blocked.
+static uint32_t pbdrv_counter_stm32f0_gpio_quad_enc_get_time(void) {
+    uint16_t high = timer_high;
+    uint16_t low = TIM7->CNT;
+
+    // If the timer wrapped but the interrupt has not been handled yet, the
+    // low half is small and the high half is one behind.
+    if ((TIM7->SR & TIM_SR_UIF) && low < 0x8000) {
+        high++;
+    }
+
+    return (uint32_t)high << 16 | low;
+}
+
 static pbio_error_t pbdrv_counter_stm32f0_gpio_quad_enc_get_count(pbdrv_counter_dev_t *dev, int32_t *count) {
     private_data_t *priv = dev->priv;
 
@@ -44,60 +62,27 @@ static pbio_error_t pbdrv_counter_stm32f0_gpio_quad_enc_get_count(pbdrv_counter_
     return PBIO_SUCCESS;
 }
 
-static pbio_error_t pbdrv_counter_stm32f0_gpio_quad_enc_get_rate(pbdrv_counter_dev_t *dev, int32_t *rate) {
+static pbio_error_t pbdrv_counter_stm32f0_gpio_quad_enc_get_rate_confidence(pbdrv_counter_dev_t *dev, int32_t *rate, uint8_t *confidence) {
     private_data_t *priv = dev->priv;
-    int32_t head_count, tail_count = 0;
-    uint16_t now, head_time, tail_time = 0;
-    uint8_t head, tail, x = 0;
-
-    // head can be updated in interrupt, so only read it once
-    head = priv->head;
-    head_count = priv->counts[head];
-    head_time = priv->timestamps[head];
+    uint32_t irq_state, now;
 
-    now = TIM7->CNT;
+    irq_state = __get_PRIMASK();
+    __disable_irq();
+    now = pbdrv_counter_stm32f0_gpio_quad_enc_get_time();
+    __set_PRIMASK(irq_state);
 
-    // if it has been more than 50ms since last timestamp, we are not moving.
-    if ((uint16_t)(now - head_time) > 50 * 100) {
-        *rate = 0;
-        return PBIO_SUCCESS;
-    }
-
-    while (x++ < RING_BUF_SIZE) {
-        tail = (head - x) & (RING_BUF_SIZE - 1);
-
-        tail_count = priv->counts[tail];
-        tail_time = priv->timestamps[tail];
-
-        // if count hasn't changed, then we are not moving
-        if (head_count == tail_count) {
-            *rate = 0;
-            return PBIO_SUCCESS;
-        }
-
-        /*
-         * we need delta_t to be >= 20ms to be reasonably accurate.
-         * timer is 10us, thus * 100 to get ms.
-         */
-        if ((uint16_t)(head_time - tail_time) >= 20 * 100) {
-            break;
-        }
-    }
-
-    /* avoid divide by 0 - motor probably hasn't moved yet */
-    if (head_time == tail_time) {
-        *rate = 0;
-        return PBIO_SUCCESS;
-    }
-
-    /* timer is 100000kHz */
-    *rate = (head_count - tail_count) * 100000 / (uint16_t)(head_time - tail_time);
+    pbdrv_counter_rate_get(&priv->rate, now, rate, confidence);
 
     return PBIO_SUCCESS;
 }
 
+static pbio_error_t pbdrv_counter_stm32f0_gpio_quad_enc_get_rate(pbdrv_counter_dev_t *dev, int32_t *rate) {
+    uint8_t confidence;
+    return pbdrv_counter_stm32f0_gpio_quad_enc_get_rate_confidence(dev, rate, &confidence);
+}
+
 static void pbdrv_counter_stm32f0_gpio_quad_enc_update_count(private_data_t *priv,
-    bool int_pin_state, bool dir_pin_state, uint16_t timestamp) {
+    bool int_pin_state, bool dir_pin_state, uint32_t timestamp) {
     if (int_pin_state ^ dir_pin_state) {
         priv->count--;
     } else {
@@ -106,23 +91,18 @@ static void pbdrv_counter_stm32f0_gpio_quad_enc_update_count(private_data_t *pri
 
     // log timestamp on rising edge for rate calculation
     if (int_pin_state) {
-        uint8_t new_head = (priv->head + 1) & (RING_BUF_SIZE - 1);
-
-        priv->counts[new_head] = priv->count;
-        priv->timestamps[new_head] = timestamp;
-        priv->head = new_head;
+        pbdrv_counter_rate_add_edge(&priv->rate, priv->count, timestamp);
     }
 }
 
 // irq handler name defined in startup_stm32f0.s
 void EXTI0_1_IRQHandler(void) {
-    uint32_t exti_pr;
-    uint16_t timestamp;
+    uint32_t exti_pr, timestamp;
 
     exti_pr = EXTI->PR & (EXTI_PR_PR0 | EXTI_PR_PR1);
     EXTI->PR = exti_pr; // clear the events we are handling
 
-    timestamp = TIM7->CNT;
+    timestamp = pbdrv_counter_stm32f0_gpio_quad_enc_get_time();
 
     // Port A - inverted.
     if (exti_pr & EXTI_PR_PR1) {
@@ -142,27 +122,15 @@ void EXTI0_1_IRQHandler(void) {
 }
 
 void TIM7_IRQHandler(void) {
-    uint16_t timestamp;
-    uint8_t i, new_head;
-
     TIM7->SR &= ~TIM_SR_UIF; // clear interrupt
 
-    timestamp = TIM7->CNT;
-
-    // log a new timestamp when the timer recycles to avoid rate calculation
-    // problems when the motor is not moving
-    for (i = 0; i < PBIO_ARRAY_SIZE(private_data); i++) {
-        private_data_t *priv = &private_data[i];
-        new_head = (priv->head + 1) & (RING_BUF_SIZE - 1);
-        priv->counts[new_head] = priv->count;
-        priv->timestamps[new_head] = timestamp;
-        priv->head = new_head;
-    }
+    timer_high++;
 }
 
 static const pbdrv_counter_funcs_t pbdrv_counter_stm32f0_gpio_quad_enc_funcs = {
     .get_count = pbdrv_counter_stm32f0_gpio_quad_enc_get_count,
     .get_rate = pbdrv_counter_stm32f0_gpio_quad_enc_get_rate,
+    .get_rate_confidence = pbdrv_counter_stm32f0_gpio_quad_enc_get_rate_confidence,
 };
 
 void pbdrv_counter_stm32f0_gpio_quad_enc_init(pbdrv_counter_dev_t *devs) {
@@ -171,6 +139,8 @@ void pbdrv_counter_stm32f0_gpio_quad_enc_init(pbdrv_counter_dev_t *devs) {
             &pbdrv_counter_stm32f0_gpio_quad_enc_platform_data[i];
         private_data_t *priv = &private_data[i];
 
+        pbdrv_counter_rate_reset(&priv->rate);
+
         // TODO: may need to add pull to platform data if we add more platforms
         // that use this driver.
 
@@ -6,13 +6,16 @@
 #if PBDRV_CONFIG_MOTOR && !PBIO_TEST_BUILD
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <pbdrv/motor.h>
 #include <pbio/config.h>
 #include <pbio/iodev.h>
+#include <pbio/util.h>
 
 #include <ev3dev_stretch/lego_port.h>
 #include <ev3dev_stretch/sysfs.h>
@@ -21,16 +24,59 @@
 
 #define PORT_TO_IDX(p) ((p) - PBDRV_CONFIG_FIRST_MOTOR_PORT)
 
+// Duty cycle value that never matches a real one, so it is always written
+#define DUTY_UNKNOWN (INT16_MIN)
+
 typedef struct _motor_t {
     int n_motor;
     bool connected;
     bool coasting;
     pbio_iodev_type_id_t id;
-    FILE *f_command;
-    FILE *f_duty;
+    int fd_command;
+    int fd_duty;
+    // Duty cycle in sysfs units that is requested but not yet written
+    int16_t duty_pending;
+    // Duty cycle in sysfs units that the driver has now, or DUTY_UNKNOWN
+    int16_t duty_written;
+    // Whether the driver is in run-direct mode
+    bool run_direct;
 } motor_t;
 
-static motor_t motors[4];
+static motor_t motors[4] = {
+    [0 ... 3] = { .fd_command = -1, .fd_duty = -1 },
+};
+
+// Writes a string to a sysfs attribute on a file descriptor that stays open.
+// There is no need to seek first because pwrite always writes at the start.
+static pbio_error_t ev3dev_motor_write(int fd, const char *buf, size_t len) {
+    if (pwrite(fd, buf, len, 0) != (ssize_t)len) {
+        return PBIO_ERROR_IO;
+    }
+    return PBIO_SUCCESS;
+}
+
+// Opens a motor attribute for writing, closing the previous one if any
+static pbio_error_t ev3dev_motor_open(int *fd, const char *class, int n, const char *attribute) {
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, MAX_PATH_LENGTH, "/sys/class/%s/motor%d/%s", class, n, attribute);
+
+    if (*fd >= 0) {
+        close(*fd);
+    }
+    *fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (*fd < 0) {
+        return PBIO_ERROR_IO;
+    }
+    return PBIO_SUCCESS;
+}
+
+// Sends the stop command right away, which makes the motor coast
+static pbio_error_t ev3dev_motor_write_stop(motor_t *mtr) {
+    mtr->coasting = true;
+    mtr->run_direct = false;
+    mtr->duty_written = DUTY_UNKNOWN;
+    return ev3dev_motor_write(mtr->fd_command, "stop", 4);
+}
 
 static pbio_error_t ev3dev_motor_init(motor_t *mtr, pbio_port_id_t port) {
 
@@ -65,15 +111,14 @@ static pbio_error_t ev3dev_motor_init(motor_t *mtr, pbio_port_id_t port) {
             return PBIO_ERROR_IO;
         }
         // Open command file
-        err = sysfs_open_tacho_motor_attr(&mtr->f_command, mtr->n_motor, "command", "w");
+        err = ev3dev_motor_open(&mtr->fd_command, "tacho-motor", mtr->n_motor, "command");
         if (err != PBIO_SUCCESS) {
             return err;
         }
         // Open duty file
-        err = sysfs_open_tacho_motor_attr(&mtr->f_duty, mtr->n_motor, "duty_cycle_sp", "w");
+        err = ev3dev_motor_open(&mtr->fd_duty, "tacho-motor", mtr->n_motor, "duty_cycle_sp");
         if (err != PBIO_SUCCESS) {
             return err;
-
         }
     }
     // If tacho-motor was not found, look for dc-motor instead
@@ -86,12 +131,12 @@ static pbio_error_t ev3dev_motor_init(motor_t *mtr, pbio_port_id_t port) {
         // On success, open relevant sysfs files and set ID type
         mtr->id = PBIO_IODEV_TYPE_ID_EV3DEV_DC_MOTOR;
         // Open command
-        err = sysfs_open_dc_motor_attr(&mtr->f_command, mtr->n_motor, "command", "w");
+        err = ev3dev_motor_open(&mtr->fd_command, "dc-motor", mtr->n_motor, "command");
         if (err != PBIO_SUCCESS) {
             return err;
         }
         // Open duty
-        err = sysfs_open_dc_motor_attr(&mtr->f_duty, mtr->n_motor, "duty_cycle_sp", "w");
+        err = ev3dev_motor_open(&mtr->fd_duty, "dc-motor", mtr->n_motor, "duty_cycle_sp");
         if (err != PBIO_SUCCESS) {
             return err;
         }
@@ -103,8 +148,7 @@ static pbio_error_t ev3dev_motor_init(motor_t *mtr, pbio_port_id_t port) {
     mtr->connected = true;
 
     // Now that we have found the motor, coast it
-    mtr->coasting = true;
-    return sysfs_write_str(mtr->f_command, "stop");
+    return ev3dev_motor_write_stop(mtr);
 }
 
 static pbio_error_t ev3dev_motor_get(motor_t **motor, pbio_port_id_t port) {
@@ -132,6 +176,50 @@ static pbio_error_t ev3dev_motor_connect_status(motor_t *mtr, pbio_error_t err)
     return err;
 }
 
+// Writes the pending duty cycle if it differs from what the driver has now.
+// Returns the number of writes, or -1 if there was an I/O error.
+static int ev3dev_motor_commit(motor_t *mtr) {
+    int writes = 0;
+
+    if (!mtr->connected || mtr->coasting || mtr->duty_pending == mtr->duty_written) {
+        return 0;
+    }
+
+    // The duty cycle has no effect until we are in run-direct mode
+    if (!mtr->run_direct) {
+        writes++;
+        if (ev3dev_motor_write(mtr->fd_command, "run-direct", 10) != PBIO_SUCCESS) {
+            ev3dev_motor_connect_status(mtr, PBIO_ERROR_IO);
+            return -1;
+        }
+        mtr->run_direct = true;
+    }
+
+    char buf[8];
+    int len = snprintf(buf, sizeof(buf), "%d", mtr->duty_pending);
+    writes++;
+    if (ev3dev_motor_write(mtr->fd_duty, buf, len) != PBIO_SUCCESS) {
+        mtr->duty_written = DUTY_UNKNOWN;
+        ev3dev_motor_connect_status(mtr, PBIO_ERROR_IO);
+        return -1;
+    }
+    mtr->duty_written = mtr->duty_pending;
+    return writes;
+}
+
+#if PBDRV_CONFIG_MOTOR_DEFERRED_COMMIT
+uint32_t pbdrv_motor_commit(void) {
+    uint32_t writes = 0;
+    for (size_t i = 0; i < PBIO_ARRAY_SIZE(motors); i++) {
+        int n = ev3dev_motor_commit(&motors[i]);
+        if (n > 0) {
+            writes += n;
+        }
+    }
+    return writes;
+}
+#endif
+
 pbio_error_t pbdrv_motor_coast(pbio_port_id_t port) {
     // Get the motor and initialize if needed
     pbio_error_t err;
@@ -144,9 +232,9 @@ pbio_error_t pbdrv_motor_coast(pbio_port_id_t port) {
     if (mtr->coasting) {
         return PBIO_SUCCESS;
     }
-    // Send the stop command to trigger coast
-    mtr->coasting = true;
-    err = sysfs_write_str(mtr->f_command, "stop");
+    // Send the stop command to trigger coast. This is never deferred, so
+    // that motors stop even if no more control updates follow.
+    err = ev3dev_motor_write_stop(mtr);
     return ev3dev_motor_connect_status(mtr, err);
 }
 
@@ -158,17 +246,18 @@ pbio_error_t pbdrv_motor_set_duty_cycle(pbio_port_id_t port, int16_t duty_cycle)
     if (err != PBIO_SUCCESS) {
         return ev3dev_motor_connect_status(mtr, err);
     }
-    // If we are coasting, we must first set the command to run-direct
-    if (mtr->coasting) {
-        err = sysfs_write_str(mtr->f_command, "run-direct");
-        if (err != PBIO_SUCCESS) {
-            return ev3dev_motor_connect_status(mtr, err);
-        }
-        mtr->coasting = false;
-    }
-    // Set the duty cycle value
-    err = sysfs_write_int(mtr->f_duty, duty_cycle / 100);
-    return ev3dev_motor_connect_status(mtr, err);
+    // Only remember the new duty cycle. It gets written along with those of
+    // the other motors once the control update is done, and only if it differs
+    // from what the driver has already. The driver only takes whole percents,
+    // so small changes often need no write at all.
+    mtr->duty_pending = duty_cycle / 100;
+    mtr->coasting = false;
+
+    #if PBDRV_CONFIG_MOTOR_DEFERRED_COMMIT
+    return PBIO_SUCCESS;
+    #else
+    return ev3dev_motor_commit(mtr) < 0 ? PBIO_ERROR_IO : PBIO_SUCCESS;
+    #endif
 }
 
 pbio_error_t pbdrv_motor_get_id(pbio_port_id_t port, pbio_iodev_type_id_t *id) {
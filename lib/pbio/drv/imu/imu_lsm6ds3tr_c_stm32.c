@@ -0,0 +1,531 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// IMU driver for ST LSM6DS3TR-C accel/gyro connected to STM32 MCU by I2C.
+//
+// The chip puts every gyro and accel sample in its FIFO at the full output
+// data rate. The driver empties the FIFO in the background at the same rate as
+// the motor control loop and keeps the samples in a ring buffer with a time
+// stamp, so users of the driver never wait for the bus. The rotation about the
+// z axis is integrated from every sample, so that it can be used as heading
+// feedback.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <contiki.h>
+#include <lsm6ds3tr_c_reg.h>
+
+#include STM32_HAL_H
+
+#include <pbdrv/clock.h>
+#include <pbdrv/imu.h>
+#include <pbio/error.h>
+
+#include "imu_lsm6ds3tr_c_stm32.h"
+
+#define platform pbdrv_imu_lsm6ds3tr_c_stm32_platform_data
+
+#define NUM_SAMPLES PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_NUM_SAMPLES
+
+#if NUM_SAMPLES & (NUM_SAMPLES - 1)
+#error "PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_NUM_SAMPLES must be a power of 2"
+#endif
+
+// Time between reads of the FIFO (ms), the same as the motor control loop
+#define READ_TIME_MS (5)
+
+// Number of 16-bit words in one FIFO data set: gyro x, y, z, accel x, y, z
+#define SET_WORDS (6)
+
+// Maximum number of data sets in one read. About four arrive between reads,
+// so there is room to catch up if a read was missed.
+#define MAX_SETS (16)
+
+// Sample periods are in microseconds with this many fractional bits
+#define PERIOD_SHIFT (8)
+
+// Sample period at the nominal output data rate of 833 Hz
+#define PERIOD_NOMINAL (1200 << PERIOD_SHIFT)
+
+// The output data rate of the chip may be off by a few percent, so the actual
+// period is measured against the clock of the MCU over this many microseconds.
+#define PERIOD_WINDOW (2000000)
+
+// The bias is kept with this many fractional bits, in gyro LSB
+#define BIAS_SHIFT (8)
+
+// Number of samples in one window of the bias estimate (about 1 second)
+#define BIAS_NUM_SAMPLES (833)
+
+// If no gyro axis changes more than this during a window, the hub was not
+// moving, so the average of the window is the new bias. At 250 dps full scale,
+// this is about 1 deg/s.
+#define BIAS_STILL_RANGE (114)
+
+PROCESS(pbdrv_imu_lsm6ds3tr_c_stm32_process, "LSM6DS3TR-C");
+
+static I2C_HandleTypeDef pbdrv_imu_hi2c;
+#if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA
+static DMA_HandleTypeDef pbdrv_imu_hdma;
+#endif
+static stmdev_ctx_t pbdrv_imu_ctx;
+static volatile bool pbdrv_imu_i2c_error;
+static struct etimer pbdrv_imu_timer;
+
+// PBIO_SUCCESS once there is a sample
+static pbio_error_t pbdrv_imu_status = PBIO_ERROR_AGAIN;
+
+// Data sets read from the FIFO
+static int16_t pbdrv_imu_fifo[MAX_SETS * SET_WORDS];
+
+// A sample as it is kept in the ring buffer
+typedef struct {
+    uint32_t time;
+    int16_t data[SET_WORDS];
+} pbdrv_imu_raw_sample_t;
+
+// The most recent samples. The sample with index i is at i % NUM_SAMPLES.
+static pbdrv_imu_raw_sample_t pbdrv_imu_samples[NUM_SAMPLES];
+
+// Index of the next sample
+static uint32_t pbdrv_imu_index;
+
+// Measured sample period
+static uint32_t pbdrv_imu_period = PERIOD_NOMINAL;
+
+// Start of the current window of the period measurement
+static struct {
+    uint32_t time;
+    uint32_t index;
+    bool valid;
+} pbdrv_imu_period_window;
+
+// Scale of the raw values
+static float pbdrv_imu_gyro_scale; // deg/s per LSB
+static float pbdrv_imu_accel_scale; // m/s² per LSB
+
+// Gyro bias, scaled by 2^BIAS_SHIFT
+static int32_t pbdrv_imu_bias[3];
+
+// Rotation about the z axis of the hub, in LSB scaled by 2^BIAS_SHIFT times
+// microseconds
+static int64_t pbdrv_imu_heading;
+
+// Bias estimate of the current window
+static struct {
+    int32_t sum[3];
+    int16_t min[3];
+    int16_t max[3];
+    uint32_t count;
+} pbdrv_imu_window;
+
+void pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_er_irq(void) {
+    HAL_I2C_ER_IRQHandler(&pbdrv_imu_hi2c);
+}
+
+void pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_ev_irq(void) {
+    HAL_I2C_EV_IRQHandler(&pbdrv_imu_hi2c);
+}
+
+#if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA
+void pbdrv_imu_lsm6ds3tr_c_stm32_handle_rx_dma_irq(void) {
+    HAL_DMA_IRQHandler(&pbdrv_imu_hdma);
+}
+#endif
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    pbdrv_imu_ctx.read_write_done = true;
+    process_poll(&pbdrv_imu_lsm6ds3tr_c_stm32_process);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    pbdrv_imu_ctx.read_write_done = true;
+    process_poll(&pbdrv_imu_lsm6ds3tr_c_stm32_process);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    // Let the waiting protothread continue. The result is discarded.
+    pbdrv_imu_i2c_error = true;
+    pbdrv_imu_ctx.read_write_done = true;
+    process_poll(&pbdrv_imu_lsm6ds3tr_c_stm32_process);
+}
+
+static void pbdrv_imu_write_reg(void *handle, uint8_t reg, uint8_t *data, uint16_t len) {
+    HAL_I2C_Mem_Write_IT(&pbdrv_imu_hi2c, LSM6DS3TR_C_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, data, len);
+}
+
+static void pbdrv_imu_read_reg(void *handle, uint8_t reg, uint8_t *data, uint16_t len) {
+    HAL_I2C_Mem_Read_IT(&pbdrv_imu_hi2c, LSM6DS3TR_C_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, data, len);
+}
+
+void pbdrv_imu_init(void) {
+    pbdrv_imu_ctx.write_reg = pbdrv_imu_write_reg;
+    pbdrv_imu_ctx.read_reg = pbdrv_imu_read_reg;
+    process_start(&pbdrv_imu_lsm6ds3tr_c_stm32_process);
+}
+
+// Gets the angular velocity of one axis in LSB scaled by 2^BIAS_SHIFT,
+// compensated for bias and in the hub frame.
+static int32_t pbdrv_imu_get_gyro_raw(const int16_t *data, uint8_t axis) {
+    int32_t value = ((int32_t)data[axis] << BIAS_SHIFT) - pbdrv_imu_bias[axis];
+    return platform.gyro_flip_xz && axis != 1 ? -value : value;
+}
+
+// Converts a raw sample to the hub frame and physical units.
+static void pbdrv_imu_convert(const int16_t *data, float *angular_velocity, float *acceleration) {
+    for (uint8_t i = 0; i < 3; i++) {
+        angular_velocity[i] = pbdrv_imu_get_gyro_raw(data, i) * pbdrv_imu_gyro_scale / (1 << BIAS_SHIFT);
+        acceleration[i] = data[3 + i] * pbdrv_imu_accel_scale;
+        if (platform.accel_flip_xz && i != 1) {
+            acceleration[i] = -acceleration[i];
+        }
+    }
+}
+
+pbio_error_t pbdrv_imu_get_angular_velocity(float *values) {
+    if (pbdrv_imu_status != PBIO_SUCCESS) {
+        return pbdrv_imu_status;
+    }
+
+    float acceleration[3];
+    pbdrv_imu_convert(pbdrv_imu_samples[(pbdrv_imu_index - 1) % NUM_SAMPLES].data, values, acceleration);
+
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_imu_get_acceleration(float *values) {
+    if (pbdrv_imu_status != PBIO_SUCCESS) {
+        return pbdrv_imu_status;
+    }
+
+    float angular_velocity[3];
+    pbdrv_imu_convert(pbdrv_imu_samples[(pbdrv_imu_index - 1) % NUM_SAMPLES].data, angular_velocity, values);
+
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_imu_get_heading(int32_t *heading) {
+    if (pbdrv_imu_status != PBIO_SUCCESS) {
+        *heading = 0;
+        return pbdrv_imu_status;
+    }
+
+    // At 250 dps full scale, one LSB is 8.75 mdps, so one LSB for one
+    // microsecond is 35 / 4 / 1000000 mdeg.
+    *heading = pbdrv_imu_heading * 35 / ((int64_t)4000000 << BIAS_SHIFT);
+
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_imu_get_sample_index(uint32_t *index) {
+    *index = pbdrv_imu_index;
+    return pbdrv_imu_status;
+}
+
+pbio_error_t pbdrv_imu_get_samples(uint32_t *index, pbdrv_imu_sample_t *samples, uint32_t *num) {
+    if (pbdrv_imu_status != PBIO_SUCCESS) {
+        *num = 0;
+        return pbdrv_imu_status;
+    }
+
+    // Skip samples that have been overwritten
+    if (pbdrv_imu_index - *index > NUM_SAMPLES) {
+        *index = pbdrv_imu_index - NUM_SAMPLES;
+    }
+
+    uint32_t count = 0;
+    while (count < *num && *index != pbdrv_imu_index) {
+        pbdrv_imu_raw_sample_t *sample = &pbdrv_imu_samples[*index % NUM_SAMPLES];
+        samples[count].time = sample->time;
+        pbdrv_imu_convert(sample->data, samples[count].angular_velocity, samples[count].acceleration);
+        (*index)++;
+        count++;
+    }
+    *num = count;
+
+    return PBIO_SUCCESS;
+}
+
+// Updates the bias estimate with a new gyro sample.
+static void pbdrv_imu_update_bias(const int16_t *gyro) {
+    if (pbdrv_imu_window.count == 0) {
+        for (uint8_t i = 0; i < 3; i++) {
+            pbdrv_imu_window.sum[i] = 0;
+            pbdrv_imu_window.min[i] = INT16_MAX;
+            pbdrv_imu_window.max[i] = INT16_MIN;
+        }
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        pbdrv_imu_window.sum[i] += gyro[i];
+        if (gyro[i] < pbdrv_imu_window.min[i]) {
+            pbdrv_imu_window.min[i] = gyro[i];
+        }
+        if (gyro[i] > pbdrv_imu_window.max[i]) {
+            pbdrv_imu_window.max[i] = gyro[i];
+        }
+    }
+
+    if (++pbdrv_imu_window.count < BIAS_NUM_SAMPLES) {
+        return;
+    }
+    pbdrv_imu_window.count = 0;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        if (pbdrv_imu_window.max[i] - pbdrv_imu_window.min[i] > BIAS_STILL_RANGE) {
+            return;
+        }
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        pbdrv_imu_bias[i] = ((int64_t)pbdrv_imu_window.sum[i] << BIAS_SHIFT) / BIAS_NUM_SAMPLES;
+    }
+}
+
+// Updates the measured sample period. The given number of data sets were in
+// the FIFO at the given time, including the ones that are about to be read.
+static void pbdrv_imu_update_period(uint32_t time, uint32_t available) {
+    uint32_t index = pbdrv_imu_index + available;
+
+    if (!pbdrv_imu_period_window.valid) {
+        pbdrv_imu_period_window.time = time;
+        pbdrv_imu_period_window.index = index;
+        pbdrv_imu_period_window.valid = true;
+        return;
+    }
+
+    uint32_t elapsed = time - pbdrv_imu_period_window.time;
+    uint32_t count = index - pbdrv_imu_period_window.index;
+    if (elapsed < PERIOD_WINDOW || count == 0) {
+        return;
+    }
+
+    uint32_t period = ((uint64_t)elapsed << PERIOD_SHIFT) / count;
+
+    // Ignore results that are way off, e.g. if reads were delayed a lot
+    if (period > PERIOD_NOMINAL * 9 / 10 && period < PERIOD_NOMINAL * 11 / 10) {
+        pbdrv_imu_period = period;
+    }
+
+    pbdrv_imu_period_window.time = time;
+    pbdrv_imu_period_window.index = index;
+}
+
+// Adds a sample that was taken at the given time.
+static void pbdrv_imu_add_sample(const int16_t *data, uint32_t time) {
+    pbdrv_imu_raw_sample_t *sample = &pbdrv_imu_samples[pbdrv_imu_index % NUM_SAMPLES];
+
+    sample->time = time;
+    for (uint8_t i = 0; i < SET_WORDS; i++) {
+        sample->data[i] = data[i];
+    }
+
+    pbdrv_imu_update_bias(data);
+
+    // Each sample stands for one sample period of rotation
+    pbdrv_imu_heading += ((int64_t)pbdrv_imu_get_gyro_raw(data, 2) * pbdrv_imu_period) >> PERIOD_SHIFT;
+
+    pbdrv_imu_index++;
+    pbdrv_imu_status = PBIO_SUCCESS;
+}
+
+// Reads registers. Gives up when the next read of the FIFO is due, so that
+// the driver keeps going if the bus gets stuck. Sets pbdrv_imu_i2c_error if
+// the read failed.
+static PT_THREAD(pbdrv_imu_read(struct pt *pt, uint8_t reg, void *data, uint16_t len)) {
+    PT_BEGIN(pt);
+
+    pbdrv_imu_i2c_error = false;
+    pbdrv_imu_ctx.read_write_done = false;
+
+    #if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA
+    if (reg == LSM6DS3TR_C_FIFO_DATA_OUT_L) {
+        if (HAL_I2C_Mem_Read_DMA(&pbdrv_imu_hi2c, LSM6DS3TR_C_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, data, len) != HAL_OK) {
+            pbdrv_imu_i2c_error = true;
+            PT_EXIT(pt);
+        }
+    } else
+    #endif
+    if (HAL_I2C_Mem_Read_IT(&pbdrv_imu_hi2c, LSM6DS3TR_C_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, data, len) != HAL_OK) {
+        pbdrv_imu_i2c_error = true;
+        PT_EXIT(pt);
+    }
+
+    PT_WAIT_UNTIL(pt, pbdrv_imu_ctx.read_write_done || etimer_expired(&pbdrv_imu_timer));
+
+    if (!pbdrv_imu_ctx.read_write_done) {
+        HAL_I2C_Master_Abort_IT(&pbdrv_imu_hi2c, LSM6DS3TR_C_I2C_ADD_L);
+        pbdrv_imu_i2c_error = true;
+    }
+
+    PT_END(pt);
+}
+
+static PT_THREAD(pbdrv_imu_configure(struct pt *pt)) {
+    static struct pt child;
+    static uint8_t id;
+    static uint8_t rst;
+    stmdev_ctx_t *ctx = &pbdrv_imu_ctx;
+
+    PT_BEGIN(pt);
+
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_device_id_get(&child, ctx, &id));
+
+    if (pbdrv_imu_i2c_error || id != LSM6DS3TR_C_ID) {
+        pbdrv_imu_status = PBIO_ERROR_NO_DEV;
+        PT_EXIT(pt);
+    }
+
+    // Restore default configuration
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_reset_set(&child, ctx, PROPERTY_ENABLE));
+    do {
+        PT_SPAWN(pt, &child, lsm6ds3tr_c_reset_get(&child, ctx, &rst));
+    } while (rst);
+
+    // Don't update the output registers while they are being read
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_block_data_update_set(&child, ctx, PROPERTY_ENABLE));
+
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_xl_data_rate_set(&child, ctx, LSM6DS3TR_C_XL_ODR_833Hz));
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_gy_data_rate_set(&child, ctx, LSM6DS3TR_C_GY_ODR_833Hz));
+
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_xl_full_scale_set(&child, ctx, LSM6DS3TR_C_2g));
+    pbdrv_imu_accel_scale = lsm6ds3tr_c_from_fs2g_to_mg(1) * 0.00981f;
+
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_gy_full_scale_set(&child, ctx, LSM6DS3TR_C_250dps));
+    pbdrv_imu_gyro_scale = lsm6ds3tr_c_from_fs250dps_to_mdps(1) / 1000.0f;
+
+    // The high pass filter of the gyro would remove the bias, but it also
+    // removes part of slow turns, which makes the heading drift. The bias is
+    // estimated by the driver instead.
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_gy_band_pass_set(&child, ctx, LSM6DS3TR_C_HP_DISABLE_LP1_LIGHT));
+
+    // Put every gyro and accel sample in the FIFO, overwriting the oldest
+    // samples if it is full. Each data set is gyro x, y, z, accel x, y, z.
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_fifo_gy_batch_set(&child, ctx, LSM6DS3TR_C_FIFO_GY_NO_DEC));
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_fifo_xl_batch_set(&child, ctx, LSM6DS3TR_C_FIFO_XL_NO_DEC));
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_fifo_data_rate_set(&child, ctx, LSM6DS3TR_C_FIFO_833Hz));
+    PT_SPAWN(pt, &child, lsm6ds3tr_c_fifo_mode_set(&child, ctx, LSM6DS3TR_C_STREAM_MODE));
+
+    PT_END(pt);
+}
+
+PROCESS_THREAD(pbdrv_imu_lsm6ds3tr_c_stm32_process, ev, data) {
+    static struct pt child;
+    static uint8_t status[4];
+    static uint32_t time;
+    static uint32_t words;
+    static uint32_t pattern;
+    static uint32_t available;
+    static uint32_t num;
+
+    PROCESS_BEGIN();
+
+    #if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA
+    pbdrv_imu_hdma.Instance = platform.rx_dma;
+    pbdrv_imu_hdma.Init.Channel = platform.rx_dma_ch;
+    pbdrv_imu_hdma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    pbdrv_imu_hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+    pbdrv_imu_hdma.Init.MemInc = DMA_MINC_ENABLE;
+    pbdrv_imu_hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    pbdrv_imu_hdma.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    pbdrv_imu_hdma.Init.Mode = DMA_NORMAL;
+    pbdrv_imu_hdma.Init.Priority = DMA_PRIORITY_LOW;
+    pbdrv_imu_hdma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&pbdrv_imu_hdma);
+    __HAL_LINKDMA(&pbdrv_imu_hi2c, hdmarx, pbdrv_imu_hdma);
+
+    HAL_NVIC_SetPriority(platform.rx_dma_irq, 3, 3);
+    HAL_NVIC_EnableIRQ(platform.rx_dma_irq);
+    #endif
+
+    pbdrv_imu_hi2c.Instance = platform.i2c;
+    #if defined(STM32L4)
+    pbdrv_imu_hi2c.Init.Timing = platform.i2c_timing;
+    #else
+    pbdrv_imu_hi2c.Init.ClockSpeed = platform.i2c_clock_speed;
+    #endif
+    pbdrv_imu_hi2c.Init.OwnAddress1 = 0;
+    pbdrv_imu_hi2c.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+    pbdrv_imu_hi2c.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+    pbdrv_imu_hi2c.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+    pbdrv_imu_hi2c.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+    if (HAL_I2C_Init(&pbdrv_imu_hi2c) != HAL_OK) {
+        pbdrv_imu_status = PBIO_ERROR_NO_DEV;
+        PROCESS_EXIT();
+    }
+
+    PROCESS_PT_SPAWN(&child, pbdrv_imu_configure(&child));
+
+    if (pbdrv_imu_status == PBIO_ERROR_NO_DEV) {
+        PROCESS_EXIT();
+    }
+
+    etimer_set(&pbdrv_imu_timer, READ_TIME_MS);
+
+    for (;;) {
+        if (!etimer_expired(&pbdrv_imu_timer)) {
+            PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && etimer_expired(&pbdrv_imu_timer));
+        }
+        etimer_reset(&pbdrv_imu_timer);
+
+        // FIFO_STATUS1 to FIFO_STATUS4 have the number of unread words, the
+        // overrun flag and which word of the data set is next.
+        PROCESS_PT_SPAWN(&child, pbdrv_imu_read(&child, LSM6DS3TR_C_FIFO_STATUS1, status, sizeof(status)));
+        if (pbdrv_imu_i2c_error) {
+            continue;
+        }
+        time = pbdrv_clock_get_us();
+
+        words = status[0] | (status[1] & 0x07) << 8;
+        pattern = status[2] | (status[3] & 0x03) << 8;
+
+        // Samples were lost, so the count does not match the time
+        if (status[1] & 0x40) {
+            pbdrv_imu_period_window.valid = false;
+        }
+
+        // Drop the rest of a data set that was partly read, e.g. after a
+        // failed read, so that the next word is gyro x again.
+        if (pattern != 0) {
+            num = SET_WORDS - pattern;
+            if (words < num) {
+                continue;
+            }
+            words -= num;
+            PROCESS_PT_SPAWN(&child, pbdrv_imu_read(&child, LSM6DS3TR_C_FIFO_DATA_OUT_L, pbdrv_imu_fifo, num * 2));
+            if (pbdrv_imu_i2c_error) {
+                continue;
+            }
+        }
+
+        available = words / SET_WORDS;
+        if (available == 0) {
+            continue;
+        }
+        pbdrv_imu_update_period(time, available);
+
+        // The read address goes back from FIFO_DATA_OUT_H to FIFO_DATA_OUT_L,
+        // so all data sets can be read at once.
+        num = available < MAX_SETS ? available : MAX_SETS;
+        PROCESS_PT_SPAWN(&child, pbdrv_imu_read(&child, LSM6DS3TR_C_FIFO_DATA_OUT_L, pbdrv_imu_fifo, num * SET_WORDS * 2));
+        if (pbdrv_imu_i2c_error) {
+            continue;
+        }
+
+        // The newest data set that was available was taken just before the
+        // status was read, and the others one period apart before that.
+        for (uint32_t i = 0; i < num; i++) {
+            uint32_t age = (available - 1 - i) * pbdrv_imu_period >> PERIOD_SHIFT;
+            pbdrv_imu_add_sample(&pbdrv_imu_fifo[i * SET_WORDS], time - age);
+        }
+    }
+
+    PROCESS_END();
+}
+
+#endif // PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// IMU driver for ST LSM6DS3TR-C accel/gyro connected to STM32 MCU by I2C.
+
+#ifndef _INTERNAL_PBDRV_IMU_LSM6DS3TR_C_STM32_H_
+#define _INTERNAL_PBDRV_IMU_LSM6DS3TR_C_STM32_H_
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include STM32_H
+
+/** Platform-specific device information. */
+typedef struct {
+    /** The I2C peripheral connected to the chip. */
+    I2C_TypeDef *i2c;
+    #if defined(STM32L4)
+    /** Value of the I2C TIMINGR register. */
+    uint32_t i2c_timing;
+    #else
+    /** I2C clock speed in Hz. */
+    uint32_t i2c_clock_speed;
+    #endif
+    /** Whether the x and z axes of the gyro are flipped in the hub frame. */
+    bool gyro_flip_xz;
+    /** Whether the x and z axes of the accelerometer are flipped in the hub frame. */
+    bool accel_flip_xz;
+    #if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA
+    /** The DMA stream for receiving from the I2C peripheral. */
+    DMA_Stream_TypeDef *rx_dma;
+    /** The DMA channel for receiving from the I2C peripheral. */
+    uint32_t rx_dma_ch;
+    /** The DMA stream interrupt number. */
+    IRQn_Type rx_dma_irq;
+    #endif
+} pbdrv_imu_lsm6ds3tr_c_stm32_platform_data_t;
+
+/** Platform-specific data - defined in platform.c */
+extern const pbdrv_imu_lsm6ds3tr_c_stm32_platform_data_t pbdrv_imu_lsm6ds3tr_c_stm32_platform_data;
+
+void pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_er_irq(void);
+void pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_ev_irq(void);
+#if PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA
+void pbdrv_imu_lsm6ds3tr_c_stm32_handle_rx_dma_irq(void);
+#endif
+
+#endif // PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32
+
+#endif // _INTERNAL_PBDRV_IMU_LSM6DS3TR_C_STM32_H_
@@ -62,4 +62,30 @@ pbio_error_t pbdrv_led_array_set_brightness(pbdrv_led_array_dev_t *dev, uint8_t
     return dev->funcs->set_brightness(dev, index, brightness);
 }
 
+/**
+ * Starts a new frame.
+ *
+ * Brightness changes made with pbdrv_led_array_set_brightness() after this
+ * call are shown together once pbdrv_led_array_commit_frame() is called.
+ * Calls may be nested.
+ *
+ * @param [in]  dev         The LED array device instance.
+ */
+void pbdrv_led_array_begin_frame(pbdrv_led_array_dev_t *dev) {
+    if (dev->funcs->begin_frame) {
+        dev->funcs->begin_frame(dev);
+    }
+}
+
+/**
+ * Ends a frame that was started with pbdrv_led_array_begin_frame().
+ *
+ * @param [in]  dev         The LED array device instance.
+ */
+void pbdrv_led_array_commit_frame(pbdrv_led_array_dev_t *dev) {
+    if (dev->funcs->commit_frame) {
+        dev->funcs->commit_frame(dev);
+    }
+}
+
 #endif // PBDRV_CONFIG_LED_ARRAY
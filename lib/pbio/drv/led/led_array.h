@@ -25,6 +25,16 @@ typedef struct {
      * @return                  ::PBIO_SUCCESS if successful.
      */
     pbio_error_t (*set_brightness)(pbdrv_led_array_dev_t *dev, uint8_t index, uint8_t brightness);
+    /**
+     * Starts a frame, see pbdrv_led_array_begin_frame() (optional).
+     * @param [in]  dev         The LED array device instance.
+     */
+    void (*begin_frame)(pbdrv_led_array_dev_t *dev);
+    /**
+     * Commits a frame, see pbdrv_led_array_commit_frame() (optional).
+     * @param [in]  dev         The LED array device instance.
+     */
+    void (*commit_frame)(pbdrv_led_array_dev_t *dev);
 } pbdrv_led_array_funcs_t;
 
 /** LED device instance. */
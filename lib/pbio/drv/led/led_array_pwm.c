@@ -42,8 +42,28 @@ static pbio_error_t pbdrv_led_array_pwm_set_brightness(pbdrv_led_array_dev_t *de
     return PBIO_SUCCESS;
 }
 
+static void pbdrv_led_array_pwm_begin_frame(pbdrv_led_array_dev_t *dev) {
+    const pbdrv_led_array_pwm_platform_data_t *pdata = dev->pdata;
+
+    pbdrv_pwm_dev_t *pwm;
+    if (pbdrv_pwm_get_dev(pdata->pwm_id, &pwm) == PBIO_SUCCESS) {
+        pbdrv_pwm_begin_frame(pwm);
+    }
+}
+
+static void pbdrv_led_array_pwm_commit_frame(pbdrv_led_array_dev_t *dev) {
+    const pbdrv_led_array_pwm_platform_data_t *pdata = dev->pdata;
+
+    pbdrv_pwm_dev_t *pwm;
+    if (pbdrv_pwm_get_dev(pdata->pwm_id, &pwm) == PBIO_SUCCESS) {
+        pbdrv_pwm_commit_frame(pwm);
+    }
+}
+
 static const pbdrv_led_array_funcs_t pbdrv_led_array_pwm_funcs = {
     .set_brightness = pbdrv_led_array_pwm_set_brightness,
+    .begin_frame = pbdrv_led_array_pwm_begin_frame,
+    .commit_frame = pbdrv_led_array_pwm_commit_frame,
 };
 
 void pbdrv_led_array_pwm_init(pbdrv_led_array_dev_t *devs) {
@@ -18,6 +18,12 @@
 typedef struct {
     /** Driver implementation of pbdrv_pwm_set_duty() */
     pbio_error_t (*set_duty)(pbdrv_pwm_dev_t *dev, uint32_t ch, uint32_t value);
+    /** Driver implementation of pbdrv_pwm_begin_frame() (optional) */
+    void (*begin_frame)(pbdrv_pwm_dev_t *dev);
+    /** Driver implementation of pbdrv_pwm_commit_frame() (optional) */
+    void (*commit_frame)(pbdrv_pwm_dev_t *dev);
+    /** Driver implementation of pbdrv_pwm_get_transfer_count() (optional) */
+    uint32_t (*get_transfer_count)(pbdrv_pwm_dev_t *dev);
 } pbdrv_pwm_driver_funcs_t;
 
 struct _pbdrv_pwm_dev_t {
@@ -67,4 +67,50 @@ pbio_error_t pbdrv_pwm_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch, uint32_t valu
     return dev->funcs->set_duty(dev, ch, value);
 }
 
+/**
+ * Starts a new frame.
+ *
+ * Drivers that buffer duty cycles do not send any duty cycle to the hardware
+ * until the frame is committed with pbdrv_pwm_commit_frame(). This way, all
+ * channels change at the same time. Calls may be nested. Drivers that write
+ * duty cycles directly to the hardware ignore this.
+ *
+ * @param [in]  dev     Pointer to the PWM device.
+ */
+void pbdrv_pwm_begin_frame(pbdrv_pwm_dev_t *dev) {
+    if (dev->funcs->begin_frame) {
+        dev->funcs->begin_frame(dev);
+    }
+}
+
+/**
+ * Ends a frame that was started with pbdrv_pwm_begin_frame().
+ *
+ * The frame is sent to the hardware at the next refresh of the driver, but
+ * only if any duty cycle has actually changed.
+ *
+ * @param [in]  dev     Pointer to the PWM device.
+ */
+void pbdrv_pwm_commit_frame(pbdrv_pwm_dev_t *dev) {
+    if (dev->funcs->commit_frame) {
+        dev->funcs->commit_frame(dev);
+    }
+}
+
+/**
+ * Gets the number of times that the driver sent duty cycles to the hardware.
+ *
+ * This can be used to measure how many updates are saved by using frames.
+ *
+ * @param [in]  dev     Pointer to the PWM device.
+ * @return              The number of transfers since boot or 0 if the driver
+ *                      does not count transfers.
+ */
+uint32_t pbdrv_pwm_get_transfer_count(pbdrv_pwm_dev_t *dev) {
+    if (dev->funcs->get_transfer_count) {
+        return dev->funcs->get_transfer_count(dev);
+    }
+    return 0;
+}
+
 #endif // PBDRV_CONFIG_PWM
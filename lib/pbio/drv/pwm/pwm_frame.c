@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Double buffered frames for PWM drivers that send all channels at once.
+//
+// set_duty writes into the back buffer. At each refresh interval, the driver
+// calls pbdrv_pwm_frame_refresh(), which copies the back buffer to the front
+// buffer if there is a complete frame that differs from the one that was sent
+// last. The driver then sends the front buffer, so the next frame can be
+// written during the transfer.
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_PWM_FRAME
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pwm_frame.h"
+
+/**
+ * Initializes the frame buffers.
+ * @param [in]  frame   The frame.
+ * @param [in]  back    Buffer that is written by set_duty.
+ * @param [in]  front   Buffer that is sent to the hardware.
+ * @param [in]  size    The size of each buffer.
+ */
+void pbdrv_pwm_frame_init(pbdrv_pwm_frame_t *frame, uint8_t *back, uint8_t *front, uint32_t size) {
+    *frame = (pbdrv_pwm_frame_t) {
+        .back = back,
+        .front = front,
+        .size = size,
+    };
+
+    // The data in the hardware is unknown, so the first frame is always sent
+    memset(front, 0xff, size);
+}
+
+/**
+ * Writes data into the back buffer.
+ * @param [in]  frame   The frame.
+ * @param [in]  offset  Offset in the buffer.
+ * @param [in]  data    The data.
+ * @param [in]  size    The size of @p data.
+ */
+void pbdrv_pwm_frame_set(pbdrv_pwm_frame_t *frame, uint32_t offset, const uint8_t *data, uint32_t size) {
+    assert(offset + size <= frame->size);
+
+    memcpy(&frame->back[offset], data, size);
+    frame->changed = true;
+}
+
+/**
+ * Starts a frame. Calls may be nested.
+ * @param [in]  frame   The frame.
+ */
+void pbdrv_pwm_frame_begin(pbdrv_pwm_frame_t *frame) {
+    assert(frame->depth < UINT8_MAX);
+    frame->depth++;
+}
+
+/**
+ * Ends a frame that was started with pbdrv_pwm_frame_begin().
+ * @param [in]  frame   The frame.
+ */
+void pbdrv_pwm_frame_commit(pbdrv_pwm_frame_t *frame) {
+    assert(frame->depth > 0);
+    frame->depth--;
+}
+
+/**
+ * Prepares the front buffer for a transfer. Drivers call this at each refresh
+ * interval and send the front buffer if it returns true.
+ * @param [in]  frame   The frame.
+ * @return              True if the front buffer has a new frame to send.
+ */
+bool pbdrv_pwm_frame_refresh(pbdrv_pwm_frame_t *frame) {
+    // Only send complete frames
+    if (!frame->changed || frame->depth > 0) {
+        return false;
+    }
+    frame->changed = false;
+
+    // Skip the transfer if the frame ended up the same as the last one
+    if (memcmp(frame->front, frame->back, frame->size) == 0) {
+        return false;
+    }
+
+    memcpy(frame->front, frame->back, frame->size);
+    frame->transfer_count++;
+
+    return true;
+}
+
+#endif // PBDRV_CONFIG_PWM_FRAME
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Double buffered frames for PWM drivers that send all channels at once.
+
+#ifndef _INTERNAL_PBDRV_PWM_FRAME_H_
+#define _INTERNAL_PBDRV_PWM_FRAME_H_
+
+#include <pbdrv/config.h>
+
+#if PBDRV_CONFIG_PWM_FRAME
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    /** Data written by set_duty (back buffer). */
+    uint8_t *back;
+    /** Data being sent to the hardware (front buffer). */
+    uint8_t *front;
+    /** Size of each buffer in bytes. */
+    uint32_t size;
+    /** The back buffer has been written since the last refresh. */
+    bool changed;
+    /** Number of frames that have begun but are not yet committed. */
+    uint8_t depth;
+    /** Number of times the front buffer was updated for a transfer. */
+    uint32_t transfer_count;
+} pbdrv_pwm_frame_t;
+
+void pbdrv_pwm_frame_init(pbdrv_pwm_frame_t *frame, uint8_t *back, uint8_t *front, uint32_t size);
+void pbdrv_pwm_frame_set(pbdrv_pwm_frame_t *frame, uint32_t offset, const uint8_t *data, uint32_t size);
+void pbdrv_pwm_frame_begin(pbdrv_pwm_frame_t *frame);
+void pbdrv_pwm_frame_commit(pbdrv_pwm_frame_t *frame);
+bool pbdrv_pwm_frame_refresh(pbdrv_pwm_frame_t *frame);
+
+#endif // PBDRV_CONFIG_PWM_FRAME
+
+#endif // _INTERNAL_PBDRV_PWM_FRAME_H_
@@ -21,6 +21,7 @@
 #include <pbio/util.h>
 
 #include "../core.h"
+#include "pwm_frame.h"
 #include "pwm_tlc5955_stm32.h"
 #include "pwm.h"
 
@@ -30,6 +31,9 @@
 // number of PWM channels on TLC5955
 #define TLC5955_NUM_CHANNEL 48
 
+// time between frame updates in milliseconds
+#define TLC5955_REFRESH_INTERVAL 10
+
 /** Values for TLC5955_CONTROL_DATA maximum current parameter. */
 enum {
     /** Max current: 3.2 mA */
@@ -131,9 +135,7 @@ typedef struct {
     /** Pointer to generic PWM device instance */
     pbdrv_pwm_dev_t *pwm;
     /** Grayscale latch register data */
-    uint8_t *grayscale_latch;
-    /** grayscale value has changed, update needed */
-    bool changed;
+    pbdrv_pwm_frame_t frame;
 } pbdrv_pwm_tlc5955_stm32_priv_t;
 
 PROCESS(pwm_tlc5955_stm32, "pwm_tlc5955_stm32");
@@ -145,6 +147,9 @@ static pbdrv_pwm_tlc5955_stm32_priv_t dev_priv[PBDRV_CONFIG_PWM_TLC5955_STM32_NU
 static const TLC5955_CONTROL_DATA(control_latch_3mA, 127, TLC5955_MC_3_2, 127, 1, 0, 0, 1, 1);
 
 static uint8_t grayscale_latch[PBDRV_CONFIG_PWM_TLC5955_STM32_NUM_DEV][TLC5955_DATA_SIZE];
+static uint8_t grayscale_latch_sent[PBDRV_CONFIG_PWM_TLC5955_STM32_NUM_DEV][TLC5955_DATA_SIZE];
+
+static struct etimer refresh_timer;
 
 // channels are mapped to GS registers in reverse order. CH 0: GSB15, CH 1: GSG15,
 // CH 2: GSR15 ... CH 45: GSB0, CH 46: GSG0, CH 47: GSR0
@@ -154,16 +159,43 @@ static pbio_error_t pbdrv_pwm_tlc5955_stm32_set_duty(pbdrv_pwm_dev_t *dev, uint3
     assert(ch < TLC5955_NUM_CHANNEL);
     assert(value <= UINT16_MAX);
 
-    priv->grayscale_latch[ch * 2 + 1] = value >> 8;
-    priv->grayscale_latch[ch * 2 + 2] = value;
-    priv->changed = true;
-    process_poll(&pwm_tlc5955_stm32);
+    // The latch is sent at the next refresh, so all channels that are set
+    // before then are sent together.
+    uint8_t data[2] = { value >> 8, value };
+    pbdrv_pwm_frame_set(&priv->frame, ch * 2 + 1, data, sizeof(data));
+
+    // The refresh timer is stopped while there is nothing to send, so let the
+    // process start it again.
+    if (etimer_expired(&refresh_timer)) {
+        process_poll(&pwm_tlc5955_stm32);
+    }
 
     return PBIO_SUCCESS;
 }
 
+static void pbdrv_pwm_tlc5955_stm32_begin_frame(pbdrv_pwm_dev_t *dev) {
+    pbdrv_pwm_tlc5955_stm32_priv_t *priv = dev->priv;
+
+    pbdrv_pwm_frame_begin(&priv->frame);
+}
+
+static void pbdrv_pwm_tlc5955_stm32_commit_frame(pbdrv_pwm_dev_t *dev) {
+    pbdrv_pwm_tlc5955_stm32_priv_t *priv = dev->priv;
+
+    pbdrv_pwm_frame_commit(&priv->frame);
+}
+
+static uint32_t pbdrv_pwm_tlc5955_stm32_get_transfer_count(pbdrv_pwm_dev_t *dev) {
+    pbdrv_pwm_tlc5955_stm32_priv_t *priv = dev->priv;
+
+    return priv->frame.transfer_count;
+}
+
 static const pbdrv_pwm_driver_funcs_t pbdrv_pwm_tlc5955_stm32_funcs = {
     .set_duty = pbdrv_pwm_tlc5955_stm32_set_duty,
+    .begin_frame = pbdrv_pwm_tlc5955_stm32_begin_frame,
+    .commit_frame = pbdrv_pwm_tlc5955_stm32_commit_frame,
+    .get_transfer_count = pbdrv_pwm_tlc5955_stm32_get_transfer_count,
 };
 
 void pbdrv_pwm_tlc5955_stm32_init(pbdrv_pwm_dev_t *devs) {
@@ -236,7 +268,7 @@ void pbdrv_pwm_tlc5955_stm32_init(pbdrv_pwm_dev_t *devs) {
 
         PT_INIT(&priv->pt);
         priv->pwm = pwm;
-        priv->grayscale_latch = grayscale_latch[i];
+        pbdrv_pwm_frame_init(&priv->frame, grayscale_latch[i], grayscale_latch_sent[i], TLC5955_DATA_SIZE);
         pwm->pdata = pdata;
         pwm->priv = priv;
         // don't set funcs yet since we are not fully initialized
@@ -270,9 +302,12 @@ static PT_THREAD(pbdrv_pwm_tlc5955_stm32_handle_event(pbdrv_pwm_tlc5955_stm32_pr
     pbdrv_init_busy_down();
 
     for (;;) {
-        PT_WAIT_UNTIL(&priv->pt, priv->changed);
-        HAL_SPI_Transmit_DMA(&priv->hspi, priv->grayscale_latch, TLC5955_DATA_SIZE);
-        priv->changed = false;
+        // Only send at the refresh interval, and only new, complete frames
+        PT_WAIT_UNTIL(&priv->pt, ev == PROCESS_EVENT_TIMER && pbdrv_pwm_frame_refresh(&priv->frame));
+
+        // Send the front buffer, so set_duty can write the next frame during
+        // the transfer
+        HAL_SPI_Transmit_DMA(&priv->hspi, priv->frame.front, TLC5955_DATA_SIZE);
         PT_WAIT_UNTIL(&priv->pt, priv->hspi.State == HAL_SPI_STATE_READY);
         pbdrv_pwm_tlc5955_toggle_latch(priv);
     }
@@ -317,10 +352,24 @@ PROCESS_THREAD(pwm_tlc5955_stm32, ev, data) {
     // need to allow all drivers to init first
     PROCESS_PAUSE();
 
+    etimer_set(&refresh_timer, TLC5955_REFRESH_INTERVAL);
+
     for (;;) {
+        bool pending = false;
         for (int i = 0; i < PBDRV_CONFIG_PWM_TLC5955_STM32_NUM_DEV; i++) {
             pbdrv_pwm_tlc5955_stm32_priv_t *priv = &dev_priv[i];
             pbdrv_pwm_tlc5955_stm32_handle_event(priv, ev);
+            pending |= priv->frame.changed;
+        }
+
+        // Only keep waking up while there are frames left to send. The timer
+        // is started again when set_duty writes a new value.
+        if (ev == PROCESS_EVENT_TIMER && etimer_expired(&refresh_timer)) {
+            if (pending) {
+                etimer_reset(&refresh_timer);
+            }
+        } else if (ev == PROCESS_EVENT_POLL && etimer_expired(&refresh_timer) && pending) {
+            etimer_set(&refresh_timer, TLC5955_REFRESH_INTERVAL);
         }
         PROCESS_WAIT_EVENT();
     }
@@ -109,6 +109,21 @@ pbio_error_t pbdrv_uart_read_end(pbdrv_uart_dev_t *uart_dev) {
     return err;
 }
 
+pbio_error_t pbdrv_uart_read_available(pbdrv_uart_dev_t *uart_dev, uint8_t *data, uint32_t size, uint32_t *count) {
+    pbdrv_uart_t *uart = PBIO_CONTAINER_OF(uart_dev, pbdrv_uart_t, uart_dev);
+    uint32_t i;
+
+    // copy all bytes received by the interrupt handler so far
+    for (i = 0; i < size && uart->rx_ring_buf_head != uart->rx_ring_buf_tail; i++) {
+        data[i] = uart->rx_ring_buf[uart->rx_ring_buf_tail];
+        uart->rx_ring_buf_tail = (uart->rx_ring_buf_tail + 1) & (UART_RING_BUF_SIZE - 1);
+    }
+
+    *count = i;
+
+    return PBIO_SUCCESS;
+}
+
 void pbdrv_uart_read_cancel(pbdrv_uart_dev_t *uart_dev) {
     pbdrv_uart_t *uart = PBIO_CONTAINER_OF(uart_dev, pbdrv_uart_t, uart_dev);
 
@@ -234,6 +249,9 @@ static void handle_poll(void) {
                     break;
                 }
             }
+        } else if (!uart->rx_buf && uart->rx_ring_buf_head != uart->rx_ring_buf_tail) {
+            // bytes are waiting for pbdrv_uart_read_available()
+            process_post(PROCESS_BROADCAST, PROCESS_EVENT_COM, NULL);
         }
 
         if (uart->tx_buf && uart->tx_buf_index == uart->tx_buf_size) {
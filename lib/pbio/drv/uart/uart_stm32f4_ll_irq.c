@@ -105,6 +105,24 @@ pbio_error_t pbdrv_uart_read_end(pbdrv_uart_dev_t *uart_dev) {
     return PBIO_SUCCESS;
 }
 
+pbio_error_t pbdrv_uart_read_available(pbdrv_uart_dev_t *uart_dev, uint8_t *data, uint32_t size, uint32_t *count) {
+    pbdrv_uart_t *uart = PBIO_CONTAINER_OF(uart_dev, pbdrv_uart_t, uart_dev);
+    uint32_t i;
+
+    // Take everything the IRQ handler has put in the ring buffer so far
+    for (i = 0; i < size; i++) {
+        int c = ringbuf_get(&uart->rx_buf);
+        if (c == -1) {
+            break;
+        }
+        data[i] = c;
+    }
+
+    *count = i;
+
+    return PBIO_SUCCESS;
+}
+
 void pbdrv_uart_read_cancel(pbdrv_uart_dev_t *uart_dev) {
     // TODO
 }
@@ -232,6 +250,11 @@ static void handle_poll(void) {
             process_post(PROCESS_BROADCAST, PROCESS_EVENT_COM, NULL);
         }
 
+        // broadcast when bytes are waiting for pbdrv_uart_read_available()
+        if (!uart->read_buf && ringbuf_elements(&uart->rx_buf) > 0) {
+            process_post(PROCESS_BROADCAST, PROCESS_EVENT_COM, NULL);
+        }
+
         // broadcast when write_buf is drained
         if (uart->write_buf && uart->write_pos == uart->write_length) {
             // clearing write_buf to prevent multiple broadcasts
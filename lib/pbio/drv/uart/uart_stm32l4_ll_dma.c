@@ -236,6 +236,32 @@ pbio_error_t pbdrv_uart_read_end(pbdrv_uart_dev_t *uart_dev) {
     return PBIO_SUCCESS;
 }
 
+pbio_error_t pbdrv_uart_read_available(pbdrv_uart_dev_t *uart_dev, uint8_t *data, uint32_t size, uint32_t *count) {
+    pbdrv_uart_t *uart = PBIO_CONTAINER_OF(uart_dev, pbdrv_uart_t, uart_dev);
+    const pbdrv_uart_stm32l4_ll_dma_platform_data_t *pdata = uart->pdata;
+
+    // DMA keeps writing to the circular buffer, so everything between the
+    // tail and the last position that DMA wrote to can be taken at once.
+    uint32_t rx_head = (RX_DATA_SIZE - LL_DMA_GetDataLength(pdata->rx_dma, pdata->rx_dma_ch)) & (RX_DATA_SIZE - 1);
+    uint32_t available = (rx_head - uart->rx_tail) & (RX_DATA_SIZE - 1);
+    if (available > size) {
+        available = size;
+    }
+
+    if (uart->rx_tail + available > RX_DATA_SIZE) {
+        uint32_t partial_size = RX_DATA_SIZE - uart->rx_tail;
+        volatile_copy(&uart->rx_data[uart->rx_tail], &data[0], partial_size);
+        volatile_copy(&uart->rx_data[0], &data[partial_size], available - partial_size);
+    } else {
+        volatile_copy(&uart->rx_data[uart->rx_tail], &data[0], available);
+    }
+
+    uart->rx_tail = (uart->rx_tail + available) & (RX_DATA_SIZE - 1);
+    *count = available;
+
+    return PBIO_SUCCESS;
+}
+
 void pbdrv_uart_read_cancel(pbdrv_uart_dev_t *uart_dev) {
     // TODO
 }
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+/**
+ * @addtogroup BlockDeviceDriver Driver: Block Device
+ *
+ * Storage that can be erased in blocks and written in pages, such as external
+ * SPI flash. Offsets are relative to the start of the region that Pybricks
+ * may use, not to the start of the memory chip. Other firmware may have left
+ * data in this region, so users must check before they overwrite it.
+ *
+ * @{
+ */
+
+#ifndef _PBDRV_BLOCK_DEVICE_H_
+#define _PBDRV_BLOCK_DEVICE_H_
+
+#include <stdint.h>
+
+#include <pbdrv/config.h>
+#include <pbio/error.h>
+
+#if PBDRV_CONFIG_BLOCK_DEVICE
+
+/** Size of one erasable block in bytes. */
+#define PBDRV_BLOCK_DEVICE_BLOCK_SIZE PBDRV_CONFIG_BLOCK_DEVICE_BLOCK_SIZE
+
+/** Size of one programmable page in bytes. */
+#define PBDRV_BLOCK_DEVICE_PAGE_SIZE PBDRV_CONFIG_BLOCK_DEVICE_PAGE_SIZE
+
+/** Number of blocks in the region that Pybricks may use. */
+#define PBDRV_BLOCK_DEVICE_NUM_BLOCKS (PBDRV_CONFIG_BLOCK_DEVICE_SIZE / PBDRV_CONFIG_BLOCK_DEVICE_BLOCK_SIZE)
+
+/**
+ * Reads data from the block device.
+ * @param [in]  offset  Offset from the start of the region
+ * @param [out] buf     Buffer for the data
+ * @param [in]  size    Number of bytes to read
+ * @return              ::PBIO_SUCCESS if the call was successful,
+ *                      ::PBIO_ERROR_INVALID_ARG if the range is out of bounds
+ *                      ::PBIO_ERROR_IO if there was an I/O error
+ */
+pbio_error_t pbdrv_block_device_read(uint32_t offset, uint8_t *buf, uint32_t size);
+
+/**
+ * Writes data to the block device. The range must be erased first and may
+ * not cross a page boundary.
+ * @param [in]  offset  Offset from the start of the region
+ * @param [in]  buf     The data
+ * @param [in]  size    Number of bytes to write
+ * @return              ::PBIO_SUCCESS if the call was successful,
+ *                      ::PBIO_ERROR_INVALID_ARG if the range is out of bounds
+ *                      ::PBIO_ERROR_TIMEDOUT if the device did not finish
+ *                      ::PBIO_ERROR_IO if there was an I/O error
+ */
+pbio_error_t pbdrv_block_device_prog(uint32_t offset, const uint8_t *buf, uint32_t size);
+
+/**
+ * Erases one block of the block device.
+ * @param [in]  offset  Offset of the block from the start of the region
+ * @return              ::PBIO_SUCCESS if the call was successful,
+ *                      ::PBIO_ERROR_INVALID_ARG if the offset is out of bounds
+ *                      ::PBIO_ERROR_TIMEDOUT if the device did not finish
+ *                      ::PBIO_ERROR_IO if there was an I/O error
+ */
+pbio_error_t pbdrv_block_device_erase(uint32_t offset);
+
+#else // PBDRV_CONFIG_BLOCK_DEVICE
+
+static inline pbio_error_t pbdrv_block_device_read(uint32_t offset, uint8_t *buf, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_block_device_prog(uint32_t offset, const uint8_t *buf, uint32_t size) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_block_device_erase(uint32_t offset) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+#endif // PBDRV_CONFIG_BLOCK_DEVICE
+
+#endif // _PBDRV_BLOCK_DEVICE_H_
+
+/** @} */
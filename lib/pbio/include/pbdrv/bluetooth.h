@@ -129,6 +129,13 @@ void pbdrv_bluetooth_stop_advertising(void);
  */
 bool pbdrv_bluetooth_is_connected(pbdrv_bluetooth_connection_t connection);
 
+/**
+ * Gets the largest value that can be sent in one notification on the
+ * current connection, as negotiated with the central.
+ * @return                  The size in bytes.
+ */
+uint16_t pbdrv_bluetooth_get_max_notification_size(void);
+
 /**
  * Registers a callback that is called when Bluetooth event occurs.
  *
@@ -140,7 +147,9 @@ void pbdrv_bluetooth_set_on_event(pbdrv_bluetooth_on_event_t on_event);
  * Requests for @p data to be sent via a characteristic notification.
  *
  * It is up to the caller to verify that notifications are enabled and
- * that any previous notification request is done before calling this function.
+ * that no more than ::PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS requests are
+ * pending before calling this function. Requests are done in the order they
+ * were made. The done callback may be called before this function returns.
  *
  * @param [in]  context     The data to be sent and where to send it.
  */
@@ -199,6 +208,10 @@ static inline bool pbdrv_bluetooth_is_connected(pbdrv_bluetooth_connection_t con
     return false;
 }
 
+static inline uint16_t pbdrv_bluetooth_get_max_notification_size(void) {
+    return 0;
+}
+
 static inline void pbdrv_bluetooth_send(pbdrv_bluetooth_send_context_t *context) {
 }
 
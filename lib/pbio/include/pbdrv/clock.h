@@ -21,6 +21,17 @@ uint32_t pbdrv_clock_get_ms(void);
  */
 uint32_t pbdrv_clock_get_us(void);
 
+/**
+ * Gets a free running counter with the highest resolution available, for
+ * measuring short time intervals. It wraps around at UINT32_MAX.
+ */
+uint32_t pbdrv_clock_get_cycles(void);
+
+/**
+ * Gets the number of pbdrv_clock_get_cycles() counts per microsecond.
+ */
+uint32_t pbdrv_clock_get_cycles_per_us(void);
+
 #endif /* _PBDRV_CLOCK_H_ */
 
 /** @} */
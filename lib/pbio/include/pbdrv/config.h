@@ -78,4 +78,9 @@
 #endif
 #endif
 
+// the number of notifications that can be handed to the Bluetooth driver before the first one is done
+#ifndef PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS
+#define PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS (1)
+#endif
+
 #endif // _PBDRV_CONFIG_H_
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+/**
+ * @addtogroup IMUDriver Driver: Inertial Measurement Unit
+ * @{
+ */
+
+#ifndef _PBDRV_IMU_H_
+#define _PBDRV_IMU_H_
+
+#include <stdint.h>
+
+#include <pbdrv/config.h>
+#include <pbio/error.h>
+
+/** One sample of the IMU. */
+typedef struct _pbdrv_imu_sample_t {
+    /** Time of the sample in microseconds, like ::pbdrv_clock_get_us. */
+    uint32_t time;
+    /** Angular velocity in the hub frame in deg/s. */
+    float angular_velocity[3];
+    /** Acceleration in the hub frame in m/s². */
+    float acceleration[3];
+} pbdrv_imu_sample_t;
+
+#if PBDRV_CONFIG_IMU
+
+/**
+ * Gets the latest angular velocity sample, compensated for gyro bias.
+ * @param [out] values      The x, y and z components in the hub frame in deg/s.
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_AGAIN if there is no
+ *                          sample yet or ::PBIO_ERROR_NO_DEV if the sensor was
+ *                          not found.
+ */
+pbio_error_t pbdrv_imu_get_angular_velocity(float *values);
+
+/**
+ * Gets the latest acceleration sample.
+ * @param [out] values      The x, y and z components in the hub frame in m/s².
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_AGAIN if there is no
+ *                          sample yet or ::PBIO_ERROR_NO_DEV if the sensor was
+ *                          not found.
+ */
+pbio_error_t pbdrv_imu_get_acceleration(float *values);
+
+/**
+ * Gets the rotation about the z axis of the hub, integrated from the angular
+ * velocity since the driver started. It is counterclockwise positive when
+ * looking at the top of the hub. The value wraps around on overflow, so only
+ * differences between two readings are meaningful.
+ * @param [out] heading     The heading in millidegrees.
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_AGAIN if there is no
+ *                          sample yet or ::PBIO_ERROR_NO_DEV if the sensor was
+ *                          not found.
+ */
+pbio_error_t pbdrv_imu_get_heading(int32_t *heading);
+
+/**
+ * Gets the index that the next new sample will have. Samples are numbered
+ * from 0 in the order that the sensor took them.
+ * @param [out] index       The index.
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_AGAIN if there is no
+ *                          sample yet or ::PBIO_ERROR_NO_DEV if the sensor was
+ *                          not found.
+ */
+pbio_error_t pbdrv_imu_get_sample_index(uint32_t *index);
+
+/**
+ * Gets buffered samples, oldest first. Only the most recent samples are kept,
+ * so if @p index is older than that, it skips ahead to the oldest one.
+ * @param [in, out] index   Index of the first sample to get. On return, the
+ *                          index after the last sample that was copied.
+ * @param [out] samples     Array for the samples.
+ * @param [in, out] num     Size of @p samples. On return, the number of
+ *                          samples that were copied.
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_AGAIN if there is no
+ *                          sample yet or ::PBIO_ERROR_NO_DEV if the sensor was
+ *                          not found.
+ */
+pbio_error_t pbdrv_imu_get_samples(uint32_t *index, pbdrv_imu_sample_t *samples, uint32_t *num);
+
+#else // PBDRV_CONFIG_IMU
+
+static inline pbio_error_t pbdrv_imu_get_angular_velocity(float *values) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_imu_get_acceleration(float *values) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_imu_get_heading(int32_t *heading) {
+    *heading = 0;
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_imu_get_sample_index(uint32_t *index) {
+    *index = 0;
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+static inline pbio_error_t pbdrv_imu_get_samples(uint32_t *index, pbdrv_imu_sample_t *samples, uint32_t *num) {
+    *num = 0;
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+
+#endif // PBDRV_CONFIG_IMU
+
+#endif // _PBDRV_IMU_H_
+
+/** @} */
@@ -42,6 +42,8 @@ static inline pbio_error_t pbdrv_led_set_hsv(pbdrv_led_dev_t *dev, const pbio_co
 
 pbio_error_t pbdrv_led_array_get_dev(uint8_t id, pbdrv_led_array_dev_t **dev);
 pbio_error_t pbdrv_led_array_set_brightness(pbdrv_led_array_dev_t *dev, uint8_t index, uint8_t brightness);
+void pbdrv_led_array_begin_frame(pbdrv_led_array_dev_t *dev);
+void pbdrv_led_array_commit_frame(pbdrv_led_array_dev_t *dev);
 
 #else // PBDRV_CONFIG_LED_ARRAY
 
@@ -54,6 +56,12 @@ static inline pbio_error_t pbdrv_led_array_set_brightness(pbdrv_led_array_dev_t
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline void pbdrv_led_array_begin_frame(pbdrv_led_array_dev_t *dev) {
+}
+
+static inline void pbdrv_led_array_commit_frame(pbdrv_led_array_dev_t *dev) {
+}
+
 #endif // PBDRV_CONFIG_LED_ARRAY
 
 #endif // _PBDRV_LED_H_
@@ -69,6 +69,25 @@ pbio_error_t pbdrv_motor_get_id(pbio_port_id_t port, pbio_iodev_type_id_t *id);
  */
 pbio_error_t pbdrv_motor_setup(pbio_port_id_t port, bool is_servo);
 
+#if PBDRV_CONFIG_MOTOR_DEFERRED_COMMIT
+
+/**
+ * Writes the duty cycles that were set since the last call to the hardware.
+ * Drivers with this option only remember the duty cycle in
+ * ::pbdrv_motor_set_duty_cycle, so this must be called after every control
+ * update. Coasting is not deferred.
+ * @return              The number of writes it took, for diagnostics
+ */
+uint32_t pbdrv_motor_commit(void);
+
+#else
+
+static inline uint32_t pbdrv_motor_commit(void) {
+    return 0;
+}
+
+#endif // PBDRV_CONFIG_MOTOR_DEFERRED_COMMIT
+
 #else
 
 static inline pbio_error_t pbdrv_motor_coast(pbio_port_id_t port) {
@@ -84,6 +103,9 @@ static inline pbio_error_t pbdrv_motor_get_id(pbio_port_id_t port, pbio_iodev_ty
 static inline pbio_error_t pbdrv_motor_setup(pbio_port_id_t port, bool is_servo) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
+static inline uint32_t pbdrv_motor_commit(void) {
+    return 0;
+}
 
 #endif
 
@@ -24,6 +24,9 @@ typedef struct _pbdrv_pwm_dev_t pbdrv_pwm_dev_t;
 
 pbio_error_t pbdrv_pwm_get_dev(uint8_t id, pbdrv_pwm_dev_t **dev);
 pbio_error_t pbdrv_pwm_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch, uint32_t value);
+void pbdrv_pwm_begin_frame(pbdrv_pwm_dev_t *dev);
+void pbdrv_pwm_commit_frame(pbdrv_pwm_dev_t *dev);
+uint32_t pbdrv_pwm_get_transfer_count(pbdrv_pwm_dev_t *dev);
 
 #else
 
@@ -36,6 +39,16 @@ static inline pbio_error_t pbdrv_pwm_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch,
     return PBIO_ERROR_NOT_SUPPORTED;
 }
 
+static inline void pbdrv_pwm_begin_frame(pbdrv_pwm_dev_t *dev) {
+}
+
+static inline void pbdrv_pwm_commit_frame(pbdrv_pwm_dev_t *dev) {
+}
+
+static inline uint32_t pbdrv_pwm_get_transfer_count(pbdrv_pwm_dev_t *dev) {
+    return 0;
+}
+
 #endif
 
 #endif /* _PBDRV_PWM_H_ */
@@ -34,6 +34,21 @@ pbio_error_t pbdrv_uart_get(uint8_t id, pbdrv_uart_dev_t **uart_dev);
 pbio_error_t pbdrv_uart_set_baud_rate(pbdrv_uart_dev_t *uart, uint32_t baud);
 pbio_error_t pbdrv_uart_read_begin(pbdrv_uart_dev_t *uart, uint8_t *msg, uint8_t length, uint32_t timeout);
 pbio_error_t pbdrv_uart_read_end(pbdrv_uart_dev_t *uart);
+
+/**
+ * Copies bytes that have already been received, without waiting for more.
+ *
+ * This must not be mixed with pbdrv_uart_read_begin() on the same device.
+ *
+ * @param [in]  uart    The UART device
+ * @param [out] data    Buffer for the received bytes
+ * @param [in]  size    The size of @p data in bytes
+ * @param [out] count   The number of bytes copied to @p data
+ * @return              ::PBIO_SUCCESS even if no bytes were copied or
+ *                      ::PBIO_ERROR_NOT_SUPPORTED if the driver does not
+ *                      buffer received bytes.
+ */
+pbio_error_t pbdrv_uart_read_available(pbdrv_uart_dev_t *uart, uint8_t *data, uint32_t size, uint32_t *count);
 void pbdrv_uart_read_cancel(pbdrv_uart_dev_t *uart);
 pbio_error_t pbdrv_uart_write_begin(pbdrv_uart_dev_t *uart, uint8_t *msg, uint8_t length, uint32_t timeout);
 pbio_error_t pbdrv_uart_write_end(pbdrv_uart_dev_t *uart);
@@ -55,6 +70,10 @@ static inline pbio_error_t pbdrv_uart_read_begin(pbdrv_uart_dev_t *uart, uint8_t
 static inline pbio_error_t pbdrv_uart_read_end(pbdrv_uart_dev_t *uart) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
+static inline pbio_error_t pbdrv_uart_read_available(pbdrv_uart_dev_t *uart, uint8_t *data, uint32_t size, uint32_t *count) {
+    *count = 0;
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
 static inline void pbdrv_uart_read_cancel(pbdrv_uart_dev_t *uart) {
 }
 static inline pbio_error_t pbdrv_uart_write_begin(pbdrv_uart_dev_t *uart, uint8_t *msg, uint8_t length, uint32_t timeout) {
@@ -20,4 +20,28 @@
 #define PBIO_CONFIG_CONTROL_MINIMAL (0)
 #endif
 
+// motor control loop period in milliseconds
+#ifndef PBIO_CONFIG_CONTROL_LOOP_TIME_MS
+#define PBIO_CONFIG_CONTROL_LOOP_TIME_MS (5)
+#elif PBIO_CONFIG_CONTROL_LOOP_TIME_MS < 1
+#error "PBIO_CONFIG_CONTROL_LOOP_TIME_MS must be at least 1"
+#endif
+
+// number of angle maneuvers that can be queued per controller to blend into one motion
+#ifndef PBIO_CONFIG_CONTROL_QUEUE_SIZE
+#define PBIO_CONFIG_CONTROL_QUEUE_SIZE (4)
+#elif PBIO_CONFIG_CONTROL_QUEUE_SIZE < 1
+#error "PBIO_CONFIG_CONTROL_QUEUE_SIZE must be at least 1"
+#endif
+
+// whether to measure the run time of each background process
+#ifndef PBIO_CONFIG_PROFILER
+#define PBIO_CONFIG_PROFILER (0)
+#endif
+
+// number of processes that the profiler can keep track of
+#ifndef PBIO_CONFIG_PROFILER_NUM_PROCESSES
+#define PBIO_CONFIG_PROFILER_NUM_PROCESSES (24)
+#endif
+
 #endif // _PBIO_CONFIG_H_
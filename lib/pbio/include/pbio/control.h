@@ -8,6 +8,7 @@
 
 #include <fixmath.h>
 
+#include <pbio/config.h>
 #include <pbio/error.h>
 #include <pbio/port.h>
 #include <pbio/dcmotor.h>
@@ -17,9 +18,14 @@
 
 #include <pbio/iodev.h>
 
-#define PBIO_CONTROL_LOOP_TIME_MS (5)
+#define PBIO_CONTROL_LOOP_TIME_MS (PBIO_CONFIG_CONTROL_LOOP_TIME_MS)
 
-#define PBIO_CONTROL_LOG_COLS (13)
+#define PBIO_CONTROL_LOG_COLS (12)
+
+// Name and unit of each column in the control log
+#define PBIO_CONTROL_LOG_COL_NAMES \
+    "time:us,count:count,rate:count/s,actuation:,control:,count_ref:count,rate_ref:count/s," \
+    "count_est:count,rate_est:count/s,torque_p:uNm,torque_i:uNm,torque_d:uNm"
 
 /**
  * Control settings
@@ -77,6 +83,15 @@ typedef enum {
     PBIO_CONTROL_ANGLE,  /**< Run to an angle */
 } pbio_control_type_t;
 
+/**
+ * Angle maneuver that waits in the queue until the ongoing one starts to decelerate
+ */
+typedef struct _pbio_control_segment_t {
+    int32_t target_count;           /**< Target count at the end of the segment */
+    int32_t target_rate;            /**< Target rate during the segment */
+    pbio_actuation_t after_stop;    /**< What to do if this is the last segment */
+} pbio_control_segment_t;
+
 typedef struct _pbio_control_t {
     pbio_control_type_t type;
     pbio_control_settings_t settings;
@@ -89,6 +104,10 @@ typedef struct _pbio_control_t {
     int32_t load;
     bool stalled;
     bool on_target;
+    uint32_t maneuver;  /**< Number of maneuvers started so far, used to tell if a maneuver was replaced by a new one */
+    pbio_control_segment_t queue[PBIO_CONFIG_CONTROL_QUEUE_SIZE]; /**< Angle maneuvers to run after the ongoing one */
+    uint8_t queue_start; /**< Index of the first queued maneuver */
+    uint8_t queue_count; /**< Number of queued maneuvers */
 } pbio_control_t;
 
 // Convert control units (counts, rate) and physical user units (deg or mm, deg/s or mm/s)
@@ -115,6 +134,7 @@ pbio_error_t pbio_control_start_angle_control(pbio_control_t *ctl, int32_t time_
 pbio_error_t pbio_control_start_relative_angle_control(pbio_control_t *ctl, int32_t time_now, pbio_control_state_t *state, int32_t relative_target_count, int32_t target_rate, pbio_actuation_t after_stop);
 pbio_error_t pbio_control_start_timed_control(pbio_control_t *ctl, int32_t time_now, pbio_control_state_t *state, int32_t duration, int32_t target_rate, pbio_control_on_target_t stop_func, pbio_actuation_t after_stop);
 pbio_error_t pbio_control_start_hold_control(pbio_control_t *ctl, int32_t time_now, int32_t target_count);
+pbio_error_t pbio_control_queue_angle_control(pbio_control_t *ctl, int32_t time_now, pbio_control_state_t *state, int32_t target_count, int32_t target_rate, pbio_actuation_t after_stop);
 
 bool pbio_control_is_active(pbio_control_t *ctl);
 bool pbio_control_type_is_angle(pbio_control_t *ctl);
@@ -122,6 +142,8 @@ bool pbio_control_type_is_time(pbio_control_t *ctl);
 
 bool pbio_control_is_stalled(pbio_control_t *ctl);
 bool pbio_control_is_done(pbio_control_t *ctl);
+uint32_t pbio_control_get_last_maneuver(pbio_control_t *ctl);
+bool pbio_control_maneuver_is_done(pbio_control_t *ctl, uint32_t maneuver);
 int32_t pbio_control_get_load(pbio_control_t *ctl);
 
 void pbio_control_update(pbio_control_t *ctl, int32_t time_now, pbio_control_state_t *state, pbio_trajectory_reference_t *ref, pbio_actuation_t *actuation, int32_t *control);
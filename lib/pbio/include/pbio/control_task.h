@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#ifndef _PBIO_CONTROL_TASK_H_
+#define _PBIO_CONTROL_TASK_H_
+
+#include <stdint.h>
+
+#include <pbio/control.h>
+#include <pbio/task.h>
+
+/**
+ * Task that completes when the maneuvers of one or two controllers are done.
+ */
+typedef struct _pbio_control_task_t {
+    pbio_task_t task;           /**< The task */
+    pbio_control_t *ctl[2];     /**< The controllers, or NULL if unused */
+    uint32_t maneuver[2];       /**< The maneuver of each controller that the task waits for */
+} pbio_control_task_t;
+
+void pbio_control_task_init(pbio_control_task_t *ct, pbio_control_t *ctl_a, pbio_control_t *ctl_b);
+
+#endif // _PBIO_CONTROL_TASK_H_
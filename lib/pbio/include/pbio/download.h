@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+/**
+ * @addtogroup Download Windowed program download
+ *
+ * Receiver for the sliding window download on the Pybricks characteristic.
+ *
+ * The remote device splits the program into blocks of equal size (except the
+ * last one) and may send many blocks before it gets a status back. Each block
+ * has its own index and CRC32, so blocks can arrive in any order and only bad
+ * or missing blocks need to be sent again. The status event tells which blocks
+ * have been received.
+ *
+ * @{
+ */
+
+#ifndef _PBIO_DOWNLOAD_H_
+#define _PBIO_DOWNLOAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pbio/error.h>
+
+/** Number of blocks after the first missing one that the status can report. */
+#define PBIO_DOWNLOAD_WINDOW_SIZE (32)
+
+/** Windowed download receiver state. */
+typedef struct _pbio_download_t {
+    /** Buffer for the program, or NULL if we are not accepting a download. */
+    uint8_t *buf;
+    /** Size of the buffer. */
+    uint32_t max_size;
+    /** Size of the program. Zero until a download is started. */
+    uint32_t size;
+    /** Size of each block except the last one. */
+    uint16_t block_size;
+    /** Number of blocks in the program. */
+    uint16_t num_blocks;
+    /** Index of the first block that has not been received. */
+    uint16_t base;
+    /** Bit n is set if block base + 1 + n has been received. */
+    uint32_t received;
+    /** Result of the last command. */
+    pbio_error_t status;
+} pbio_download_t;
+
+void pbio_download_init(pbio_download_t *dl, uint8_t *buf, uint32_t max_size);
+void pbio_download_stop(pbio_download_t *dl);
+pbio_error_t pbio_download_start(pbio_download_t *dl, const uint8_t *data, uint32_t size);
+pbio_error_t pbio_download_write_block(pbio_download_t *dl, const uint8_t *data, uint32_t size);
+bool pbio_download_is_done(pbio_download_t *dl);
+
+#endif // _PBIO_DOWNLOAD_H_
+
+/** @} */
@@ -10,11 +10,45 @@
 
 #define PBIO_RADIUS_INF (INT32_MAX)
 
+/**
+ * Position and heading of a drive base, integrated from the motor counts.
+ */
+typedef struct _pbio_drivebase_pose_t {
+    /** Distance state count at the last update. */
+    int32_t distance_count;
+    /** Heading state count at the last update. */
+    int32_t heading_count;
+    /** Heading state count when the pose was reset. */
+    int32_t heading_start;
+    /** Position in distance state counts, scaled by ::PBIO_MATH_TRIG_SCALE. */
+    int64_t x;
+    /** Position in distance state counts, scaled by ::PBIO_MATH_TRIG_SCALE. */
+    int64_t y;
+} pbio_drivebase_pose_t;
+
+/**
+ * Gyro heading that is fused with the heading from the motor counts.
+ */
+typedef struct _pbio_drivebase_gyro_t {
+    /** Whether the heading state follows the gyro. */
+    bool enabled;
+    /** Sign that turns the gyro heading into the drive base heading direction. */
+    int8_t sign;
+    /** Gyro heading in millidegrees when the gyro was enabled. */
+    int32_t heading_start;
+    /** Heading state count when the gyro was enabled. */
+    int32_t count_start;
+    /** Correction of the heading state count in 1/1000 counts. */
+    int32_t offset;
+} pbio_drivebase_gyro_t;
+
 typedef struct _pbio_drivebase_t {
     pbio_servo_t *left;
     pbio_servo_t *right;
     pbio_control_t control_heading;
     pbio_control_t control_distance;
+    pbio_drivebase_pose_t pose;
+    pbio_drivebase_gyro_t gyro;
 } pbio_drivebase_t;
 
 pbio_error_t pbio_drivebase_get_drivebase(pbio_drivebase_t **db_address, pbio_servo_t *left, pbio_servo_t *right, fix16_t wheel_diameter, fix16_t axle_track);
@@ -38,6 +72,12 @@ bool pbio_drivebase_is_busy(pbio_drivebase_t *db);
 
 pbio_error_t pbio_drivebase_get_state_user(pbio_drivebase_t *db, int32_t *distance, int32_t *drive_speed, int32_t *angle, int32_t *turn_rate);
 
+pbio_error_t pbio_drivebase_reset_pose(pbio_drivebase_t *db);
+
+pbio_error_t pbio_drivebase_get_pose_user(pbio_drivebase_t *db, int32_t *x, int32_t *y, int32_t *heading);
+
+pbio_error_t pbio_drivebase_set_use_gyro(pbio_drivebase_t *db, bool use_gyro);
+
 pbio_error_t pbio_drivebase_get_drive_settings(pbio_drivebase_t *db, int32_t *drive_speed, int32_t *drive_acceleration, int32_t *turn_rate, int32_t *turn_acceleration);
 
 pbio_error_t pbio_drivebase_set_drive_settings(pbio_drivebase_t *db, int32_t drive_speed, int32_t drive_acceleration, int32_t turn_rate, int32_t turn_acceleration);
@@ -187,6 +187,17 @@ typedef enum {
  */
 #define PBIO_IODEV_MAX_DATA_SIZE    LUMP_MAX_MSG_SIZE
 
+/**
+ * Max number of values that can be sent in combi-mode, summed over all modes.
+ */
+#define PBIO_IODEV_MAX_COMBO_VALUES (8)
+
+/**
+ * Pseudo mode for ::pbio_iodev_set_mode_begin() that makes a device send the
+ * data of several modes at the same time. See ::pbio_iodev_get_combo_modes().
+ */
+#define PBIO_IODEV_MODE_COMBO       (0xFF)
+
 /**
  * Max size of units of measurements (not including null terminator)
  */
@@ -346,6 +357,12 @@ struct _pbio_iodev_t {
      * the values could be foreign-endian.
      */
     uint8_t bin_data[PBIO_IODEV_MAX_DATA_SIZE]  __attribute__((aligned(4)));
+    /**
+     * Bit flags of the modes that are currently being received together in
+     * *bin_data*, or 0 if the device is not in combi-mode. The data of these
+     * modes is stored one after the other, ordered by mode number.
+     */
+    uint16_t combo_modes;
 };
 
 /** @endcond */
@@ -353,6 +370,8 @@ struct _pbio_iodev_t {
 size_t pbio_iodev_size_of(pbio_iodev_data_type_t type);
 pbio_error_t pbio_iodev_get_data_format(pbio_iodev_t *iodev, uint8_t mode, uint8_t *len, pbio_iodev_data_type_t *type);
 pbio_error_t pbio_iodev_get_data(pbio_iodev_t *iodev, uint8_t **data);
+uint16_t pbio_iodev_get_combo_modes(pbio_iodev_t *iodev);
+pbio_error_t pbio_iodev_get_combo_data(pbio_iodev_t *iodev, uint8_t mode, uint8_t **data);
 pbio_error_t pbio_iodev_set_mode_begin(pbio_iodev_t *iodev, uint8_t mode);
 pbio_error_t pbio_iodev_set_mode_end(pbio_iodev_t *iodev);
 void pbio_iodev_set_mode_cancel(pbio_iodev_t *iodev);
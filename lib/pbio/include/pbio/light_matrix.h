@@ -9,6 +9,7 @@
 #ifndef _PBIO_LIGHT_MATRIX_H_
 #define _PBIO_LIGHT_MATRIX_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbio/config.h>
@@ -37,6 +38,8 @@ pbio_error_t pbio_light_matrix_set_pixel(pbio_light_matrix_t *light_matrix, uint
 pbio_error_t pbio_light_matrix_set_image(pbio_light_matrix_t *light_matrix, const uint8_t *image);
 void pbio_light_matrix_start_animation(pbio_light_matrix_t *light_matrix, const uint8_t *cells, uint8_t num_cells, uint16_t interval);
 void pbio_light_matrix_stop_animation(pbio_light_matrix_t *light_matrix);
+void pbio_light_matrix_start_scroll(pbio_light_matrix_t *light_matrix, const uint8_t *columns, uint16_t num_columns, uint16_t interval, bool loop);
+bool pbio_light_matrix_is_scrolling(pbio_light_matrix_t *light_matrix);
 
 #else // PBIO_CONFIG_LIGHT_MATRIX
 
@@ -69,6 +72,13 @@ static inline void pbio_light_matrix_start_animation(pbio_light_matrix_t *light_
 static inline void pbio_light_matrix_stop_animation(pbio_light_matrix_t *light_matrix) {
 }
 
+static inline void pbio_light_matrix_start_scroll(pbio_light_matrix_t *light_matrix, const uint8_t *columns, uint16_t num_columns, uint16_t interval, bool loop) {
+}
+
+static inline bool pbio_light_matrix_is_scrolling(pbio_light_matrix_t *light_matrix) {
+    return false;
+}
+
 #endif // PBIO_CONFIG_LIGHT_MATRIX
 
 #endif // _PBIO_LIGHT_MATRIX_H_
@@ -13,8 +13,11 @@
 typedef struct _pbio_log_t {
     #if PBIO_CONFIG_LOGGER
     bool active;
+    bool ring;
     uint32_t skipped;
     uint32_t sampled;
+    uint32_t first;
+    uint32_t dropped;
     uint32_t len;
     uint32_t start;
     uint8_t num_values;
@@ -32,7 +35,10 @@ typedef struct _pbio_log_t {
 #define MAX_LOG_VALUES (NUM_DEFAULT_LOG_VALUES + 15)
 
 void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div);
+void pbio_logger_start_ring(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div);
 pbio_error_t pbio_logger_read(pbio_log_t *log, int32_t sindex, int32_t *buf);
+uint32_t pbio_logger_drain(pbio_log_t *log, int32_t *buf, uint32_t rows);
+uint32_t pbio_logger_dropped(pbio_log_t *log);
 void pbio_logger_update(pbio_log_t *log, int32_t *buf);
 int32_t pbio_logger_rows(pbio_log_t *log);
 int32_t pbio_logger_cols(pbio_log_t *log);
@@ -42,9 +48,17 @@ void pbio_logger_stop(pbio_log_t *log);
 
 static inline void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div) {
 }
+static inline void pbio_logger_start_ring(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div) {
+}
 static inline pbio_error_t pbio_logger_read(pbio_log_t *log, int32_t sindex, int32_t *buf) {
     return PBIO_ERROR_NOT_SUPPORTED;
 }
+static inline uint32_t pbio_logger_drain(pbio_log_t *log, int32_t *buf, uint32_t rows) {
+    return 0;
+}
+static inline uint32_t pbio_logger_dropped(pbio_log_t *log) {
+    return 0;
+}
 static inline void pbio_logger_update(pbio_log_t *log, int32_t *buf) {
 }
 static inline int32_t pbio_logger_rows(pbio_log_t *log) {
@@ -13,4 +13,11 @@ int32_t pbio_math_div_i32_fix16(int32_t a, fix16_t b);
 int32_t pbio_math_mul_i32_fix16(int32_t a, fix16_t b);
 int32_t pbio_math_sqrt(int32_t n);
 
+// Scale of the results of the sine and cosine functions
+#define PBIO_MATH_TRIG_SHIFT (14)
+#define PBIO_MATH_TRIG_SCALE (1 << PBIO_MATH_TRIG_SHIFT)
+
+int32_t pbio_math_sin_mdeg(int32_t mdeg);
+int32_t pbio_math_cos_mdeg(int32_t mdeg);
+
 #endif // _PBIO_MATH_H_
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#ifndef _PBIO_MOTOR_PROCESS_H_
+#define _PBIO_MOTOR_PROCESS_H_
+
+#include <stdint.h>
+
+#include <pbdrv/config.h>
+
+/**
+ * Timing statistics of the motor control loop.
+ */
+typedef struct _pbio_motor_process_stats_t {
+    uint32_t updates;           /**< Number of control loop updates */
+    uint32_t overruns;          /**< Number of updates skipped because the loop fell one or more periods behind */
+    uint32_t jitter_max;        /**< Largest delay (µs) between the scheduled and actual start of an update */
+    uint64_t jitter_total;      /**< Sum of all start delays (µs), for computing the average */
+    uint32_t run_time_max;      /**< Longest duration (µs) of one update */
+    uint32_t writes_max;        /**< Most motor driver writes in one update, if the driver defers them */
+    uint64_t writes_total;      /**< Sum of all motor driver writes, for computing the average */
+} pbio_motor_process_stats_t;
+
+#if PBDRV_CONFIG_NUM_MOTOR_CONTROLLER != 0
+
+void pbio_motor_process_get_stats(pbio_motor_process_stats_t *stats);
+void pbio_motor_process_reset_stats(void);
+
+#else
+
+static inline void pbio_motor_process_get_stats(pbio_motor_process_stats_t *stats) {
+    *stats = (pbio_motor_process_stats_t) { 0 };
+}
+static inline void pbio_motor_process_reset_stats(void) {
+}
+
+#endif // PBDRV_CONFIG_NUM_MOTOR_CONTROLLER
+
+#endif // _PBIO_MOTOR_PROCESS_H_
@@ -8,13 +8,19 @@
 
 #include <pbio/control.h>
 
+// Sample time for which the model constants (phi_01, phi_11, gam_0, gam_1)
+// in the observer settings were computed.
+#define PBIO_OBSERVER_MODEL_TIME_MS (5)
+
+#if PBIO_CONFIG_CONTROL_MINIMAL && PBIO_CONTROL_LOOP_TIME_MS != PBIO_OBSERVER_MODEL_TIME_MS
+#error "The minimal observer requires PBIO_CONFIG_CONTROL_LOOP_TIME_MS to equal PBIO_OBSERVER_MODEL_TIME_MS"
+#endif
+
 #if PBIO_CONFIG_CONTROL_MINIMAL
-#define PBIO_OBSERVER_SCALE_DEG (10000)
 #define PBIO_OBSERVER_SCALE_TRQ (1000000)
 #define PBIO_OBSERVER_SCALE_LOW (1000)
 #define PBIO_OBSERVER_SCALE_HIGH (1000000)
 #else
-#define PBIO_OBSERVER_SCALE_DEG (1.0f)
 #define PBIO_OBSERVER_SCALE_TRQ (1.0f)
 #define PBIO_OBSERVER_SCALE_LOW (1.0f)
 #define PBIO_OBSERVER_SCALE_HIGH (1.0f)
@@ -54,9 +60,22 @@ typedef struct _pbio_observer_t {
     #if PBIO_CONFIG_CONTROL_MINIMAL
     int64_t est_count;
     int64_t est_rate;
+    // Settings converted to binary fixed point, see pbio_observer_reset()
+    int32_t c_phi_01;
+    int32_t c_phi_11;
+    int32_t c_gam_0;
+    int32_t c_gam_1;
+    int32_t c_k_0;
+    int32_t c_k_0_inv;
+    int32_t c_ff_1;
+    int32_t c_ff_2;
     #else
     float est_count;
     float est_rate;
+    float phi_01;
+    float phi_11;
+    float gam_0;
+    float gam_1;
     #endif
     const pbio_observer_settings_t *settings;
 } pbio_observer_t;
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+/**
+ * @addtogroup Profiler Run time profiling of background processes
+ * @{
+ */
+
+#ifndef _PBIO_PROFILER_H_
+#define _PBIO_PROFILER_H_
+
+#include <stdint.h>
+
+#include <pbio/config.h>
+#include <pbio/error.h>
+
+struct process;
+
+/** Run time statistics of one process. */
+typedef struct {
+    /** Name of the process. */
+    const char *name;
+    /** Number of times that the process was called. */
+    uint32_t calls;
+    /** Total time spent in the process in microseconds. */
+    uint32_t total_time;
+    /** Longest time spent in one call of the process in microseconds. */
+    uint32_t max_time;
+} pbio_profiler_stats_t;
+
+#if PBIO_CONFIG_PROFILER
+
+void pbio_profiler_call_begin(struct process *process);
+void pbio_profiler_call_end(struct process *process);
+void pbio_profiler_update_queue_depth(uint32_t depth);
+uint8_t pbio_profiler_get_num_processes(void);
+pbio_error_t pbio_profiler_get_stats(uint8_t index, pbio_profiler_stats_t *stats);
+uint32_t pbio_profiler_get_max_queue_depth(void);
+void pbio_profiler_reset(void);
+
+#else // PBIO_CONFIG_PROFILER
+
+static inline void pbio_profiler_call_begin(struct process *process) {
+}
+static inline void pbio_profiler_call_end(struct process *process) {
+}
+static inline void pbio_profiler_update_queue_depth(uint32_t depth) {
+}
+static inline uint8_t pbio_profiler_get_num_processes(void) {
+    return 0;
+}
+static inline pbio_error_t pbio_profiler_get_stats(uint8_t index, pbio_profiler_stats_t *stats) {
+    return PBIO_ERROR_NOT_SUPPORTED;
+}
+static inline uint32_t pbio_profiler_get_max_queue_depth(void) {
+    return 0;
+}
+static inline void pbio_profiler_reset(void) {
+}
+
+#endif // PBIO_CONFIG_PROFILER
+
+#endif // _PBIO_PROFILER_H_
+
+/** @} */
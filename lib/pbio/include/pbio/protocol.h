@@ -20,7 +20,7 @@
 #define PBIO_PROTOCOL_VERSION_MAJOR 1
 
 /** The minor version number for the protocol. */
-#define PBIO_PROTOCOL_VERSION_MINOR 1
+#define PBIO_PROTOCOL_VERSION_MINOR 4
 
 /** The patch version number for the protocol. */
 #define PBIO_PROTOCOL_VERSION_PATCH 0
@@ -47,6 +47,37 @@ typedef enum {
      * @since Protocol v1.0.0
      */
     PBIO_PYBRICKS_COMMAND_STOP_USER_PROGRAM = 0,
+    /**
+     * Starts a windowed program download.
+     *
+     * Bytes 1-4 are the size of the program and bytes 5-6 are the size of
+     * each block, both little-endian unsigned integers. The hub replies with
+     * a ::PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS event.
+     *
+     * @since Protocol v1.3.0
+     */
+    PBIO_PYBRICKS_COMMAND_START_DOWNLOAD = 1,
+    /**
+     * Writes one block of a windowed program download.
+     *
+     * Bytes 1-2 are the 16-bit little-endian block index and bytes 3-6 are
+     * the 32-bit little-endian CRC32 of the block data, which follows. Many
+     * blocks may be written before the hub replies with a
+     * ::PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS event.
+     *
+     * @since Protocol v1.3.0
+     */
+    PBIO_PYBRICKS_COMMAND_WRITE_BLOCK = 2,
+    /**
+     * Requests the run time statistics of the background processes.
+     *
+     * Byte 1 is optional. If it is non-zero, the statistics are reset after
+     * they have been sent. The hub replies with one
+     * ::PBIO_PYBRICKS_EVENT_PROFILE event for each process.
+     *
+     * @since Protocol v1.4.0
+     */
+    PBIO_PYBRICKS_COMMAND_GET_PROFILE = 3,
 } pbio_pybricks_command_t;
 
 /**
@@ -64,6 +95,43 @@ typedef enum {
      * @since Protocol v1.0.0
      */
     PBIO_PYBRICKS_EVENT_STATUS_REPORT = 0,
+    /**
+     * Telemetry data.
+     *
+     * Byte 1 is the stream identifier, byte 2 is the number of values per
+     * row and byte 3 is the number of rows. This is followed by the rows,
+     * each value being a 32-bit little-endian signed integer.
+     *
+     * @since Protocol v1.2.0
+     */
+    PBIO_PYBRICKS_EVENT_TELEMETRY = 1,
+    /**
+     * Windowed program download status.
+     *
+     * Byte 1 is the ::pbio_error_t result of the last download command. Bytes
+     * 2-3 are the 16-bit little-endian index of the first block that has not
+     * been received, which equals the number of blocks when the download is
+     * done. Bytes 4-7 are 32-bit little-endian flags, where bit n is set if
+     * the block at that index + 1 + n has been received.
+     *
+     * @since Protocol v1.3.0
+     */
+    PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS = 2,
+    /**
+     * Run time statistics of one background process.
+     *
+     * Byte 1 is the index of the process and byte 2 is the number of
+     * processes. Bytes 3-6 are the largest number of pending events seen in
+     * the event queue. Bytes 7-10 are the number of calls, bytes 11-14 the
+     * total run time and bytes 15-18 the longest run time of one call, in
+     * microseconds. All are 32-bit little-endian unsigned integers. The
+     * remaining bytes are the name of the process, truncated to fit.
+     *
+     * If profiling is not available, there is one event with 0 processes.
+     *
+     * @since Protocol v1.4.0
+     */
+    PBIO_PYBRICKS_EVENT_PROFILE = 3,
 } pbio_pybricks_event_t;
 
 /**
@@ -132,7 +200,23 @@ typedef enum {
  */
 #define PBIO_PYBRICKS_STATUS_FLAG(status) (1 << status)
 
+/** Size of the header of a ::PBIO_PYBRICKS_EVENT_TELEMETRY event. */
+#define PBIO_PYBRICKS_EVENT_TELEMETRY_HEADER_SIZE 4
+
+/** Size of the header of a ::PBIO_PYBRICKS_COMMAND_WRITE_BLOCK command. */
+#define PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE 7
+
+/** Size of a ::PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS event. */
+#define PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS_SIZE 8
+
 uint32_t pbio_pybricks_event_status_report(uint8_t *buf, uint32_t flags);
+uint32_t pbio_pybricks_event_telemetry(uint8_t *buf, uint8_t stream, uint8_t num_values, uint8_t num_rows, const int32_t *data);
+/** Size of a ::PBIO_PYBRICKS_EVENT_PROFILE event without the process name. */
+#define PBIO_PYBRICKS_EVENT_PROFILE_HEADER_SIZE 19
+
+uint32_t pbio_pybricks_event_download_status(uint8_t *buf, uint8_t status, uint16_t base, uint32_t received);
+uint32_t pbio_pybricks_event_profile(uint8_t *buf, uint32_t size, uint8_t index, uint8_t num_processes,
+    uint32_t max_queue_depth, uint32_t calls, uint32_t total_time, uint32_t max_time, const char *name);
 
 extern const uint8_t pbio_pybricks_service_uuid[];
 extern const uint8_t pbio_pybricks_control_char_uuid[];
@@ -27,6 +27,11 @@
 
 #define PBIO_SERVO_LOG_COLS (9)
 
+// Name and unit of each column in the servo log
+#define PBIO_SERVO_LOG_COL_NAMES \
+    "time:us,count:count,rate:count/s,actuation:,voltage:mV,count_est:count,rate_est:count/s," \
+    "torque_feedback:uNm,torque_feedforward:uNm"
+
 typedef struct _pbio_servo_t {
     pbio_dcmotor_t *dcmotor;
     pbio_tacho_t *tacho;
@@ -56,6 +61,7 @@ pbio_error_t pbio_servo_run_time(pbio_servo_t *srv, int32_t speed, int32_t durat
 pbio_error_t pbio_servo_run_until_stalled(pbio_servo_t *srv, int32_t speed, pbio_actuation_t after_stop);
 pbio_error_t pbio_servo_run_angle(pbio_servo_t *srv, int32_t speed, int32_t angle, pbio_actuation_t after_stop);
 pbio_error_t pbio_servo_run_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_actuation_t after_stop);
+pbio_error_t pbio_servo_queue_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_actuation_t after_stop);
 pbio_error_t pbio_servo_track_target(pbio_servo_t *srv, int32_t target);
 
 void pbio_servo_update_all(void);
@@ -104,6 +104,7 @@ void pbio_set_uint32_le(uint8_t *buf, uint32_t value) {
 
 bool pbio_uuid128_reverse_compare(const uint8_t *uuid1, const uint8_t *uuid2);
 void pbio_uuid128_reverse_copy(uint8_t *dst, const uint8_t *src);
+uint32_t pbio_crc32(uint32_t crc, const uint8_t *data, uint32_t size);
 
 #endif // _PBIO_UTIL_H_
 
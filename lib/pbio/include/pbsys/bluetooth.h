@@ -11,9 +11,11 @@
 
 #include <pbsys/config.h>
 #include <pbio/error.h>
+#include <pbio/logger.h>
 
 #if PBSYS_CONFIG_BLUETOOTH
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbsys/user_program.h>
@@ -23,6 +25,10 @@ void pbsys_bluetooth_rx_set_callback(pbsys_user_program_stdin_event_callback_t c
 uint32_t pbsys_bluetooth_rx_get_available(void);
 pbio_error_t pbsys_bluetooth_rx(uint8_t *data, uint32_t *size);
 pbio_error_t pbsys_bluetooth_tx(const uint8_t *data, uint32_t *size);
+pbio_error_t pbsys_bluetooth_telemetry_start(uint8_t id, pbio_log_t *log);
+void pbsys_bluetooth_telemetry_stop(pbio_log_t *log);
+void pbsys_bluetooth_download_init(uint8_t *buf, uint32_t max_size);
+bool pbsys_bluetooth_download_is_done(uint32_t *size);
 
 #else // PBSYS_CONFIG_BLUETOOTH
 
@@ -31,6 +37,10 @@ pbio_error_t pbsys_bluetooth_tx(const uint8_t *data, uint32_t *size);
 #define pbsys_bluetooth_rx_get_available 0
 #define pbsys_bluetooth_rx(data, size) PBIO_ERROR_NOT_SUPPORTED
 #define pbsys_bluetooth_tx(data, size) PBIO_ERROR_NOT_SUPPORTED
+#define pbsys_bluetooth_telemetry_start(id, log) PBIO_ERROR_NOT_SUPPORTED
+#define pbsys_bluetooth_telemetry_stop(log)
+#define pbsys_bluetooth_download_init(buf, max_size)
+#define pbsys_bluetooth_download_is_done(size) false
 
 #endif // PBSYS_CONFIG_BLUETOOTH
 
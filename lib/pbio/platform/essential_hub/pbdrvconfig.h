@@ -32,6 +32,7 @@
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK              (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_STM32_UART   (1)
 #undef PBDRV_CONFIG_BLUETOOTH_BTSTACK_HUB_VARIANT_ADDR
+#define PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS    (4)
 
 #define PBDRV_CONFIG_BUTTON                         (1)
 #define PBDRV_CONFIG_BUTTON_GPIO                    (1)
@@ -49,6 +50,11 @@
 #define PBDRV_CONFIG_GPIO                           (1)
 #define PBDRV_CONFIG_GPIO_STM32F4                   (1)
 
+#define PBDRV_CONFIG_IMU                            (1)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32          (1)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_NUM_SAMPLES (512)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA   (1)
+
 #define PBDRV_CONFIG_IOPORT                         (1)
 #define PBDRV_CONFIG_IOPORT_LPF2                    (1)
 #define PBDRV_CONFIG_IOPORT_LPF2_NUM_PORTS          (2)
@@ -17,6 +17,7 @@
 #include "../../drv/bluetooth/bluetooth_btstack.h"
 #include "../../drv/button/button_gpio.h"
 #include "../../drv/charger/charger_mp2639a.h"
+#include "../../drv/imu/imu_lsm6ds3tr_c_stm32.h"
 #include "../../drv/ioport/ioport_lpf2.h"
 #include "../../drv/led/led_pwm.h"
 #include "../../drv/pwm/pwm_lp50xx_stm32.h"
@@ -467,6 +468,16 @@ void OTG_FS_IRQHandler(void) {
 
 // IMU
 
+const pbdrv_imu_lsm6ds3tr_c_stm32_platform_data_t pbdrv_imu_lsm6ds3tr_c_stm32_platform_data = {
+    .i2c = I2C3,
+    .i2c_clock_speed = 400000,
+    .gyro_flip_xz = false,
+    .accel_flip_xz = true,
+    .rx_dma = DMA1_Stream2,
+    .rx_dma_ch = DMA_CHANNEL_3,
+    .rx_dma_irq = DMA1_Stream2_IRQn,
+};
+
 void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
     GPIO_InitTypeDef gpio_init;
 
@@ -495,13 +506,15 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
 }
 
 void I2C3_ER_IRQHandler(void) {
-    extern void mod_experimental_IMU_handle_i2c_er_irq(void);
-    mod_experimental_IMU_handle_i2c_er_irq();
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_er_irq();
 }
 
 void I2C3_EV_IRQHandler(void) {
-    extern void mod_experimental_IMU_handle_i2c_ev_irq(void);
-    mod_experimental_IMU_handle_i2c_ev_irq();
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_ev_irq();
+}
+
+void DMA1_Stream2_IRQHandler(void) {
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_rx_dma_irq();
 }
 
 // Early initialization
@@ -35,6 +35,7 @@
 #define PBDRV_CONFIG_IOPORT_LPF2_LAST_PORT PBIO_PORT_ID_4
 
 #define PBDRV_CONFIG_MOTOR                                  (1)
+#define PBDRV_CONFIG_MOTOR_DEFERRED_COMMIT                  (1)
 
 #define PBDRV_CONFIG_FIRST_MOTOR_PORT PBIO_PORT_ID_A
 #define PBDRV_CONFIG_LAST_MOTOR_PORT PBIO_PORT_ID_D
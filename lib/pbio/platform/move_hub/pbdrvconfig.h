@@ -35,6 +35,7 @@
 #define PBDRV_CONFIG_COUNTER_NUM_DEV                (4)
 #define PBDRV_CONFIG_COUNTER_STM32F0_GPIO_QUAD_ENC  (1)
 #define PBDRV_CONFIG_COUNTER_STM32F0_GPIO_QUAD_ENC_NUM_DEV (2)
+#define PBDRV_CONFIG_COUNTER_EDGE_RATE              (1)
 
 #define PBDRV_CONFIG_GPIO                           (1)
 #define PBDRV_CONFIG_GPIO_STM32F0                   (1)
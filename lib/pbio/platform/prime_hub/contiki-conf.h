@@ -16,4 +16,9 @@ typedef uint32_t clock_time_t;
 #define clock_time pbdrv_clock_get_ms
 #define clock_usecs pbdrv_clock_get_us
 
+// optional run time profiling of each process
+#include <pbio/profiler.h>
+#define PROCESS_CONF_CALL_BEGIN(p) pbio_profiler_call_begin(p)
+#define PROCESS_CONF_CALL_END(p) pbio_profiler_call_end(p)
+
 #endif /* _PBIO_CONF_H_ */
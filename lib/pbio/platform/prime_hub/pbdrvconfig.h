@@ -28,10 +28,22 @@
 #define PBDRV_CONFIG_BATTERY_ADC_TEMPERATURE        (1)
 #define PBDRV_CONFIG_BATTERY_ADC_TEMPERATURE_CH     2
 
+#define PBDRV_CONFIG_BLOCK_DEVICE                   (1)
+#define PBDRV_CONFIG_BLOCK_DEVICE_BLOCK_SIZE        (4 * 1024)
+#define PBDRV_CONFIG_BLOCK_DEVICE_PAGE_SIZE         (256)
+#define PBDRV_CONFIG_BLOCK_DEVICE_SIZE              (1024 * 1024)
+#define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32      (1)
+#define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_ADDR_4BYTE (1)
+// The last 1 MB of the 32 MB W25Q256 chip. The stock firmware may also store
+// data on this chip, so the program cache only uses this region if it is
+// blank or already has the program cache marker. See program_cache.c.
+#define PBDRV_CONFIG_BLOCK_DEVICE_W25QXX_STM32_OFFSET (31 * 1024 * 1024)
+
 #define PBDRV_CONFIG_BLUETOOTH                      (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK              (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_STM32_UART   (1)
 #define PBDRV_CONFIG_BLUETOOTH_BTSTACK_HUB_VARIANT_ADDR 0x08007d80
+#define PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS    (4)
 
 #define PBDRV_CONFIG_BUTTON                         (1)
 #define PBDRV_CONFIG_BUTTON_RESISTOR_LADDER         (1)
@@ -50,6 +62,11 @@
 #define PBDRV_CONFIG_GPIO                           (1)
 #define PBDRV_CONFIG_GPIO_STM32F4                   (1)
 
+#define PBDRV_CONFIG_IMU                            (1)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32          (1)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_NUM_SAMPLES (512)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA   (1)
+
 #define PBDRV_CONFIG_IOPORT                         (1)
 #define PBDRV_CONFIG_IOPORT_LPF2                    (1)
 #define PBDRV_CONFIG_IOPORT_LPF2_NUM_PORTS          (6)
@@ -70,6 +87,7 @@
 
 #define PBDRV_CONFIG_PWM                            (1)
 #define PBDRV_CONFIG_PWM_NUM_DEV                    (6)
+#define PBDRV_CONFIG_PWM_FRAME                      (1)
 #define PBDRV_CONFIG_PWM_STM32_TIM                  (1)
 #define PBDRV_CONFIG_PWM_STM32_TIM_NUM_DEV          (5)
 #define PBDRV_CONFIG_PWM_STM32_TIM_EXTRA_FLAGS      (1)
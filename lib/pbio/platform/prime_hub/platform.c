@@ -11,10 +11,12 @@
 #include "pbio/light_matrix.h"
 
 #include "../../drv/adc/adc_stm32_hal.h"
+#include "../../drv/block_device/block_device_w25qxx_stm32.h"
 #include "../../drv/bluetooth/bluetooth_btstack_control_gpio.h"
 #include "../../drv/bluetooth/bluetooth_btstack_uart_block_stm32_hal.h"
 #include "../../drv/bluetooth/bluetooth_btstack.h"
 #include "../../drv/charger/charger_mp2639a.h"
+#include "../../drv/imu/imu_lsm6ds3tr_c_stm32.h"
 #include "../../drv/ioport/ioport_lpf2.h"
 #include "../../drv/led/led_array_pwm.h"
 #include "../../drv/led/led_dual.h"
@@ -129,6 +131,14 @@ const pbdrv_bluetooth_btstack_platform_data_t pbdrv_bluetooth_btstack_platform_d
     .ir_key = (const uint8_t *)UID_BASE,
 };
 
+// Block device
+
+const pbdrv_block_device_w25qxx_stm32_platform_data_t pbdrv_block_device_w25qxx_stm32_platform_data = {
+    .spi = SPI2,
+    .ncs_gpio = GPIOB,
+    .ncs_gpio_pin = GPIO_PIN_12,
+};
+
 // charger
 
 const pbdrv_charger_mp2639a_platform_data_t pbdrv_charger_mp2639a_platform_data = {
@@ -646,6 +656,21 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *hspi) {
         gpio_init.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
         gpio_init.Alternate = GPIO_AF5_SPI1;
         HAL_GPIO_Init(GPIOA, &gpio_init);
+    } else if (hspi->Instance == SPI2) {
+        // W25Q256 external flash
+        GPIO_InitTypeDef gpio_init;
+
+        // SCK
+        gpio_init.Pin = GPIO_PIN_13;
+        gpio_init.Mode = GPIO_MODE_AF_PP;
+        gpio_init.Pull = GPIO_NOPULL;
+        gpio_init.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+        gpio_init.Alternate = GPIO_AF5_SPI2;
+        HAL_GPIO_Init(GPIOB, &gpio_init);
+
+        // MISO, MOSI
+        gpio_init.Pin = GPIO_PIN_2 | GPIO_PIN_3;
+        HAL_GPIO_Init(GPIOC, &gpio_init);
     }
 }
 
@@ -685,6 +710,19 @@ void OTG_FS_IRQHandler(void) {
     HAL_PCD_IRQHandler(&hpcd);
 }
 
+// IMU
+
+const pbdrv_imu_lsm6ds3tr_c_stm32_platform_data_t pbdrv_imu_lsm6ds3tr_c_stm32_platform_data = {
+    .i2c = I2C2,
+    .i2c_clock_speed = 400000,
+    // Sensor is upside down
+    .gyro_flip_xz = true,
+    .accel_flip_xz = true,
+    .rx_dma = DMA1_Stream2,
+    .rx_dma_ch = DMA_CHANNEL_7,
+    .rx_dma_irq = DMA1_Stream2_IRQn,
+};
+
 void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
     GPIO_InitTypeDef gpio_init;
 
@@ -712,13 +750,15 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
 }
 
 void I2C2_ER_IRQHandler(void) {
-    extern void mod_experimental_IMU_handle_i2c_er_irq(void);
-    mod_experimental_IMU_handle_i2c_er_irq();
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_er_irq();
 }
 
 void I2C2_EV_IRQHandler(void) {
-    extern void mod_experimental_IMU_handle_i2c_ev_irq(void);
-    mod_experimental_IMU_handle_i2c_ev_irq();
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_ev_irq();
+}
+
+void DMA1_Stream2_IRQHandler(void) {
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_rx_dma_irq();
 }
 
 // Early initialization
@@ -769,7 +809,7 @@ void SystemInit(void) {
     RCC->APB1ENR |= RCC_APB1ENR_USART2EN | RCC_APB1ENR_UART4EN | RCC_APB1ENR_UART5EN |
         RCC_APB1ENR_UART7EN | RCC_APB1ENR_UART8EN | RCC_APB1ENR_TIM2EN | RCC_APB1ENR_TIM3EN |
         RCC_APB1ENR_TIM4EN | RCC_APB1ENR_TIM6EN | RCC_APB1ENR_TIM12EN | RCC_APB1ENR_I2C2EN |
-        RCC_APB1ENR_DACEN;
+        RCC_APB1ENR_DACEN | RCC_APB1ENR_SPI2EN;
     RCC->APB2ENR |= RCC_APB2ENR_TIM1EN | RCC_APB2ENR_TIM8EN | RCC_APB2ENR_UART9EN |
         RCC_APB2ENR_UART10EN | RCC_APB2ENR_ADC1EN | RCC_APB2ENR_SPI1EN | RCC_APB2ENR_SYSCFGEN;
     RCC->AHB2ENR |= RCC_AHB2ENR_OTGFSEN;
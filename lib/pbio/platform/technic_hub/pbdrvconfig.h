@@ -29,6 +29,7 @@
 #define PBDRV_CONFIG_BLUETOOTH                      (1)
 #define PBDRV_CONFIG_BLUETOOTH_STM32_CC2640         (1)
 #define PBDRV_CONFIG_BLUETOOTH_STM32_CC2640_HUB_ID  "\x80"
+#define PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS    (4)
 
 #define PBDRV_CONFIG_BUTTON                         (1)
 #define PBDRV_CONFIG_BUTTON_GPIO                    (1)
@@ -43,6 +44,11 @@
 #define PBDRV_CONFIG_GPIO                           (1)
 #define PBDRV_CONFIG_GPIO_STM32L4                   (1)
 
+#define PBDRV_CONFIG_IMU                            (1)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32          (1)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_NUM_SAMPLES (128)
+#define PBDRV_CONFIG_IMU_LSM6DS3TR_C_STM32_RX_DMA   (0)
+
 #define PBDRV_CONFIG_IOPORT                         (1)
 #define PBDRV_CONFIG_IOPORT_LPF2                    (1)
 #define PBDRV_CONFIG_IOPORT_LPF2_NUM_PORTS          (4)
@@ -9,6 +9,7 @@
 #include "../../drv/battery/battery_adc.h"
 #include "../../drv/bluetooth/bluetooth_stm32_cc2640.h"
 #include "../../drv/button/button_gpio.h"
+#include "../../drv/imu/imu_lsm6ds3tr_c_stm32.h"
 #include "../../drv/ioport/ioport_lpf2.h"
 #include "../../drv/led/led_pwm.h"
 #include "../../drv/pwm/pwm_stm32_tim.h"
@@ -16,6 +17,7 @@
 
 #include "stm32l4xx_hal.h"
 #include "stm32l4xx_ll_dma.h"
+#include "stm32l4xx_ll_i2c.h"
 #include "stm32l4xx_ll_rcc.h"
 
 enum {
@@ -556,6 +558,17 @@ void DMA1_Channel1_IRQHandler(void) {
     pbdrv_adc_stm32_hal_handle_irq();
 }
 
+// IMU
+
+const pbdrv_imu_lsm6ds3tr_c_stm32_platform_data_t pbdrv_imu_lsm6ds3tr_c_stm32_platform_data = {
+    .i2c = I2C1,
+    // Clock is 5MHz, so these timing come out to 1 usec. When combined with
+    // internal delays, this is slightly slower than 400kHz
+    .i2c_timing = __LL_I2C_CONVERT_TIMINGS(0, 0, 0, 4, 4),
+    .gyro_flip_xz = false,
+    .accel_flip_xz = false,
+};
+
 void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
     GPIO_InitTypeDef gpio_init = { 0 };
 
@@ -574,13 +587,11 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef *hi2c) {
 }
 
 void I2C1_ER_IRQHandler(void) {
-    extern void mod_experimental_IMU_handle_i2c_er_irq(void);
-    mod_experimental_IMU_handle_i2c_er_irq();
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_er_irq();
 }
 
 void I2C1_EV_IRQHandler(void) {
-    extern void mod_experimental_IMU_handle_i2c_ev_irq(void);
-    mod_experimental_IMU_handle_i2c_ev_irq();
+    pbdrv_imu_lsm6ds3tr_c_stm32_handle_i2c_ev_irq();
 }
 
 // Early initialization
@@ -9,6 +9,44 @@
 #include <pbio/trajectory.h>
 #include <pbio/integrator.h>
 
+// Discards queued maneuvers. They count as replaced, like the ongoing one.
+static void pbio_control_queue_clear(pbio_control_t *ctl) {
+    ctl->maneuver += ctl->queue_count;
+    ctl->queue_count = 0;
+}
+
+// Starts the next queued maneuver from the current reference. This happens
+// when the ongoing maneuver would start to decelerate, so the motor keeps
+// going at speed through the intermediate target instead of stopping there.
+// If the next target is in the opposite direction, the motor still
+// decelerates to zero exactly at the intermediate target before turning back.
+static void pbio_control_queue_pop(pbio_control_t *ctl, int32_t time_ref) {
+
+    pbio_control_segment_t *segment = &ctl->queue[ctl->queue_start];
+    ctl->queue_start = (ctl->queue_start + 1) % PBIO_CONFIG_CONTROL_QUEUE_SIZE;
+    ctl->queue_count--;
+
+    // Set new maneuver action and stop type
+    ctl->maneuver++;
+    ctl->after_stop = segment->after_stop;
+    ctl->on_target = false;
+    ctl->on_target_func = pbio_control_on_target_angle;
+
+    // Continue from where the reference is now, including its speed
+    pbio_trajectory_reference_t ref;
+    pbio_trajectory_get_reference(&ctl->trajectory, time_ref, &ref);
+
+    pbio_trajectory_t next;
+    pbio_error_t err = pbio_trajectory_calc_time_new(&next, time_ref, ref.count, segment->target_count, ref.rate, segment->target_rate, ctl->settings.max_rate, ctl->settings.abs_acceleration);
+    if (err != PBIO_SUCCESS) {
+        // Segments were checked when queued, so this should not happen. If it
+        // does, just finish the ongoing trajectory.
+        pbio_control_queue_clear(ctl);
+        return;
+    }
+    ctl->trajectory = next;
+}
+
 void pbio_control_update(pbio_control_t *ctl, int32_t time_now, pbio_control_state_t *state, pbio_trajectory_reference_t *ref, pbio_actuation_t *actuation, int32_t *control) {
 
     // Declare current time, positions, rates, and their reference value and error
@@ -21,6 +59,11 @@ void pbio_control_update(pbio_control_t *ctl, int32_t time_now, pbio_control_sta
     // This compensates for any time we may have spent pausing when the motor was stalled.
     time_ref = pbio_control_get_ref_time(ctl, time_now);
 
+    // Blend into the next queued maneuver once the ongoing one starts to decelerate
+    if (ctl->queue_count > 0 && pbio_control_type_is_angle(ctl) && time_ref - ctl->trajectory.t2 >= 0) {
+        pbio_control_queue_pop(ctl, time_ref);
+    }
+
     // Get reference signals
     pbio_trajectory_get_reference(&ctl->trajectory, time_ref, ref);
 
@@ -137,6 +180,8 @@ void pbio_control_update(pbio_control_t *ctl, int32_t time_now, pbio_control_sta
 
 
 void pbio_control_stop(pbio_control_t *ctl) {
+    pbio_control_queue_clear(ctl);
+    ctl->maneuver++;
     ctl->type = PBIO_CONTROL_NONE;
     ctl->on_target = true;
     ctl->on_target_func = pbio_control_on_target_always;
@@ -148,6 +193,8 @@ pbio_error_t pbio_control_start_angle_control(pbio_control_t *ctl, int32_t time_
     pbio_error_t err;
 
     // Set new maneuver action and stop type, and state
+    pbio_control_queue_clear(ctl);
+    ctl->maneuver++;
     ctl->after_stop = after_stop;
     ctl->on_target = false;
     ctl->on_target_func = pbio_control_on_target_angle;
@@ -217,6 +264,8 @@ pbio_error_t pbio_control_start_relative_angle_control(pbio_control_t *ctl, int3
 pbio_error_t pbio_control_start_hold_control(pbio_control_t *ctl, int32_t time_now, int32_t target_count) {
 
     // Set new maneuver action and stop type, and state
+    pbio_control_queue_clear(ctl);
+    ctl->maneuver++;
     ctl->after_stop = PBIO_ACTUATION_HOLD;
     ctl->on_target = false;
     ctl->on_target_func = pbio_control_on_target_always;
@@ -245,6 +294,8 @@ pbio_error_t pbio_control_start_timed_control(pbio_control_t *ctl, int32_t time_
     pbio_error_t err;
 
     // Set new maneuver action and stop type, and state
+    pbio_control_queue_clear(ctl);
+    ctl->maneuver++;
     ctl->after_stop = after_stop;
     ctl->on_target = false;
     ctl->on_target_func = stop_func;
@@ -290,6 +341,34 @@ pbio_error_t pbio_control_start_timed_control(pbio_control_t *ctl, int32_t time_
     return PBIO_SUCCESS;
 }
 
+pbio_error_t pbio_control_queue_angle_control(pbio_control_t *ctl, int32_t time_now, pbio_control_state_t *state, int32_t target_count, int32_t target_rate, pbio_actuation_t after_stop) {
+
+    // If there is no angle maneuver to follow, just start right away
+    if (!pbio_control_type_is_angle(ctl) || pbio_control_is_done(ctl)) {
+        return pbio_control_start_angle_control(ctl, time_now, state, target_count, target_rate, after_stop);
+    }
+
+    if (ctl->queue_count == PBIO_CONFIG_CONTROL_QUEUE_SIZE) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    // A segment starts where the previous one ends. Reject segments that
+    // could not be turned into a trajectory later.
+    int32_t count_start = ctl->queue_count == 0 ? ctl->trajectory.th3 :
+        ctl->queue[(ctl->queue_start + ctl->queue_count - 1) % PBIO_CONFIG_CONTROL_QUEUE_SIZE].target_count;
+    if (target_rate == 0 || abs((target_count - count_start) / target_rate) + 1 > DURATION_MAX_S) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbio_control_segment_t *segment = &ctl->queue[(ctl->queue_start + ctl->queue_count) % PBIO_CONFIG_CONTROL_QUEUE_SIZE];
+    segment->target_count = target_count;
+    segment->target_rate = target_rate;
+    segment->after_stop = after_stop;
+    ctl->queue_count++;
+
+    return PBIO_SUCCESS;
+}
+
 static bool _pbio_control_on_target_always(pbio_trajectory_t *trajectory, pbio_control_settings_t *settings, int32_t time, int32_t count, int32_t rate, bool stalled) {
     return true;
 }
@@ -449,6 +528,18 @@ bool pbio_control_is_done(pbio_control_t *ctl) {
     return ctl->type == PBIO_CONTROL_NONE || ctl->on_target;
 }
 
+// Gets the number of the most recently started or queued maneuver
+uint32_t pbio_control_get_last_maneuver(pbio_control_t *ctl) {
+    return ctl->maneuver + ctl->queue_count;
+}
+
+// Checks if a maneuver is done. Queued maneuvers are not done yet, and
+// maneuvers that were replaced by a new one count as done.
+bool pbio_control_maneuver_is_done(pbio_control_t *ctl, uint32_t maneuver) {
+    int32_t pending = (int32_t)(maneuver - ctl->maneuver);
+    return pending < 0 || (pending == 0 && pbio_control_is_done(ctl));
+}
+
 int32_t pbio_control_get_load(pbio_control_t *ctl) {
     return ctl->type == PBIO_CONTROL_NONE ? 0 : ctl->load;
 }
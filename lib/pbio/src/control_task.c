@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Tasks that wait for control maneuvers to complete.
+
+#include <stdbool.h>
+
+#include <contiki.h>
+
+#include <pbio/control.h>
+#include <pbio/control_task.h>
+#include <pbio/error.h>
+#include <pbio/task.h>
+#include <pbio/util.h>
+
+static bool pbio_control_task_is_done(pbio_control_task_t *ct) {
+    for (uint8_t i = 0; i < PBIO_ARRAY_SIZE(ct->ctl); i++) {
+        pbio_control_t *ctl = ct->ctl[i];
+
+        if (ctl && !pbio_control_maneuver_is_done(ctl, ct->maneuver[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static PT_THREAD(pbio_control_task_thread(struct pt *pt, pbio_task_t *task)) {
+    pbio_control_task_t *ct = task->context;
+
+    PT_BEGIN(pt);
+
+    PT_WAIT_UNTIL(pt, task->cancel || pbio_control_task_is_done(ct));
+
+    // Canceling only stops waiting. The maneuver itself keeps going.
+    task->status = task->cancel ? PBIO_ERROR_CANCELED : PBIO_SUCCESS;
+
+    PT_END(pt);
+}
+
+/**
+ * Initializes a task that completes when the most recently started or queued
+ * maneuvers are done.
+ *
+ * The task is not queued, so it can live in memory that is freed at any time.
+ * Its owner runs it with pbio_task_run_once() instead.
+ *
+ * @param [in]  ct      The uninitialized control task.
+ * @param [in]  ctl_a   The first controller.
+ * @param [in]  ctl_b   The second controller, or NULL if there is only one.
+ */
+void pbio_control_task_init(pbio_control_task_t *ct, pbio_control_t *ctl_a, pbio_control_t *ctl_b) {
+    ct->ctl[0] = ctl_a;
+    ct->ctl[1] = ctl_b;
+    ct->maneuver[0] = pbio_control_get_last_maneuver(ctl_a);
+    ct->maneuver[1] = ctl_b ? pbio_control_get_last_maneuver(ctl_b) : 0;
+    pbio_task_init(&ct->task, pbio_control_task_thread, ct);
+}
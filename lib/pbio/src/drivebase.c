@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include <pbdrv/clock.h>
+#include <pbdrv/imu.h>
 #include <pbio/error.h>
 #include <pbio/drivebase.h>
 #include <pbio/math.h>
@@ -15,6 +16,12 @@
 
 #define NUM_DRIVEBASES (PBDRV_CONFIG_NUM_MOTOR_CONTROLLER / 2)
 
+// When the gyro is used, the heading moves this fraction of the way to the gyro
+// heading on each update, on top of the heading change from the motor counts.
+// This is about 80 ms at the default loop time, so the motor counts only fill
+// in between gyro samples.
+#define GYRO_WEIGHT_DIV (16)
+
 static pbio_drivebase_t drivebases[NUM_DRIVEBASES];
 
 // The drivebase update can run if both servos are successfully updating
@@ -97,6 +104,11 @@ static pbio_error_t pbio_drivebase_get_state(pbio_drivebase_t *db, pbio_control_
     state_heading->count_est = state_left.count_est - state_right.count_est;
     state_heading->rate_est = state_left.rate_est - state_right.rate_est;
 
+    // Apply the correction from the gyro, if any. It is kept when the gyro is
+    // disabled so the heading does not jump.
+    state_heading->count += db->gyro.offset / 1000;
+    state_heading->count_est += db->gyro.offset / 1000;
+
     return PBIO_SUCCESS;
 }
 
@@ -256,7 +268,12 @@ pbio_error_t pbio_drivebase_get_drivebase(pbio_drivebase_t **db_address, pbio_se
                 )
             );
 
-    return PBIO_SUCCESS;
+    // Start with the heading from the motor counts only
+    db->gyro.enabled = false;
+    db->gyro.offset = 0;
+
+    // Start tracking the pose from here
+    return pbio_drivebase_reset_pose(db);
 }
 
 pbio_error_t pbio_drivebase_stop(pbio_drivebase_t *db, pbio_actuation_t after_stop) {
@@ -292,13 +309,58 @@ bool pbio_drivebase_is_busy(pbio_drivebase_t *db) {
     return !pbio_control_is_done(&db->control_distance) || !pbio_control_is_done(&db->control_heading);
 }
 
-static pbio_error_t pbio_drivebase_update(pbio_drivebase_t *db) {
+// Gets the heading in millidegrees since the pose was reset, for a heading
+// state count that is doubled so that it can be halfway between two counts.
+static int32_t pbio_drivebase_get_pose_heading(pbio_drivebase_t *db, int64_t double_count) {
+    int64_t double_start = (int64_t)db->pose.heading_start * 2;
+    int64_t mdeg = (double_count - double_start) * 1000 * fix16_one / (2 * (int64_t)db->control_heading.settings.counts_per_unit);
+    return mdeg % 360000;
+}
 
-    // If passive, then exit
-    if (db->control_heading.type == PBIO_CONTROL_NONE || db->control_distance.type == PBIO_CONTROL_NONE) {
-        return PBIO_SUCCESS;
+// Moves the pose along with the motion since the previous update
+static void pbio_drivebase_update_pose(pbio_drivebase_t *db, pbio_control_state_t *state_distance, pbio_control_state_t *state_heading) {
+    pbio_drivebase_pose_t *pose = &db->pose;
+
+    // Use the heading halfway through this update, which is accurate for
+    // straight lines and arcs.
+    int32_t heading = pbio_drivebase_get_pose_heading(db, (int64_t)pose->heading_count + state_heading->count);
+    int32_t distance = state_distance->count - pose->distance_count;
+
+    pose->x += (int64_t)distance * pbio_math_cos_mdeg(heading);
+    pose->y += (int64_t)distance * pbio_math_sin_mdeg(heading);
+
+    pose->distance_count = state_distance->count;
+    pose->heading_count = state_heading->count;
+}
+
+// Moves the heading state toward the gyro heading
+static void pbio_drivebase_update_gyro(pbio_drivebase_t *db, pbio_control_state_t *state_heading) {
+    pbio_drivebase_gyro_t *gyro = &db->gyro;
+
+    int32_t heading;
+    if (!gyro->enabled || pbdrv_imu_get_heading(&heading) != PBIO_SUCCESS) {
+        return;
     }
 
+    // Gyro heading in 1/1000 heading state counts. The gyro heading may wrap
+    // around, but the difference with the start does not.
+    int32_t turned = (uint32_t)heading - (uint32_t)gyro->heading_start;
+    int64_t target = (int64_t)gyro->count_start * 1000 +
+        (int64_t)turned * gyro->sign * db->control_heading.settings.counts_per_unit / fix16_one;
+
+    // Current heading in the same units, without the rounding of the state
+    int32_t correction = gyro->offset / 1000;
+    int64_t current = ((int64_t)state_heading->count - correction) * 1000 + gyro->offset;
+
+    gyro->offset += (target - current) / GYRO_WEIGHT_DIV;
+
+    // Update the state that was read before this correction
+    state_heading->count += gyro->offset / 1000 - correction;
+    state_heading->count_est += gyro->offset / 1000 - correction;
+}
+
+static pbio_error_t pbio_drivebase_update(pbio_drivebase_t *db) {
+
     // Get current time
     int32_t time_now = pbdrv_clock_get_us();
 
@@ -310,6 +372,17 @@ static pbio_error_t pbio_drivebase_update(pbio_drivebase_t *db) {
         return err;
     }
 
+    // Correct the heading with the gyro, also while passive
+    pbio_drivebase_update_gyro(db, &state_heading);
+
+    // Keep track of the pose, also while passive
+    pbio_drivebase_update_pose(db, &state_distance, &state_heading);
+
+    // If passive, then exit
+    if (db->control_heading.type == PBIO_CONTROL_NONE || db->control_distance.type == PBIO_CONTROL_NONE) {
+        return PBIO_SUCCESS;
+    }
+
     // Get reference and torque signals
     pbio_trajectory_reference_t ref_distance;
     pbio_trajectory_reference_t ref_heading;
@@ -511,6 +584,121 @@ pbio_error_t pbio_drivebase_get_state_user(pbio_drivebase_t *db, int32_t *distan
     return PBIO_SUCCESS;
 }
 
+/**
+ * Resets the pose to (0, 0) with a heading of 0.
+ *
+ * @param [in]  db          The drive base.
+ * @return                  Error code.
+ */
+pbio_error_t pbio_drivebase_reset_pose(pbio_drivebase_t *db) {
+
+    // Get drive base state
+    pbio_control_state_t state_distance;
+    pbio_control_state_t state_heading;
+    pbio_error_t err = pbio_drivebase_get_state(db, &state_distance, &state_heading);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    db->pose.distance_count = state_distance.count;
+    db->pose.heading_count = state_heading.count;
+    db->pose.heading_start = state_heading.count;
+    db->pose.x = 0;
+    db->pose.y = 0;
+
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Gets the pose since the last reset, as of the last control loop update.
+ *
+ * The x axis points in the direction that the drive base was facing when the
+ * pose was reset. The y axis points to the right of that, so that the heading
+ * goes from x to y like the angle of the drive base.
+ *
+ * @param [in]  db          The drive base.
+ * @param [out] x           Position along the x axis in mm.
+ * @param [out] y           Position along the y axis in mm.
+ * @param [out] heading     Heading in degrees.
+ * @return                  Error code.
+ */
+pbio_error_t pbio_drivebase_get_pose_user(pbio_drivebase_t *db, int32_t *x, int32_t *y, int32_t *heading) {
+    pbio_drivebase_pose_t *pose = &db->pose;
+
+    // Round to the nearest count
+    int32_t x_count = (pose->x + PBIO_MATH_TRIG_SCALE / 2) >> PBIO_MATH_TRIG_SHIFT;
+    int32_t y_count = (pose->y + PBIO_MATH_TRIG_SCALE / 2) >> PBIO_MATH_TRIG_SHIFT;
+
+    *x = pbio_control_counts_to_user(&db->control_distance.settings, x_count);
+    *y = pbio_control_counts_to_user(&db->control_distance.settings, y_count);
+    *heading = pbio_control_counts_to_user(&db->control_heading.settings, pose->heading_count - pose->heading_start);
+
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Sets whether the heading follows the gyro of the hub.
+ *
+ * The motor counts drift from the actual heading when the wheels slip. With
+ * the gyro, the heading moves toward the gyro heading on each control loop
+ * update, so the error does not add up. This can only be used if the hub is
+ * mounted flat, with the top or the bottom facing up.
+ *
+ * @param [in]  db          The drive base.
+ * @param [in]  use_gyro    Whether to use the gyro.
+ * @return                  ::PBIO_SUCCESS, ::PBIO_ERROR_NOT_SUPPORTED if the
+ *                          hub does not have a gyro, ::PBIO_ERROR_INVALID_OP
+ *                          if the hub is not flat or another error from
+ *                          reading the state.
+ */
+pbio_error_t pbio_drivebase_set_use_gyro(pbio_drivebase_t *db, bool use_gyro) {
+    pbio_drivebase_gyro_t *gyro = &db->gyro;
+
+    if (!use_gyro) {
+        // The correction so far is kept, so the heading does not jump
+        gyro->enabled = false;
+        return PBIO_SUCCESS;
+    }
+
+    if (gyro->enabled) {
+        return PBIO_SUCCESS;
+    }
+
+    float accel[3];
+    pbio_error_t err = pbdrv_imu_get_acceleration(accel);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // The gyro has to rotate about the vertical axis, so gravity must be
+    // mostly along z.
+    if (accel[2] > -7.0f && accel[2] < 7.0f) {
+        return PBIO_ERROR_INVALID_OP;
+    }
+
+    int32_t heading;
+    err = pbdrv_imu_get_heading(&heading);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    pbio_control_state_t state_distance;
+    pbio_control_state_t state_heading;
+    err = pbio_drivebase_get_state(db, &state_distance, &state_heading);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // The gyro heading is counterclockwise seen from the top of the hub, but
+    // the drive base heading is clockwise seen from above.
+    gyro->sign = accel[2] > 0 ? -1 : 1;
+    gyro->heading_start = heading;
+    gyro->count_start = state_heading.count;
+    gyro->enabled = true;
+
+    return PBIO_SUCCESS;
+}
+
 pbio_error_t pbio_drivebase_get_drive_settings(pbio_drivebase_t *db, int32_t *drive_speed, int32_t *drive_acceleration, int32_t *turn_rate, int32_t *turn_acceleration) {
 
     pbio_control_settings_t *sd = &db->control_distance.settings;
@@ -72,10 +72,90 @@ pbio_error_t pbio_iodev_get_data(pbio_iodev_t *iodev, uint8_t **data) {
     return PBIO_SUCCESS;
 }
 
+/**
+ * Gets the modes that an I/O device sends together in combi-mode.
+ *
+ * These are the modes in pbio_iodev_info_t::mode_combos, taken in order of
+ * mode number for as long as their values fit in one message.
+ *
+ * @param [in]  iodev       The I/O device
+ * @return                  Bit flags of the modes, or 0 if the device does
+ *                          not support combi-mode
+ */
+uint16_t pbio_iodev_get_combo_modes(pbio_iodev_t *iodev) {
+    const pbio_iodev_info_t *info = iodev->info;
+    uint16_t modes = 0;
+    uint8_t num_values = 0;
+    size_t size = 0;
+
+    // Motors use combi-mode internally for position and speed
+    if (info->type_id == PBIO_IODEV_TYPE_ID_NONE || PBIO_IODEV_IS_FEEDBACK_MOTOR(iodev)) {
+        return 0;
+    }
+
+    for (uint8_t mode = 0; mode < info->num_modes && mode < 16; mode++) {
+        if (!(info->mode_combos & (1 << mode))) {
+            continue;
+        }
+        const pbio_iodev_mode_t *mode_info = &info->mode_info[mode];
+        uint8_t mode_values = mode_info->num_values;
+        size_t mode_size = mode_values * pbio_iodev_size_of(mode_info->data_type);
+        if (num_values + mode_values > PBIO_IODEV_MAX_COMBO_VALUES || size + mode_size > PBIO_IODEV_MAX_DATA_SIZE) {
+            break;
+        }
+        num_values += mode_values;
+        size += mode_size;
+        modes |= 1 << mode;
+    }
+
+    // A combination of one mode is not worth it
+    return __builtin_popcount(modes) > 1 ? modes : 0;
+}
+
+/**
+ * Gets the raw data of one mode while the I/O device is in combi-mode.
+ * @param [in]  iodev       The I/O device
+ * @param [in]  mode        The mode
+ * @param [out] data        Pointer to the data of *mode* inside *bin_data*
+ * @return                  ::PBIO_SUCCESS on success
+ *                          ::PBIO_ERROR_NO_DEV if the port does not have a device attached
+ *                          ::PBIO_ERROR_NOT_SUPPORTED if *mode* can't be received in combi-mode
+ *                          ::PBIO_ERROR_AGAIN if the device is not in combi-mode right now
+ *
+ * The binary format of *data* is determined by ::pbio_iodev_get_data_format().
+ * It may not be aligned to the size of the values.
+ */
+pbio_error_t pbio_iodev_get_combo_data(pbio_iodev_t *iodev, uint8_t mode, uint8_t **data) {
+    if (iodev->info->type_id == PBIO_IODEV_TYPE_ID_NONE) {
+        return PBIO_ERROR_NO_DEV;
+    }
+
+    if (mode >= 16 || !(pbio_iodev_get_combo_modes(iodev) & (1 << mode))) {
+        return PBIO_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!(iodev->combo_modes & (1 << mode))) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    // Skip the data of the modes that come before this one
+    size_t offset = 0;
+    for (uint8_t m = 0; m < mode; m++) {
+        if (iodev->combo_modes & (1 << m)) {
+            const pbio_iodev_mode_t *mode_info = &iodev->info->mode_info[m];
+            offset += mode_info->num_values * pbio_iodev_size_of(mode_info->data_type);
+        }
+    }
+
+    *data = iodev->bin_data + offset;
+
+    return PBIO_SUCCESS;
+}
+
 /**
  * Sets the mode of an I/O device.
  * @param [in]  iodev       The I/O device
- * @param [in]  mode        The new mode
+ * @param [in]  mode        The new mode or ::PBIO_IODEV_MODE_COMBO
  * @return                  ::PBIO_SUCCESS on success
  *                          ::PBIO_ERROR_INVALID_ARG if the mode is not valid
  *                          ::PBIO_ERROR_NOT_SUPPORTED if the device does not support setting the mode
@@ -85,7 +165,11 @@ pbio_error_t pbio_iodev_set_mode_begin(pbio_iodev_t *iodev, uint8_t mode) {
         return PBIO_ERROR_NOT_SUPPORTED;
     }
 
-    if (mode >= iodev->info->num_modes) {
+    if (mode == PBIO_IODEV_MODE_COMBO) {
+        if (!pbio_iodev_get_combo_modes(iodev)) {
+            return PBIO_ERROR_NOT_SUPPORTED;
+        }
+    } else if (mode >= iodev->info->num_modes) {
         return PBIO_ERROR_INVALID_ARG;
     }
 
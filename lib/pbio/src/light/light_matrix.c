@@ -58,6 +58,18 @@ static pbio_error_t _pbio_light_matrix_set_pixel(pbio_light_matrix_t *light_matr
     return light_matrix->funcs->set_pixel(light_matrix, row, col, brightness);
 }
 
+static void pbio_light_matrix_begin_frame(pbio_light_matrix_t *light_matrix) {
+    if (light_matrix->funcs->begin_frame) {
+        light_matrix->funcs->begin_frame(light_matrix);
+    }
+}
+
+static void pbio_light_matrix_commit_frame(pbio_light_matrix_t *light_matrix) {
+    if (light_matrix->funcs->commit_frame) {
+        light_matrix->funcs->commit_frame(light_matrix);
+    }
+}
+
 /**
  * Initializes the required fields in a ::pbio_light_matrix_t.
  *
@@ -111,15 +123,15 @@ uint8_t pbio_light_matrix_get_size(pbio_light_matrix_t *light_matrix) {
  */
 pbio_error_t pbio_light_matrix_clear(pbio_light_matrix_t *light_matrix) {
     pbio_light_matrix_stop_animation(light_matrix);
-    for (uint8_t i = 0; i < light_matrix->size; i++) {
-        for (uint8_t j = 0; j < light_matrix->size; j++) {
-            pbio_error_t err = _pbio_light_matrix_set_pixel(light_matrix, i, j, 0);
-            if (err != PBIO_SUCCESS) {
-                return err;
-            }
+    pbio_error_t err = PBIO_SUCCESS;
+    pbio_light_matrix_begin_frame(light_matrix);
+    for (uint8_t i = 0; i < light_matrix->size && err == PBIO_SUCCESS; i++) {
+        for (uint8_t j = 0; j < light_matrix->size && err == PBIO_SUCCESS; j++) {
+            err = _pbio_light_matrix_set_pixel(light_matrix, i, j, 0);
         }
     }
-    return PBIO_SUCCESS;
+    pbio_light_matrix_commit_frame(light_matrix);
+    return err;
 }
 
 /**
@@ -141,21 +153,21 @@ pbio_error_t pbio_light_matrix_clear(pbio_light_matrix_t *light_matrix) {
  */
 pbio_error_t pbio_light_matrix_set_rows(pbio_light_matrix_t *light_matrix, const uint8_t *rows) {
     pbio_light_matrix_stop_animation(light_matrix);
+    pbio_error_t err = PBIO_SUCCESS;
+    pbio_light_matrix_begin_frame(light_matrix);
     // Loop through all rows i, starting at row 0 at the top.
     uint8_t size = light_matrix->size;
-    for (uint8_t i = 0; i < size; i++) {
+    for (uint8_t i = 0; i < size && err == PBIO_SUCCESS; i++) {
         // Loop through all columns j, starting at col 0 on the left.
-        for (uint8_t j = 0; j < size; j++) {
+        for (uint8_t j = 0; j < size && err == PBIO_SUCCESS; j++) {
             // The pixel is on if the bit is high.
             bool on = rows[i] & (1 << (size - 1 - j));
             // Set the pixel.
-            pbio_error_t err = _pbio_light_matrix_set_pixel(light_matrix, i, j, on * 100);
-            if (err != PBIO_SUCCESS) {
-                return err;
-            }
+            err = _pbio_light_matrix_set_pixel(light_matrix, i, j, on * 100);
         }
     }
-    return PBIO_SUCCESS;
+    pbio_light_matrix_commit_frame(light_matrix);
+    return err;
 }
 
 /**
@@ -202,16 +214,16 @@ pbio_error_t pbio_light_matrix_set_pixel(pbio_light_matrix_t *light_matrix, uint
  */
 pbio_error_t pbio_light_matrix_set_image(pbio_light_matrix_t *light_matrix, const uint8_t *image) {
     pbio_light_matrix_stop_animation(light_matrix);
+    pbio_error_t err = PBIO_SUCCESS;
+    pbio_light_matrix_begin_frame(light_matrix);
     uint8_t size = light_matrix->size;
-    for (uint8_t r = 0; r < size; r++) {
-        for (uint8_t c = 0; c < size; c++) {
-            pbio_error_t err = _pbio_light_matrix_set_pixel(light_matrix, r, c, image[r * size + c]);
-            if (err != PBIO_SUCCESS) {
-                return err;
-            }
+    for (uint8_t r = 0; r < size && err == PBIO_SUCCESS; r++) {
+        for (uint8_t c = 0; c < size && err == PBIO_SUCCESS; c++) {
+            err = _pbio_light_matrix_set_pixel(light_matrix, r, c, image[r * size + c]);
         }
     }
-    return PBIO_SUCCESS;
+    pbio_light_matrix_commit_frame(light_matrix);
+    return err;
 }
 
 static uint32_t pbio_light_matrix_animation_next(pbio_light_animation_t *animation) {
@@ -221,11 +233,13 @@ static uint32_t pbio_light_matrix_animation_next(pbio_light_animation_t *animati
     uint8_t size = light_matrix->size;
     const uint8_t *cell = light_matrix->animation_cells + size * size * light_matrix->current_cell;
 
+    pbio_light_matrix_begin_frame(light_matrix);
     for (uint8_t r = 0; r < size; r++) {
         for (uint8_t c = 0; c < size; c++) {
             _pbio_light_matrix_set_pixel(light_matrix, r, c, cell[r * size + c]);
         }
     }
+    pbio_light_matrix_commit_frame(light_matrix);
 
     // move to the next cell
     if (++light_matrix->current_cell >= light_matrix->num_animation_cells) {
@@ -257,6 +271,80 @@ void pbio_light_matrix_start_animation(pbio_light_matrix_t *light_matrix, const
     pbio_light_animation_start(&light_matrix->animation);
 }
 
+static uint32_t pbio_light_matrix_scroll_next(pbio_light_animation_t *animation) {
+    pbio_light_matrix_t *light_matrix = PBIO_CONTAINER_OF(animation, pbio_light_matrix_t, animation);
+
+    // The columns scroll in from the right until the last one is gone on the left
+    uint8_t size = light_matrix->size;
+    uint32_t last_step = light_matrix->num_scroll_columns + size;
+
+    // When done, keep the display off until the animation is stopped
+    if (light_matrix->scroll_step > last_step) {
+        return light_matrix->interval;
+    }
+
+    // display the columns that are in view at this step
+    pbio_light_matrix_begin_frame(light_matrix);
+    for (uint8_t c = 0; c < size; c++) {
+        int32_t column = light_matrix->scroll_step + c - size;
+        bool visible = column >= 0 && column < light_matrix->num_scroll_columns;
+        for (uint8_t r = 0; r < size; r++) {
+            _pbio_light_matrix_set_pixel(light_matrix, r, c, visible ? light_matrix->scroll_columns[size * column + r] : 0);
+        }
+    }
+    pbio_light_matrix_commit_frame(light_matrix);
+
+    // move to the next step
+    if (++light_matrix->scroll_step > last_step && light_matrix->scroll_loop) {
+        light_matrix->scroll_step = 1;
+    }
+
+    return light_matrix->interval;
+}
+
+/**
+ * Starts scrolling columns across the light matrix in the background.
+ *
+ * The columns enter on the right and move one column to the left at every
+ * step, until the last column has left the matrix on the left. This can be
+ * used to show text or an image that is wider than the matrix.
+ *
+ * If another animation is already running in the background, it will be stopped.
+ *
+ * @param [in]  light_matrix  The light matrix instance
+ * @param [in]  columns     Array of @p num_columns arrays of size brightness
+ *                          values (0 to 100), from top to bottom.
+ * @param [in]  num_columns Number of @p columns
+ * @param [in]  interval    Time in milliseconds to wait between each step.
+ * @param [in]  loop        If true, start over after the last column has
+ *                          left the matrix.
+ */
+void pbio_light_matrix_start_scroll(pbio_light_matrix_t *light_matrix, const uint8_t *columns, uint16_t num_columns, uint16_t interval, bool loop) {
+    pbio_light_matrix_stop_animation(light_matrix);
+
+    pbio_light_animation_init(&light_matrix->animation, pbio_light_matrix_scroll_next);
+    light_matrix->scroll_columns = columns;
+    light_matrix->num_scroll_columns = num_columns;
+    light_matrix->scroll_loop = loop;
+    light_matrix->scroll_step = 1;
+    light_matrix->interval = interval;
+
+    pbio_light_animation_start(&light_matrix->animation);
+}
+
+/**
+ * Tests if columns are still scrolling across the light matrix.
+ *
+ * @param [in]  light_matrix  The light matrix instance
+ * @return                    *true* if a scroll was started and has not
+ *                            finished or been stopped, otherwise *false*.
+ */
+bool pbio_light_matrix_is_scrolling(pbio_light_matrix_t *light_matrix) {
+    return pbio_light_animation_is_started(&light_matrix->animation) &&
+           light_matrix->animation.next == pbio_light_matrix_scroll_next &&
+           light_matrix->scroll_step <= light_matrix->num_scroll_columns + light_matrix->size;
+}
+
 /**
  * Stops the background animation.
  * @param [in]  light_matrix  The light matrix instance
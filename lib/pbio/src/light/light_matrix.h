@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2020 The Pybricks Authors
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <pbio/error.h>
@@ -23,6 +24,19 @@ typedef struct {
      * @return                  Success/failure of the operation.
      */
     pbio_error_t (*set_pixel)(pbio_light_matrix_t *light_matrix, uint8_t row, uint8_t col, uint8_t brightess);
+    /**
+     * Starts a frame. Pixels set after this are shown together when the
+     * frame is committed. Optional.
+     *
+     * @param [in]  light_matrix  The light matrix instance.
+     */
+    void (*begin_frame)(pbio_light_matrix_t *light_matrix);
+    /**
+     * Commits a frame that was started with @p begin_frame. Optional.
+     *
+     * @param [in]  light_matrix  The light matrix instance.
+     */
+    void (*commit_frame)(pbio_light_matrix_t *light_matrix);
 } pbio_light_matrix_funcs_t;
 
 struct _pbio_light_matrix_t {
@@ -38,6 +52,14 @@ struct _pbio_light_matrix_t {
     uint8_t current_cell;
     /** Animation update rate in milliseconds. */
     uint16_t interval;
+    /** Scroll column data, size brightness values per column, top to bottom. */
+    const uint8_t *scroll_columns;
+    /** The number of columns in @p scroll_columns */
+    uint16_t num_scroll_columns;
+    /** The number of scroll steps so far. At step n, column n - 1 is on the right. */
+    uint16_t scroll_step;
+    /** Whether to start over after the last column has scrolled out of view. */
+    bool scroll_loop;
     /** Size of the matrix (assumes matrix is square). */
     uint8_t size;
     /** Orientation of the matrix: which side is "up". */
@@ -23,8 +23,11 @@
  */
 void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div) {
     // (re-)initialize logger status for this servo
+    log->ring = false;
     log->sampled = 0;
     log->skipped = 0;
+    log->first = 0;
+    log->dropped = 0;
     log->data = buf;
     log->len = len;
     log->sample_div = div;
@@ -32,6 +35,33 @@ void pbio_logger_start(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div)
     log->active = true;
 }
 
+/**
+ * Starts logging continuously in the background.
+ *
+ * Unlike ::pbio_logger_start, the logger does not stop when @p buf is full.
+ * Instead, the oldest row is overwritten. Rows can be removed from the buffer
+ * with ::pbio_logger_drain to make room for new ones, so that data can be
+ * streamed for as long as needed using a fixed amount of memory.
+ *
+ * @param [in]  log     pointer to log
+ * @param [in]  buf     array large enough to hold @p len rows of data
+ * @param [in]  len     number of rows in the ring buffer
+ * @param [in]  div     clock divider to slow down sampling period
+ */
+void pbio_logger_start_ring(pbio_log_t *log, int32_t *buf, uint32_t len, int32_t div) {
+    pbio_logger_start(log, buf, len, div);
+    log->ring = true;
+}
+
+// Gets the row in the buffer that holds the sample at the given logical index.
+static int32_t *pbio_logger_row(pbio_log_t *log, uint32_t index) {
+    index += log->first;
+    if (index >= log->len) {
+        index -= log->len;
+    }
+    return &log->data[index * log->num_values];
+}
+
 int32_t pbio_logger_rows(pbio_log_t *log) {
     return log->sampled;
 }
@@ -58,24 +88,29 @@ void pbio_logger_update(pbio_log_t *log, int32_t *buf) {
     }
     log->skipped = 0;
 
-    // Stop if log is full.
-    if (log->sampled > log->len) {
-        log->active = false;
-        return;
-    }
+    // Handle a full log
+    if (log->sampled >= log->len) {
 
-    // Stop successfully when done
-    if (log->sampled == log->len) {
-        log->active = false;
-        return;
+        // Stop successfully when done
+        if (!log->ring || log->len == 0) {
+            log->active = false;
+            return;
+        }
+
+        // In ring mode, discard the oldest row to make room for the new one
+        log->first = log->first + 1 == log->len ? 0 : log->first + 1;
+        log->sampled--;
+        log->dropped++;
     }
 
+    int32_t *row = pbio_logger_row(log, log->sampled);
+
     // Write time of logging
-    log->data[log->sampled * log->num_values] = pbdrv_clock_get_ms() - log->start;
+    row[0] = pbdrv_clock_get_ms() - log->start;
 
     // Write the data
     for (uint8_t i = NUM_DEFAULT_LOG_VALUES; i < log->num_values; i++) {
-        log->data[log->sampled * log->num_values + i] = buf[i - NUM_DEFAULT_LOG_VALUES];
+        row[i] = buf[i - NUM_DEFAULT_LOG_VALUES];
     }
 
     // Increment sample counter
@@ -100,11 +135,53 @@ pbio_error_t pbio_logger_read(pbio_log_t *log, int32_t sindex, int32_t *buf) {
     }
 
     // Read the data
+    int32_t *row = pbio_logger_row(log, index);
     for (uint8_t i = 0; i < log->num_values; i++) {
-        buf[i] = log->data[index * log->num_values + i];
+        buf[i] = row[i];
     }
 
     return PBIO_SUCCESS;
 }
 
+/**
+ * Copies the oldest rows out of the log and removes them from it.
+ * @param [in]  log     pointer to log
+ * @param [out] buf     array large enough to hold @p rows rows of data
+ * @param [in]  rows    maximum number of rows to copy
+ * @return              number of rows that were copied
+ */
+uint32_t pbio_logger_drain(pbio_log_t *log, int32_t *buf, uint32_t rows) {
+
+    // Copy no more than what is available
+    if (rows > log->sampled) {
+        rows = log->sampled;
+    }
+
+    for (uint32_t r = 0; r < rows; r++) {
+        int32_t *row = pbio_logger_row(log, r);
+        for (uint8_t i = 0; i < log->num_values; i++) {
+            *buf++ = row[i];
+        }
+    }
+
+    // Release the rows so they can be written again
+    log->first += rows;
+    if (log->first >= log->len) {
+        log->first -= log->len;
+    }
+    log->sampled -= rows;
+
+    return rows;
+}
+
+/**
+ * Gets the number of rows that were overwritten in ring mode before they
+ * could be drained.
+ * @param [in]  log     pointer to log
+ * @return              number of dropped rows since the log was started
+ */
+uint32_t pbio_logger_dropped(pbio_log_t *log) {
+    return log->dropped;
+}
+
 #endif // PBIO_CONFIG_LOGGER
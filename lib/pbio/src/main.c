@@ -21,6 +21,7 @@
 #include <pbio/light_matrix.h>
 #include <pbio/light.h>
 #include <pbio/main.h>
+#include <pbio/profiler.h>
 #include <pbio/uartdev.h>
 
 #include "light/animation.h"
@@ -87,7 +88,9 @@ int pbio_do_one_event(void) {
     if (pbio_event_hook) {
         pbio_event_hook();
     }
-    return process_run();
+    int pending = process_run();
+    pbio_profiler_update_queue_depth(pending);
+    return pending;
 }
 
 /**
@@ -5,6 +5,8 @@
 #include <inttypes.h>
 #include <fixmath.h>
 
+#include <pbio/math.h>
+
 int32_t pbio_math_sign(int32_t a) {
     if (a == 0) {
         return 0;
@@ -46,3 +48,51 @@ int32_t pbio_math_sqrt(int32_t n) {
         x0 = x1;
     }
 }
+
+// sin(x) * PBIO_MATH_TRIG_SCALE for x = 0, 1, ..., 90 degrees
+static const int16_t sin_table[] = {
+    0, 286, 572, 857, 1143, 1428, 1713, 1997, 2280, 2563,
+    2845, 3126, 3406, 3686, 3964, 4240, 4516, 4790, 5063, 5334,
+    5604, 5872, 6138, 6402, 6664, 6924, 7182, 7438, 7692, 7943,
+    8192, 8438, 8682, 8923, 9162, 9397, 9630, 9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384,
+};
+
+// Gets the sine of an angle in millidegrees, scaled by PBIO_MATH_TRIG_SCALE.
+int32_t pbio_math_sin_mdeg(int32_t mdeg) {
+
+    // Bring angle into 0 to 360 degrees
+    mdeg %= 360000;
+    if (mdeg < 0) {
+        mdeg += 360000;
+    }
+
+    // Use symmetry to get to 0 to 90 degrees
+    int32_t sign = 1;
+    if (mdeg >= 180000) {
+        mdeg -= 180000;
+        sign = -1;
+    }
+    if (mdeg > 90000) {
+        mdeg = 180000 - mdeg;
+    }
+
+    // Interpolate between whole degrees
+    int32_t deg = mdeg / 1000;
+    if (deg == 90) {
+        return sign * sin_table[90];
+    }
+    int32_t low = sin_table[deg];
+    int32_t high = sin_table[deg + 1];
+    return sign * (low + ((high - low) * (mdeg % 1000) + 500) / 1000);
+}
+
+// Gets the cosine of an angle in millidegrees, scaled by PBIO_MATH_TRIG_SCALE.
+int32_t pbio_math_cos_mdeg(int32_t mdeg) {
+    return pbio_math_sin_mdeg(mdeg % 360000 + 90000);
+}
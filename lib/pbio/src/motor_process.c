@@ -1,15 +1,35 @@
 // SPDX-License-Identifier: MIT
-// Copyright (c) 2018-2020 The Pybricks Authors
+// Copyright (c) 2018-2021 The Pybricks Authors
 
+#include <pbdrv/clock.h>
+#include <pbdrv/motor.h>
 #include <pbio/battery.h>
 #include <pbio/control.h>
 #include <pbio/drivebase.h>
+#include <pbio/motor_process.h>
 #include <pbio/servo.h>
 
 #include <contiki.h>
 
 #if PBDRV_CONFIG_NUM_MOTOR_CONTROLLER != 0
 
+static pbio_motor_process_stats_t stats;
+
+/**
+ * Gets the timing statistics of the motor control loop.
+ * @param [out] stats_out   The statistics since the last reset.
+ */
+void pbio_motor_process_get_stats(pbio_motor_process_stats_t *stats_out) {
+    *stats_out = stats;
+}
+
+/**
+ * Resets the timing statistics of the motor control loop.
+ */
+void pbio_motor_process_reset_stats(void) {
+    stats = (pbio_motor_process_stats_t) { 0 };
+}
+
 PROCESS(pbio_motor_process, "servo");
 
 PROCESS_THREAD(pbio_motor_process, ev, data) {
@@ -28,6 +48,10 @@ PROCESS_THREAD(pbio_motor_process, ev, data) {
     for (;;) {
         PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && etimer_expired(&timer));
 
+        // Measure how late we are compared to the scheduled time.
+        uint32_t time_start = pbdrv_clock_get_us();
+        uint32_t jitter = time_start - etimer_expiration_time(&timer) * US_PER_MS;
+
         // Update battery voltage.
         pbio_battery_update();
 
@@ -37,8 +61,35 @@ PROCESS_THREAD(pbio_motor_process, ev, data) {
         // Update servos
         pbio_servo_update_all();
 
-        // Reset timer to wait for next update
-        etimer_restart(&timer);
+        // Write the new motor outputs all at once, if the driver defers them.
+        uint32_t writes = pbdrv_motor_commit();
+
+        uint32_t run_time = pbdrv_clock_get_us() - time_start;
+
+        stats.updates++;
+        stats.jitter_total += jitter;
+        if (jitter > stats.jitter_max) {
+            stats.jitter_max = jitter;
+        }
+        if (run_time > stats.run_time_max) {
+            stats.run_time_max = run_time;
+        }
+        stats.writes_total += writes;
+        if (writes > stats.writes_max) {
+            stats.writes_max = writes;
+        }
+
+        // The next update is scheduled one period after the previous one was
+        // due, not one period from now, so the loop keeps a fixed phase and the
+        // run time of this update does not add to the period. If we are one or
+        // more periods behind, skip the missed updates instead of running them
+        // back to back.
+        clock_time_t missed = (clock_time() - etimer_expiration_time(&timer)) / PBIO_CONTROL_LOOP_TIME_MS;
+        if (missed > 0) {
+            etimer_adjust(&timer, missed * PBIO_CONTROL_LOOP_TIME_MS);
+            stats.overruns += missed;
+        }
+        etimer_reset(&timer);
     }
 
     PROCESS_END();
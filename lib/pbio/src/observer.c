@@ -10,14 +10,56 @@
 #include <pbio/observer.h>
 
 #if PBIO_CONFIG_CONTROL_MINIMAL
+
+// The estimated state is stored in degrees with this many fractional bits.
+#define FRAC_BITS (14)
+
+// The precomputed model coefficients have this many fractional bits.
+#define COEF_BITS (24)
+
+// The feedforward coefficients have fewer fractional bits so they fit in 32 bits.
+#define COEF_BITS_FF (16)
+
+// Rounds a value with FRAC_BITS fractional bits to the nearest integer.
+static int32_t pbio_observer_round(int64_t value) {
+    return (int32_t)((value + (1 << (FRAC_BITS - 1))) >> FRAC_BITS);
+}
+
+static int64_t pbio_observer_abs(int64_t value) {
+    return value < 0 ? -value : value;
+}
+
+// The settings are scaled by powers of ten. Dividing by those at run time
+// takes a slow library call on chips without a hardware divider, so they are
+// converted once to coefficients that only need a multiply and a shift.
+static void pbio_observer_precompute(pbio_observer_t *obs) {
+    const pbio_observer_settings_t *s = obs->settings;
+
+    // Model constants in the units of the state, with COEF_BITS fractional
+    // bits. The torques are in micronewtonmeters.
+    obs->c_phi_01 = (int32_t)(((int64_t)s->phi_01 << COEF_BITS) / PBIO_OBSERVER_SCALE_HIGH);
+    obs->c_phi_11 = (int32_t)(((int64_t)s->phi_11 << COEF_BITS) / PBIO_OBSERVER_SCALE_LOW);
+    obs->c_gam_0 = (int32_t)(((int64_t)s->gam_0 << (COEF_BITS + FRAC_BITS)) / PBIO_OBSERVER_SCALE_LOW / PBIO_OBSERVER_SCALE_TRQ);
+    obs->c_gam_1 = (int32_t)(((int64_t)s->gam_1 << (COEF_BITS + FRAC_BITS)) / PBIO_OBSERVER_SCALE_LOW / PBIO_OBSERVER_SCALE_TRQ);
+
+    // Torque per millivolt and millivolt per torque.
+    obs->c_k_0 = (int32_t)(((int64_t)s->k_0 << COEF_BITS) * (PBIO_OBSERVER_SCALE_TRQ / PBIO_OBSERVER_SCALE_HIGH) / 1000);
+    obs->c_k_0_inv = s->k_0 ? (int32_t)(((int64_t)1000 << COEF_BITS) * (PBIO_OBSERVER_SCALE_HIGH / PBIO_OBSERVER_SCALE_TRQ) / s->k_0) : 0;
+
+    // Torque per unit of speed and acceleration.
+    obs->c_ff_1 = (int32_t)(((int64_t)s->k_0 * s->k_1 << COEF_BITS_FF) * (PBIO_OBSERVER_SCALE_TRQ / PBIO_OBSERVER_SCALE_HIGH) / PBIO_OBSERVER_SCALE_HIGH);
+    obs->c_ff_2 = (int32_t)(((int64_t)s->k_0 * s->k_2 << COEF_BITS_FF) * (PBIO_OBSERVER_SCALE_TRQ / PBIO_OBSERVER_SCALE_HIGH) / PBIO_OBSERVER_SCALE_HIGH);
+}
+
 void pbio_observer_reset(pbio_observer_t *obs, int32_t count_now, int32_t rate_now) {
-    obs->est_count = count_now * PBIO_OBSERVER_SCALE_DEG;
-    obs->est_rate = rate_now * PBIO_OBSERVER_SCALE_DEG;
+    obs->est_count = (int64_t)count_now << FRAC_BITS;
+    obs->est_rate = (int64_t)rate_now << FRAC_BITS;
+    pbio_observer_precompute(obs);
 }
 
 void pbio_observer_get_estimated_state(pbio_observer_t *obs, int32_t *count, int32_t *rate) {
-    *count = (int32_t)(obs->est_count / PBIO_OBSERVER_SCALE_DEG);
-    *rate = (int32_t)(obs->est_rate / PBIO_OBSERVER_SCALE_DEG);
+    *count = pbio_observer_round(obs->est_count);
+    *rate = pbio_observer_round(obs->est_rate);
 }
 
 void pbio_observer_update(pbio_observer_t *obs, int32_t count, bool is_coasting, int32_t voltage) {
@@ -28,8 +70,8 @@ void pbio_observer_update(pbio_observer_t *obs, int32_t count, bool is_coasting,
 
     const pbio_observer_settings_t *s = obs->settings;
 
-    // Torque due to duty cycle
-    int64_t tau_e = (int64_t)voltage * s->k_0 / 1000 * (PBIO_OBSERVER_SCALE_TRQ / PBIO_OBSERVER_SCALE_HIGH);
+    // Torque due to voltage
+    int64_t tau_e = ((int64_t)voltage * obs->c_k_0) >> COEF_BITS;
 
     // Friction torque
     int64_t tau_f = obs->est_rate > 0 ? s->f_low: -s->f_low;
@@ -40,28 +82,33 @@ void pbio_observer_update(pbio_observer_t *obs, int32_t count, bool is_coasting,
     int64_t k_high = k_low * (s->obs_gains & 0x000000FF);
 
     // Below this error, the virtual spring stiffness is low.
-    int64_t r1 = 5 * PBIO_OBSERVER_SCALE_DEG;
+    int64_t r1 = 5 << FRAC_BITS;
 
     // Below this error, the virtual spring stiffness is medium, above is high.
-    int64_t r2 = 25 * PBIO_OBSERVER_SCALE_DEG;
+    int64_t r2 = 25 << FRAC_BITS;
 
     // Get estimation error
-    int64_t est_err = (int64_t)count * PBIO_OBSERVER_SCALE_DEG - obs->est_count;
+    int64_t est_err = ((int64_t)count << FRAC_BITS) - obs->est_count;
+    int64_t abs_err = pbio_observer_abs(est_err);
 
     // Compute torque for estimation error correction as a piecewise affine spring
-    int64_t tau_o = 0;
-    if (abs(est_err) < r1) {
-        tau_o = k_low * est_err / PBIO_OBSERVER_SCALE_DEG;
-    } else if (abs(est_err) < r2) {
-        tau_o = (k_low * r1 + (abs(est_err) - r1) * k_med) * pbio_math_sign(est_err) / PBIO_OBSERVER_SCALE_DEG;
+    int64_t tau_o;
+    if (abs_err < r1) {
+        tau_o = (k_low * abs_err) >> FRAC_BITS;
+    } else if (abs_err < r2) {
+        tau_o = (k_low * r1 + (abs_err - r1) * k_med) >> FRAC_BITS;
     } else {
-        tau_o = (k_low * r1 + k_med * (r2 - r1) + (abs(est_err) - r2) * k_high) * pbio_math_sign(est_err) / PBIO_OBSERVER_SCALE_DEG;
+        tau_o = (k_low * r1 + k_med * (r2 - r1) + (abs_err - r2) * k_high) >> FRAC_BITS;
+    }
+    if (est_err < 0) {
+        tau_o = -tau_o;
     }
 
-    int64_t next_count = obs->est_count + (s->phi_01 * obs->est_rate) / PBIO_OBSERVER_SCALE_HIGH + s->gam_0 * (tau_e + tau_o) * (PBIO_OBSERVER_SCALE_DEG / PBIO_OBSERVER_SCALE_LOW) / PBIO_OBSERVER_SCALE_TRQ;
-    int64_t next_rate = (s->phi_11 * obs->est_rate) / PBIO_OBSERVER_SCALE_LOW + s->gam_1 * (tau_e + tau_o - tau_f) * (PBIO_OBSERVER_SCALE_DEG / PBIO_OBSERVER_SCALE_LOW) / PBIO_OBSERVER_SCALE_TRQ;
+    // Get next state given total torque
+    int64_t next_count = obs->est_count + ((obs->c_phi_01 * obs->est_rate + obs->c_gam_0 * (tau_e + tau_o)) >> COEF_BITS);
+    int64_t next_rate = (obs->c_phi_11 * obs->est_rate + obs->c_gam_1 * (tau_e + tau_o - tau_f)) >> COEF_BITS;
 
-    if ((next_rate < 0) != (next_rate + s->gam_1 * tau_f * (PBIO_OBSERVER_SCALE_DEG / PBIO_OBSERVER_SCALE_LOW) / PBIO_OBSERVER_SCALE_TRQ < 0)) {
+    if ((next_rate < 0) != (next_rate + ((obs->c_gam_1 * tau_f) >> COEF_BITS) < 0)) {
         next_rate = 0;
     }
 
@@ -72,23 +119,55 @@ void pbio_observer_update(pbio_observer_t *obs, int32_t count, bool is_coasting,
 int32_t pbio_observer_get_feedforward_torque(pbio_observer_t *obs, int32_t rate_ref, int32_t acceleration_ref) {
     const pbio_observer_settings_t *s = obs->settings;
 
-    // Torque terms in micronewtons (TODO: Convert to integer math)
-    int32_t friction_compensation_torque = (int32_t)(s->f_low * pbio_math_sign(rate_ref));
-    int32_t back_emf_compensation_torque = (int32_t)((int64_t)s->k_0 * s->k_2 * rate_ref * (PBIO_OBSERVER_SCALE_TRQ / PBIO_OBSERVER_SCALE_HIGH) / PBIO_OBSERVER_SCALE_HIGH);
-    int32_t acceleration_torque = (int32_t)((int64_t)s->k_0 * s->k_1 * acceleration_ref * (PBIO_OBSERVER_SCALE_TRQ / PBIO_OBSERVER_SCALE_HIGH) / PBIO_OBSERVER_SCALE_HIGH);
+    // Torque terms in micronewtons
+    int32_t friction_compensation_torque = s->f_low * pbio_math_sign(rate_ref);
+    int32_t back_emf_compensation_torque = (int32_t)(((int64_t)obs->c_ff_2 * rate_ref) >> COEF_BITS_FF);
+    int32_t acceleration_torque = (int32_t)(((int64_t)obs->c_ff_1 * acceleration_ref) >> COEF_BITS_FF);
 
-    // Scale micronewtons by battery voltage to duty (0--10000)
-    return (int32_t)(friction_compensation_torque + back_emf_compensation_torque + acceleration_torque);
+    // Total feedforward torque
+    return friction_compensation_torque + back_emf_compensation_torque + acceleration_torque;
 }
 
 int32_t pbio_observer_torque_to_voltage(pbio_observer_t *obs, int32_t desired_torque) {
-    return (int32_t)((int64_t)desired_torque * (PBIO_OBSERVER_SCALE_HIGH / 1000) / obs->settings->k_0);
+    return (int32_t)(((int64_t)desired_torque * obs->c_k_0_inv) >> COEF_BITS);
 }
 
 #else
+
+// The model constants in the settings are discretized at the model sample
+// time. Convert them to the control loop period. The speed is modeled as a
+// first order system, so phi_11 = exp(-a * T), phi_01 = (1 - phi_11) / a,
+// gam_1 = b * phi_01, and gam_0 = b * (T - phi_01) / a.
+static void pbio_observer_discretize(pbio_observer_t *obs) {
+    const pbio_observer_settings_t *s = obs->settings;
+
+    #if PBIO_CONTROL_LOOP_TIME_MS != PBIO_OBSERVER_MODEL_TIME_MS
+    // No scaling needed if there is no model (phi_11 = 0) or if the model is
+    // a pure integrator (phi_11 = 1).
+    if (s->phi_11 > 0.0f && s->phi_11 < 1.0f) {
+        const float t_model = PBIO_OBSERVER_MODEL_TIME_MS / 1000.0f;
+        const float t_loop = PBIO_CONTROL_LOOP_TIME_MS / 1000.0f;
+
+        obs->phi_11 = powf(s->phi_11, t_loop / t_model);
+
+        float scale = (1.0f - obs->phi_11) / (1.0f - s->phi_11);
+        obs->phi_01 = s->phi_01 * scale;
+        obs->gam_1 = s->gam_1 * scale;
+        obs->gam_0 = s->gam_0 * (t_loop - obs->phi_01) / (t_model - s->phi_01);
+        return;
+    }
+    #endif
+
+    obs->phi_01 = s->phi_01;
+    obs->phi_11 = s->phi_11;
+    obs->gam_0 = s->gam_0;
+    obs->gam_1 = s->gam_1;
+}
+
 void pbio_observer_reset(pbio_observer_t *obs, int32_t count_now, int32_t rate_now) {
     obs->est_count = count_now;
     obs->est_rate = rate_now;
+    pbio_observer_discretize(obs);
 }
 
 void pbio_observer_get_estimated_state(pbio_observer_t *obs, int32_t *count, int32_t *rate) {
@@ -105,7 +184,7 @@ void pbio_observer_update(pbio_observer_t *obs, int32_t count, bool is_coasting,
     const pbio_observer_settings_t *s = obs->settings;
 
     // Torque due to voltage
-    float tau_e = voltage / 1000 * s->k_0;
+    float tau_e = voltage / 1000.0f * s->k_0;
 
     // Friction torque
     float tau_f = obs->est_rate > 0 ? s->f_low: -s->f_low;
@@ -135,10 +214,10 @@ void pbio_observer_update(pbio_observer_t *obs, int32_t count, bool is_coasting,
     }
 
     // Get next state given total torque
-    float next_count = obs->est_count + s->phi_01 * obs->est_rate + s->gam_0 * (tau_e + tau_o);
-    float next_rate = s->phi_11 * obs->est_rate + s->gam_1 * (tau_e + tau_o - tau_f);
+    float next_count = obs->est_count + obs->phi_01 * obs->est_rate + obs->gam_0 * (tau_e + tau_o);
+    float next_rate = obs->phi_11 * obs->est_rate + obs->gam_1 * (tau_e + tau_o - tau_f);
 
-    if ((next_rate < 0) != (next_rate + s->gam_1 * tau_f < 0)) {
+    if ((next_rate < 0) != (next_rate + obs->gam_1 * tau_f < 0)) {
         next_rate = 0;
     }
 
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Counts calls and measures the run time of each Contiki process. The hooks
+// are called from call_process(), see PROCESS_CONF_CALL_BEGIN in contiki-conf.h.
+
+#include <pbio/config.h>
+
+#if PBIO_CONFIG_PROFILER
+
+#include <stdint.h>
+
+#include <contiki.h>
+
+#include <pbdrv/clock.h>
+#include <pbio/error.h>
+#include <pbio/profiler.h>
+
+// Processes can call other processes synchronously, so calls can be nested
+#define MAX_CALL_DEPTH 4
+
+typedef struct {
+    struct process *process;
+    uint32_t calls;
+    uint64_t total_cycles;
+    uint32_t max_cycles;
+} pbio_profiler_entry_t;
+
+static pbio_profiler_entry_t entries[PBIO_CONFIG_PROFILER_NUM_PROCESSES];
+static uint8_t num_entries;
+
+static uint32_t call_start[MAX_CALL_DEPTH];
+static uint8_t call_depth;
+
+static uint32_t max_queue_depth;
+
+/**
+ * Marks the start of a call to a process.
+ * @param [in]  process     The process that is about to be called.
+ */
+void pbio_profiler_call_begin(struct process *process) {
+    if (call_depth < MAX_CALL_DEPTH) {
+        call_start[call_depth] = pbdrv_clock_get_cycles();
+    }
+    call_depth++;
+}
+
+/**
+ * Marks the end of a call to a process and adds it to the statistics.
+ *
+ * Time spent in processes called by @p process is included in its time.
+ *
+ * @param [in]  process     The process that just returned.
+ */
+void pbio_profiler_call_end(struct process *process) {
+    uint32_t now = pbdrv_clock_get_cycles();
+
+    if (call_depth == 0 || --call_depth >= MAX_CALL_DEPTH) {
+        return;
+    }
+
+    uint32_t cycles = now - call_start[call_depth];
+
+    // Find the process, or add it if this is its first call
+    pbio_profiler_entry_t *entry = NULL;
+    for (uint8_t i = 0; i < num_entries; i++) {
+        if (entries[i].process == process) {
+            entry = &entries[i];
+            break;
+        }
+    }
+    if (!entry) {
+        if (num_entries == PBIO_CONFIG_PROFILER_NUM_PROCESSES) {
+            return;
+        }
+        entry = &entries[num_entries++];
+        *entry = (pbio_profiler_entry_t) { .process = process };
+    }
+
+    entry->calls++;
+    entry->total_cycles += cycles;
+    if (cycles > entry->max_cycles) {
+        entry->max_cycles = cycles;
+    }
+}
+
+/**
+ * Records the number of pending events after running the event loop.
+ * @param [in]  depth       The number of pending events.
+ */
+void pbio_profiler_update_queue_depth(uint32_t depth) {
+    if (depth > max_queue_depth) {
+        max_queue_depth = depth;
+    }
+}
+
+/**
+ * Gets the number of processes that have been called since the last reset.
+ * @return                  The number of processes.
+ */
+uint8_t pbio_profiler_get_num_processes(void) {
+    return num_entries;
+}
+
+/**
+ * Gets the run time statistics of a process.
+ * @param [in]  index       Index of the process, in the order in which they
+ *                          were first called.
+ * @param [out] stats       The statistics.
+ * @return                  ::PBIO_SUCCESS on success or ::PBIO_ERROR_INVALID_ARG
+ *                          if @p index is out of range.
+ */
+pbio_error_t pbio_profiler_get_stats(uint8_t index, pbio_profiler_stats_t *stats) {
+    if (index >= num_entries) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    pbio_profiler_entry_t *entry = &entries[index];
+    uint32_t cycles_per_us = pbdrv_clock_get_cycles_per_us();
+    uint64_t total_time = entry->total_cycles / cycles_per_us;
+
+    stats->name = PROCESS_NAME_STRING(entry->process);
+    stats->calls = entry->calls;
+    stats->total_time = total_time > UINT32_MAX ? UINT32_MAX : total_time;
+    stats->max_time = entry->max_cycles / cycles_per_us;
+
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Gets the largest number of pending events seen since the last reset.
+ * @return                  The number of events.
+ */
+uint32_t pbio_profiler_get_max_queue_depth(void) {
+    return max_queue_depth;
+}
+
+/**
+ * Clears all statistics.
+ */
+void pbio_profiler_reset(void) {
+    num_entries = 0;
+    max_queue_depth = 0;
+}
+
+#endif // PBIO_CONFIG_PROFILER
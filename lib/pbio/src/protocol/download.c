@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Receiver for windowed program downloads
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pbio/download.h>
+#include <pbio/error.h>
+#include <pbio/protocol.h>
+#include <pbio/util.h>
+
+/**
+ * Initializes the receiver.
+ *
+ * @param [in]  dl          The receiver.
+ * @param [in]  buf         Buffer for the program or NULL to reject downloads.
+ * @param [in]  max_size    The size of @p buf.
+ */
+void pbio_download_init(pbio_download_t *dl, uint8_t *buf, uint32_t max_size) {
+    *dl = (pbio_download_t) {
+        .buf = buf,
+        .max_size = max_size,
+    };
+}
+
+/**
+ * Stops accepting downloads.
+ *
+ * Unlike pbio_download_init() with a NULL buffer, this keeps the progress of
+ * the last download, so that its final status can still be reported after the
+ * buffer has been taken by the caller.
+ *
+ * @param [in]  dl          The receiver.
+ */
+void pbio_download_stop(pbio_download_t *dl) {
+    dl->buf = NULL;
+    dl->max_size = 0;
+}
+
+/**
+ * Handles the ::PBIO_PYBRICKS_COMMAND_START_DOWNLOAD command.
+ *
+ * This discards any previous download, so a download can be restarted at any
+ * time.
+ *
+ * @param [in]  dl      The receiver.
+ * @param [in]  data    The command, including the command byte.
+ * @param [in]  size    The size of @p data.
+ * @return              ::PBIO_SUCCESS on success,
+ *                      ::PBIO_ERROR_INVALID_OP if downloads are not accepted now,
+ *                      ::PBIO_ERROR_INVALID_ARG if the sizes are not valid.
+ */
+pbio_error_t pbio_download_start(pbio_download_t *dl, const uint8_t *data, uint32_t size) {
+    dl->size = 0;
+    dl->base = 0;
+    dl->received = 0;
+
+    if (!dl->buf) {
+        return dl->status = PBIO_ERROR_INVALID_OP;
+    }
+
+    if (size < 7) {
+        return dl->status = PBIO_ERROR_INVALID_ARG;
+    }
+
+    uint32_t program_size = pbio_get_uint32_le(&data[1]);
+    uint16_t block_size = pbio_get_uint16_le(&data[5]);
+
+    if (program_size == 0 || program_size > dl->max_size || block_size == 0) {
+        return dl->status = PBIO_ERROR_INVALID_ARG;
+    }
+
+    uint32_t num_blocks = (program_size + block_size - 1) / block_size;
+    if (num_blocks > UINT16_MAX) {
+        return dl->status = PBIO_ERROR_INVALID_ARG;
+    }
+
+    dl->size = program_size;
+    dl->block_size = block_size;
+    dl->num_blocks = num_blocks;
+
+    return dl->status = PBIO_SUCCESS;
+}
+
+/**
+ * Handles the ::PBIO_PYBRICKS_COMMAND_WRITE_BLOCK command.
+ *
+ * Blocks that were already received are accepted again but not copied.
+ *
+ * @param [in]  dl      The receiver.
+ * @param [in]  data    The command, including the command byte.
+ * @param [in]  size    The size of @p data.
+ * @return              ::PBIO_SUCCESS on success,
+ *                      ::PBIO_ERROR_INVALID_OP if no download was started,
+ *                      ::PBIO_ERROR_INVALID_ARG if the block index or size is
+ *                      not valid or if it is too far ahead of the first missing
+ *                      block, ::PBIO_ERROR_IO if the CRC does not match.
+ */
+pbio_error_t pbio_download_write_block(pbio_download_t *dl, const uint8_t *data, uint32_t size) {
+    if (!dl->buf || dl->size == 0) {
+        return dl->status = PBIO_ERROR_INVALID_OP;
+    }
+
+    if (size < PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE) {
+        return dl->status = PBIO_ERROR_INVALID_ARG;
+    }
+
+    uint16_t index = pbio_get_uint16_le(&data[1]);
+    uint32_t crc = pbio_get_uint32_le(&data[3]);
+    const uint8_t *block = &data[PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE];
+    uint32_t block_size = size - PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE;
+
+    if (index >= dl->num_blocks || index > dl->base + PBIO_DOWNLOAD_WINDOW_SIZE) {
+        return dl->status = PBIO_ERROR_INVALID_ARG;
+    }
+
+    uint32_t offset = index * dl->block_size;
+    uint32_t expected_size = dl->size - offset < dl->block_size ? dl->size - offset : dl->block_size;
+    if (block_size != expected_size) {
+        return dl->status = PBIO_ERROR_INVALID_ARG;
+    }
+
+    if (pbio_crc32(0, block, block_size) != crc) {
+        return dl->status = PBIO_ERROR_IO;
+    }
+
+    // Already have it, so the status event got lost or was too late
+    if (index < dl->base || (index > dl->base && dl->received & (UINT32_C(1) << (index - dl->base - 1)))) {
+        return dl->status = PBIO_SUCCESS;
+    }
+
+    memcpy(&dl->buf[offset], block, block_size);
+
+    if (index > dl->base) {
+        dl->received |= UINT32_C(1) << (index - dl->base - 1);
+        return dl->status = PBIO_SUCCESS;
+    }
+
+    // The first missing block arrived, so slide the window past all blocks
+    // that we have in a row.
+    dl->base++;
+    while (dl->received & 1) {
+        dl->received >>= 1;
+        dl->base++;
+    }
+    dl->received >>= 1;
+
+    return dl->status = PBIO_SUCCESS;
+}
+
+/**
+ * Tests if all blocks have been received.
+ *
+ * @param [in]  dl      The receiver.
+ * @return              True if the program is complete.
+ */
+bool pbio_download_is_done(pbio_download_t *dl) {
+    return dl->buf && dl->size && dl->base == dl->num_blocks;
+}
@@ -4,6 +4,7 @@
 // Pybricks communication protocol
 
 #include <stdint.h>
+#include <string.h>
 
 #include <pbio/protocol.h>
 #include <pbio/util.h>
@@ -24,6 +25,84 @@ uint32_t pbio_pybricks_event_status_report(uint8_t *buf, uint32_t flags) {
     return 5;
 }
 
+/**
+ * Writes Pybricks telemetry event to @p buf
+ *
+ * @param [in]  buf         The buffer to hold the binary data.
+ * @param [in]  stream      The stream identifier.
+ * @param [in]  num_values  The number of values in each row.
+ * @param [in]  num_rows    The number of rows.
+ * @param [in]  data        The rows of data.
+ * @return                  The number of bytes written to @p buf.
+ */
+uint32_t pbio_pybricks_event_telemetry(uint8_t *buf, uint8_t stream, uint8_t num_values, uint8_t num_rows, const int32_t *data) {
+    buf[0] = PBIO_PYBRICKS_EVENT_TELEMETRY;
+    buf[1] = stream;
+    buf[2] = num_values;
+    buf[3] = num_rows;
+
+    uint32_t size = PBIO_PYBRICKS_EVENT_TELEMETRY_HEADER_SIZE;
+    for (uint32_t i = 0; i < num_values * num_rows; i++) {
+        pbio_set_uint32_le(&buf[size], data[i]);
+        size += 4;
+    }
+    return size;
+}
+
+/**
+ * Writes Pybricks download status event to @p buf
+ *
+ * @param [in]  buf         The buffer to hold the binary data.
+ * @param [in]  status      The result of the last download command.
+ * @param [in]  base        The index of the first missing block.
+ * @param [in]  received    Flags of received blocks after @p base.
+ * @return                  The number of bytes written to @p buf.
+ */
+uint32_t pbio_pybricks_event_download_status(uint8_t *buf, uint8_t status, uint16_t base, uint32_t received) {
+    buf[0] = PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS;
+    buf[1] = status;
+    pbio_set_uint16_le(&buf[2], base);
+    pbio_set_uint32_le(&buf[4], received);
+    return PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS_SIZE;
+}
+
+/**
+ * Writes Pybricks profile event to @p buf
+ *
+ * @param [in]  buf             The buffer to hold the binary data.
+ * @param [in]  size            The size of @p buf. Must be at least
+ *                              ::PBIO_PYBRICKS_EVENT_PROFILE_HEADER_SIZE.
+ * @param [in]  index           The index of the process.
+ * @param [in]  num_processes   The number of processes.
+ * @param [in]  max_queue_depth The largest number of pending events.
+ * @param [in]  calls           The number of calls of the process.
+ * @param [in]  total_time      The total run time in microseconds.
+ * @param [in]  max_time        The longest run time of one call in microseconds.
+ * @param [in]  name            The name of the process or NULL.
+ * @return                      The number of bytes written to @p buf.
+ */
+uint32_t pbio_pybricks_event_profile(uint8_t *buf, uint32_t size, uint8_t index, uint8_t num_processes,
+    uint32_t max_queue_depth, uint32_t calls, uint32_t total_time, uint32_t max_time, const char *name) {
+
+    buf[0] = PBIO_PYBRICKS_EVENT_PROFILE;
+    buf[1] = index;
+    buf[2] = num_processes;
+    pbio_set_uint32_le(&buf[3], max_queue_depth);
+    pbio_set_uint32_le(&buf[7], calls);
+    pbio_set_uint32_le(&buf[11], total_time);
+    pbio_set_uint32_le(&buf[15], max_time);
+
+    uint32_t name_size = name ? strlen(name) : 0;
+    if (name_size > size - PBIO_PYBRICKS_EVENT_PROFILE_HEADER_SIZE) {
+        name_size = size - PBIO_PYBRICKS_EVENT_PROFILE_HEADER_SIZE;
+    }
+    if (name_size) {
+        memcpy(&buf[PBIO_PYBRICKS_EVENT_PROFILE_HEADER_SIZE], name, name_size);
+    }
+
+    return PBIO_PYBRICKS_EVENT_PROFILE_HEADER_SIZE + name_size;
+}
+
 /**
  * Pybricks Service UUID.
  *
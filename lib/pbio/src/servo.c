@@ -387,7 +387,7 @@ pbio_error_t pbio_servo_run_until_stalled(pbio_servo_t *srv, int32_t speed, pbio
     return pbio_servo_run_timed(srv, speed, DURATION_FOREVER, pbio_control_on_target_stalled, after_stop);
 }
 
-pbio_error_t pbio_servo_run_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_actuation_t after_stop) {
+static pbio_error_t pbio_servo_run_target_func(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_actuation_t after_stop, bool queue) {
 
     // Don't allow new user command if update loop not registered.
     if (!pbio_servo_update_loop_is_running(srv)) {
@@ -414,9 +414,23 @@ pbio_error_t pbio_servo_run_target(pbio_servo_t *srv, int32_t speed, int32_t tar
         return err;
     }
 
+    // Either queue the target after the ongoing angle maneuver or replace it
+    if (queue) {
+        return pbio_control_queue_angle_control(&srv->control, time_now, &state, target_count, target_rate, after_stop);
+    }
     return pbio_control_start_angle_control(&srv->control, time_now, &state, target_count, target_rate, after_stop);
 }
 
+pbio_error_t pbio_servo_run_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_actuation_t after_stop) {
+    return pbio_servo_run_target_func(srv, speed, target, after_stop, false);
+}
+
+pbio_error_t pbio_servo_queue_target(pbio_servo_t *srv, int32_t speed, int32_t target, pbio_actuation_t after_stop) {
+    // Run to the target once the ongoing angle maneuver and any queued before
+    // it are done, blending them into one motion without stopping in between.
+    return pbio_servo_run_target_func(srv, speed, target, after_stop, true);
+}
+
 pbio_error_t pbio_servo_run_angle(pbio_servo_t *srv, int32_t speed, int32_t angle, pbio_actuation_t after_stop) {
 
     // Don't allow new user command if update loop not registered.
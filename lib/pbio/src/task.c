@@ -28,10 +28,15 @@ void pbio_task_init(pbio_task_t *task, pbio_task_thread_t thread, void *context)
 
 /**
  * Runs the task protothread until the next yield.
+ *
+ * This is used to drive a task that is not in any task queue, e.g. one that
+ * is polled by its owner. It must only be called while the task status is
+ * ::PBIO_ERROR_AGAIN.
+ *
  * @param [in]  task    The task.
  * @returns             True if the protothread has completed, otherwise false.
  */
-static bool pbio_task_run_once(pbio_task_t *task) {
+bool pbio_task_run_once(pbio_task_t *task) {
     if (PT_SCHEDULE(task->thread(&task->pt, task))) {
         return false;
     }
@@ -300,6 +300,15 @@ void pbio_trajectory_stretch(pbio_trajectory_t *trj, int32_t t1mt0, int32_t t2mt
         return;
     }
 
+    // If this trajectory doesn't move at all, it just has to take as long as
+    // the other one. This also avoids dividing by the zero accelerations below.
+    if (trj->th3 == trj->th0 && trj->w0 == 0) {
+        trj->t1 = trj->t0 + t1mt0;
+        trj->t2 = trj->t0 + t2mt0;
+        trj->t3 = trj->t0 + t3mt0;
+        return;
+    }
+
     // This recomputes several components of a trajectory such that it travels
     // the same distance as before, but with new time stamps t1, t2, and t3.
     // Setting the speed integral equal to (th3 - th0) gives three constraint
@@ -133,7 +133,6 @@ typedef enum {
  * struct ev3_uart_port_data - Data for EV3/LPF2 UART Sensor communication
  * @iodev: The I/O device state information struct
  * @pt: Protothread for main communication protocol
- * @data_pt: Protothread for receiving sensor data
  * @speed_pt: Protothread for setting the baud rate
  * @timer: Timer for sending keepalive messages and other delays.
  * @uart: Pointer to the UART device to use for communications
@@ -153,6 +152,7 @@ typedef enum {
  * @tx_msg: Buffer to hold messages transmitted to the device
  * @rx_msg: Buffer to hold messages received from the device
  * @rx_msg_size: Size of the current message being received
+ * @rx_msg_pos: Number of bytes of the current DATA message received so far
  * @ext_mode: Extra mode adder for Powered Up devices (for modes > LUMP_MAX_MODE)
  * @write_cmd_size: The size parameter received from a WRITE command
  * @tacho_rate: The tacho rate received from an LPF2 motor
@@ -172,7 +172,6 @@ typedef enum {
 typedef struct {
     pbio_iodev_t iodev;
     struct pt pt;
-    struct pt data_pt;
     struct pt speed_pt;
     struct etimer timer;
     pbdrv_uart_dev_t *uart;
@@ -189,6 +188,7 @@ typedef struct {
     uint8_t *tx_msg;
     uint8_t *rx_msg;
     uint8_t rx_msg_size;
+    uint8_t rx_msg_pos;
     uint8_t ext_mode;
     uint8_t write_cmd_size;
     int8_t tacho_rate;
@@ -200,7 +200,7 @@ typedef struct {
     bool tx_busy;
     bool mode_change_tx_done;
     uint8_t speed_payload[4];
-    uint8_t mode_combo_payload[5];
+    uint8_t mode_combo_payload[2 + PBIO_IODEV_MAX_COMBO_VALUES];
     uint8_t mode_combo_size;
 } uartdev_port_data_t;
 
@@ -374,6 +374,13 @@ static void pbio_uartdev_parse_msg(uartdev_port_data_t *data) {
                         data->write_cmd_size = cmd2 & 0x3;
                         if (PBIO_IODEV_IS_FEEDBACK_MOTOR(&data->iodev)) {
                             // TODO: msg[3] and msg[4] probably give us useful information
+                        } else if (data->new_mode == PBIO_IODEV_MODE_COMBO) {
+                            // The device echoes the mode combo command, so
+                            // from now on it sends the data of all modes.
+                            // DATA received before this was in the old mode,
+                            // so wait for the first combo DATA message.
+                            data->iodev.combo_modes = pbio_iodev_get_combo_modes(&data->iodev);
+                            data->data_rec = false;
                         } else {
                             // TODO: handle other write commands
                         }
@@ -590,6 +597,9 @@ static void pbio_uartdev_parse_msg(uartdev_port_data_t *data) {
                 if (data->info->capability_flags & PBIO_IODEV_CAPABILITY_FLAG_HAS_MOTOR_ABS_POS) {
                     data->abs_pos = data->rx_msg[7] << 8 | data->rx_msg[6];
                 }
+            } else if (data->iodev.combo_modes) {
+                // data of all modes in the combination, in order of mode number
+                memcpy(data->iodev.bin_data, data->rx_msg + 1, msg_size - 2);
             } else {
                 if (mode >= data->info->num_modes) {
                     DBG_ERR(data->last_err = "Invalid mode received");
@@ -735,6 +745,8 @@ static PT_THREAD(pbio_uartdev_update(uartdev_port_data_t * data)) {
     // reset state for new device
     data->info->type_id = PBIO_IODEV_TYPE_ID_NONE;
     data->info->capability_flags = PBIO_IODEV_CAPABILITY_FLAG_NONE;
+    data->info->mode_combos = 0;
+    data->iodev.combo_modes = 0;
     data->ext_mode = 0;
     data->status = PBIO_UARTDEV_STATUS_SYNCING;
     // default max tacho rate for BOOST external motor since it is the only
@@ -891,8 +903,8 @@ static PT_THREAD(pbio_uartdev_update(uartdev_port_data_t * data)) {
     debug_pr("set baud: %" PRIu32 "\n", data->new_baud_rate);
 
     data->status = PBIO_UARTDEV_STATUS_DATA;
-    // reset data rx thread
-    PT_INIT(&data->data_pt);
+    // reset data rx parser
+    data->rx_msg_pos = 0;
 
     if (PBIO_IODEV_IS_FEEDBACK_MOTOR(&data->iodev)) {
         data->mode_combo_size = __builtin_popcount(data->info->mode_combos) + 2;
@@ -984,58 +996,74 @@ err:
     PT_END(&data->pt);
 }
 
-// REVISIT: This is not the greatest. We can easily get a buffer overrun and
-// loose data. For now, the retry after bad message size helps get back into
-// sync with the data stream.
-static PT_THREAD(pbio_uartdev_receive_data(uartdev_port_data_t * data)) {
+// Parses DATA messages from the bytes that have been received so far. Instead
+// of waiting for each header and each payload separately, this takes whatever
+// is in the UART receive buffer, so one wakeup can handle many messages. A
+// partial message is kept in rx_msg until the rest of it arrives.
+static void pbio_uartdev_receive_data(uartdev_port_data_t *data) {
     pbio_error_t err;
-
-    PT_BEGIN(&data->data_pt);
+    uint32_t count;
 
     while (true) {
-        PBIO_PT_WAIT_READY(&data->data_pt,
-            err = pbdrv_uart_read_begin(data->uart, data->rx_msg, 1, EV3_UART_IO_TIMEOUT));
-        if (err != PBIO_SUCCESS) {
-            DBG_ERR(data->last_err = "UART Rx data header begin error");
-            break;
-        }
-        PBIO_PT_WAIT_READY(&data->data_pt, err = pbdrv_uart_read_end(data->uart));
-        if (err != PBIO_SUCCESS) {
-            DBG_ERR(data->last_err = "UART Rx data header end error");
-            break;
-        }
+        if (data->rx_msg_pos == 0) {
+            err = pbdrv_uart_read_available(data->uart, data->rx_msg, 1, &count);
+            if (err != PBIO_SUCCESS || count == 0) {
+                break;
+            }
 
-        data->rx_msg_size = ev3_uart_get_msg_size(data->rx_msg[0]);
-        if (data->rx_msg_size < 3 || data->rx_msg_size > EV3_UART_MAX_MESSAGE_SIZE) {
-            DBG_ERR(data->last_err = "Bad data message size");
-            continue;
-        }
+            // If the header is not valid, skip it to get back into sync with
+            // the data stream.
+            data->rx_msg_size = ev3_uart_get_msg_size(data->rx_msg[0]);
+            if (data->rx_msg_size < 3 || data->rx_msg_size > EV3_UART_MAX_MESSAGE_SIZE) {
+                DBG_ERR(data->last_err = "Bad data message size");
+                continue;
+            }
 
-        uint8_t msg_type = data->rx_msg[0] & LUMP_MSG_TYPE_MASK;
-        uint8_t cmd = data->rx_msg[0] & LUMP_MSG_CMD_MASK;
-        if (msg_type != LUMP_MSG_TYPE_DATA && (msg_type != LUMP_MSG_TYPE_CMD ||
-                                               (cmd != LUMP_CMD_WRITE && cmd != LUMP_CMD_EXT_MODE))) {
-            DBG_ERR(data->last_err = "Bad msg type");
-            continue;
+            uint8_t msg_type = data->rx_msg[0] & LUMP_MSG_TYPE_MASK;
+            uint8_t cmd = data->rx_msg[0] & LUMP_MSG_CMD_MASK;
+            if (msg_type != LUMP_MSG_TYPE_DATA && (msg_type != LUMP_MSG_TYPE_CMD ||
+                                                   (cmd != LUMP_CMD_WRITE && cmd != LUMP_CMD_EXT_MODE))) {
+                DBG_ERR(data->last_err = "Bad msg type");
+                continue;
+            }
+
+            data->rx_msg_pos = 1;
         }
 
-        PBIO_PT_WAIT_READY(&data->data_pt,
-            err = pbdrv_uart_read_begin(data->uart, data->rx_msg + 1, data->rx_msg_size - 1, EV3_UART_IO_TIMEOUT));
+        err = pbdrv_uart_read_available(data->uart, data->rx_msg + data->rx_msg_pos,
+            data->rx_msg_size - data->rx_msg_pos, &count);
         if (err != PBIO_SUCCESS) {
-            DBG_ERR(data->last_err = "UART Rx data begin error");
             break;
         }
-        PBIO_PT_WAIT_READY(&data->data_pt, err = pbdrv_uart_read_end(data->uart));
-        if (err != PBIO_SUCCESS) {
-            DBG_ERR(data->last_err = "UART Rx data end error");
+        data->rx_msg_pos += count;
+        if (data->rx_msg_pos < data->rx_msg_size) {
+            // wait for the rest of the message
             break;
         }
 
         // at this point, we have a full data->msg that can be parsed
         pbio_uartdev_parse_msg(data);
+        data->rx_msg_pos = 0;
     }
+}
+
+// Sets up the payload of the WRITE command that makes the device send all
+// values of the given modes in a single DATA message.
+static void ev3_uart_set_combo_payload(uartdev_port_data_t *port_data, uint16_t modes) {
+    uint8_t size = 2;
 
-    PT_END(&data->data_pt);
+    for (uint8_t mode = 0; mode < 16; mode++) {
+        if (!(modes & (1 << mode))) {
+            continue;
+        }
+        for (uint8_t i = 0; i < port_data->info->mode_info[mode].num_values; i++) {
+            port_data->mode_combo_payload[size++] = mode << 4 | i; // mode, dataset
+        }
+    }
+
+    port_data->mode_combo_payload[0] = 0x20 | (size - 2); // mode combo command, x values
+    port_data->mode_combo_payload[1] = 0; // combo index
+    port_data->mode_combo_size = size;
 }
 
 static pbio_error_t ev3_uart_set_mode_begin(pbio_iodev_t *iodev, uint8_t mode) {
@@ -1047,11 +1075,21 @@ static pbio_error_t ev3_uart_set_mode_begin(pbio_iodev_t *iodev, uint8_t mode) {
         return PBIO_ERROR_NOT_SUPPORTED;
     }
 
-    err = ev3_uart_begin_tx_msg(port_data, LUMP_MSG_TYPE_CMD, LUMP_CMD_SELECT, &mode, 1);
+    if (mode == PBIO_IODEV_MODE_COMBO) {
+        ev3_uart_set_combo_payload(port_data, pbio_iodev_get_combo_modes(iodev));
+        err = ev3_uart_begin_tx_msg(port_data, LUMP_MSG_TYPE_CMD, LUMP_CMD_WRITE,
+            port_data->mode_combo_payload, port_data->mode_combo_size);
+    } else {
+        err = ev3_uart_begin_tx_msg(port_data, LUMP_MSG_TYPE_CMD, LUMP_CMD_SELECT, &mode, 1);
+    }
     if (err != PBIO_SUCCESS) {
         return err;
     }
 
+    // Selecting a mode ends combi-mode. Combi-mode starts again when the
+    // device echoes the mode combo command.
+    iodev->combo_modes = 0;
+
     port_data->new_mode = mode;
     port_data->mode_change_tx_done = false;
 
@@ -1077,7 +1115,12 @@ static pbio_error_t ev3_uart_set_mode_end(pbio_iodev_t *iodev) {
         return err;
     }
 
-    if (!port_data->data_rec || port_data->iodev.mode != port_data->new_mode) {
+    if (!port_data->data_rec) {
+        return PBIO_ERROR_AGAIN;
+    }
+
+    if (port_data->new_mode == PBIO_IODEV_MODE_COMBO ?
+        !port_data->iodev.combo_modes : port_data->iodev.mode != port_data->new_mode) {
         return PBIO_ERROR_AGAIN;
     }
 
@@ -32,3 +32,30 @@ void pbio_uuid128_reverse_copy(uint8_t *dst, const uint8_t *src) {
         dst[i] = src[15 - i];
     }
 }
+
+/**
+ * Updates a CRC32 with more data.
+ *
+ * This is the same CRC32 as used by zlib and Ethernet. It uses a small table
+ * with one entry per nibble, so it is reasonably fast without using much flash.
+ *
+ * @param [in]  crc     The CRC32 of the data so far, or 0 to start.
+ * @param [in]  data    The data.
+ * @param [in]  size    The size of @p data in bytes.
+ * @return              The CRC32 including @p data.
+ */
+uint32_t pbio_crc32(uint32_t crc, const uint8_t *data, uint32_t size) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+        0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+
+    crc = ~crc;
+    for (uint32_t i = 0; i < size; i++) {
+        crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0xf];
+        crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0xf];
+    }
+    return ~crc;
+}
@@ -14,17 +14,32 @@
 #include <lwrb/lwrb.h>
 
 #include <pbdrv/bluetooth.h>
+#include <pbio/download.h>
 #include <pbio/error.h>
 #include <pbio/event.h>
+#include <pbio/logger.h>
+#include <pbio/profiler.h>
 #include <pbio/protocol.h>
 #include <pbio/util.h>
 #include <pbsys/command.h>
 #include <pbsys/status.h>
 #include <pbsys/user_program.h>
 
-// REVISIT: this can be the negotiated MTU - 3 to allow for better throughput
+// Largest notification that any of the Bluetooth drivers can send
+#define MAX_NOTIFICATION_SIZE (158 - 3)
+
+// Largest notification this hub can send once the MTU has been negotiated
+#if PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS > 1
+// Drivers that can take several notifications at once are limited by how
+// much they can send per connection interval, so fill up to the negotiated MTU
+#define MAX_MTU_NOTIFICATION_SIZE MAX_NOTIFICATION_SIZE
+#else
+// Drivers that send one notification at a time only use the default MTU
+#define MAX_MTU_NOTIFICATION_SIZE 20
+#endif
+
 // max data size for Nordic UART characteristics
-#define NUS_CHAR_SIZE 20
+#define NUS_CHAR_SIZE MAX_MTU_NOTIFICATION_SIZE
 
 // Nordic UART Rx hook
 static pbsys_user_program_stdin_event_callback_t uart_rx_callback;
@@ -36,17 +51,54 @@ typedef struct {
     list_t queue;
     pbdrv_bluetooth_send_context_t context;
     bool is_queued;
-    uint8_t payload[NUS_CHAR_SIZE];
+    // large enough for the status events
+    uint8_t payload[PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS_SIZE];
 } send_msg_t;
 
+// Messages waiting to be sent
 LIST(send_queue);
-static bool send_busy;
+// Messages handed to the driver, in the order they will be done
+LIST(sent_queue);
+static uint8_t send_pending;
+
+// Stays in send_queue while there is UART data to send
+static send_msg_t uart_msg;
+
+typedef struct {
+    send_msg_t msg;
+    uint8_t payload[NUS_CHAR_SIZE];
+} uart_tx_msg_t;
+
+// Each pending send can be a UART notification, so we need this many buffers
+static uart_tx_msg_t uart_tx_msgs[PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS];
+
+// Maximum number of logs that can be streamed at the same time
+#define NUM_TELEMETRY_STREAMS 4
+
+// Rows logged within this interval are batched into as few notifications as possible
+#define TELEMETRY_INTERVAL_MS 50
+
+typedef struct {
+    pbio_log_t *log;
+    uint8_t id;
+} telemetry_stream_t;
+
+static telemetry_stream_t telemetry_streams[NUM_TELEMETRY_STREAMS];
+
+// Windowed program download on the Pybricks characteristic
+static pbio_download_t download;
+static send_msg_t download_status_msg;
+static bool download_status_changed;
+
+// Process run time statistics requested with PBIO_PYBRICKS_COMMAND_GET_PROFILE
+static bool profile_requested;
+static bool profile_reset;
 
 PROCESS(pbsys_bluetooth_process, "Bluetooth");
 
 /** Initializes Bluetooth. */
 void pbsys_bluetooth_init(void) {
-    static uint8_t uart_tx_buf[NUS_CHAR_SIZE * 2 + 1];
+    static uint8_t uart_tx_buf[NUS_CHAR_SIZE * (PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS + 1) + 1];
     static uint8_t uart_rx_buf[100 + 1]; // download chunk size
 
     lwrb_init(&uart_tx_ring, uart_tx_buf, PBIO_ARRAY_SIZE(uart_tx_buf));
@@ -112,8 +164,6 @@ pbio_error_t pbsys_bluetooth_rx(uint8_t *data, uint32_t *size) {
  *                          if this platform does not support Bluetooth.
  */
 pbio_error_t pbsys_bluetooth_tx(const uint8_t *data, uint32_t *size) {
-    static send_msg_t uart_msg;
-
     // make sure we have a Bluetooth connection
     if (!pbdrv_bluetooth_is_connected(PBDRV_BLUETOOTH_CONNECTION_UART)) {
         return PBIO_ERROR_INVALID_OP;
@@ -121,11 +171,9 @@ pbio_error_t pbsys_bluetooth_tx(const uint8_t *data, uint32_t *size) {
 
     // only allow one UART Tx message in the queue at a time
     if (!uart_msg.is_queued) {
-        // Setting data and size are deferred until we actually send the message.
+        // Reading the data is deferred until we actually send the message.
         // This way, if the caller is only writting one byte at a time, we can
         // still buffer data to send it more efficiently.
-        uart_msg.context.connection = PBDRV_BLUETOOTH_CONNECTION_UART;
-
         list_add(send_queue, &uart_msg);
         uart_msg.is_queued = true;
     }
@@ -141,9 +189,164 @@ pbio_error_t pbsys_bluetooth_tx(const uint8_t *data, uint32_t *size) {
     return PBIO_SUCCESS;
 }
 
+/**
+ * Starts sending the rows of a log as telemetry notifications on the Pybricks
+ * characteristic.
+ *
+ * The log should be started in ring mode. Sent rows are drained from it. Its
+ * sample divider sets the decimation of the stream.
+ *
+ * @param [in]  id      Identifier of the stream, included in each notification.
+ * @param [in]  log     The log. It must remain valid until the stream is stopped.
+ * @return              ::PBIO_SUCCESS if the stream was started,
+ *                      ::PBIO_ERROR_INVALID_ARG if one row of the log does
+ *                      not fit in a notification or ::PBIO_ERROR_BUSY if too
+ *                      many streams are active.
+ */
+pbio_error_t pbsys_bluetooth_telemetry_start(uint8_t id, pbio_log_t *log) {
+    telemetry_stream_t *free_stream = NULL;
+
+    if (PBIO_PYBRICKS_EVENT_TELEMETRY_HEADER_SIZE + sizeof(int32_t) * pbio_logger_cols(log) > MAX_MTU_NOTIFICATION_SIZE) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < NUM_TELEMETRY_STREAMS; i++) {
+        telemetry_stream_t *stream = &telemetry_streams[i];
+
+        // Restarting a stream just changes the identifier
+        if (stream->log == log) {
+            stream->id = id;
+            return PBIO_SUCCESS;
+        }
+
+        if (!stream->log && !free_stream) {
+            free_stream = stream;
+        }
+    }
+
+    if (!free_stream) {
+        return PBIO_ERROR_BUSY;
+    }
+
+    free_stream->id = id;
+    free_stream->log = log;
+
+    return PBIO_SUCCESS;
+}
+
+/**
+ * Stops sending telemetry for a log.
+ * @param [in]  log     The log or NULL to stop all streams.
+ */
+void pbsys_bluetooth_telemetry_stop(pbio_log_t *log) {
+    for (int i = 0; i < NUM_TELEMETRY_STREAMS; i++) {
+        if (!log || telemetry_streams[i].log == log) {
+            telemetry_streams[i].log = NULL;
+        }
+    }
+}
+
+/**
+ * Sets the buffer for windowed program downloads.
+ *
+ * Downloads are rejected until this is called, and after it is called with
+ * a NULL buffer. The status of the last download is kept in that case, since
+ * its final status event may not have been sent yet.
+ *
+ * @param [in]  buf         Buffer for the program or NULL.
+ * @param [in]  max_size    The size of @p buf.
+ */
+void pbsys_bluetooth_download_init(uint8_t *buf, uint32_t max_size) {
+    if (buf) {
+        pbio_download_init(&download, buf, max_size);
+    } else {
+        pbio_download_stop(&download);
+    }
+}
+
+/**
+ * Tests if a windowed program download is complete.
+ * @param [out] size    The size of the program.
+ * @return              True if the program is complete.
+ */
+bool pbsys_bluetooth_download_is_done(uint32_t *size) {
+    if (!pbio_download_is_done(&download)) {
+        return false;
+    }
+    *size = download.size;
+    return true;
+}
+
+/**
+ * Moves as many rows of a telemetry stream as fit into one notification.
+ * @param [in]  stream      The stream.
+ * @param [out] buf         Buffer of at least ::MAX_NOTIFICATION_SIZE bytes.
+ * @param [in, out] rows    Maximum number of rows to move. This is reduced by
+ *                          the number of rows that were actually moved.
+ * @return                  The size of the notification or 0 if there is nothing to send.
+ */
+static uint8_t pack_telemetry(telemetry_stream_t *stream, uint8_t *buf, uint32_t *rows) {
+    int32_t data[(MAX_NOTIFICATION_SIZE - PBIO_PYBRICKS_EVENT_TELEMETRY_HEADER_SIZE) / sizeof(int32_t)];
+
+    if (!stream->log || *rows == 0) {
+        return 0;
+    }
+
+    uint32_t size = pbdrv_bluetooth_get_max_notification_size();
+    if (size > MAX_NOTIFICATION_SIZE) {
+        size = MAX_NOTIFICATION_SIZE;
+    }
+
+    uint8_t num_values = pbio_logger_cols(stream->log);
+
+    // Rows may not fit until the MTU has been negotiated. Keep them in the
+    // log until then, so the stream resumes when the MTU has grown.
+    if (size < PBIO_PYBRICKS_EVENT_TELEMETRY_HEADER_SIZE + sizeof(int32_t) * num_values) {
+        return 0;
+    }
+
+    uint32_t max_rows = (size - PBIO_PYBRICKS_EVENT_TELEMETRY_HEADER_SIZE) / sizeof(int32_t) / num_values;
+    if (max_rows > *rows) {
+        max_rows = *rows;
+    }
+
+    uint8_t num_rows = pbio_logger_drain(stream->log, data, max_rows);
+    if (num_rows == 0) {
+        return 0;
+    }
+    *rows -= num_rows;
+
+    return pbio_pybricks_event_telemetry(buf, stream->id, num_values, num_rows, data);
+}
+
+// Queues the download status event. If it is already queued, it will include
+// the latest state when it is sent, so one event can report many blocks.
+static void queue_download_status(void) {
+    download_status_changed = true;
+    if (!download_status_msg.is_queued) {
+        download_status_msg.context.connection = PBDRV_BLUETOOTH_CONNECTION_PYBRICKS;
+        list_add(send_queue, &download_status_msg);
+        download_status_msg.is_queued = true;
+    }
+    process_poll(&pbsys_bluetooth_process);
+}
+
 static void handle_receive(pbdrv_bluetooth_connection_t connection, const uint8_t *data, uint8_t size) {
     if (connection == PBDRV_BLUETOOTH_CONNECTION_PYBRICKS) {
-        pbsys_command(data, size);
+        // Download commands are handled here since they need a reply
+        if (size && data[0] == PBIO_PYBRICKS_COMMAND_START_DOWNLOAD) {
+            pbio_download_start(&download, data, size);
+            queue_download_status();
+        } else if (size && data[0] == PBIO_PYBRICKS_COMMAND_WRITE_BLOCK) {
+            pbio_download_write_block(&download, data, size);
+            queue_download_status();
+        } else if (size && data[0] == PBIO_PYBRICKS_COMMAND_GET_PROFILE) {
+            profile_requested = true;
+            profile_reset = size > 1 && data[1];
+            process_poll(&pbsys_bluetooth_process);
+        } else {
+            pbsys_command(data, size);
+        }
     } else if (connection == PBDRV_BLUETOOTH_CONNECTION_UART) {
         // This will drop data if buffer is full
         if (uart_rx_callback) {
@@ -161,19 +364,72 @@ static void handle_receive(pbdrv_bluetooth_connection_t connection, const uint8_
 }
 
 static void send_done(void) {
-    send_msg_t *msg = list_pop(send_queue);
+    send_msg_t *msg = list_pop(sent_queue);
 
-    if (msg->context.connection == PBDRV_BLUETOOTH_CONNECTION_UART && lwrb_get_full(&uart_tx_ring)) {
-        // If there is more buffered data to send, put the message back in the queue
+    // Nothing to do if the queues were reset while the driver was busy
+    if (!msg) {
+        return;
+    }
+
+    if (msg == &download_status_msg && download_status_changed) {
+        // The status changed after this one was made, so send it again
         list_add(send_queue, msg);
     } else {
         msg->is_queued = false;
     }
 
-    send_busy = false;
+    send_pending--;
     process_poll(&pbsys_bluetooth_process);
 }
 
+// Hands queued messages to the driver until it can't take any more.
+static void send_queued(void) {
+    send_msg_t *msg;
+
+    while (send_pending < PBDRV_CONFIG_BLUETOOTH_MAX_PENDING_SENDS && (msg = list_head(send_queue))) {
+        if (msg == &uart_msg) {
+            if (!lwrb_get_full(&uart_tx_ring)) {
+                list_remove(send_queue, msg);
+                msg->is_queued = false;
+                continue;
+            }
+
+            // There are as many buffers as pending sends, so one is free
+            int i = 0;
+            while (uart_tx_msgs[i].msg.is_queued) {
+                i++;
+            }
+
+            uint32_t size = pbdrv_bluetooth_get_max_notification_size();
+            if (size > NUS_CHAR_SIZE) {
+                size = NUS_CHAR_SIZE;
+            }
+
+            // uart_msg stays in the queue until all buffered data is sent
+            msg = &uart_tx_msgs[i].msg;
+            msg->context.connection = PBDRV_BLUETOOTH_CONNECTION_UART;
+            msg->context.size = lwrb_read(&uart_tx_ring, uart_tx_msgs[i].payload, size);
+            msg->context.data = uart_tx_msgs[i].payload;
+            msg->is_queued = true;
+        } else {
+            list_remove(send_queue, msg);
+            if (msg == &download_status_msg) {
+                msg->context.size = pbio_pybricks_event_download_status(&msg->payload[0],
+                    download.status, download.base, download.received);
+                msg->context.data = &msg->payload[0];
+                download_status_changed = false;
+            }
+        }
+
+        msg->context.done = send_done;
+        list_add(sent_queue, msg);
+        send_pending++;
+
+        // This may call send_done() right away
+        pbdrv_bluetooth_send(&msg->context);
+    }
+}
+
 // drain all buffers and queues and reset global state
 static void reset_all(void) {
     send_msg_t *msg;
@@ -182,7 +438,11 @@ static void reset_all(void) {
         msg->is_queued = false;
     }
 
-    send_busy = false;
+    while ((msg = list_pop(sent_queue))) {
+        msg->is_queued = false;
+    }
+
+    send_pending = 0;
 
     lwrb_reset(&uart_rx_ring);
     lwrb_reset(&uart_tx_ring);
@@ -211,6 +471,7 @@ static PT_THREAD(pbsys_bluetooth_monitor_status(struct pt *pt)) {
 
         // send the message
         msg.context.size = pbio_pybricks_event_status_report(&msg.payload[0], new_status_flags);
+        msg.context.data = &msg.payload[0];
         msg.context.connection = PBDRV_BLUETOOTH_CONNECTION_PYBRICKS;
         list_add(send_queue, &msg);
         msg.is_queued = true;
@@ -225,9 +486,93 @@ static PT_THREAD(pbsys_bluetooth_monitor_status(struct pt *pt)) {
     PT_END(pt);
 }
 
+static PT_THREAD(pbsys_bluetooth_send_telemetry(struct pt *pt)) {
+    static struct etimer timer;
+    static send_msg_t msg;
+    static uint8_t payload[MAX_NOTIFICATION_SIZE];
+    static uint32_t rows;
+    static int i;
+
+    PT_BEGIN(pt);
+
+    etimer_set(&timer, TELEMETRY_INTERVAL_MS);
+
+    for (;;) {
+        PT_WAIT_UNTIL(pt, etimer_expired(&timer));
+
+        // Keep a fixed interval, regardless of how long sending took
+        etimer_reset(&timer);
+
+        for (i = 0; i < NUM_TELEMETRY_STREAMS; i++) {
+            if (!telemetry_streams[i].log) {
+                continue;
+            }
+
+            // Send the rows logged since the last interval, filling up each
+            // notification before starting the next one. Rows that are logged
+            // while sending are left for the next interval.
+            rows = pbio_logger_rows(telemetry_streams[i].log);
+            while ((msg.context.size = pack_telemetry(&telemetry_streams[i], payload, &rows))) {
+                msg.context.data = payload;
+                msg.context.connection = PBDRV_BLUETOOTH_CONNECTION_PYBRICKS;
+                list_add(send_queue, &msg);
+                msg.is_queued = true;
+
+                PT_WAIT_WHILE(pt, msg.is_queued);
+            }
+        }
+    }
+
+    PT_END(pt);
+}
+
+static PT_THREAD(pbsys_bluetooth_send_profile(struct pt *pt)) {
+    static send_msg_t msg;
+    static uint8_t payload[MAX_NOTIFICATION_SIZE];
+    static uint8_t i, num_processes;
+
+    PT_BEGIN(pt);
+
+    for (;;) {
+        PT_WAIT_UNTIL(pt, profile_requested);
+        profile_requested = false;
+
+        // Send one event per process. If there are none, a single event with
+        // zero processes is sent so the request always gets a reply.
+        num_processes = pbio_profiler_get_num_processes();
+        i = 0;
+        do {
+            pbio_profiler_stats_t stats = { 0 };
+            pbio_profiler_get_stats(i, &stats);
+
+            uint32_t size = pbdrv_bluetooth_get_max_notification_size();
+            if (size > MAX_NOTIFICATION_SIZE) {
+                size = MAX_NOTIFICATION_SIZE;
+            }
+
+            msg.context.size = pbio_pybricks_event_profile(payload, size, i, num_processes,
+                pbio_profiler_get_max_queue_depth(), stats.calls, stats.total_time, stats.max_time, stats.name);
+            msg.context.data = payload;
+            msg.context.connection = PBDRV_BLUETOOTH_CONNECTION_PYBRICKS;
+            list_add(send_queue, &msg);
+            msg.is_queued = true;
+
+            PT_WAIT_WHILE(pt, msg.is_queued);
+        } while (++i < num_processes);
+
+        if (profile_reset) {
+            pbio_profiler_reset();
+        }
+    }
+
+    PT_END(pt);
+}
+
 PROCESS_THREAD(pbsys_bluetooth_process, ev, data) {
     static struct etimer timer;
     static struct pt status_monitor_pt;
+    static struct pt telemetry_pt;
+    static struct pt profile_pt;
 
     PROCESS_BEGIN();
 
@@ -260,6 +605,8 @@ PROCESS_THREAD(pbsys_bluetooth_process, ev, data) {
         pbsys_status_clear(PBIO_PYBRICKS_STATUS_BLE_ADVERTISING);
 
         PT_INIT(&status_monitor_pt);
+        PT_INIT(&telemetry_pt);
+        PT_INIT(&profile_pt);
 
         while (pbdrv_bluetooth_is_connected(PBDRV_BLUETOOTH_CONNECTION_LE)
                && !pbsys_status_test(PBIO_PYBRICKS_STATUS_SHUTDOWN)) {
@@ -268,26 +615,17 @@ PROCESS_THREAD(pbsys_bluetooth_process, ev, data) {
                 // Since pbsys status events are broadcast to all processes, this
                 // will get triggered right away if there is a status change event.
                 pbsys_bluetooth_monitor_status(&status_monitor_pt);
+                pbsys_bluetooth_send_telemetry(&telemetry_pt);
+                pbsys_bluetooth_send_profile(&profile_pt);
             } else {
                 // REVISIT: this is probably a bit inefficient since it only
                 // needs to be called once each time notifications are enabled
                 PT_INIT(&status_monitor_pt);
+                PT_INIT(&telemetry_pt);
+                PT_INIT(&profile_pt);
             }
 
-            if (!send_busy) {
-                // msg is removed from queue in send_done callback rather than here
-                send_msg_t *msg = list_head(send_queue);
-                if (msg) {
-                    msg->context.done = send_done;
-                    if (msg->context.connection == PBDRV_BLUETOOTH_CONNECTION_UART) {
-                        msg->context.size = lwrb_read(&uart_tx_ring, &msg->payload[0], PBIO_ARRAY_SIZE(msg->payload));
-                        assert(msg->context.size);
-                    }
-                    msg->context.data = &msg->payload[0];
-                    send_busy = true;
-                    pbdrv_bluetooth_send(&msg->context);
-                }
-            }
+            send_queued();
 
             PROCESS_WAIT_EVENT();
         }
@@ -42,27 +42,47 @@ static pbio_error_t pbsys_hub_light_matrix_set_pixel(pbio_light_matrix_t *light_
     return PBIO_SUCCESS;
 }
 
+static void pbsys_hub_light_matrix_begin_frame(pbio_light_matrix_t *light_matrix) {
+    pbdrv_led_array_dev_t *array;
+    if (pbdrv_led_array_get_dev(0, &array) == PBIO_SUCCESS) {
+        pbdrv_led_array_begin_frame(array);
+    }
+}
+
+static void pbsys_hub_light_matrix_commit_frame(pbio_light_matrix_t *light_matrix) {
+    pbdrv_led_array_dev_t *array;
+    if (pbdrv_led_array_get_dev(0, &array) == PBIO_SUCCESS) {
+        pbdrv_led_array_commit_frame(array);
+    }
+}
+
 static const pbio_light_matrix_funcs_t pbsys_hub_light_matrix_funcs = {
     .set_pixel = pbsys_hub_light_matrix_set_pixel,
+    .begin_frame = pbsys_hub_light_matrix_begin_frame,
+    .commit_frame = pbsys_hub_light_matrix_commit_frame,
 };
 
 static void pbsys_hub_light_matrix_clear(void) {
     // turn of all pixels
+    pbsys_hub_light_matrix_begin_frame(pbsys_hub_light_matrix);
     for (uint8_t r = 0; r < pbsys_hub_light_matrix->size; r++) {
         for (uint8_t c = 0; c < pbsys_hub_light_matrix->size; c++) {
             pbsys_hub_light_matrix_set_pixel(pbsys_hub_light_matrix, r, c, 0);
         }
     }
+    pbsys_hub_light_matrix_commit_frame(pbsys_hub_light_matrix);
 }
 
 static void pbsys_hub_light_matrix_show_stop_sign(void) {
     // 3x3 "stop sign" at top center of light matrix
+    pbsys_hub_light_matrix_begin_frame(pbsys_hub_light_matrix);
     for (uint8_t r = 0; r < pbsys_hub_light_matrix->size; r++) {
         for (uint8_t c = 0; c < pbsys_hub_light_matrix->size; c++) {
             uint8_t brightness = r < 3 && c > 0 && c < 4 ? 100: 0;
             pbsys_hub_light_matrix_set_pixel(pbsys_hub_light_matrix, r, c, brightness);
         }
     }
+    pbsys_hub_light_matrix_commit_frame(pbsys_hub_light_matrix);
 }
 
 void pbsys_hub_light_matrix_init(void) {
@@ -80,6 +100,7 @@ static uint32_t pbsys_hub_light_matrix_user_program_animation_next(pbio_light_an
 
     pbdrv_led_array_dev_t *array;
     if (pbdrv_led_array_get_dev(0, &array) == PBIO_SUCCESS) {
+        pbdrv_led_array_begin_frame(array);
         for (int i = 0; i < PBIO_ARRAY_SIZE(indexes); i++) {
             // The pixels are spread equally across the pattern.
             uint8_t offset = cycle + i * (UINT8_MAX / PBIO_ARRAY_SIZE(indexes));
@@ -88,6 +109,7 @@ static uint32_t pbsys_hub_light_matrix_user_program_animation_next(pbio_light_an
             // Set the brightness for this pixel
             pbdrv_led_array_set_brightness(array, indexes[i], brightness);
         }
+        pbdrv_led_array_commit_frame(array);
         // This increment controls the speed of the pattern
         cycle += 9;
     }
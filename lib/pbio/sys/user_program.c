@@ -43,6 +43,7 @@ void pbsys_user_program_unprepare(void) {
     user_stop_func = NULL;
     stop_buttons = PBIO_BUTTON_CENTER;
     pbsys_bluetooth_rx_set_callback(NULL);
+    pbsys_bluetooth_telemetry_stop(NULL);
 }
 
 /**
@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Closed-loop benchmark of the motor control loop.
+//
+// This runs the same updates as pbio_motor_process against simulated motors
+// for a given number of simulated seconds. It reports the host CPU time spent
+// per control cycle and the RMS error between the reference trajectories and
+// the true motor positions, and compares the drive base pose to odometry
+// from the true motor positions in double precision.
+//
+// Usage: bench-pbio [seconds]
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <fixmath.h>
+
+#include <pbdrv/clock.h>
+#include <pbdrv/counter.h>
+#include <pbio/battery.h>
+#include <pbio/control.h>
+#include <pbio/dcmotor.h>
+#include <pbio/drivebase.h>
+#include <pbio/servo.h>
+#include <pbio/util.h>
+
+#include "../../drv/counter/counter.h"
+#include "motor_sim.h"
+
+#define BENCH_DEFAULT_DURATION_S (60)
+
+// Accumulated tracking error of one controller.
+typedef struct {
+    const char *name;
+    uint32_t samples;
+    double sum_sq;
+    int32_t max;
+} bench_error_t;
+
+static void bench_error_add(bench_error_t *e, int32_t err) {
+    e->samples++;
+    e->sum_sq += (double)err * err;
+    if (abs(err) > e->max) {
+        e->max = abs(err);
+    }
+}
+
+static void bench_error_print(bench_error_t *e) {
+    printf("%-24s rms error %8.2f counts, max %6" PRId32 " counts (%" PRIu32 " samples)\n",
+        e->name, e->samples ? sqrt(e->sum_sq / e->samples) : 0.0, e->max, e->samples);
+}
+
+// Samples the reference of an active controller and compares it to count.
+static void bench_error_sample(bench_error_t *e, pbio_control_t *ctl, int32_t count) {
+    if (!pbio_control_is_active(ctl)) {
+        return;
+    }
+    pbio_trajectory_reference_t ref;
+    pbio_trajectory_get_reference(&ctl->trajectory, pbio_control_get_ref_time(ctl, pbdrv_clock_get_us()), &ref);
+    bench_error_add(e, ref.count - count);
+}
+
+// Drive base geometry in mm
+#define BENCH_WHEEL_DIAMETER (56)
+#define BENCH_AXLE_TRACK (112)
+
+// Double precision odometry from the true motor positions.
+typedef struct {
+    int32_t left;
+    int32_t right;
+    double x;
+    double y;
+    double max_error;
+} bench_pose_t;
+
+// Moves the reference pose along an arc to the new motor positions and
+// compares it to the drive base pose.
+static void bench_pose_update(bench_pose_t *p, pbio_drivebase_t *db, int32_t left, int32_t right) {
+    double heading = (p->left - p->right) * (double)BENCH_WHEEL_DIAMETER / (2 * BENCH_AXLE_TRACK) * M_PI / 180;
+    double distance = ((left + right) - (p->left + p->right)) / 2.0 * M_PI * BENCH_WHEEL_DIAMETER / 360;
+    double turn = ((left - right) - (p->left - p->right)) * (double)BENCH_WHEEL_DIAMETER / (2 * BENCH_AXLE_TRACK) * M_PI / 180;
+    double chord = turn == 0 ? distance : distance * sin(turn / 2) / (turn / 2);
+
+    p->x += chord * cos(heading + turn / 2);
+    p->y += chord * sin(heading + turn / 2);
+    p->left = left;
+    p->right = right;
+
+    int32_t x, y, angle;
+    pbio_drivebase_get_pose_user(db, &x, &y, &angle);
+    double error = hypot(x - p->x, y - p->y);
+    if (error > p->max_error) {
+        p->max_error = error;
+    }
+}
+
+static void bench_abort(const char *what, pbio_error_t err) {
+    fprintf(stderr, "%s failed: %d\n", what, err);
+    exit(EXIT_FAILURE);
+}
+
+static int64_t bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    pbio_error_t err;
+
+    int32_t duration_s = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_DURATION_S;
+    if (duration_s <= 0) {
+        fprintf(stderr, "usage: %s [seconds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Drive base on A and B, a positioning servo on C, and a speed controlled
+    // servo on D.
+    pbio_test_motor_sim_attach(PBIO_PORT_ID_A, PBIO_IODEV_TYPE_ID_SPIKE_M_MOTOR);
+    pbio_test_motor_sim_attach(PBIO_PORT_ID_B, PBIO_IODEV_TYPE_ID_SPIKE_M_MOTOR);
+    pbio_test_motor_sim_attach(PBIO_PORT_ID_C, PBIO_IODEV_TYPE_ID_SPIKE_L_MOTOR);
+    pbio_test_motor_sim_attach(PBIO_PORT_ID_D, PBIO_IODEV_TYPE_ID_INTERACTIVE_MOTOR);
+
+    pbdrv_counter_init();
+    pbio_battery_init();
+    pbio_dcmotor_stop_all(true);
+
+    pbio_servo_t *srv[PBDRV_CONFIG_NUM_MOTOR_CONTROLLER];
+    for (uint8_t i = 0; i < PBDRV_CONFIG_NUM_MOTOR_CONTROLLER; i++) {
+        err = pbio_servo_get_servo(PBDRV_CONFIG_FIRST_MOTOR_PORT + i, &srv[i]);
+        if (err != PBIO_SUCCESS) {
+            bench_abort("pbio_servo_get_servo", err);
+        }
+        err = pbio_servo_setup(srv[i], PBIO_DIRECTION_CLOCKWISE, fix16_one, true);
+        if (err != PBIO_SUCCESS) {
+            bench_abort("pbio_servo_setup", err);
+        }
+    }
+
+    pbio_drivebase_t *db;
+    err = pbio_drivebase_get_drivebase(&db, srv[0], srv[1], fix16_from_int(BENCH_WHEEL_DIAMETER), fix16_from_int(BENCH_AXLE_TRACK));
+    if (err != PBIO_SUCCESS) {
+        bench_abort("pbio_drivebase_get_drivebase", err);
+    }
+
+    bench_error_t err_distance = { .name = "drivebase distance" };
+    bench_error_t err_heading = { .name = "drivebase heading" };
+    bench_error_t err_target = { .name = "servo C run_target" };
+    bench_error_t err_timed = { .name = "servo D run_time" };
+    bench_pose_t pose = {
+        .left = pbio_test_motor_sim_get_count(PBIO_PORT_ID_A),
+        .right = pbio_test_motor_sim_get_count(PBIO_PORT_ID_B),
+    };
+
+    static const int32_t targets[] = { 360, -90, 720, 0, 45, -180 };
+    uint32_t target_index = 0;
+    uint32_t timed_index = 0;
+    uint32_t drive_index = 0;
+
+    uint32_t cycles = 0;
+    int64_t cpu_ns = 0;
+    int64_t cpu_ns_max = 0;
+
+    while (pbdrv_clock_get_ms() < (uint32_t)duration_s * MS_PER_SECOND) {
+
+        // Give new commands as soon as the previous ones complete.
+        if (!pbio_drivebase_is_busy(db)) {
+            err = drive_index++ % 2 ?
+                pbio_drivebase_drive_curve(db, 0, 90, 200, 180, PBIO_ACTUATION_HOLD) :
+                pbio_drivebase_drive_curve(db, PBIO_RADIUS_INF, 300, 200, 180, PBIO_ACTUATION_HOLD);
+            if (err != PBIO_SUCCESS) {
+                bench_abort("pbio_drivebase_drive_curve", err);
+            }
+        }
+        if (pbio_control_is_done(&srv[2]->control)) {
+            err = pbio_servo_run_target(srv[2], 500, targets[target_index++ % PBIO_ARRAY_SIZE(targets)], PBIO_ACTUATION_HOLD);
+            if (err != PBIO_SUCCESS) {
+                bench_abort("pbio_servo_run_target", err);
+            }
+        }
+        if (pbio_control_is_done(&srv[3]->control)) {
+            err = pbio_servo_run_time(srv[3], timed_index++ % 2 ? -300 : 800, 1500, PBIO_ACTUATION_BRAKE);
+            if (err != PBIO_SUCCESS) {
+                bench_abort("pbio_servo_run_time", err);
+            }
+        }
+
+        // This is the same sequence of updates as in pbio_motor_process.
+        int64_t start = bench_now_ns();
+        pbio_battery_update();
+        pbio_drivebase_update_all();
+        pbio_servo_update_all();
+        int64_t elapsed = bench_now_ns() - start;
+
+        cpu_ns += elapsed;
+        if (elapsed > cpu_ns_max) {
+            cpu_ns_max = elapsed;
+        }
+        cycles++;
+
+        // The pose is updated with the motor positions at this time.
+        bench_pose_update(&pose, db, pbio_test_motor_sim_get_count(PBIO_PORT_ID_A), pbio_test_motor_sim_get_count(PBIO_PORT_ID_B));
+
+        // Let the motors respond until the next control update.
+        pbio_test_motor_sim_run(PBIO_CONTROL_LOOP_TIME_MS * US_PER_MS);
+
+        // Compare the true motor positions to the references at the sample time.
+        int32_t count_left = pbio_test_motor_sim_get_count(PBIO_PORT_ID_A);
+        int32_t count_right = pbio_test_motor_sim_get_count(PBIO_PORT_ID_B);
+        bench_error_sample(&err_distance, &db->control_distance, count_left + count_right);
+        bench_error_sample(&err_heading, &db->control_heading, count_left - count_right);
+        bench_error_sample(&err_target, &srv[2]->control, pbio_test_motor_sim_get_count(PBIO_PORT_ID_C));
+        bench_error_sample(&err_timed, &srv[3]->control, pbio_test_motor_sim_get_count(PBIO_PORT_ID_D));
+    }
+
+    printf("simulated %" PRId32 " s, %" PRIu32 " control cycles of %d ms\n", duration_s, cycles, PBIO_CONTROL_LOOP_TIME_MS);
+    printf("%-24s %8.1f ns/cycle, max %" PRId64 " ns\n", "cpu time", (double)cpu_ns / cycles, cpu_ns_max);
+    bench_error_print(&err_distance);
+    bench_error_print(&err_heading);
+    bench_error_print(&err_target);
+    bench_error_print(&err_timed);
+
+    int32_t x, y, heading;
+    pbio_drivebase_get_pose_user(db, &x, &y, &heading);
+    printf("%-24s x %" PRId32 " mm, y %" PRId32 " mm, heading %" PRId32 " deg, reference x %.1f mm, y %.1f mm\n",
+        "drivebase pose", x, y, heading, pose.x, pose.y);
+    printf("%-24s max %.2f mm\n", "drivebase pose error", pose.max_error);
+
+    return EXIT_SUCCESS;
+}
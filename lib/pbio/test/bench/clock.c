@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Simulated clock for the motor benchmark. Time only advances when the motor
+// simulator integrates the plant, so results do not depend on the host speed.
+
+#include <stdint.h>
+
+#include <pbdrv/clock.h>
+
+#include "motor_sim.h"
+
+static uint32_t clock_us;
+
+/**
+ * Advances the simulated clock.
+ * @param [in]  us      The number of microseconds to add to the clock.
+ */
+void pbio_test_clock_tick_us(uint32_t us) {
+    clock_us += us;
+}
+
+uint32_t pbdrv_clock_get_ms(void) {
+    return clock_us / 1000;
+}
+
+uint32_t pbdrv_clock_get_us(void) {
+    return clock_us;
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Simulated DC motors that implement the motor and counter drivers.
+//
+// Each plant is a rigid DC motor with back EMF and Coulomb friction:
+//
+//     J * dw/dt = k_0 * (V - k_2 * w) - f_low * sign(w)
+//
+// where J = k_0 * k_1. The constants come from the same observer settings
+// table that the servo uses, so the controller runs against the motor model it
+// was tuned for. When coasting, the windings are open so there is no electrical
+// torque at all. The state is integrated with a much smaller time step than the
+// control loop period.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <pbdrv/battery.h>
+#include <pbdrv/config.h>
+#include <pbdrv/counter.h>
+#include <pbdrv/motor.h>
+#include <pbio/control.h>
+#include <pbio/error.h>
+#include <pbio/observer.h>
+#include <pbio/servo.h>
+
+#include "../../drv/counter/counter.h"
+#include "motor_sim.h"
+
+typedef struct {
+    bool attached;
+    bool coasting;
+    pbio_iodev_type_id_t id;
+    int16_t duty_cycle;
+    double k_0;
+    double k_1;
+    double k_2;
+    double f_low;
+    double angle;
+    double speed;
+} motor_sim_t;
+
+static motor_sim_t motor_sims[PBDRV_CONFIG_NUM_MOTOR_CONTROLLER];
+
+static motor_sim_t *motor_sim_get(pbio_port_id_t port) {
+    if (port < PBDRV_CONFIG_FIRST_MOTOR_PORT || port > PBDRV_CONFIG_LAST_MOTOR_PORT) {
+        return NULL;
+    }
+    return &motor_sims[port - PBDRV_CONFIG_FIRST_MOTOR_PORT];
+}
+
+/**
+ * Connects a simulated motor to a port.
+ * @param [in]  port    The motor port
+ * @param [in]  id      The motor type, used to look up its model parameters
+ * @return              ::PBIO_SUCCESS on success, ::PBIO_ERROR_INVALID_PORT
+ *                      for a bad port or ::PBIO_ERROR_NOT_SUPPORTED if there
+ *                      are no settings for this motor type.
+ */
+pbio_error_t pbio_test_motor_sim_attach(pbio_port_id_t port, pbio_iodev_type_id_t id) {
+    motor_sim_t *sim = motor_sim_get(port);
+    if (!sim) {
+        return PBIO_ERROR_INVALID_PORT;
+    }
+
+    pbio_control_settings_t control_settings;
+    const pbio_observer_settings_t *s;
+    pbio_error_t err = pbio_servo_load_settings(&control_settings, &s, id);
+    if (err != PBIO_SUCCESS) {
+        return err;
+    }
+
+    // Undo the fixed point scaling, if any. For floating point builds, these
+    // scalars are all 1.
+    sim->k_0 = (double)s->k_0 / PBIO_OBSERVER_SCALE_HIGH;
+    sim->k_1 = (double)s->k_1 / PBIO_OBSERVER_SCALE_HIGH;
+    sim->k_2 = (double)s->k_2 / PBIO_OBSERVER_SCALE_HIGH;
+    sim->f_low = (double)s->f_low / PBIO_OBSERVER_SCALE_TRQ;
+
+    sim->id = id;
+    sim->coasting = true;
+    sim->duty_cycle = 0;
+    sim->angle = 0;
+    sim->speed = 0;
+    sim->attached = true;
+
+    return PBIO_SUCCESS;
+}
+
+static void motor_sim_step(motor_sim_t *sim, double dt) {
+
+    // Electrical torque, including back EMF, unless the windings are open.
+    double torque = 0;
+    if (!sim->coasting) {
+        double voltage = (double)sim->duty_cycle * PBIO_TEST_MOTOR_SIM_BATTERY_MV / PBDRV_MAX_DUTY / 1000;
+        torque = sim->k_0 * (voltage - sim->k_2 * sim->speed);
+    }
+
+    // Static friction holds the motor if it can overcome the applied torque.
+    if (sim->speed == 0 && fabs(torque) <= sim->f_low) {
+        return;
+    }
+
+    double inertia = sim->k_0 * sim->k_1;
+    double friction = sim->speed != 0 ? copysign(sim->f_low, sim->speed) : copysign(sim->f_low, torque);
+    double speed_next = sim->speed + (torque - friction) / inertia * dt;
+
+    // Friction can stop the motor, but not make it change direction.
+    if (sim->speed != 0 && (speed_next < 0) != (sim->speed < 0) && fabs(torque) <= sim->f_low) {
+        speed_next = 0;
+    }
+
+    sim->angle += (sim->speed + speed_next) / 2 * dt;
+    sim->speed = speed_next;
+}
+
+/**
+ * Integrates all motor models and advances the simulated clock accordingly.
+ * @param [in]  duration_us     How long to simulate.
+ */
+void pbio_test_motor_sim_run(uint32_t duration_us) {
+    for (uint32_t t = 0; t < duration_us; t += PBIO_TEST_MOTOR_SIM_STEP_US) {
+        for (uint8_t i = 0; i < PBDRV_CONFIG_NUM_MOTOR_CONTROLLER; i++) {
+            if (motor_sims[i].attached) {
+                motor_sim_step(&motor_sims[i], PBIO_TEST_MOTOR_SIM_STEP_US / 1e6);
+            }
+        }
+        pbio_test_clock_tick_us(PBIO_TEST_MOTOR_SIM_STEP_US);
+    }
+}
+
+/**
+ * Gets the true (not measured) angle of a simulated motor.
+ * @param [in]  port    The motor port
+ * @return              The angle in encoder counts.
+ */
+int32_t pbio_test_motor_sim_get_count(pbio_port_id_t port) {
+    return (int32_t)lround(motor_sim_get(port)->angle);
+}
+
+// Battery driver implementation
+
+pbio_error_t pbdrv_battery_get_voltage_now(uint16_t *value) {
+    *value = PBIO_TEST_MOTOR_SIM_BATTERY_MV;
+    return PBIO_SUCCESS;
+}
+
+// Motor driver implementation
+
+pbio_error_t pbdrv_motor_coast(pbio_port_id_t port) {
+    motor_sim_t *sim = motor_sim_get(port);
+    if (!sim) {
+        return PBIO_ERROR_INVALID_PORT;
+    }
+    if (!sim->attached) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    sim->coasting = true;
+    sim->duty_cycle = 0;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_motor_set_duty_cycle(pbio_port_id_t port, int16_t duty_cycle) {
+    motor_sim_t *sim = motor_sim_get(port);
+    if (!sim) {
+        return PBIO_ERROR_INVALID_PORT;
+    }
+    if (!sim->attached) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    if (duty_cycle < -PBDRV_MAX_DUTY || duty_cycle > PBDRV_MAX_DUTY) {
+        return PBIO_ERROR_INVALID_ARG;
+    }
+    sim->coasting = false;
+    sim->duty_cycle = duty_cycle;
+    return PBIO_SUCCESS;
+}
+
+pbio_error_t pbdrv_motor_get_id(pbio_port_id_t port, pbio_iodev_type_id_t *id) {
+    motor_sim_t *sim = motor_sim_get(port);
+    if (!sim) {
+        return PBIO_ERROR_INVALID_PORT;
+    }
+    if (!sim->attached) {
+        return PBIO_ERROR_NO_DEV;
+    }
+    *id = sim->id;
+    return PBIO_SUCCESS;
+}
+
+// Counter driver implementation. Like real encoders, these report whole counts.
+
+static pbio_error_t motor_sim_get_count(pbdrv_counter_dev_t *dev, int32_t *count) {
+    motor_sim_t *sim = dev->priv;
+    *count = (int32_t)floor(sim->angle);
+    return PBIO_SUCCESS;
+}
+
+static pbio_error_t motor_sim_get_rate(pbdrv_counter_dev_t *dev, int32_t *rate) {
+    motor_sim_t *sim = dev->priv;
+    *rate = (int32_t)sim->speed;
+    return PBIO_SUCCESS;
+}
+
+static const pbdrv_counter_funcs_t motor_sim_counter_funcs = {
+    .get_count = motor_sim_get_count,
+    .get_rate = motor_sim_get_rate,
+};
+
+void pbdrv_counter_test_init(pbdrv_counter_dev_t *devs) {
+    for (uint8_t i = 0; i < PBDRV_CONFIG_NUM_MOTOR_CONTROLLER; i++) {
+        devs[i].funcs = &motor_sim_counter_funcs;
+        devs[i].priv = &motor_sims[i];
+    }
+}
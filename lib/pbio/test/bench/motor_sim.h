@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Simulated DC motor plants for benchmarking the motor control loop.
+
+#ifndef _PBIO_TEST_MOTOR_SIM_H_
+#define _PBIO_TEST_MOTOR_SIM_H_
+
+#include <stdint.h>
+
+#include <pbio/error.h>
+#include <pbio/iodev.h>
+#include <pbio/port.h>
+
+// Integration step of the motor model
+#define PBIO_TEST_MOTOR_SIM_STEP_US (50)
+
+// Simulated battery voltage
+#define PBIO_TEST_MOTOR_SIM_BATTERY_MV (7200)
+
+void pbio_test_clock_tick_us(uint32_t us);
+
+pbio_error_t pbio_test_motor_sim_attach(pbio_port_id_t port, pbio_iodev_type_id_t id);
+void pbio_test_motor_sim_run(uint32_t duration_us);
+int32_t pbio_test_motor_sim_get_count(pbio_port_id_t port);
+
+#endif // _PBIO_TEST_MOTOR_SIM_H_
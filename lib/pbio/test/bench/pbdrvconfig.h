@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Driver configuration for the closed-loop motor benchmark. Each motor port
+// is backed by a simulated motor plant (see motor_sim.c).
+
+#define PBDRV_CONFIG_BATTERY                        (1)
+
+#define PBDRV_CONFIG_COUNTER                        (1)
+#define PBDRV_CONFIG_COUNTER_NUM_DEV                (4)
+#define PBDRV_CONFIG_COUNTER_TEST                   (1)
+
+#define PBDRV_CONFIG_MOTOR                          (1)
+#define PBDRV_CONFIG_HAS_PORT_A                     (1)
+#define PBDRV_CONFIG_HAS_PORT_B                     (1)
+#define PBDRV_CONFIG_HAS_PORT_C                     (1)
+#define PBDRV_CONFIG_HAS_PORT_D                     (1)
+#define PBDRV_CONFIG_FIRST_MOTOR_PORT               PBIO_PORT_ID_A
+#define PBDRV_CONFIG_LAST_MOTOR_PORT                PBIO_PORT_ID_D
+#define PBDRV_CONFIG_NUM_MOTOR_CONTROLLER           (4)
@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#define PBIO_CONFIG_DCMOTOR                 (1)
+#define PBIO_CONFIG_LOGGER                  (1)
+#define PBIO_CONFIG_TACHO                   (1)
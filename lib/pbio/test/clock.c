@@ -29,3 +29,11 @@ uint32_t pbdrv_clock_get_ms(void) {
 uint32_t pbdrv_clock_get_us(void) {
     return clock_ticks * 1000;
 }
+
+uint32_t pbdrv_clock_get_cycles(void) {
+    return clock_ticks * 1000;
+}
+
+uint32_t pbdrv_clock_get_cycles_per_us(void) {
+    return 1;
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Tests for the TI BLE stack commands used by the CC2640 Bluetooth driver.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <test-pbio.h>
+
+#include "../../../ble5stack/central/att.h"
+#include "../../../ble5stack/central/hci_tl.h"
+
+static uint16_t sent_opcode;
+static uint8_t sent_data[TX_BUFFER_SIZE];
+static uint8_t sent_size;
+static uint32_t sent_count;
+
+// Takes the place of the CC2640 driver, which sends the command over SPI
+HCI_StatusCodes_t HCI_sendHCICommand(uint16_t opcode, uint8_t *pData, uint8_t dataLength) {
+    sent_opcode = opcode;
+    memcpy(sent_data, pData, dataLength);
+    sent_size = dataLength;
+    sent_count++;
+    return bleSUCCESS;
+}
+
+static void test_att_handle_value_noti(void *env) {
+    static uint8_t value[ATT_MAX_MTU_SIZE - 3 + 1];
+    attHandleValueNoti_t req;
+
+    for (int i = 0; i < sizeof(value); i++) {
+        value[i] = i;
+    }
+
+    req.handle = 0x1234;
+    req.pValue = value;
+
+    // notifications larger than the default MTU are sent in one command
+    sent_count = 0;
+    req.len = ATT_MAX_MTU_SIZE - 3;
+    tt_want_uint_op(ATT_HandleValueNoti(0x0001, &req), ==, bleSUCCESS);
+    tt_want_uint_op(sent_count, ==, 1);
+    tt_want_uint_op(sent_opcode, ==, ATT_CMD_HANDLE_VALUE_NOTI);
+    tt_want_uint_op(sent_size, ==, 5 + ATT_MAX_MTU_SIZE - 3);
+    tt_want_uint_op(sent_data[0], ==, 0x01);
+    tt_want_uint_op(sent_data[1], ==, 0x00);
+    tt_want_uint_op(sent_data[3], ==, 0x34);
+    tt_want_uint_op(sent_data[4], ==, 0x12);
+    tt_want(memcmp(&sent_data[5], value, ATT_MAX_MTU_SIZE - 3) == 0);
+
+    // notifications that don't fit in the largest MTU are not sent
+    sent_count = 0;
+    req.len = ATT_MAX_MTU_SIZE - 3 + 1;
+    tt_want_uint_op(ATT_HandleValueNoti(0x0001, &req), ==, bleInvalidRange);
+    tt_want_uint_op(sent_count, ==, 0);
+}
+
+struct testcase_t pbdrv_bluetooth_cc2640_tests[] = {
+    PBIO_TEST(test_att_handle_value_noti),
+    END_OF_TESTCASES
+};
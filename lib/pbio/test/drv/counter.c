@@ -80,6 +80,11 @@ static void test_counter_get(void *env) {
     pbdrv_counter_init();
     tt_want(pbdrv_counter_get_dev(0, &dev) == PBIO_SUCCESS);
     tt_want(dev->priv == &test_private_data);
+
+    // optional function not implemented by this driver
+    int32_t rate;
+    uint8_t confidence;
+    tt_want(pbdrv_counter_get_rate_confidence(dev, &rate, &confidence) == PBIO_ERROR_NOT_SUPPORTED);
 }
 
 struct testcase_t pbdrv_counter_tests[] = {
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#include <stdint.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <test-pbio.h>
+
+#include "../drv/counter/counter_rate.h"
+
+// Adds num edges that are period ticks and counts apart, starting one period
+// after the given time and count. Returns the time of the last edge.
+static uint32_t add_edges(pbdrv_counter_rate_t *est, int32_t *count, uint32_t time, uint32_t period, int32_t counts, int num) {
+    for (int i = 0; i < num; i++) {
+        time += period;
+        *count += counts;
+        pbdrv_counter_rate_add_edge(est, *count, time);
+    }
+    return time;
+}
+
+static void test_counter_rate(void *env) {
+    pbdrv_counter_rate_t est;
+    int32_t rate, count = 0;
+    uint8_t confidence;
+    uint32_t time;
+
+    // No edges, so we don't know the rate
+    pbdrv_counter_rate_reset(&est);
+    pbdrv_counter_rate_get(&est, 1000, &rate, &confidence);
+    tt_want_int_op(rate, ==, 0);
+    tt_want_uint_op(confidence, ==, 0);
+
+    // One edge is not enough either
+    time = add_edges(&est, &count, 0, 1000, 2, 1);
+    pbdrv_counter_rate_get(&est, time, &rate, &confidence);
+    tt_want_int_op(rate, ==, 0);
+    tt_want_uint_op(confidence, ==, 0);
+
+    // Two counts per edge and an edge every 10 ms is 200 counts per second
+    time = add_edges(&est, &count, time, 1000, 2, 1);
+    pbdrv_counter_rate_get(&est, time + 500, &rate, &confidence);
+    tt_want_int_op(rate, ==, 200);
+    tt_want_uint_op(confidence, ==, 100);
+
+    // Same with more edges, now using the fit
+    time = add_edges(&est, &count, time, 1000, 2, 10);
+    pbdrv_counter_rate_get(&est, time + 500, &rate, &confidence);
+    tt_want_int_op(rate, ==, 200);
+    tt_want_uint_op(confidence, ==, 100);
+
+    // If the next edge is late, the rate can't be more than one edge in the
+    // time since the last edge, allowing for uneven slots
+    pbdrv_counter_rate_get(&est, time + 1250, &rate, &confidence);
+    tt_want_int_op(rate, ==, 200);
+    tt_want_uint_op(confidence, ==, 100);
+    pbdrv_counter_rate_get(&est, time + 2500, &rate, &confidence);
+    tt_want_int_op(rate, ==, 100);
+    tt_want_uint_op(confidence, ==, 50);
+
+    // After the timeout, we are not moving
+    pbdrv_counter_rate_get(&est, time + PBDRV_COUNTER_RATE_TIMEOUT + 1, &rate, &confidence);
+    tt_want_int_op(rate, ==, 0);
+    tt_want_uint_op(confidence, ==, 100);
+
+    // The first edge after stopping does not give a rate
+    time = add_edges(&est, &count, time, 50000, 2, 1);
+    pbdrv_counter_rate_get(&est, time, &rate, &confidence);
+    tt_want_int_op(rate, ==, 0);
+    tt_want_uint_op(confidence, ==, 0);
+
+    // Slow, so there are only a few edges in the window
+    time = add_edges(&est, &count, time, 5000, 2, 3);
+    pbdrv_counter_rate_get(&est, time, &rate, &confidence);
+    tt_want_int_op(rate, ==, 40);
+    tt_want_uint_op(confidence, ==, 100);
+
+    // Reverse
+    time = add_edges(&est, &count, time, 1000, -2, 8);
+    pbdrv_counter_rate_get(&est, time + 100, &rate, &confidence);
+    tt_want_int_op(rate, ==, -200);
+    tt_want_uint_op(confidence, ==, 100);
+    pbdrv_counter_rate_get(&est, time + 5000, &rate, &confidence);
+    tt_want_int_op(rate, ==, -50);
+    tt_want_uint_op(confidence, ==, 25);
+
+    // An edge that happened after the current time was read
+    pbdrv_counter_rate_get(&est, time - 1, &rate, &confidence);
+    tt_want_int_op(rate, ==, -200);
+    tt_want_uint_op(confidence, ==, 100);
+
+    // Timer wraps around
+    pbdrv_counter_rate_reset(&est);
+    time = add_edges(&est, &count, UINT32_MAX - 3500, 1000, 2, 8);
+    pbdrv_counter_rate_get(&est, time + 500, &rate, &confidence);
+    tt_want_int_op(rate, ==, 200);
+    tt_want_uint_op(confidence, ==, 100);
+
+    // Uneven edges are averaged by the fit
+    pbdrv_counter_rate_reset(&est);
+    time = 0;
+    for (int i = 0; i < 8; i++) {
+        time = add_edges(&est, &count, time, i & 1 ? 900 : 1100, 2, 1);
+    }
+    pbdrv_counter_rate_get(&est, time, &rate, &confidence);
+    tt_want_int_op(rate, >=, 195);
+    tt_want_int_op(rate, <=, 205);
+}
+
+struct testcase_t pbdrv_counter_rate_tests[] = {
+    PBIO_TEST(test_counter_rate),
+    END_OF_TESTCASES
+};
@@ -2,6 +2,7 @@
 // Copyright (c) 2020-2021 The Pybricks Authors
 
 #include <stdio.h>
+#include <string.h>
 
 #include <tinytest.h>
 #include <tinytest_macros.h>
@@ -11,26 +12,56 @@
 #include <test-pbio.h>
 
 #include "../drv/pwm/pwm.h"
+#include "../drv/pwm/pwm_frame.h"
+
+#define TEST_NUM_CHANNELS 4
 
 typedef struct {
     uint32_t duty_channel;
     uint32_t duty_value;
+    pbdrv_pwm_frame_t frame;
 } test_private_data_t;
 
 static test_private_data_t test_private_data;
 
+static uint8_t test_back[TEST_NUM_CHANNELS * 2];
+static uint8_t test_front[TEST_NUM_CHANNELS * 2];
+
+// Like a buffered driver, each channel is two big endian bytes in the frame
 static pbio_error_t test_set_duty(pbdrv_pwm_dev_t *dev, uint32_t ch, uint32_t value) {
     test_private_data_t *priv = dev->priv;
     priv->duty_channel = ch;
     priv->duty_value = value;
+    uint8_t data[2] = { value >> 8, value };
+    pbdrv_pwm_frame_set(&priv->frame, ch * 2, data, sizeof(data));
     return PBIO_SUCCESS;
 }
 
+static void test_begin_frame(pbdrv_pwm_dev_t *dev) {
+    test_private_data_t *priv = dev->priv;
+    pbdrv_pwm_frame_begin(&priv->frame);
+}
+
+static void test_commit_frame(pbdrv_pwm_dev_t *dev) {
+    test_private_data_t *priv = dev->priv;
+    pbdrv_pwm_frame_commit(&priv->frame);
+}
+
+static uint32_t test_get_transfer_count(pbdrv_pwm_dev_t *dev) {
+    test_private_data_t *priv = dev->priv;
+    return priv->frame.transfer_count;
+}
+
 static const pbdrv_pwm_driver_funcs_t test_funcs = {
     .set_duty = test_set_duty,
+    .begin_frame = test_begin_frame,
+    .commit_frame = test_commit_frame,
+    .get_transfer_count = test_get_transfer_count,
 };
 
 void pbdrv_pwm_test_init(pbdrv_pwm_dev_t *devs) {
+    memset(test_back, 0, sizeof(test_back));
+    pbdrv_pwm_frame_init(&test_private_data.frame, test_back, test_front, sizeof(test_back));
     devs[0].funcs = &test_funcs;
     devs[0].priv = &test_private_data;
 }
@@ -60,8 +91,59 @@ static void test_pwm_set_duty(void *env) {
     tt_want_int_op(test_private_data.duty_value, ==, 100);
 }
 
+static void test_pwm_frame(void *env) {
+    pbdrv_pwm_dev_t *dev;
+    pbdrv_pwm_frame_t *frame = &test_private_data.frame;
+
+    pbdrv_pwm_init();
+    tt_want(pbdrv_pwm_get_dev(0, &dev) == PBIO_SUCCESS);
+
+    // nothing is sent until a duty cycle is set
+    tt_want(!pbdrv_pwm_frame_refresh(frame));
+    tt_want_int_op(pbdrv_pwm_get_transfer_count(dev), ==, 0);
+
+    // the first frame is always sent, even if it is all zeros
+    pbdrv_pwm_set_duty(dev, 0, 0);
+    tt_want(pbdrv_pwm_frame_refresh(frame));
+    tt_want_int_op(pbdrv_pwm_get_transfer_count(dev), ==, 1);
+
+    // all duty cycles set between refreshes are sent in one transfer
+    pbdrv_pwm_set_duty(dev, 0, 0x0102);
+    pbdrv_pwm_set_duty(dev, 1, 0x0304);
+    tt_want(pbdrv_pwm_frame_refresh(frame));
+    tt_want(!pbdrv_pwm_frame_refresh(frame));
+    tt_want_int_op(pbdrv_pwm_get_transfer_count(dev), ==, 2);
+    tt_want_int_op(test_front[1], ==, 0x02);
+    tt_want_int_op(test_front[3], ==, 0x04);
+
+    // the front buffer is not changed while the next frame is written
+    pbdrv_pwm_set_duty(dev, 1, 0x0506);
+    tt_want_int_op(test_front[3], ==, 0x04);
+
+    // a frame that ends up the same as the last one is not sent
+    pbdrv_pwm_set_duty(dev, 1, 0x0304);
+    tt_want(!pbdrv_pwm_frame_refresh(frame));
+    tt_want_int_op(pbdrv_pwm_get_transfer_count(dev), ==, 2);
+
+    // nested frames are held back until the outer frame is committed
+    pbdrv_pwm_begin_frame(dev);
+    pbdrv_pwm_set_duty(dev, 2, 0x0708);
+    pbdrv_pwm_begin_frame(dev);
+    pbdrv_pwm_set_duty(dev, 3, 0x090a);
+    pbdrv_pwm_commit_frame(dev);
+    tt_want(!pbdrv_pwm_frame_refresh(frame));
+    tt_want_int_op(test_front[5], ==, 0);
+    pbdrv_pwm_commit_frame(dev);
+    tt_want(pbdrv_pwm_frame_refresh(frame));
+    tt_want_int_op(pbdrv_pwm_get_transfer_count(dev), ==, 3);
+    tt_want_int_op(memcmp(test_front, test_back, sizeof(test_front)), ==, 0);
+    tt_want_int_op(test_front[5], ==, 0x08);
+    tt_want_int_op(test_front[7], ==, 0x0a);
+}
+
 struct testcase_t pbdrv_pwm_tests[] = {
     PBIO_TEST(test_pwm_get),
     PBIO_TEST(test_pwm_set_duty),
+    PBIO_TEST(test_pwm_frame),
     END_OF_TESTCASES
 };
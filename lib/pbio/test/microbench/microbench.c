@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Micro-benchmark of the control loop building blocks.
+//
+// This times pbio_observer_update, pbio_control_update and
+// pbio_trajectory_get_reference on fixed input sequences, and compares the
+// observer and trajectory outputs to a double precision reference computed
+// from the same settings. It is built twice, once for the fixed point control
+// code (PBIO_CONFIG_CONTROL_MINIMAL) and once for the floating point control
+// code, so the two can be compared side by side.
+//
+// Times are in CPU cycles where the host has a cycle counter, otherwise in
+// nanoseconds.
+//
+// Usage: microbench-fixed [repeats]
+//        microbench-float [repeats]
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <pbdrv/clock.h>
+#include <pbio/config.h>
+#include <pbio/control.h>
+#include <pbio/observer.h>
+#include <pbio/servo.h>
+#include <pbio/trajectory.h>
+#include <pbio/util.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MICROBENCH_UNIT "cycles"
+static uint64_t microbench_now(void) {
+    return __rdtsc();
+}
+#else
+#define MICROBENCH_UNIT "ns"
+static uint64_t microbench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#endif
+
+#define MICROBENCH_DEFAULT_REPEATS (50)
+
+// Number of control loop samples in each input sequence
+#define MICROBENCH_SAMPLES (4000)
+
+// Keeps the compiler from optimizing away unused results
+static volatile int32_t microbench_sink;
+
+// The control code only uses the clock for logging, which is disabled here
+uint32_t pbdrv_clock_get_ms(void) {
+    return 0;
+}
+
+uint32_t pbdrv_clock_get_us(void) {
+    return 0;
+}
+
+// Accumulated difference between an implementation and the reference.
+typedef struct {
+    uint32_t samples;
+    double sum_sq;
+    double max;
+} microbench_error_t;
+
+static void microbench_error_add(microbench_error_t *e, double err) {
+    e->samples++;
+    e->sum_sq += err * err;
+    if (fabs(err) > e->max) {
+        e->max = fabs(err);
+    }
+}
+
+static double microbench_error_rms(microbench_error_t *e) {
+    return e->samples ? sqrt(e->sum_sq / e->samples) : 0.0;
+}
+
+// Double precision version of the observer, using the same model and settings
+typedef struct {
+    double phi_01;
+    double phi_11;
+    double gam_0;
+    double gam_1;
+    double k_0;
+    double f_low;
+    double k_low;
+    double k_med;
+    double k_high;
+    double count;
+    double rate;
+} ref_observer_t;
+
+static void ref_observer_reset(ref_observer_t *ref, const pbio_observer_settings_t *s, int32_t count) {
+    ref->phi_01 = (double)s->phi_01 / PBIO_OBSERVER_SCALE_HIGH;
+    ref->phi_11 = (double)s->phi_11 / PBIO_OBSERVER_SCALE_LOW;
+    ref->gam_0 = (double)s->gam_0 / PBIO_OBSERVER_SCALE_LOW;
+    ref->gam_1 = (double)s->gam_1 / PBIO_OBSERVER_SCALE_LOW;
+    ref->k_0 = (double)s->k_0 / PBIO_OBSERVER_SCALE_HIGH;
+    ref->f_low = (double)s->f_low / PBIO_OBSERVER_SCALE_TRQ;
+    ref->k_low = (double)(s->obs_gains >> 16) / 1000000;
+    ref->k_med = ref->k_low * ((s->obs_gains & 0x0000FF00) >> 8);
+    ref->k_high = ref->k_low * (s->obs_gains & 0x000000FF);
+    ref->count = count;
+    ref->rate = 0;
+}
+
+static void ref_observer_update(ref_observer_t *ref, int32_t count, int32_t voltage) {
+    const double r1 = 5;
+    const double r2 = 25;
+
+    double tau_e = voltage / 1000.0 * ref->k_0;
+    double tau_f = ref->rate > 0 ? ref->f_low : -ref->f_low;
+
+    double err = count - ref->count;
+    double tau_o;
+    if (fabs(err) < r1) {
+        tau_o = ref->k_low * err;
+    } else if (fabs(err) < r2) {
+        tau_o = copysign(ref->k_low * r1 + (fabs(err) - r1) * ref->k_med, err);
+    } else {
+        tau_o = copysign(ref->k_low * r1 + ref->k_med * (r2 - r1) + (fabs(err) - r2) * ref->k_high, err);
+    }
+
+    double next_count = ref->count + ref->phi_01 * ref->rate + ref->gam_0 * (tau_e + tau_o);
+    double next_rate = ref->phi_11 * ref->rate + ref->gam_1 * (tau_e + tau_o - tau_f);
+
+    if ((next_rate < 0) != (next_rate + ref->gam_1 * tau_f < 0)) {
+        next_rate = 0;
+    }
+
+    ref->count = next_count;
+    ref->rate = next_rate;
+}
+
+// Measured counts and applied voltages for the observer
+static int32_t input_count[MICROBENCH_SAMPLES];
+static int32_t input_voltage[MICROBENCH_SAMPLES];
+
+// Makes an input sequence by driving the model itself with a varying voltage
+// and a load that is not in the model, so the observer has something to correct.
+static void microbench_make_input(const pbio_observer_settings_t *s) {
+    ref_observer_t plant;
+    ref_observer_reset(&plant, s, 0);
+
+    double angle = 0;
+    for (int i = 0; i < MICROBENCH_SAMPLES; i++) {
+        double t = (double)i * PBIO_CONTROL_LOOP_TIME_MS / MS_PER_SECOND;
+
+        // Sine sweep with a few steps and a pause in between
+        int32_t voltage = (int32_t)(6000 * sin(2 * M_PI * 0.5 * t));
+        if (i % 1000 > 700) {
+            voltage = i % 1000 > 850 ? 0 : 8000;
+        }
+        input_voltage[i] = voltage;
+        input_count[i] = (int32_t)floor(angle);
+
+        // Load torque that comes and goes
+        double load = (i / 500) % 2 ? plant.f_low * 3 : 0;
+        double tau = voltage / 1000.0 * plant.k_0 - load;
+        double tau_f = plant.rate > 0 ? plant.f_low : plant.rate < 0 ? -plant.f_low : 0;
+        double rate = plant.phi_11 * plant.rate + plant.gam_1 * (tau - tau_f);
+        if (plant.rate != 0 && (rate < 0) != (plant.rate < 0)) {
+            rate = 0;
+        }
+        angle += plant.phi_01 * plant.rate + plant.gam_0 * tau;
+        plant.rate = rate;
+    }
+}
+
+static void microbench_observer(const char *name, pbio_iodev_type_id_t id, int repeats) {
+    pbio_control_settings_t control_settings;
+    const pbio_observer_settings_t *s;
+    if (pbio_servo_load_settings(&control_settings, &s, id) != PBIO_SUCCESS) {
+        return;
+    }
+    microbench_make_input(s);
+
+    // Compare to the reference
+    pbio_observer_t obs = { .settings = s };
+    ref_observer_t ref;
+    microbench_error_t err_count = { 0 };
+    microbench_error_t err_rate = { 0 };
+
+    pbio_observer_reset(&obs, input_count[0], 0);
+    ref_observer_reset(&ref, s, input_count[0]);
+    for (int i = 0; i < MICROBENCH_SAMPLES; i++) {
+        int32_t count, rate;
+        pbio_observer_update(&obs, input_count[i], false, input_voltage[i]);
+        ref_observer_update(&ref, input_count[i], input_voltage[i]);
+        pbio_observer_get_estimated_state(&obs, &count, &rate);
+        microbench_error_add(&err_count, count - ref.count);
+        microbench_error_add(&err_rate, rate - ref.rate);
+    }
+
+    // Time it
+    uint64_t total = 0;
+    for (int r = 0; r < repeats; r++) {
+        pbio_observer_reset(&obs, input_count[0], 0);
+        uint64_t start = microbench_now();
+        for (int i = 0; i < MICROBENCH_SAMPLES; i++) {
+            pbio_observer_update(&obs, input_count[i], false, input_voltage[i]);
+        }
+        total += microbench_now() - start;
+        int32_t count, rate;
+        pbio_observer_get_estimated_state(&obs, &count, &rate);
+        microbench_sink = count + rate;
+    }
+
+    printf("observer %-12s %8.1f %s/call, count err rms %6.3f max %6.3f, rate err rms %7.3f max %7.3f\n",
+        name, (double)total / repeats / MICROBENCH_SAMPLES, MICROBENCH_UNIT,
+        microbench_error_rms(&err_count), err_count.max, microbench_error_rms(&err_rate), err_rate.max);
+}
+
+// Evaluates a trajectory in double precision
+static void ref_trajectory_get_reference(pbio_trajectory_t *trj, int32_t time, double *count, double *rate) {
+    if (time - trj->t1 < 0) {
+        double dt = (double)(time - trj->t0) / US_PER_SECOND;
+        *rate = trj->w0 + trj->a0 * dt;
+        *count = trj->th0 + trj->th0_ext / 1000.0 + trj->w0 * dt + trj->a0 * dt * dt / 2;
+    } else if (trj->forever || time - trj->t2 <= 0) {
+        double dt = (double)(time - trj->t1) / US_PER_SECOND;
+        *rate = trj->w1;
+        *count = trj->th1 + trj->th1_ext / 1000.0 + trj->w1 * dt;
+    } else if (time - trj->t3 <= 0) {
+        double dt = (double)(time - trj->t2) / US_PER_SECOND;
+        *rate = trj->w1 + trj->a2 * dt;
+        *count = trj->th2 + trj->th2_ext / 1000.0 + trj->w1 * dt + trj->a2 * dt * dt / 2;
+    } else {
+        *rate = 0;
+        *count = trj->th3 + trj->th3_ext / 1000.0;
+    }
+}
+
+static void microbench_trajectory(const char *name, pbio_trajectory_t *trj, int repeats) {
+    microbench_error_t err_count = { 0 };
+    microbench_error_t err_rate = { 0 };
+    pbio_trajectory_reference_t ref;
+
+    // Sample the whole maneuver and some time after it at 1 ms intervals
+    int32_t duration = trj->forever ? 10 * US_PER_SECOND : trj->t3 - trj->t0 + US_PER_SECOND;
+    int32_t samples = duration / US_PER_MS;
+
+    for (int32_t i = 0; i < samples; i++) {
+        int32_t time = trj->t0 + i * US_PER_MS;
+        double count, rate;
+        pbio_trajectory_get_reference(trj, time, &ref);
+        ref_trajectory_get_reference(trj, time, &count, &rate);
+        microbench_error_add(&err_count, ref.count + ref.count_ext / 1000.0 - count);
+        microbench_error_add(&err_rate, ref.rate - rate);
+    }
+
+    uint64_t total = 0;
+    for (int r = 0; r < repeats; r++) {
+        uint64_t start = microbench_now();
+        for (int32_t i = 0; i < samples; i++) {
+            pbio_trajectory_get_reference(trj, trj->t0 + i * US_PER_MS, &ref);
+        }
+        total += microbench_now() - start;
+        microbench_sink = ref.count;
+    }
+
+    printf("trajectory %-10s %8.1f %s/call, count err rms %6.3f max %6.3f, rate err rms %7.3f max %7.3f\n",
+        name, (double)total / repeats / samples, MICROBENCH_UNIT,
+        microbench_error_rms(&err_count), err_count.max, microbench_error_rms(&err_rate), err_rate.max);
+}
+
+static void microbench_control(int repeats) {
+    pbio_control_t ctl = { 0 };
+    const pbio_observer_settings_t *s;
+    if (pbio_servo_load_settings(&ctl.settings, &s, PBIO_IODEV_TYPE_ID_INTERACTIVE_MOTOR) != PBIO_SUCCESS) {
+        return;
+    }
+
+    uint64_t total = 0;
+    uint32_t checksum = 0;
+    for (int r = 0; r < repeats; r++) {
+        pbio_control_state_t state = { 0 };
+        pbio_control_stop(&ctl);
+        pbio_control_start_angle_control(&ctl, 0, &state, 720, 800, PBIO_ACTUATION_HOLD);
+
+        checksum = 0;
+        for (int i = 0; i < MICROBENCH_SAMPLES; i++) {
+            int32_t time = i * PBIO_CONTROL_LOOP_TIME_MS * US_PER_MS;
+            pbio_trajectory_reference_t ref;
+            pbio_actuation_t actuation;
+            int32_t torque;
+
+            uint64_t start = microbench_now();
+            pbio_control_update(&ctl, time, &state, &ref, &actuation, &torque);
+            total += microbench_now() - start;
+
+            // Follow the reference with some lag and noise
+            state.count = ref.count - ref.rate / 50 + (i * 7919) % 5 - 2;
+            state.count_est = state.count;
+            state.rate = ref.rate;
+            state.rate_est = ref.rate;
+            checksum = checksum * 31 + (uint32_t)torque;
+        }
+    }
+
+    // There is no floating point code in the controller, so this checksum
+    // should be the same for both builds.
+    printf("control  %-12s %8.1f %s/call, torque checksum %08" PRIx32 "\n",
+        "interactive", (double)total / repeats / MICROBENCH_SAMPLES, MICROBENCH_UNIT, checksum);
+}
+
+int main(int argc, char **argv) {
+    int repeats = argc > 1 ? atoi(argv[1]) : MICROBENCH_DEFAULT_REPEATS;
+    if (repeats <= 0) {
+        fprintf(stderr, "usage: %s [repeats]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s control code, %d ms loop, %d repeats\n",
+        PBIO_CONFIG_CONTROL_MINIMAL ? "fixed point" : "floating point", PBIO_CONTROL_LOOP_TIME_MS, repeats);
+
+    static const struct {
+        const char *name;
+        pbio_iodev_type_id_t id;
+    } motors[] = {
+        { "interactive", PBIO_IODEV_TYPE_ID_INTERACTIVE_MOTOR },
+        { "movehub", PBIO_IODEV_TYPE_ID_MOVE_HUB_MOTOR },
+        { "technic_l", PBIO_IODEV_TYPE_ID_TECHNIC_L_MOTOR },
+        { "technic_xl", PBIO_IODEV_TYPE_ID_TECHNIC_XL_MOTOR },
+        { "spike_s", PBIO_IODEV_TYPE_ID_SPIKE_S_MOTOR },
+        { "spike_m", PBIO_IODEV_TYPE_ID_SPIKE_M_MOTOR },
+        { "spike_l", PBIO_IODEV_TYPE_ID_SPIKE_L_MOTOR },
+    };
+    for (size_t i = 0; i < PBIO_ARRAY_SIZE(motors); i++) {
+        microbench_observer(motors[i].name, motors[i].id, repeats);
+    }
+
+    pbio_trajectory_t trj;
+    pbio_trajectory_calc_time_new(&trj, 0, 0, 720, 0, 800, 1000, 2000);
+    microbench_trajectory("target", &trj, repeats);
+    pbio_trajectory_calc_angle_new(&trj, 0, 3 * US_PER_SECOND, 0, 0, 0, -600, 1000, 2000);
+    microbench_trajectory("timed", &trj, repeats);
+
+    microbench_control(repeats);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Driver configuration for the control micro-benchmark. No drivers are used.
+// The counter options only select which motor settings are available.
+
+#define PBDRV_CONFIG_COUNTER_TEST                   (1)
+#define PBDRV_CONFIG_COUNTER_STM32F0_GPIO_QUAD_ENC  (1)
+
+#define PBDRV_CONFIG_HAS_PORT_A                     (1)
+#define PBDRV_CONFIG_FIRST_MOTOR_PORT               PBIO_PORT_ID_A
+#define PBDRV_CONFIG_LAST_MOTOR_PORT                PBIO_PORT_ID_A
+#define PBDRV_CONFIG_NUM_MOTOR_CONTROLLER           (1)
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// PBIO_CONFIG_CONTROL_MINIMAL is set on the command line, so that the same
+// benchmark can be built for the fixed point and floating point control code.
+
+// Only needed for the motor voltage limits in the motor settings
+#define PBIO_CONFIG_DCMOTOR                 (1)
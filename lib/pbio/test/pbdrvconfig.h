@@ -9,6 +9,7 @@
 #define PBDRV_CONFIG_COUNTER                        (1)
 #define PBDRV_CONFIG_COUNTER_NUM_DEV                (1)
 #define PBDRV_CONFIG_COUNTER_TEST                   (1)
+#define PBDRV_CONFIG_COUNTER_EDGE_RATE              (1)
 
 #define PBDRV_CONFIG_LED                            (1)
 #define PBDRV_CONFIG_LED_NUM_DEV                    (0)
@@ -18,6 +19,7 @@
 
 #define PBDRV_CONFIG_PWM                            (1)
 #define PBDRV_CONFIG_PWM_NUM_DEV                    (1)
+#define PBDRV_CONFIG_PWM_FRAME                      (1)
 #define PBDRV_CONFIG_PWM_TEST                       (1)
 
 #define PBDRV_CONFIG_UART                           (1)
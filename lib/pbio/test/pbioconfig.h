@@ -9,3 +9,5 @@
 
 #define PBIO_CONFIG_UARTDEV                 (1)
 #define PBIO_CONFIG_UARTDEV_NUM_DEV         (1)
+
+#define PBIO_CONFIG_PROFILER                (1)
@@ -0,0 +1,7 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Driver configuration for the encoder rate benchmark. Only the rate
+// estimator is used.
+
+#define PBDRV_CONFIG_COUNTER_EDGE_RATE              (1)
@@ -0,0 +1,336 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+// Benchmark of the encoder rate estimate of the GPIO quadrature encoder driver.
+//
+// This replays encoder edges through the old rate estimate of
+// counter_stm32f0_gpio_quad_enc.c (copied below) and through the edge rate
+// estimator in counter_rate.c, and compares both to the true rate, queried
+// every control loop period like pbio does.
+//
+// Without arguments, it simulates a few speed profiles where the true rate is
+// known. The encoder is modeled with slightly uneven slots, and the rising
+// edges of the interrupt pin are logged like the driver does.
+//
+// With a file argument, it replays recorded edges instead. Each line has the
+// time in 10 us ticks and the count after the edge, for each logged edge. The
+// true rate is not known, so the rate from a 20 ms window centered on the
+// query time is used as the reference.
+//
+// Times are in CPU cycles where the host has a cycle counter, otherwise in
+// nanoseconds.
+//
+// Usage: ratebench [edges.txt]
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <pbio/util.h>
+
+#include "../../drv/counter/counter_rate.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RATEBENCH_UNIT "cycles"
+static uint64_t ratebench_now(void) {
+    return __rdtsc();
+}
+#else
+#define RATEBENCH_UNIT "ns"
+static uint64_t ratebench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#endif
+
+// Ticks between rate queries, like the 5 ms control loop
+#define RATEBENCH_QUERY_TICKS (500)
+
+// Length of simulated profiles in ticks
+#define RATEBENCH_DURATION (4 * PBDRV_COUNTER_RATE_TICKS_PER_SEC)
+
+// Simulated profiles may start at speed, which neither estimate can know
+// right away, so the first queries are not counted.
+#define RATEBENCH_SETTLE (PBDRV_COUNTER_RATE_TICKS_PER_SEC / 2)
+
+// Maximum number of recorded edges
+#define RATEBENCH_MAX_EDGES (200000)
+
+// The old estimate, with a ring of 16-bit timestamps and a sample added each
+// time the timer wraps.
+
+#define LEGACY_RING_BUF_SIZE 32
+
+typedef struct {
+    int32_t counts[LEGACY_RING_BUF_SIZE];
+    uint16_t timestamps[LEGACY_RING_BUF_SIZE];
+    uint8_t head;
+} legacy_t;
+
+static void legacy_add(legacy_t *priv, int32_t count, uint16_t timestamp) {
+    uint8_t new_head = (priv->head + 1) & (LEGACY_RING_BUF_SIZE - 1);
+    priv->counts[new_head] = count;
+    priv->timestamps[new_head] = timestamp;
+    priv->head = new_head;
+}
+
+static int32_t legacy_get_rate(legacy_t *priv, uint16_t now) {
+    int32_t head_count, tail_count = 0;
+    uint16_t head_time, tail_time = 0;
+    uint8_t head, tail, x = 0;
+
+    head = priv->head;
+    head_count = priv->counts[head];
+    head_time = priv->timestamps[head];
+
+    if ((uint16_t)(now - head_time) > 50 * 100) {
+        return 0;
+    }
+
+    while (x++ < LEGACY_RING_BUF_SIZE) {
+        tail = (head - x) & (LEGACY_RING_BUF_SIZE - 1);
+        tail_count = priv->counts[tail];
+        tail_time = priv->timestamps[tail];
+        if (head_count == tail_count) {
+            return 0;
+        }
+        if ((uint16_t)(head_time - tail_time) >= 20 * 100) {
+            break;
+        }
+    }
+
+    if (head_time == tail_time) {
+        return 0;
+    }
+
+    return (head_count - tail_count) * 100000 / (uint16_t)(head_time - tail_time);
+}
+
+// Accumulated difference between an estimate and the reference.
+typedef struct {
+    uint32_t samples;
+    double sum_sq;
+    double max;
+    uint64_t time;
+} ratebench_result_t;
+
+static void ratebench_result_add(ratebench_result_t *r, double err, uint64_t time) {
+    r->samples++;
+    r->sum_sq += err * err;
+    if (fabs(err) > r->max) {
+        r->max = fabs(err);
+    }
+    r->time += time;
+}
+
+static void ratebench_result_print(const char *name, const char *method, ratebench_result_t *r) {
+    printf("%-10s %-7s %10.1f %10.1f %10.1f\n", name, method,
+        r->samples ? sqrt(r->sum_sq / r->samples) : 0.0, r->max,
+        r->samples ? (double)r->time / r->samples : 0.0);
+}
+
+// Both estimators, fed with the same edges.
+typedef struct {
+    legacy_t legacy;
+    pbdrv_counter_rate_t est;
+    ratebench_result_t legacy_result;
+    ratebench_result_t est_result;
+} ratebench_t;
+
+static void ratebench_init(ratebench_t *b) {
+    *b = (ratebench_t) {0};
+    pbdrv_counter_rate_reset(&b->est);
+}
+
+static void ratebench_edge(ratebench_t *b, int32_t count, uint32_t time) {
+    legacy_add(&b->legacy, count, time);
+    pbdrv_counter_rate_add_edge(&b->est, count, time);
+}
+
+static void ratebench_tick(ratebench_t *b, int32_t count, uint32_t time) {
+    // The driver adds a sample each time the 16-bit timer wraps
+    if ((time & 0xffff) == 0) {
+        legacy_add(&b->legacy, count, time);
+    }
+}
+
+static void ratebench_query(ratebench_t *b, uint32_t time, double reference) {
+    int32_t rate;
+    uint8_t confidence;
+    uint64_t start;
+
+    start = ratebench_now();
+    rate = legacy_get_rate(&b->legacy, time);
+    ratebench_result_add(&b->legacy_result, rate - reference, ratebench_now() - start);
+
+    start = ratebench_now();
+    pbdrv_counter_rate_get(&b->est, time, &rate, &confidence);
+    ratebench_result_add(&b->est_result, rate - reference, ratebench_now() - start);
+}
+
+// Speed profiles in counts per second
+
+static double profile_crawl(double t) {
+    return 12;
+}
+
+static double profile_slow(double t) {
+    return 40;
+}
+
+static double profile_fast(double t) {
+    return 1500;
+}
+
+static double profile_ramp(double t) {
+    return t < 2 ? 750 * t : 750 * (4 - t);
+}
+
+static double profile_reverse(double t) {
+    return 200 * sin(M_PI * t);
+}
+
+typedef struct {
+    const char *name;
+    double (*rate)(double t);
+} ratebench_profile_t;
+
+static const ratebench_profile_t ratebench_profiles[] = {
+    { "crawl", profile_crawl },
+    { "slow", profile_slow },
+    { "fast", profile_fast },
+    { "ramp", profile_ramp },
+    { "reverse", profile_reverse },
+};
+
+static void ratebench_simulate(const ratebench_profile_t *profile) {
+    static ratebench_t b;
+    double slot_offset[64];
+    double position = 0;
+    int32_t count = 0;
+
+    // Slots are not exactly evenly spaced
+    srand(1);
+    for (int i = 0; i < PBIO_ARRAY_SIZE(slot_offset); i++) {
+        slot_offset[i] = 0.15 * (2.0 * rand() / RAND_MAX - 1);
+    }
+
+    ratebench_init(&b);
+
+    for (uint32_t time = 1; time <= RATEBENCH_DURATION; time++) {
+        double rate = profile->rate((double)time / PBDRV_COUNTER_RATE_TICKS_PER_SEC);
+        position += rate / PBDRV_COUNTER_RATE_TICKS_PER_SEC;
+
+        // Boundary n is between count n - 1 and n. The interrupt pin is high
+        // for even counts, so an edge is logged when we get to an even count.
+        while (position >= count + 1 + slot_offset[(count + 1) & 63]) {
+            count++;
+            if (!(count & 1)) {
+                ratebench_edge(&b, count, time);
+            }
+        }
+        while (position < count + slot_offset[count & 63]) {
+            count--;
+            if (!(count & 1)) {
+                ratebench_edge(&b, count, time);
+            }
+        }
+
+        ratebench_tick(&b, count, time);
+
+        if (time % RATEBENCH_QUERY_TICKS == 0 && time >= RATEBENCH_SETTLE) {
+            ratebench_query(&b, time, rate);
+        }
+    }
+
+    ratebench_result_print(profile->name, "legacy", &b.legacy_result);
+    ratebench_result_print(profile->name, "edge", &b.est_result);
+}
+
+// Recorded edges
+static uint32_t edge_times[RATEBENCH_MAX_EDGES];
+static int32_t edge_counts[RATEBENCH_MAX_EDGES];
+
+// Gets the count at the given time, interpolated between the recorded edges.
+static double ratebench_interpolate(uint32_t num_edges, uint32_t time) {
+    static uint32_t i;
+
+    if (i >= num_edges || edge_times[i] > time) {
+        i = 0;
+    }
+    while (i + 1 < num_edges && edge_times[i + 1] <= time) {
+        i++;
+    }
+    if (i + 1 == num_edges || edge_times[i] > time) {
+        return edge_counts[i];
+    }
+    double f = (double)(time - edge_times[i]) / (edge_times[i + 1] - edge_times[i]);
+    return edge_counts[i] + f * (edge_counts[i + 1] - edge_counts[i]);
+}
+
+static int ratebench_replay(const char *path) {
+    static ratebench_t b;
+    uint32_t num_edges = 0;
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    while (num_edges < RATEBENCH_MAX_EDGES &&
+           fscanf(f, "%" SCNu32 " %" SCNd32, &edge_times[num_edges], &edge_counts[num_edges]) == 2) {
+        num_edges++;
+    }
+    fclose(f);
+
+    if (num_edges < 2) {
+        fprintf(stderr, "%s: not enough edges\n", path);
+        return 1;
+    }
+
+    ratebench_init(&b);
+
+    const uint32_t half_window = 10 * 100;
+    uint32_t next = 0;
+
+    for (uint32_t time = edge_times[0]; time <= edge_times[num_edges - 1]; time++) {
+        int32_t count = next ? edge_counts[next - 1] : 0;
+        while (next < num_edges && edge_times[next] == time) {
+            count = edge_counts[next++];
+            ratebench_edge(&b, count, time);
+        }
+
+        ratebench_tick(&b, count, time);
+
+        if (time % RATEBENCH_QUERY_TICKS == 0 && time >= edge_times[0] + half_window &&
+            time + half_window <= edge_times[num_edges - 1]) {
+            double reference = (ratebench_interpolate(num_edges, time + half_window) -
+                ratebench_interpolate(num_edges, time - half_window)) *
+                PBDRV_COUNTER_RATE_TICKS_PER_SEC / (2 * half_window);
+            ratebench_query(&b, time, reference);
+        }
+    }
+
+    ratebench_result_print("recorded", "legacy", &b.legacy_result);
+    ratebench_result_print("recorded", "edge", &b.est_result);
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    printf("%-10s %-7s %10s %10s %10s\n", "profile", "method", "rms", "max", RATEBENCH_UNIT);
+
+    if (argc > 1) {
+        return ratebench_replay(argv[1]);
+    }
+
+    for (int i = 0; i < PBIO_ARRAY_SIZE(ratebench_profiles); i++) {
+        ratebench_simulate(&ratebench_profiles[i]);
+    }
+
+    return 0;
+}
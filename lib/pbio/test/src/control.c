@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/control.h>
+#include <pbio/error.h>
+#include <pbio/trajectory.h>
+#include <test-pbio.h>
+
+#define LOOP_TIME_US (PBIO_CONTROL_LOOP_TIME_MS * US_PER_MS)
+
+static void test_control_init(pbio_control_t *ctl) {
+    *ctl = (pbio_control_t) {
+        .settings = {
+            .max_rate = 1000,
+            .abs_acceleration = 2000,
+            .rate_tolerance = 50,
+            .count_tolerance = 3,
+            .stall_rate_limit = 20,
+            .stall_time = 200 * US_PER_MS,
+            .pid_kp = 100,
+            .pid_ki = 10,
+            .pid_kd = 3,
+            .max_torque = 100000,
+            .integral_rate = 10,
+        },
+    };
+    pbio_control_stop(ctl);
+}
+
+// Runs the control loop with a motor that follows the reference exactly,
+// and returns the time at which all maneuvers are done. Also gets the lowest
+// speed while the count is between 100 and 620, and the highest count.
+static int32_t test_control_run(pbio_control_t *ctl, pbio_control_state_t *state, int32_t time, int32_t *min_rate, int32_t *max_count) {
+    *min_rate = INT32_MAX;
+    *max_count = INT32_MIN;
+
+    for (; !pbio_control_is_done(ctl) && time < 10 * US_PER_SECOND; time += LOOP_TIME_US) {
+        pbio_trajectory_reference_t ref;
+        pbio_actuation_t actuation;
+        int32_t torque;
+        int32_t count_prev = state->count;
+
+        pbio_control_update(ctl, time, state, &ref, &actuation, &torque);
+
+        // the reference must not jump when a queued maneuver starts
+        tt_want_int_op(abs(ref.count - count_prev), <=, ctl->settings.max_rate * LOOP_TIME_US / US_PER_SECOND + 1);
+
+        state->count = state->count_est = ref.count;
+        state->rate = state->rate_est = ref.rate;
+        if (ref.count > 100 && ref.count < 620 && ref.rate < *min_rate) {
+            *min_rate = ref.rate;
+        }
+        *max_count = ref.count > *max_count ? ref.count : *max_count;
+    }
+
+    return time;
+}
+
+// Tests that queued angle maneuvers are blended without stopping in between.
+static void test_control_queue(void *env) {
+    pbio_control_t ctl;
+    pbio_control_state_t state = { 0 };
+    int32_t min_rate, max_count;
+
+    // Two maneuvers one after the other as a reference
+    test_control_init(&ctl);
+    tt_want_int_op(pbio_control_start_angle_control(&ctl, 0, &state, 360, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    int32_t time = test_control_run(&ctl, &state, 0, &min_rate, &max_count);
+    tt_want_int_op(pbio_control_start_angle_control(&ctl, time, &state, 720, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    int32_t time_separate = test_control_run(&ctl, &state, time, &min_rate, &max_count);
+    tt_want_int_op(state.count, ==, 720);
+
+    // Same targets, but queued. The first one starts right away.
+    test_control_init(&ctl);
+    state = (pbio_control_state_t) { 0 };
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 360, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_uint_op(ctl.queue_count, ==, 0);
+    uint32_t first = pbio_control_get_last_maneuver(&ctl);
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 720, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_uint_op(ctl.queue_count, ==, 1);
+    uint32_t second = pbio_control_get_last_maneuver(&ctl);
+    tt_want_uint_op(second, ==, first + 1);
+    tt_want(!pbio_control_maneuver_is_done(&ctl, first));
+    tt_want(!pbio_control_maneuver_is_done(&ctl, second));
+
+    // The motor gets there without slowing down in between, and faster
+    int32_t time_blended = test_control_run(&ctl, &state, 0, &min_rate, &max_count);
+    tt_want_int_op(state.count, ==, 720);
+    tt_want_int_op(min_rate, >=, 490);
+    tt_want_int_op(time_blended, <, time_separate - 200 * US_PER_MS);
+    tt_want(pbio_control_maneuver_is_done(&ctl, first));
+    tt_want(pbio_control_maneuver_is_done(&ctl, second));
+    tt_want_int_op(ctl.queue_count, ==, 0);
+
+    // Going back and forth stops exactly at the intermediate target
+    test_control_init(&ctl);
+    state = (pbio_control_state_t) { 0 };
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 360, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 0, 500, PBIO_ACTUATION_COAST), ==, PBIO_SUCCESS);
+    test_control_run(&ctl, &state, 0, &min_rate, &max_count);
+    tt_want_int_op(abs(max_count - 360), <=, 1);
+    tt_want_int_op(state.count, ==, 0);
+    tt_want_int_op(ctl.type, ==, PBIO_CONTROL_NONE);
+
+    // The queue has a limited size and rejects segments that can't be made
+    test_control_init(&ctl);
+    state = (pbio_control_state_t) { 0 };
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 100, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 200, 0, PBIO_ACTUATION_HOLD), ==, PBIO_ERROR_INVALID_ARG);
+    for (int i = 0; i < PBIO_CONFIG_CONTROL_QUEUE_SIZE; i++) {
+        tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 200 + i * 100, 500, PBIO_ACTUATION_HOLD), ==, PBIO_SUCCESS);
+    }
+    tt_want_int_op(pbio_control_queue_angle_control(&ctl, 0, &state, 1000, 500, PBIO_ACTUATION_HOLD), ==, PBIO_ERROR_BUSY);
+
+    // Starting a new maneuver discards the queue, and counts those as done
+    second = pbio_control_get_last_maneuver(&ctl);
+    tt_want_int_op(pbio_control_start_hold_control(&ctl, 0, 0), ==, PBIO_SUCCESS);
+    tt_want_int_op(ctl.queue_count, ==, 0);
+    tt_want(pbio_control_maneuver_is_done(&ctl, second));
+}
+
+struct testcase_t pbio_control_tests[] = {
+    PBIO_TEST(test_control_queue),
+    END_OF_TESTCASES
+};
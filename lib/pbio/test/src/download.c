@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/download.h>
+#include <pbio/protocol.h>
+#include <pbio/util.h>
+#include <test-pbio.h>
+
+#define BLOCK_SIZE 10
+
+static uint8_t program[95];
+
+static pbio_error_t test_start(pbio_download_t *dl, uint32_t size, uint16_t block_size) {
+    uint8_t cmd[7] = { PBIO_PYBRICKS_COMMAND_START_DOWNLOAD };
+    pbio_set_uint32_le(&cmd[1], size);
+    pbio_set_uint16_le(&cmd[5], block_size);
+    return pbio_download_start(dl, cmd, sizeof(cmd));
+}
+
+// Sends one block of the test program, optionally with a bad CRC
+static pbio_error_t test_write(pbio_download_t *dl, uint16_t index, bool corrupt) {
+    uint8_t cmd[PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE + BLOCK_SIZE] = { PBIO_PYBRICKS_COMMAND_WRITE_BLOCK };
+    uint32_t offset = index * BLOCK_SIZE;
+    uint32_t size = sizeof(program) - offset < BLOCK_SIZE ? sizeof(program) - offset : BLOCK_SIZE;
+
+    pbio_set_uint16_le(&cmd[1], index);
+    pbio_set_uint32_le(&cmd[3], pbio_crc32(0, &program[offset], size) ^ corrupt);
+    memcpy(&cmd[PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE], &program[offset], size);
+
+    return pbio_download_write_block(dl, cmd, PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE + size);
+}
+
+static void test_download(void *env) {
+    static uint8_t buf[100];
+    pbio_download_t dl;
+
+    for (uint32_t i = 0; i < sizeof(program); i++) {
+        program[i] = i * 7 + 3;
+    }
+
+    // Nothing is accepted without a buffer
+    pbio_download_init(&dl, NULL, 0);
+    tt_want_int_op(test_start(&dl, sizeof(program), BLOCK_SIZE), ==, PBIO_ERROR_INVALID_OP);
+    tt_want_int_op(test_write(&dl, 0, false), ==, PBIO_ERROR_INVALID_OP);
+    tt_want(!pbio_download_is_done(&dl));
+
+    // Blocks need a download to be started
+    pbio_download_init(&dl, buf, sizeof(buf));
+    tt_want_int_op(test_write(&dl, 0, false), ==, PBIO_ERROR_INVALID_OP);
+
+    // The program has to fit
+    tt_want_int_op(test_start(&dl, sizeof(buf) + 1, BLOCK_SIZE), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_int_op(test_start(&dl, sizeof(program), 0), ==, PBIO_ERROR_INVALID_ARG);
+    tt_want_int_op(test_start(&dl, sizeof(program), BLOCK_SIZE), ==, PBIO_SUCCESS);
+    tt_want_uint_op(dl.num_blocks, ==, 10);
+
+    // Blocks may arrive out of order, which is reported in the flags
+    tt_want_int_op(test_write(&dl, 2, false), ==, PBIO_SUCCESS);
+    tt_want_int_op(test_write(&dl, 3, false), ==, PBIO_SUCCESS);
+    tt_want_int_op(test_write(&dl, 5, false), ==, PBIO_SUCCESS);
+    tt_want_uint_op(dl.base, ==, 0);
+    tt_want_uint_op(dl.received, ==, 0x16);
+
+    // A bad block is rejected
+    tt_want_int_op(test_write(&dl, 0, true), ==, PBIO_ERROR_IO);
+    tt_want_uint_op(dl.base, ==, 0);
+
+    // The window slides past all blocks that we have in a row
+    tt_want_int_op(test_write(&dl, 0, false), ==, PBIO_SUCCESS);
+    tt_want_uint_op(dl.base, ==, 1);
+    tt_want_uint_op(dl.received, ==, 0xb);
+    tt_want_int_op(test_write(&dl, 1, false), ==, PBIO_SUCCESS);
+    tt_want_uint_op(dl.base, ==, 4);
+    tt_want_uint_op(dl.received, ==, 0x1);
+
+    // Blocks that we already have are accepted again
+    tt_want_int_op(test_write(&dl, 2, false), ==, PBIO_SUCCESS);
+    tt_want_int_op(test_write(&dl, 5, false), ==, PBIO_SUCCESS);
+    tt_want_uint_op(dl.base, ==, 4);
+
+    // Blocks must have the right size and index
+    uint8_t short_block[PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE + 1] = { PBIO_PYBRICKS_COMMAND_WRITE_BLOCK, 4 };
+    tt_want_int_op(pbio_download_write_block(&dl, short_block, sizeof(short_block)), ==, PBIO_ERROR_INVALID_ARG);
+    short_block[1] = 10;
+    tt_want_int_op(pbio_download_write_block(&dl, short_block, sizeof(short_block)), ==, PBIO_ERROR_INVALID_ARG);
+
+    // The last block is shorter
+    for (uint16_t i = 9; i >= 4; i--) {
+        tt_want(!pbio_download_is_done(&dl));
+        tt_want_int_op(test_write(&dl, i, false), ==, PBIO_SUCCESS);
+    }
+    tt_want(pbio_download_is_done(&dl));
+    tt_want_uint_op(dl.base, ==, 10);
+    tt_want_int_op(memcmp(buf, program, sizeof(program)), ==, 0);
+
+    // The final status can still be sent after the buffer was taken back
+    uint8_t event[PBIO_PYBRICKS_EVENT_DOWNLOAD_STATUS_SIZE];
+    pbio_download_stop(&dl);
+    tt_want(!pbio_download_is_done(&dl));
+    pbio_pybricks_event_download_status(event, dl.status, dl.base, dl.received);
+    tt_want_uint_op(event[1], ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbio_get_uint16_le(&event[2]), ==, 10);
+
+    // Late blocks are no longer accepted, but don't change the progress
+    tt_want_int_op(test_write(&dl, 9, false), ==, PBIO_ERROR_INVALID_OP);
+    tt_want_uint_op(dl.base, ==, 10);
+
+    // Blocks too far ahead of the window are rejected
+    pbio_download_init(&dl, buf, sizeof(buf));
+    tt_want_int_op(test_start(&dl, 40 * 2, 2), ==, PBIO_SUCCESS);
+    uint8_t far_block[PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE + 2] = { PBIO_PYBRICKS_COMMAND_WRITE_BLOCK };
+    pbio_set_uint16_le(&far_block[1], PBIO_DOWNLOAD_WINDOW_SIZE + 1);
+    pbio_set_uint32_le(&far_block[3], pbio_crc32(0, &far_block[PBIO_PYBRICKS_COMMAND_WRITE_BLOCK_HEADER_SIZE], 2));
+    tt_want_int_op(pbio_download_write_block(&dl, far_block, sizeof(far_block)), ==, PBIO_ERROR_INVALID_ARG);
+    pbio_set_uint16_le(&far_block[1], PBIO_DOWNLOAD_WINDOW_SIZE);
+    tt_want_int_op(pbio_download_write_block(&dl, far_block, sizeof(far_block)), ==, PBIO_SUCCESS);
+    tt_want_uint_op(dl.received, ==, 0x80000000);
+}
+
+struct testcase_t pbio_download_tests[] = {
+    PBIO_TEST(test_download),
+    END_OF_TESTCASES
+};
@@ -31,6 +31,11 @@ static const uint8_t test_animation[] = {
     11, 12, 13, 14, 15, 16, 17, 18, 19,
 };
 
+static const uint8_t test_scroll[] = {
+    1, 2, 3,
+    4, 5, 6,
+};
+
 static uint8_t test_light_matrix_set_pixel_last_brightness[MATRIX_SIZE][MATRIX_SIZE];
 
 static void test_light_matrix_reset(void) {
@@ -115,6 +120,85 @@ static PT_THREAD(test_light_matrix(struct pt *pt)) {
     PT_END(pt);
 }
 
+static PT_THREAD(test_light_matrix_scroll(struct pt *pt)) {
+    static int i;
+
+    PT_BEGIN(pt);
+
+    static pbio_light_matrix_t test_light_matrix;
+    pbio_light_matrix_init(&test_light_matrix, MATRIX_SIZE, &test_light_matrix_funcs);
+
+    // starting a scroll should show the first column on the right right away
+    test_light_matrix_reset();
+    pbio_light_matrix_start_scroll(&test_light_matrix, test_scroll, 2, INTERVAL, false);
+    tt_want(pbio_light_matrix_is_scrolling(&test_light_matrix));
+    tt_want_light_matrix_data(
+        0, 0, 1,
+        0, 0, 2,
+        0, 0, 3);
+
+    // the columns move one step left after each interval
+    pbio_test_clock_tick(INTERVAL - 1);
+    PT_YIELD(pt);
+    tt_want_int_op(test_light_matrix_set_pixel_last_brightness[0][1], ==, 0);
+    pbio_test_clock_tick(1);
+    PT_YIELD(pt);
+    tt_want_light_matrix_data(
+        0, 1, 4,
+        0, 2, 5,
+        0, 3, 6);
+
+    pbio_test_clock_tick(INTERVAL);
+    PT_YIELD(pt);
+    tt_want_light_matrix_data(
+        1, 4, 0,
+        2, 5, 0,
+        3, 6, 0);
+
+    pbio_test_clock_tick(INTERVAL);
+    PT_YIELD(pt);
+    tt_want_light_matrix_data(
+        4, 0, 0,
+        5, 0, 0,
+        6, 0, 0);
+    tt_want(pbio_light_matrix_is_scrolling(&test_light_matrix));
+
+    // the last step clears the display and then the scroll is done
+    pbio_test_clock_tick(INTERVAL);
+    PT_YIELD(pt);
+    tt_want_light_matrix_data(0);
+    tt_want(!pbio_light_matrix_is_scrolling(&test_light_matrix));
+
+    // nothing changes after that
+    test_light_matrix_set_pixel_last_brightness[0][0] = 1;
+    pbio_test_clock_tick(INTERVAL);
+    PT_YIELD(pt);
+    tt_want_int_op(test_light_matrix_set_pixel_last_brightness[0][0], ==, 1);
+    pbio_light_matrix_stop_animation(&test_light_matrix);
+
+    // a looping scroll starts over after the last step
+    test_light_matrix_reset();
+    pbio_light_matrix_start_scroll(&test_light_matrix, test_scroll, 2, INTERVAL, true);
+    for (i = 0; i < 4; i++) {
+        pbio_test_clock_tick(INTERVAL);
+        PT_YIELD(pt);
+    }
+    tt_want_light_matrix_data(0);
+    pbio_test_clock_tick(INTERVAL);
+    PT_YIELD(pt);
+    tt_want_light_matrix_data(
+        0, 0, 1,
+        0, 0, 2,
+        0, 0, 3);
+    tt_want(pbio_light_matrix_is_scrolling(&test_light_matrix));
+
+    // other commands stop the scroll
+    pbio_light_matrix_clear(&test_light_matrix);
+    tt_want(!pbio_light_matrix_is_scrolling(&test_light_matrix));
+
+    PT_END(pt);
+}
+
 static void test_light_matrix_rotation(void *env) {
     static pbio_light_matrix_t test_light_matrix;
     pbio_light_matrix_init(&test_light_matrix, MATRIX_SIZE, &test_light_matrix_funcs);
@@ -180,6 +264,7 @@ static void test_light_matrix_rotation(void *env) {
 
 struct testcase_t pbio_light_matrix_tests[] = {
     PBIO_PT_THREAD_TEST(test_light_matrix),
+    PBIO_PT_THREAD_TEST(test_light_matrix_scroll),
     PBIO_TEST(test_light_matrix_rotation),
     END_OF_TESTCASES
 };
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#include <stdint.h>
+
+#include <tinytest.h>
+#include <tinytest_macros.h>
+
+#include <pbio/error.h>
+#include <pbio/logger.h>
+#include <test-pbio.h>
+
+#define TEST_LOG_COLS (NUM_DEFAULT_LOG_VALUES + 1)
+#define TEST_LOG_ROWS (4)
+
+// Logs the given number of rows, with values counting up from start.
+static void log_rows(pbio_log_t *log, int32_t start, int32_t count) {
+    for (int32_t i = start; i < start + count; i++) {
+        pbio_logger_update(log, &i);
+    }
+}
+
+// Tests that the default logger stops when the buffer is full.
+static void test_logger_linear(void *env) {
+    pbio_log_t log = { .num_values = TEST_LOG_COLS };
+    int32_t buf[TEST_LOG_ROWS * TEST_LOG_COLS];
+    int32_t row[TEST_LOG_COLS];
+
+    pbio_logger_start(&log, buf, TEST_LOG_ROWS, 1);
+    log_rows(&log, 0, TEST_LOG_ROWS + 2);
+
+    tt_want_int_op(pbio_logger_rows(&log), ==, TEST_LOG_ROWS);
+    tt_want(!log.active);
+    tt_want_uint_op(pbio_logger_dropped(&log), ==, 0);
+
+    tt_want_int_op(pbio_logger_read(&log, 0, row), ==, PBIO_SUCCESS);
+    tt_want_int_op(row[NUM_DEFAULT_LOG_VALUES], ==, 0);
+    tt_want_int_op(pbio_logger_read(&log, -1, row), ==, PBIO_SUCCESS);
+    tt_want_int_op(row[NUM_DEFAULT_LOG_VALUES], ==, TEST_LOG_ROWS - 1);
+    tt_want_int_op(pbio_logger_read(&log, TEST_LOG_ROWS, row), ==, PBIO_ERROR_INVALID_ARG);
+}
+
+// Tests that the ring logger keeps the most recent rows and counts the rest.
+static void test_logger_ring(void *env) {
+    pbio_log_t log = { .num_values = TEST_LOG_COLS };
+    int32_t buf[TEST_LOG_ROWS * TEST_LOG_COLS];
+    int32_t row[TEST_LOG_COLS];
+
+    pbio_logger_start_ring(&log, buf, TEST_LOG_ROWS, 1);
+    log_rows(&log, 0, TEST_LOG_ROWS + 3);
+
+    tt_want_int_op(pbio_logger_rows(&log), ==, TEST_LOG_ROWS);
+    tt_want(log.active);
+    tt_want_uint_op(pbio_logger_dropped(&log), ==, 3);
+
+    // Reading is relative to the oldest row that is still available
+    for (int32_t i = 0; i < TEST_LOG_ROWS; i++) {
+        tt_want_int_op(pbio_logger_read(&log, i, row), ==, PBIO_SUCCESS);
+        tt_want_int_op(row[NUM_DEFAULT_LOG_VALUES], ==, i + 3);
+    }
+    tt_want_int_op(pbio_logger_read(&log, -1, row), ==, PBIO_SUCCESS);
+    tt_want_int_op(row[NUM_DEFAULT_LOG_VALUES], ==, TEST_LOG_ROWS + 2);
+}
+
+// Tests that draining the ring logger in time gives every row exactly once.
+static void test_logger_drain(void *env) {
+    pbio_log_t log = { .num_values = TEST_LOG_COLS };
+    int32_t buf[TEST_LOG_ROWS * TEST_LOG_COLS];
+    int32_t out[TEST_LOG_ROWS * TEST_LOG_COLS];
+    int32_t expected = 0;
+
+    pbio_logger_start_ring(&log, buf, TEST_LOG_ROWS, 1);
+
+    // Log a few rows at a time and drain them, wrapping around several times
+    for (int32_t i = 0; i < 10; i++) {
+        log_rows(&log, i * 3, 3);
+
+        uint32_t rows = pbio_logger_drain(&log, out, TEST_LOG_ROWS);
+        tt_want_uint_op(rows, ==, 3);
+        for (uint32_t r = 0; r < rows; r++) {
+            tt_want_int_op(out[r * TEST_LOG_COLS + NUM_DEFAULT_LOG_VALUES], ==, expected++);
+        }
+        tt_want_int_op(pbio_logger_rows(&log), ==, 0);
+    }
+    tt_want_uint_op(pbio_logger_dropped(&log), ==, 0);
+
+    // Partial drain leaves the newest rows in place
+    log_rows(&log, 100, 3);
+    tt_want_uint_op(pbio_logger_drain(&log, out, 2), ==, 2);
+    tt_want_int_op(out[NUM_DEFAULT_LOG_VALUES], ==, 100);
+    tt_want_int_op(out[TEST_LOG_COLS + NUM_DEFAULT_LOG_VALUES], ==, 101);
+    tt_want_uint_op(pbio_logger_drain(&log, out, TEST_LOG_ROWS), ==, 1);
+    tt_want_int_op(out[NUM_DEFAULT_LOG_VALUES], ==, 102);
+    tt_want_uint_op(pbio_logger_drain(&log, out, TEST_LOG_ROWS), ==, 0);
+}
+
+struct testcase_t pbio_logger_tests[] = {
+    PBIO_TEST(test_logger_linear),
+    PBIO_TEST(test_logger_ring),
+    PBIO_TEST(test_logger_drain),
+    END_OF_TESTCASES
+};
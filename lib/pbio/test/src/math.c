@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2020-2021 The Pybricks Authors
 
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <pbio/math.h>
 #include <test-pbio.h>
@@ -68,9 +70,34 @@ static void test_div_i32_fix16(void *env) {
     tt_want_int_op(pbio_math_div_i32_fix16(INT32_MIN, F16(-1.0)), ==, INT32_MIN); // overflow!
 }
 
+static void test_sin_cos_mdeg(void *env) {
+    tt_want_int_op(pbio_math_sin_mdeg(0), ==, 0);
+    tt_want_int_op(pbio_math_sin_mdeg(30000), ==, PBIO_MATH_TRIG_SCALE / 2);
+    tt_want_int_op(pbio_math_sin_mdeg(90000), ==, PBIO_MATH_TRIG_SCALE);
+    tt_want_int_op(pbio_math_sin_mdeg(150000), ==, PBIO_MATH_TRIG_SCALE / 2);
+    tt_want_int_op(pbio_math_sin_mdeg(180000), ==, 0);
+    tt_want_int_op(pbio_math_sin_mdeg(270000), ==, -PBIO_MATH_TRIG_SCALE);
+    tt_want_int_op(pbio_math_sin_mdeg(-90000), ==, -PBIO_MATH_TRIG_SCALE);
+    tt_want_int_op(pbio_math_sin_mdeg(720000 + 30000), ==, PBIO_MATH_TRIG_SCALE / 2);
+    tt_want_int_op(pbio_math_cos_mdeg(0), ==, PBIO_MATH_TRIG_SCALE);
+    tt_want_int_op(pbio_math_cos_mdeg(60000), ==, PBIO_MATH_TRIG_SCALE / 2);
+    tt_want_int_op(pbio_math_cos_mdeg(180000), ==, -PBIO_MATH_TRIG_SCALE);
+    tt_want_int_op(pbio_math_cos_mdeg(-60000), ==, PBIO_MATH_TRIG_SCALE / 2);
+    tt_want_int_op(pbio_math_cos_mdeg(INT32_MAX), ==, pbio_math_cos_mdeg(INT32_MAX % 360000));
+    tt_want_int_op(pbio_math_sin_mdeg(INT32_MIN), ==, pbio_math_sin_mdeg(INT32_MIN % 360000));
+
+    // Interpolated values are within one of the exact values
+    for (int32_t mdeg = -400000; mdeg <= 400000; mdeg += 777) {
+        double rad = mdeg / 1000.0 * M_PI / 180;
+        tt_want_int_op(abs(pbio_math_sin_mdeg(mdeg) - (int32_t)lround(sin(rad) * PBIO_MATH_TRIG_SCALE)), <=, 1);
+        tt_want_int_op(abs(pbio_math_cos_mdeg(mdeg) - (int32_t)lround(cos(rad) * PBIO_MATH_TRIG_SCALE)), <=, 1);
+    }
+}
+
 struct testcase_t pbio_math_tests[] = {
     PBIO_TEST(test_sqrt),
     PBIO_TEST(test_mul_i32_fix16),
     PBIO_TEST(test_div_i32_fix16),
+    PBIO_TEST(test_sin_cos_mdeg),
     END_OF_TESTCASES
 };
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#include <stdint.h>
+#include <string.h>
+
+#include <contiki.h>
+#include <tinytest.h>
+#include <tinytest_macros.h>
+#include <test-pbio.h>
+
+#include <pbio/error.h>
+#include <pbio/profiler.h>
+
+// How long the test process keeps the CPU busy each time it is polled
+static uint32_t test_busy_time;
+
+PROCESS(test_profiler_process, "test profiler");
+
+PROCESS_THREAD(test_profiler_process, ev, data) {
+    PROCESS_BEGIN();
+
+    for (;;) {
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+        pbio_test_clock_tick(test_busy_time);
+    }
+
+    PROCESS_END();
+}
+
+static bool test_profiler_find(const char *name, pbio_profiler_stats_t *stats) {
+    for (uint8_t i = 0; i < pbio_profiler_get_num_processes(); i++) {
+        if (pbio_profiler_get_stats(i, stats) == PBIO_SUCCESS && strcmp(stats->name, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static PT_THREAD(test_profiler(struct pt *pt)) {
+    static pbio_profiler_stats_t stats;
+
+    PT_BEGIN(pt);
+
+    pbio_profiler_reset();
+    tt_want(!test_profiler_find("test profiler", &stats));
+
+    // starting the process calls it once, which takes no time
+    process_start(&test_profiler_process, NULL);
+    tt_want(test_profiler_find("test profiler", &stats));
+    tt_want_uint_op(stats.calls, ==, 1);
+    tt_want_uint_op(stats.total_time, ==, 0);
+
+    // each poll is one more call
+    test_busy_time = 2;
+    process_poll(&test_profiler_process);
+    PT_YIELD(pt);
+    test_busy_time = 5;
+    process_poll(&test_profiler_process);
+    PT_YIELD(pt);
+
+    tt_want(test_profiler_find("test profiler", &stats));
+    tt_want_uint_op(stats.calls, ==, 3);
+    tt_want_uint_op(stats.total_time, ==, 7000);
+    tt_want_uint_op(stats.max_time, ==, 5000);
+
+    // reset clears everything
+    pbio_profiler_reset();
+    tt_want_uint_op(pbio_profiler_get_num_processes(), ==, 0);
+    tt_want_uint_op(pbio_profiler_get_max_queue_depth(), ==, 0);
+    tt_want(pbio_profiler_get_stats(0, &stats) == PBIO_ERROR_INVALID_ARG);
+
+    process_exit(&test_profiler_process);
+
+    PT_END(pt);
+}
+
+struct testcase_t pbio_profiler_tests[] = {
+    PBIO_PT_THREAD_TEST(test_profiler),
+    END_OF_TESTCASES
+};
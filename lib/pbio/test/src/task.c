@@ -10,6 +10,8 @@
 #include <tinytest.h>
 #include <tinytest_macros.h>
 
+#include <pbio/control.h>
+#include <pbio/control_task.h>
 #include <pbio/error.h>
 #include <pbio/task.h>
 #include <test-pbio.h>
@@ -148,10 +150,53 @@ static void test_task_removal(void *env) {
     tt_want_uint_op((intptr_t)task3.context, ==, 2);
 }
 
+// Tests waiting for control maneuvers without queuing the task.
+static void test_control_task(void *env) {
+    pbio_control_t ctl_a = { 0 }, ctl_b = { 0 };
+    pbio_control_task_t ct;
+
+    pbio_control_stop(&ctl_a);
+    pbio_control_stop(&ctl_b);
+
+    // no maneuver, so done right away
+    pbio_control_task_init(&ct, &ctl_a, NULL);
+    tt_want(pbio_task_run_once(&ct.task));
+    tt_want_uint_op(ct.task.status, ==, PBIO_SUCCESS);
+
+    // done when the control loop reaches the target
+    tt_want_uint_op(pbio_control_start_hold_control(&ctl_a, 0, 100), ==, PBIO_SUCCESS);
+    pbio_control_task_init(&ct, &ctl_a, NULL);
+    tt_want(!pbio_task_run_once(&ct.task));
+    tt_want_uint_op(ct.task.status, ==, PBIO_ERROR_AGAIN);
+    ctl_a.on_target = true;
+    tt_want(pbio_task_run_once(&ct.task));
+    tt_want_uint_op(ct.task.status, ==, PBIO_SUCCESS);
+
+    // done when the maneuver is replaced by a new one
+    tt_want_uint_op(pbio_control_start_hold_control(&ctl_a, 0, 200), ==, PBIO_SUCCESS);
+    pbio_control_task_init(&ct, &ctl_a, NULL);
+    tt_want(!pbio_task_run_once(&ct.task));
+    tt_want_uint_op(pbio_control_start_hold_control(&ctl_a, 0, 300), ==, PBIO_SUCCESS);
+    tt_want(pbio_task_run_once(&ct.task));
+    tt_want_uint_op(ct.task.status, ==, PBIO_SUCCESS);
+
+    // waits for both controllers
+    tt_want_uint_op(pbio_control_start_hold_control(&ctl_b, 0, 100), ==, PBIO_SUCCESS);
+    pbio_control_task_init(&ct, &ctl_a, &ctl_b);
+    ctl_a.on_target = true;
+    tt_want(!pbio_task_run_once(&ct.task));
+
+    // canceling stops waiting
+    pbio_task_cancel(&ct.task);
+    tt_want_uint_op(ct.task.status, ==, PBIO_ERROR_CANCELED);
+    tt_want(!pbio_control_is_done(&ctl_b));
+}
+
 struct testcase_t pbio_task_tests[] = {
     PBIO_TEST(test_no_yield_task),
     PBIO_TEST(test_task_removed_when_complete),
     PBIO_TEST(test_task_cancelation),
     PBIO_TEST(test_task_removal),
+    PBIO_TEST(test_control_task),
     END_OF_TESTCASES
 };
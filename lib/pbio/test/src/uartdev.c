@@ -35,6 +35,10 @@ static struct {
     uint8_t *rx_msg;
     uint8_t rx_msg_length;
     pbio_error_t rx_msg_result;
+    uint8_t rx_ring[64];
+    uint8_t rx_ring_head;
+    uint8_t rx_ring_tail;
+    bool rx_ring_active;
     uint8_t *tx_msg;
     struct etimer tx_timer;
     uint8_t tx_msg_length;
@@ -44,11 +48,28 @@ static struct {
 PT_THREAD(simulate_rx_msg(struct pt *pt, const uint8_t *msg, uint8_t length, bool *ok)) {
     PT_BEGIN(pt);
 
-    // First uartdev reads one byte header
+    // First uartdev reads one byte header, unless it is receiving DATA
+    // messages, in which case it takes all available bytes at once
     PT_WAIT_UNTIL(pt, {
         pbio_test_clock_tick(1);
-        test_uart_dev.rx_msg_result == PBIO_ERROR_AGAIN;
+        test_uart_dev.rx_msg_result == PBIO_ERROR_AGAIN || test_uart_dev.rx_ring_active;
     });
+
+    if (test_uart_dev.rx_ring_active) {
+        for (int i = 0; i < length; i++) {
+            test_uart_dev.rx_ring[test_uart_dev.rx_ring_head] = msg[i];
+            test_uart_dev.rx_ring_head = (test_uart_dev.rx_ring_head + 1) % PBIO_ARRAY_SIZE(test_uart_dev.rx_ring);
+        }
+        process_poll(&pbio_uartdev_process);
+
+        PT_WAIT_UNTIL(pt, {
+            pbio_test_clock_tick(1);
+            test_uart_dev.rx_ring_head == test_uart_dev.rx_ring_tail;
+        });
+
+        *ok = true;
+        PT_EXIT(pt);
+    }
     tt_uint_op(test_uart_dev.rx_msg_length, ==, 1);
     memcpy(test_uart_dev.rx_msg, msg, 1);
     test_uart_dev.rx_msg_result = PBIO_SUCCESS;
@@ -208,6 +229,9 @@ static PT_THREAD(test_boost_color_distance_sensor(struct pt *pt)) {
     static const uint8_t msg85[] = { 0x46, 0x00, 0xB9 }; // extened mode info
     static const uint8_t msg86[] = { 0xC0, 0xFF, 0xC0 }; // mode 0 data
 
+    // several mode 0 DATA messages arriving at once, with a stray SYNC byte
+    static const uint8_t msg_batch[] = { 0x00, 0xC0, 0x05, 0x3A, 0xC0, 0x06, 0x39, 0xC0, 0x07, 0x38 };
+
     static const uint8_t msg87[] = { 0x43, 0x01, 0xBD }; // set mode 1
     static const uint8_t msg88[] = { 0xC1, 0x00, 0x3E }; // mode 1 data
 
@@ -215,6 +239,19 @@ static PT_THREAD(test_boost_color_distance_sensor(struct pt *pt)) {
     static const uint8_t msg90[] = { 0x46, 0x08, 0xB1 }; // extened mode info
     static const uint8_t msg91[] = { 0xD0, 0x00, 0x00, 0x00, 0x00, 0x2F }; // mode 8 data
 
+    // mode combo for modes 0, 1, 2, 3 and 6, which is echoed back by the sensor
+    static const uint8_t msg92[] = {
+        0x64, 0x27, 0x00, 0x00, 0x10, 0x20, 0x30, 0x60, 0x61, 0x62,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xDF
+    };
+    // combo data: color 5, proximity 3, count 0x12345678, reflection 42, rgb 100, 200, 300
+    static const uint8_t msg93[] = {
+        0xE0, 0x05, 0x03, 0x78, 0x56, 0x34, 0x12, 0x2A, 0x64, 0x00,
+        0xC8, 0x00, 0x2C, 0x01, 0x00, 0x00, 0x00, 0xBA
+    };
+    // mode 8 data that was sent before the sensor got the mode combo command
+    static const uint8_t msg94[] = { 0xD0, 0x11, 0x22, 0x33, 0x44, 0x6B };
+
     // used in SIMULATE_RX/TX_MSG macros
     static struct pt child;
     static bool ok;
@@ -392,6 +429,13 @@ static PT_THREAD(test_boost_color_distance_sensor(struct pt *pt)) {
     tt_want_uint_op(iodev->info->mode_info[10].num_values, ==, 8);
     tt_want_uint_op(iodev->info->mode_info[10].data_type, ==, PBIO_IODEV_DATA_TYPE_INT16);
 
+    tt_want_uint_op(iodev->bin_data[0], ==, 0xFF);
+
+    // all messages received at once should be parsed, ending with the newest
+    SIMULATE_RX_MSG(msg_batch);
+    tt_want_uint_op(iodev->bin_data[0], ==, 0x07);
+    tt_want_uint_op(iodev->mode, ==, 0);
+
 
     // test changing the mode
 
@@ -448,6 +492,50 @@ static PT_THREAD(test_boost_color_distance_sensor(struct pt *pt)) {
     tt_uint_op(err, ==, PBIO_SUCCESS);
     tt_uint_op(iodev->mode, ==, 8);
 
+    // switch to combi-mode to get data of several modes at once
+
+    static uint8_t *combo_data;
+    tt_want_uint_op(pbio_iodev_get_combo_modes(iodev), ==, 1 << 6 | 1 << 3 | 1 << 2 | 1 << 1 | 1 << 0);
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 6, &combo_data), ==, PBIO_ERROR_AGAIN);
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 4, &combo_data), ==, PBIO_ERROR_NOT_SUPPORTED);
+
+    PT_WAIT_WHILE(pt, {
+        pbio_test_clock_tick(1);
+        (err = pbio_iodev_set_mode_begin(iodev, PBIO_IODEV_MODE_COMBO)) == PBIO_ERROR_AGAIN;
+    });
+    tt_uint_op(err, ==, PBIO_SUCCESS);
+
+    SIMULATE_TX_MSG(msg92);
+    tt_uint_op(pbio_iodev_set_mode_end(iodev), ==, PBIO_ERROR_AGAIN);
+
+    // data in the old mode that arrives before the echo must not end the
+    // mode change, otherwise the first combo read gets mode 8 data
+    SIMULATE_RX_MSG(msg90);
+    SIMULATE_RX_MSG(msg94);
+    SIMULATE_RX_MSG(msg92);
+    tt_uint_op(pbio_iodev_set_mode_end(iodev), ==, PBIO_ERROR_AGAIN);
+
+    SIMULATE_RX_MSG(msg93);
+
+    PT_WAIT_WHILE(pt, {
+        pbio_test_clock_tick(1);
+        (err = pbio_iodev_set_mode_end(iodev)) == PBIO_ERROR_AGAIN;
+    });
+    tt_uint_op(err, ==, PBIO_SUCCESS);
+
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 0, &combo_data), ==, PBIO_SUCCESS);
+    tt_want_int_op(*(int8_t *)combo_data, ==, 5);
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 1, &combo_data), ==, PBIO_SUCCESS);
+    tt_want_int_op(*(int8_t *)combo_data, ==, 3);
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 2, &combo_data), ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbio_get_uint32_le(combo_data), ==, 0x12345678);
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 3, &combo_data), ==, PBIO_SUCCESS);
+    tt_want_int_op(*(int8_t *)combo_data, ==, 42);
+    tt_want_uint_op(pbio_iodev_get_combo_data(iodev, 6, &combo_data), ==, PBIO_SUCCESS);
+    tt_want_uint_op(pbio_get_uint16_le(combo_data), ==, 100);
+    tt_want_uint_op(pbio_get_uint16_le(combo_data + 2), ==, 200);
+    tt_want_uint_op(pbio_get_uint16_le(combo_data + 4), ==, 300);
+
     PT_YIELD(pt);
 
 end:
@@ -1077,6 +1165,7 @@ pbio_error_t pbdrv_uart_read_begin(pbdrv_uart_dev_t *uart, uint8_t *msg, uint8_t
     test_uart_dev.rx_msg = msg;
     test_uart_dev.rx_msg_length = length;
     test_uart_dev.rx_msg_result = PBIO_ERROR_AGAIN;
+    test_uart_dev.rx_ring_active = false;
     etimer_set(&test_uart_dev.rx_timer, timeout);
 
     return PBIO_SUCCESS;
@@ -1096,6 +1185,20 @@ pbio_error_t pbdrv_uart_read_end(pbdrv_uart_dev_t *uart) {
     return test_uart_dev.rx_msg_result;
 }
 
+pbio_error_t pbdrv_uart_read_available(pbdrv_uart_dev_t *uart, uint8_t *data, uint32_t size, uint32_t *count) {
+    uint32_t i;
+
+    for (i = 0; i < size && test_uart_dev.rx_ring_tail != test_uart_dev.rx_ring_head; i++) {
+        data[i] = test_uart_dev.rx_ring[test_uart_dev.rx_ring_tail];
+        test_uart_dev.rx_ring_tail = (test_uart_dev.rx_ring_tail + 1) % PBIO_ARRAY_SIZE(test_uart_dev.rx_ring);
+    }
+
+    *count = i;
+    test_uart_dev.rx_ring_active = true;
+
+    return PBIO_SUCCESS;
+}
+
 void pbdrv_uart_read_cancel(pbdrv_uart_dev_t *uart) {
 
 }
@@ -44,8 +44,20 @@ static void test_uuid128_reverse_copy(void *env) {
     tt_want_int_op(memcmp(uuid, test_reversed_uuid, 16), ==, 0);
 }
 
+static void test_crc32(void *env) {
+    static const uint8_t data[] = "123456789";
+
+    // check value of the standard CRC-32
+    tt_want_uint_op(pbio_crc32(0, data, 9), ==, 0xcbf43926);
+    tt_want_uint_op(pbio_crc32(0, data, 0), ==, 0);
+
+    // can be computed in parts
+    tt_want_uint_op(pbio_crc32(pbio_crc32(0, data, 4), &data[4], 5), ==, 0xcbf43926);
+}
+
 struct testcase_t pbio_util_tests[] = {
     PBIO_TEST(test_uuid128_reverse_compare),
     PBIO_TEST(test_uuid128_reverse_copy),
+    PBIO_TEST(test_crc32),
     END_OF_TESTCASES
 };
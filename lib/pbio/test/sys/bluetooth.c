@@ -9,6 +9,7 @@
 #include <tinytest_macros.h>
 #include <tinytest.h>
 
+#include <pbio/logger.h>
 #include <pbio/util.h>
 #include <pbsys/bluetooth.h>
 #include <pbsys/status.h>
@@ -100,6 +101,40 @@ static PT_THREAD(test_bluetooth(struct pt *pt)) {
         pbio_test_bluetooth_get_pybricks_service_notification_count() != count;
     });
 
+    // rows of a telemetry log should be drained and sent as notifications on
+    // the Pybricks command characteristic
+    static pbio_log_t log = { .num_values = NUM_DEFAULT_LOG_VALUES + 1 };
+    static int32_t log_buf[10 * (NUM_DEFAULT_LOG_VALUES + 1)];
+
+    // a log with rows that can't fit in any notification should be rejected
+    static pbio_log_t wide_log = { .num_values = NUM_DEFAULT_LOG_VALUES + 4 };
+    static int32_t wide_log_buf[2 * (NUM_DEFAULT_LOG_VALUES + 4)];
+
+    pbio_logger_start_ring(&wide_log, wide_log_buf, 2, 1);
+    tt_want_uint_op(pbsys_bluetooth_telemetry_start(2, &wide_log), ==, PBIO_ERROR_INVALID_ARG);
+
+    pbio_logger_start_ring(&log, log_buf, 10, 1);
+    tt_want_uint_op(pbsys_bluetooth_telemetry_start(1, &log), ==, PBIO_SUCCESS);
+
+    for (int32_t i = 0; i < 6; i++) {
+        pbio_logger_update(&log, &i);
+    }
+
+    count = pbio_test_bluetooth_get_pybricks_service_notification_count();
+
+    PT_WAIT_UNTIL(pt, {
+        pbio_test_clock_tick(1);
+        pbio_logger_rows(&log) == 0;
+    });
+
+    // default MTU allows 2 rows per notification
+    PT_WAIT_UNTIL(pt, {
+        pbio_test_clock_tick(1);
+        pbio_test_bluetooth_get_pybricks_service_notification_count() >= count + 3;
+    });
+
+    pbsys_bluetooth_telemetry_stop(&log);
+
     PT_END(pt);
 }
 
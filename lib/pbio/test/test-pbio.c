@@ -77,14 +77,20 @@ struct testcase_setup_t pbio_test_setup = {
 };
 
 extern struct testcase_t pbdrv_bluetooth_tests[];
+extern struct testcase_t pbdrv_bluetooth_cc2640_tests[];
 extern struct testcase_t pbdrv_counter_tests[];
+extern struct testcase_t pbdrv_counter_rate_tests[];
 extern struct testcase_t pbdrv_pwm_tests[];
 extern struct testcase_t pbio_color_tests[];
 extern struct testcase_t pbio_light_animation_tests[];
 extern struct testcase_t pbio_color_light_tests[];
 extern struct testcase_t pbio_light_matrix_tests[];
+extern struct testcase_t pbio_control_tests[];
+extern struct testcase_t pbio_download_tests[];
+extern struct testcase_t pbio_logger_tests[];
 extern struct testcase_t pbio_math_tests[];
 extern struct testcase_t pbio_motor_tests[];
+extern struct testcase_t pbio_profiler_tests[];
 extern struct testcase_t pbio_task_tests[];
 extern struct testcase_t pbio_uartdev_tests[];
 extern struct testcase_t pbio_util_tests[];
@@ -92,14 +98,20 @@ extern struct testcase_t pbsys_bluetooth_tests[];
 extern struct testcase_t pbsys_status_tests[];
 static struct testgroup_t test_groups[] = {
     { "drv/bluetooth/", pbdrv_bluetooth_tests },
+    { "drv/bluetooth/", pbdrv_bluetooth_cc2640_tests },
     { "drv/counter/", pbdrv_counter_tests },
+    { "drv/counter/", pbdrv_counter_rate_tests },
     { "drv/pwm/", pbdrv_pwm_tests },
     { "src/color/", pbio_color_tests },
     { "src/light/", pbio_light_animation_tests },
     { "src/light/", pbio_color_light_tests },
     { "src/light/", pbio_light_matrix_tests },
+    { "src/control/", pbio_control_tests },
+    { "src/download/", pbio_download_tests },
+    { "src/logger/", pbio_logger_tests },
     { "src/math/", pbio_math_tests },
     { "src/motor/", pbio_motor_tests },
+    { "src/profiler/", pbio_profiler_tests },
     { "src/task/", pbio_task_tests, },
     { "src/uartdev/", pbio_uartdev_tests, },
     { "src/util/", pbio_util_tests, },
@@ -74,7 +74,7 @@ mp_obj_t common_Control_obj_make_new(pbio_control_t *control);
 
 #if PYBRICKS_PY_COMMON_LOGGER
 // pybricks._common.Logger()
-mp_obj_t common_Logger_obj_make_new(pbio_log_t *log, uint8_t num_values);
+mp_obj_t common_Logger_obj_make_new(pbio_log_t *log, uint8_t num_values, const char *col_names);
 #endif
 
 // pybricks._common.Motor()
@@ -35,7 +35,7 @@ mp_obj_t common_Control_obj_make_new(pbio_control_t *control) {
 
     #if PYBRICKS_PY_COMMON_LOGGER
     // Create an instance of the Logger class
-    self->logger = common_Logger_obj_make_new(&self->control->log, PBIO_CONTROL_LOG_COLS);
+    self->logger = common_Logger_obj_make_new(&self->control->log, PBIO_CONTROL_LOG_COLS, PBIO_CONTROL_LOG_COL_NAMES);
     #endif
 
     #if MICROPY_PY_BUILTINS_FLOAT
@@ -10,6 +10,8 @@
 
 #include "py/obj.h"
 
+#include <pbdrv/clock.h>
+
 #include <pybricks/common.h>
 #include <pybricks/geometry.h>
 #include <pybricks/parameters.h>
@@ -177,12 +179,68 @@ STATIC mp_obj_t common_IMU_angular_velocity(size_t n_args, const mp_obj_t *pos_a
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_IMU_angular_velocity_obj, 1, common_IMU_angular_velocity);
 
+// Number of samples copied from the driver at once
+#define SAMPLES_CHUNK (16)
+
+// Number of values per row of the result of IMU.samples
+#define SAMPLES_ROW (7)
+
+// pybricks._common.IMU.samples
+STATIC mp_obj_t common_IMU_samples(mp_obj_t self_in) {
+    common_IMU_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // Times are given in ms like the other clocks, but the samples are
+    // stamped in us, so convert using the difference to the current time.
+    uint32_t now_ms = pbdrv_clock_get_ms();
+    uint32_t now_us = pbdrv_clock_get_us();
+
+    pbdrv_imu_sample_t samples[SAMPLES_CHUNK];
+    float *data = NULL;
+    size_t rows = 0;
+
+    // Copy all samples since the previous call, one chunk at a time
+    for (;;) {
+        uint32_t num = pb_imu_samples_read(self->imu_dev, samples, SAMPLES_CHUNK);
+        if (num == 0) {
+            break;
+        }
+        data = m_renew(float, data, rows * SAMPLES_ROW, (rows + num) * SAMPLES_ROW);
+
+        for (uint32_t i = 0; i < num; i++) {
+            float *row = &data[(rows + i) * SAMPLES_ROW];
+            row[0] = now_ms - (now_us - samples[i].time) / 1000.0f;
+            common_IMU_rotate_3d_axis(self, samples[i].angular_velocity);
+            common_IMU_rotate_3d_axis(self, samples[i].acceleration);
+            for (uint8_t j = 0; j < 3; j++) {
+                row[1 + j] = samples[i].angular_velocity[j];
+                row[4 + j] = samples[i].acceleration[j];
+            }
+        }
+        rows += num;
+
+        if (num < SAMPLES_CHUNK) {
+            break;
+        }
+    }
+
+    pb_type_Matrix_obj_t *matrix = m_new_obj(pb_type_Matrix_obj_t);
+    matrix->base.type = &pb_type_Matrix;
+    matrix->data = data;
+    matrix->m = rows;
+    matrix->n = SAMPLES_ROW;
+    matrix->scale = 1;
+    matrix->transposed = false;
+    return MP_OBJ_FROM_PTR(matrix);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(common_IMU_samples_obj, common_IMU_samples);
+
 // dir(pybricks.common.IMU)
 STATIC const mp_rom_map_elem_t common_IMU_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_up),               MP_ROM_PTR(&common_IMU_up_obj)              },
     { MP_ROM_QSTR(MP_QSTR_tilt),             MP_ROM_PTR(&common_IMU_tilt_obj)            },
     { MP_ROM_QSTR(MP_QSTR_acceleration),     MP_ROM_PTR(&common_IMU_acceleration_obj)    },
     { MP_ROM_QSTR(MP_QSTR_angular_velocity), MP_ROM_PTR(&common_IMU_angular_velocity_obj)},
+    { MP_ROM_QSTR(MP_QSTR_samples),          MP_ROM_PTR(&common_IMU_samples_obj)         },
 };
 STATIC MP_DEFINE_CONST_DICT(common_IMU_locals_dict, common_IMU_locals_dict_table);
 
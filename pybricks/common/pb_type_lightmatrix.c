@@ -5,6 +5,8 @@
 
 #if PYBRICKS_PY_COMMON && PYBRICKS_PY_COMMON_LIGHT_MATRIX
 
+#include <string.h>
+
 #include <pbio/light_matrix.h>
 
 #include "py/mphal.h"
@@ -26,19 +28,22 @@ typedef struct _common_Lightmatrix_obj_t {
     mp_obj_base_t base;
     pbio_light_matrix_t *light_matrix;
     uint8_t *data;
-    uint8_t frames;
+    size_t data_len;
 } common_Lightmatrix_obj_t;
 
+// Renews memory for a given number of bytes
+STATIC void common_Lightmatrix__renew_bytes(common_Lightmatrix_obj_t *self, size_t data_len) {
+    self->data = m_renew(uint8_t, self->data, self->data_len, data_len);
+    self->data_len = data_len;
+}
+
 // Renews memory for a given number of frames
 STATIC void common_Lightmatrix__renew(common_Lightmatrix_obj_t *self, uint8_t frames) {
     // Matrix with/height
     size_t size = pbio_light_matrix_get_size(self->light_matrix);
 
     // Renew buffer for new number of frames
-    self->data = m_renew(uint8_t, self->data, size * size * self->frames, size * size * frames);
-
-    // Save new number of frames
-    self->frames = frames;
+    common_Lightmatrix__renew_bytes(self, size * size * frames);
 }
 
 // pybricks._common.LightMatrix.orientation
@@ -244,7 +249,7 @@ STATIC mp_obj_t common_Lightmatrix_animate(size_t n_args, const mp_obj_t *pos_ar
     }
 
     // Activate the animation
-    pbio_light_matrix_start_animation(self->light_matrix, self->data, self->frames, interval);
+    pbio_light_matrix_start_animation(self->light_matrix, self->data, n, interval);
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_Lightmatrix_animate_obj, 1, common_Lightmatrix_animate);
@@ -301,6 +306,75 @@ STATIC mp_obj_t common_Lightmatrix_text(size_t n_args, const mp_obj_t *pos_args,
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_Lightmatrix_text_obj, 1, common_Lightmatrix_text);
 
+// pybricks._common.LightMatrix.scroll
+STATIC mp_obj_t common_Lightmatrix_scroll(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        common_Lightmatrix_obj_t, self,
+        PB_ARG_REQUIRED(text),
+        PB_ARG_DEFAULT_INT(interval, 100),
+        PB_ARG_DEFAULT_FALSE(loop),
+        PB_ARG_DEFAULT_TRUE(wait));
+
+    uint8_t size = pbio_light_matrix_get_size(self->light_matrix);
+
+    // Currently the font is only implemented for 5x5 matrices
+    if (size != 5) {
+        pb_assert(PBIO_ERROR_NOT_IMPLEMENTED);
+    }
+
+    // Argument must be a qstring or string
+    if (!mp_obj_is_qstr(text_in)) {
+        pb_assert_type(text_in, &mp_type_str);
+    }
+    GET_STR_DATA_LEN(text_in, text, text_len);
+
+    // Each character is 5 columns wide, with one blank column in between
+    size_t num_columns = text_len * (size + 1);
+    if (text_len == 0 || num_columns > UINT16_MAX) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    // Make sure all characters are valid
+    for (size_t i = 0; i < text_len; i++) {
+        if (text[i] < 32 || text[i] > 126) {
+            pb_assert(PBIO_ERROR_INVALID_ARG);
+        }
+    }
+
+    mp_int_t interval = pb_obj_get_int(interval_in);
+    bool loop = mp_obj_is_true(loop_in);
+
+    // Render the text into columns once, so the background animation
+    // only has to copy them to the display.
+    common_Lightmatrix__renew_bytes(self, num_columns * size);
+    uint8_t *column = self->data;
+    for (size_t i = 0; i < text_len; i++) {
+        const uint8_t *glyph = pb_font_5x5[text[i] - 32];
+        for (uint8_t c = 0; c < size; c++) {
+            for (uint8_t r = 0; r < size; r++) {
+                *column++ = glyph[r] & (1 << (size - 1 - c)) ? 100 : 0;
+            }
+        }
+        // Blank column to separate the characters
+        memset(column, 0, size);
+        column += size;
+    }
+
+    // Start scrolling in the background
+    pbio_light_matrix_start_scroll(self->light_matrix, self->data, num_columns, interval, loop);
+
+    // Optionally wait for the text to scroll by. Looping never ends, so
+    // there is nothing to wait for in that case.
+    if (mp_obj_is_true(wait_in) && !loop) {
+        while (pbio_light_matrix_is_scrolling(self->light_matrix)) {
+            mp_hal_delay_ms(5);
+        }
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_Lightmatrix_scroll_obj, 1, common_Lightmatrix_scroll);
+
 // dir(pybricks.builtins.LightMatrix)
 STATIC const mp_rom_map_elem_t common_Lightmatrix_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_char),            MP_ROM_PTR(&common_Lightmatrix_char_obj)            },
@@ -312,6 +386,7 @@ STATIC const mp_rom_map_elem_t common_Lightmatrix_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_pixel),           MP_ROM_PTR(&common_Lightmatrix_pixel_obj)           },
     { MP_ROM_QSTR(MP_QSTR_orientation),     MP_ROM_PTR(&common_Lightmatrix_orientation_obj)     },
     { MP_ROM_QSTR(MP_QSTR_text),            MP_ROM_PTR(&common_Lightmatrix_text_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_scroll),          MP_ROM_PTR(&common_Lightmatrix_scroll_obj)          },
 };
 STATIC MP_DEFINE_CONST_DICT(common_Lightmatrix_locals_dict, common_Lightmatrix_locals_dict_table);
 
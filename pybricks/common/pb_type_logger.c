@@ -14,6 +14,10 @@
 #include <pbio/logger.h>
 #include <pbio/servo.h>
 
+#if !PYBRICKS_HUB_EV3BRICK
+#include <pbsys/bluetooth.h>
+#endif
+
 #include "py/obj.h"
 #include "py/runtime.h"
 #include "py/mpconfig.h"
@@ -28,13 +32,16 @@ typedef struct _tools_Logger_obj_t {
     pbio_log_t *log;
     int32_t *buf;
     uint32_t size;
+    const char *col_names;
 } tools_Logger_obj_t;
 
 STATIC mp_obj_t tools_Logger_start(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         tools_Logger_obj_t, self,
         PB_ARG_REQUIRED(duration),
-        PB_ARG_DEFAULT_INT(divisor, 1));
+        PB_ARG_DEFAULT_INT(divisor, 1),
+        PB_ARG_DEFAULT_FALSE(ring),
+        PB_ARG_DEFAULT_NONE(stream));
 
     mp_int_t divisor = pb_obj_get_int(divisor_in);
     divisor = max(divisor, 1);
@@ -43,7 +50,28 @@ STATIC mp_obj_t tools_Logger_start(size_t n_args, const mp_obj_t *pos_args, mp_m
     self->buf = m_renew(int32_t, self->buf, self->size, size);
     self->size = size;
 
-    pbio_logger_start(self->log, self->buf, rows, divisor);
+    #if PYBRICKS_HUB_EV3BRICK
+    if (stream_in != mp_const_none) {
+        pb_assert(PBIO_ERROR_NOT_SUPPORTED);
+    }
+    #else
+    // Stop streaming the previous log, if any
+    pbsys_bluetooth_telemetry_stop(self->log);
+    #endif
+
+    if (mp_obj_is_true(ring_in) || stream_in != mp_const_none) {
+        // Keep logging, overwriting old rows unless they are drained in time
+        pbio_logger_start_ring(self->log, self->buf, rows, divisor);
+    } else {
+        pbio_logger_start(self->log, self->buf, rows, divisor);
+    }
+
+    #if !PYBRICKS_HUB_EV3BRICK
+    // Send rows to the host as they come in
+    if (stream_in != mp_const_none) {
+        pb_assert(pbsys_bluetooth_telemetry_start(pb_obj_get_int(stream_in), self->log));
+    }
+    #endif
 
     return mp_const_none;
 }
@@ -72,11 +100,39 @@ STATIC mp_obj_t tools_Logger_get(size_t n_args, const mp_obj_t *pos_args, mp_map
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(tools_Logger_get_obj, 1, tools_Logger_get);
 
+STATIC mp_obj_t tools_Logger_drain(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
+        tools_Logger_obj_t, self,
+        PB_ARG_DEFAULT_NONE(rows));
+
+    // Get all rows if no maximum is given
+    mp_int_t rows = pb_obj_get_default_int(rows_in, pbio_logger_rows(self->log));
+    uint8_t num_values = pbio_logger_cols(self->log);
+
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    mp_obj_t values[MAX_LOG_VALUES];
+    int32_t data[MAX_LOG_VALUES];
+
+    // Move the oldest rows out of the log, one at a time
+    for (mp_int_t r = 0; r < rows && pbio_logger_drain(self->log, data, 1); r++) {
+        for (uint8_t i = 0; i < num_values; i++) {
+            values[i] = mp_obj_new_int(data[i]);
+        }
+        mp_obj_list_append(list, mp_obj_new_tuple(num_values, values));
+    }
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(tools_Logger_drain_obj, 1, tools_Logger_drain);
+
 STATIC mp_obj_t tools_Logger_stop(mp_obj_t self_in) {
     tools_Logger_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
     pbio_logger_stop(self->log);
 
+    #if !PYBRICKS_HUB_EV3BRICK
+    pbsys_bluetooth_telemetry_stop(self->log);
+    #endif
+
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(tools_Logger_stop_obj, tools_Logger_stop);
@@ -104,19 +160,140 @@ static void make_data_row_str(char *row, int32_t *data, uint8_t n) {
     }
 }
 
+// Binary log format version, stored in the header. Refer to
+// tools/logdecode.py for a description of the format.
+#define LOGGER_BINARY_VERSION (1)
+
+// Number of bytes of binary data written at once. On hubs, each chunk is
+// printed as one line of base64 text, so this must be a multiple of 3.
+#define LOGGER_CHUNK_SIZE (57)
+
+// Name and unit of the time column that is added by the logger itself
+static const char default_col_names[] = "log_time:ms,";
+
+// Buffered writer for binary log data
+typedef struct _logger_writer_t {
+    #if PYBRICKS_HUB_EV3BRICK
+    FILE *file;
+    #endif
+    pbio_error_t err;
+    size_t len;
+    uint8_t data[LOGGER_CHUNK_SIZE];
+} logger_writer_t;
+
+static void logger_writer_flush(logger_writer_t *writer) {
+    #if PYBRICKS_HUB_EV3BRICK
+    if (fwrite(writer->data, 1, writer->len, writer->file) != writer->len) {
+        writer->err = PBIO_ERROR_IO;
+    }
+    #else
+    static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // Encode the chunk as one line of base64 text
+    char line[LOGGER_CHUNK_SIZE / 3 * 4 + 2];
+    size_t n = 0;
+    for (size_t i = 0; i < writer->len; i += 3) {
+        uint32_t v = writer->data[i] << 16;
+        if (i + 1 < writer->len) {
+            v |= writer->data[i + 1] << 8;
+        }
+        if (i + 2 < writer->len) {
+            v |= writer->data[i + 2];
+        }
+        line[n++] = base64[(v >> 18) & 0x3f];
+        line[n++] = base64[(v >> 12) & 0x3f];
+        line[n++] = i + 1 < writer->len ? base64[(v >> 6) & 0x3f] : '=';
+        line[n++] = i + 2 < writer->len ? base64[v & 0x3f] : '=';
+    }
+    line[n++] = '\n';
+    line[n] = '\0';
+    mp_print_str(&mp_plat_print, line);
+    #endif // PYBRICKS_HUB_EV3BRICK
+    writer->len = 0;
+}
+
+static void logger_writer_put(logger_writer_t *writer, uint8_t byte) {
+    writer->data[writer->len++] = byte;
+    if (writer->len == LOGGER_CHUNK_SIZE) {
+        logger_writer_flush(writer);
+    }
+}
+
+// Writes an unsigned LEB128 varint, using 7 bits per byte
+static void logger_writer_put_varint(logger_writer_t *writer, uint32_t value) {
+    while (value >= 0x80) {
+        logger_writer_put(writer, value | 0x80);
+        value >>= 7;
+    }
+    logger_writer_put(writer, value);
+}
+
+static void logger_writer_put_str(logger_writer_t *writer, const char *str) {
+    while (*str) {
+        logger_writer_put(writer, *str++);
+    }
+}
+
+// Writes each value as the zigzag-encoded difference with the previous row,
+// so slowly changing values take only one byte.
+static void logger_writer_put_row(logger_writer_t *writer, const int32_t *data, int32_t *prev, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) {
+        // Differences wrap around just like they do on the host
+        int32_t delta = (int32_t)((uint32_t)data[i] - (uint32_t)prev[i]);
+        logger_writer_put_varint(writer, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+        prev[i] = data[i];
+    }
+}
+
+// Writes the log in the binary format, with a header describing the columns
+static pbio_error_t logger_save_binary(tools_Logger_obj_t *self, logger_writer_t *writer) {
+
+    int32_t data[MAX_LOG_VALUES];
+    uint8_t num_values = pbio_logger_cols(self->log);
+    int32_t sampled = pbio_logger_rows(self->log);
+    pbio_error_t err = PBIO_SUCCESS;
+
+    // Write the header
+    logger_writer_put_str(writer, "PBLG");
+    logger_writer_put(writer, LOGGER_BINARY_VERSION);
+    logger_writer_put(writer, num_values);
+    logger_writer_put_varint(writer, sampled);
+    logger_writer_put_varint(writer, strlen(default_col_names) + strlen(self->col_names));
+    logger_writer_put_str(writer, default_col_names);
+    logger_writer_put_str(writer, self->col_names);
+
+    // Write the rows, relative to an initial row of zeros
+    int32_t prev[MAX_LOG_VALUES] = { 0 };
+    for (int32_t i = 0; i < sampled && writer->err == PBIO_SUCCESS; i++) {
+        err = pbio_logger_read(self->log, i, data);
+        if (err != PBIO_SUCCESS) {
+            return err;
+        }
+        logger_writer_put_row(writer, data, prev, num_values);
+
+        // Writing data can take a while, so give MicroPython some time too
+        mp_handle_pending(true);
+    }
+    logger_writer_flush(writer);
+
+    return writer->err;
+}
+
 STATIC mp_obj_t tools_Logger_save(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
 
     PB_PARSE_ARGS_METHOD(n_args, pos_args, kw_args,
         tools_Logger_obj_t, self,
-        PB_ARG_DEFAULT_NONE(path));
-    const char *path = path_in == mp_const_none ? "log.txt" : mp_obj_str_get_str(path_in);
+        PB_ARG_DEFAULT_NONE(path),
+        PB_ARG_DEFAULT_FALSE(binary));
+    bool binary = mp_obj_is_true(binary_in);
+    const char *path = path_in != mp_const_none ? mp_obj_str_get_str(path_in) : binary ? "log.bin" : "log.txt";
 
     #if PYBRICKS_HUB_EV3BRICK
     // Create an empty log file
     FILE *log_file;
 
     // Open file to erase it
-    log_file = fopen(path, "w");
+    log_file = fopen(path, binary ? "wb" : "w");
     if (log_file == NULL) {
         pb_assert(PBIO_ERROR_IO);
     }
@@ -131,36 +308,46 @@ STATIC mp_obj_t tools_Logger_save(size_t n_args, const mp_obj_t *pos_args, mp_ma
 
     uint8_t num_values = pbio_logger_cols(self->log);
     int32_t sampled = pbio_logger_rows(self->log);
-    pbio_error_t err;
-
-    // Allocate space for one null-terminated row of data
-    char row_str[max_val_strln * MAX_LOG_VALUES + 1];
-
-    // Write data to file line by line
-    for (int32_t i = 0; i < sampled; i++) {
-
-        // Read one line inside lock
-        err = pbio_logger_read(self->log, i, data);
-        if (err != PBIO_SUCCESS) {
-            break;
+    pbio_error_t err = PBIO_SUCCESS;
+
+    if (binary) {
+        logger_writer_t writer = {
+            #if PYBRICKS_HUB_EV3BRICK
+            .file = log_file,
+            #endif
+            .err = PBIO_SUCCESS,
+        };
+        err = logger_save_binary(self, &writer);
+    } else {
+        // Allocate space for one null-terminated row of data
+        char row_str[max_val_strln * MAX_LOG_VALUES + 1];
+
+        // Write data to file line by line
+        for (int32_t i = 0; i < sampled; i++) {
+
+            // Read one line inside lock
+            err = pbio_logger_read(self->log, i, data);
+            if (err != PBIO_SUCCESS) {
+                break;
+            }
+
+            // Make one string of values
+            make_data_row_str(row_str, data, num_values);
+
+            #if PYBRICKS_HUB_EV3BRICK
+            // Append the row to file
+            if (fprintf(log_file, "%s", row_str) < 0) {
+                err = PBIO_ERROR_IO;
+                break;
+            }
+            #else
+            // Print the row
+            mp_print_str(&mp_plat_print, row_str);
+            #endif // PYBRICKS_HUB_EV3BRICK
+
+            // Writing data can take a while, so give MicroPython some time too
+            mp_handle_pending(true);
         }
-
-        // Make one string of values
-        make_data_row_str(row_str, data, num_values);
-
-        #if PYBRICKS_HUB_EV3BRICK
-        // Append the row to file
-        if (fprintf(log_file, "%s", row_str) < 0) {
-            err = PBIO_ERROR_IO;
-            break;
-        }
-        #else
-        // Print the row
-        mp_print_str(&mp_plat_print, row_str);
-        #endif // PYBRICKS_HUB_EV3BRICK
-
-        // Writing data can take a while, so give MicroPython some time too
-        mp_handle_pending(true);
     }
 
     #if PYBRICKS_HUB_EV3BRICK
@@ -191,6 +378,7 @@ STATIC mp_obj_t tools_Logger_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
 STATIC const mp_rom_map_elem_t tools_Logger_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_start), MP_ROM_PTR(&tools_Logger_start_obj) },
     { MP_ROM_QSTR(MP_QSTR_get), MP_ROM_PTR(&tools_Logger_get_obj) },
+    { MP_ROM_QSTR(MP_QSTR_drain), MP_ROM_PTR(&tools_Logger_drain_obj) },
     { MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&tools_Logger_stop_obj) },
     { MP_ROM_QSTR(MP_QSTR_save), MP_ROM_PTR(&tools_Logger_save_obj) },
 };
@@ -203,10 +391,11 @@ STATIC const mp_obj_type_t tools_Logger_type = {
     .unary_op = tools_Logger_unary_op,
 };
 
-mp_obj_t common_Logger_obj_make_new(pbio_log_t *log, uint8_t num_values) {
+mp_obj_t common_Logger_obj_make_new(pbio_log_t *log, uint8_t num_values, const char *col_names) {
     tools_Logger_obj_t *logger = m_new_obj(tools_Logger_obj_t);
     logger->base.type = (mp_obj_type_t *)&tools_Logger_type;
     logger->log = log;
+    logger->col_names = col_names;
     logger->log->num_values = num_values + NUM_DEFAULT_LOG_VALUES;
     return logger;
 }
@@ -15,6 +15,7 @@
 
 #include <pybricks/common.h>
 #include <pybricks/parameters.h>
+#include <pybricks/tools.h>
 
 #include <pybricks/util_pb/pb_error.h>
 #include <pybricks/util_mp/pb_obj_helper.h>
@@ -31,6 +32,17 @@ STATIC void wait_for_completion(pbio_servo_t *srv) {
     }
 }
 
+/* Wait for a servo maneuver to complete, which may still be queued */
+
+STATIC void wait_for_maneuver(pbio_servo_t *srv, uint32_t maneuver) {
+    while (!pbio_control_maneuver_is_done(&srv->control, maneuver)) {
+        mp_hal_delay_ms(5);
+    }
+    if (!pbio_servo_update_loop_is_running(srv)) {
+        pb_assert(PBIO_ERROR_NO_DEV);
+    }
+}
+
 // pybricks._common.Motor.__init__
 STATIC mp_obj_t common_Motor_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     PB_PARSE_ARGS_CLASS(n_args, n_kw, args,
@@ -111,7 +123,7 @@ STATIC mp_obj_t common_Motor_make_new(const mp_obj_type_t *type, size_t n_args,
 
     #if PYBRICKS_PY_COMMON_LOGGER
     // Create an instance of the Logger class
-    self->logger = common_Logger_obj_make_new(&self->srv->log, PBIO_SERVO_LOG_COLS);
+    self->logger = common_Logger_obj_make_new(&self->srv->log, PBIO_SERVO_LOG_COLS, PBIO_SERVO_LOG_COL_NAMES);
     #endif
 
     return MP_OBJ_FROM_PTR(self);
@@ -202,9 +214,11 @@ STATIC mp_obj_t common_Motor_run_time(size_t n_args, const mp_obj_t *pos_args, m
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion(self->srv);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_servo(self->srv);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_Motor_run_time_obj, 1, common_Motor_run_time);
 
@@ -288,9 +302,11 @@ STATIC mp_obj_t common_Motor_run_angle(size_t n_args, const mp_obj_t *pos_args,
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion(self->srv);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_servo(self->srv);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_Motor_run_angle_obj, 1, common_Motor_run_angle);
 
@@ -301,20 +317,28 @@ STATIC mp_obj_t common_Motor_run_target(size_t n_args, const mp_obj_t *pos_args,
         PB_ARG_REQUIRED(speed),
         PB_ARG_REQUIRED(target_angle),
         PB_ARG_DEFAULT_OBJ(then, pb_Stop_HOLD_obj),
-        PB_ARG_DEFAULT_TRUE(wait));
+        PB_ARG_DEFAULT_TRUE(wait),
+        PB_ARG_DEFAULT_FALSE(blend));
 
     mp_int_t speed = pb_obj_get_int(speed_in);
     mp_int_t target_angle = pb_obj_get_int(target_angle_in);
     pbio_actuation_t then = pb_type_enum_get_value(then_in, &pb_enum_type_Stop);
 
-    // Call pbio with parsed user/default arguments
-    pb_assert(pbio_servo_run_target(self->srv, speed, target_angle, then));
+    // With blend, run to the target after the ongoing run_target commands
+    // without stopping in between. Otherwise, replace the ongoing command.
+    if (mp_obj_is_true(blend_in)) {
+        pb_assert(pbio_servo_queue_target(self->srv, speed, target_angle, then));
+    } else {
+        pb_assert(pbio_servo_run_target(self->srv, speed, target_angle, then));
+    }
 
     if (mp_obj_is_true(wait_in)) {
-        wait_for_completion(self->srv);
+        wait_for_maneuver(self->srv, pbio_control_get_last_maneuver(&self->srv->control));
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_servo(self->srv);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(common_Motor_run_target_obj, 1, common_Motor_run_target);
 
@@ -103,6 +103,105 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_0(pb_type_System_shutdown_obj, pb_type_System_shu
 
 #endif // PBIO_CONFIG_ENABLE_SYS
 
+#if PBIO_CONFIG_PROFILER
+
+#include <pbio/profiler.h>
+
+#include <pybricks/util_mp/pb_kwarg_helper.h>
+
+STATIC mp_obj_t pb_type_System_profile(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_FALSE(reset));
+
+    // Copy the statistics first, since allocating can run background processes.
+    uint8_t num_processes = pbio_profiler_get_num_processes();
+    pbio_profiler_stats_t stats[PBIO_CONFIG_PROFILER_NUM_PROCESSES];
+    for (uint8_t i = 0; i < num_processes; i++) {
+        pbio_profiler_get_stats(i, &stats[i]);
+    }
+    mp_int_t max_queue_depth = pbio_profiler_get_max_queue_depth();
+
+    if (mp_obj_is_true(reset_in)) {
+        pbio_profiler_reset();
+    }
+
+    // Each process is reported as (name, calls, total time, max time)
+    mp_obj_t processes[PBIO_CONFIG_PROFILER_NUM_PROCESSES];
+    for (uint8_t i = 0; i < num_processes; i++) {
+        mp_obj_t values[] = {
+            mp_obj_new_str(stats[i].name, strlen(stats[i].name)),
+            mp_obj_new_int_from_uint(stats[i].calls),
+            mp_obj_new_int_from_uint(stats[i].total_time),
+            mp_obj_new_int_from_uint(stats[i].max_time),
+        };
+        processes[i] = mp_obj_new_tuple(MP_ARRAY_SIZE(values), values);
+    }
+
+    mp_obj_t ret[] = {
+        MP_OBJ_NEW_SMALL_INT(max_queue_depth),
+        mp_obj_new_tuple(num_processes, processes),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(ret), ret);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_System_profile_obj, 0, pb_type_System_profile);
+
+#if PBDRV_CONFIG_NUM_MOTOR_CONTROLLER != 0
+
+#include <pbio/motor_process.h>
+
+STATIC mp_obj_t pb_type_System_control_stats(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    PB_PARSE_ARGS_FUNCTION(n_args, pos_args, kw_args,
+        PB_ARG_DEFAULT_FALSE(reset));
+
+    pbio_motor_process_stats_t stats;
+    pbio_motor_process_get_stats(&stats);
+
+    if (mp_obj_is_true(reset_in)) {
+        pbio_motor_process_reset_stats();
+    }
+
+    // Reported as (updates, overruns, max jitter, total jitter, max run time,
+    // max writes, total writes). Writes are 0 if the motor driver does not
+    // defer them.
+    mp_obj_t ret[] = {
+        mp_obj_new_int_from_uint(stats.updates),
+        mp_obj_new_int_from_uint(stats.overruns),
+        mp_obj_new_int_from_uint(stats.jitter_max),
+        mp_obj_new_int_from_ull(stats.jitter_total),
+        mp_obj_new_int_from_uint(stats.run_time_max),
+        mp_obj_new_int_from_uint(stats.writes_max),
+        mp_obj_new_int_from_ull(stats.writes_total),
+    };
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(ret), ret);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(pb_type_System_control_stats_obj, 0, pb_type_System_control_stats);
+
+#endif // PBDRV_CONFIG_NUM_MOTOR_CONTROLLER
+
+#if PBDRV_CONFIG_PWM_FRAME
+
+#include <pbdrv/pwm.h>
+
+STATIC mp_obj_t pb_type_System_pwm_transfers(void) {
+    // Each PWM device is reported as the number of times it sent its duty
+    // cycles to the hardware, or 0 if the driver does not count transfers.
+    mp_obj_t counts[PBDRV_CONFIG_PWM_NUM_DEV];
+    for (uint8_t i = 0; i < PBDRV_CONFIG_PWM_NUM_DEV; i++) {
+        pbdrv_pwm_dev_t *dev;
+        uint32_t count = 0;
+        if (pbdrv_pwm_get_dev(i, &dev) == PBIO_SUCCESS) {
+            count = pbdrv_pwm_get_transfer_count(dev);
+        }
+        counts[i] = mp_obj_new_int_from_uint(count);
+    }
+    return mp_obj_new_tuple(PBDRV_CONFIG_PWM_NUM_DEV, counts);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(pb_type_System_pwm_transfers_obj, pb_type_System_pwm_transfers);
+
+#endif // PBDRV_CONFIG_PWM_FRAME
+
+#endif // PBIO_CONFIG_PROFILER
+
 // dir(pybricks.common.System)
 STATIC const mp_rom_map_elem_t common_System_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_name), MP_ROM_PTR(&pb_type_System_name_obj) },
@@ -114,6 +213,15 @@ STATIC const mp_rom_map_elem_t common_System_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_set_stop_button), MP_ROM_PTR(&pb_type_System_set_stop_button_obj) },
     { MP_ROM_QSTR(MP_QSTR_shutdown), MP_ROM_PTR(&pb_type_System_shutdown_obj) },
     #endif
+    #if PBIO_CONFIG_PROFILER
+    { MP_ROM_QSTR(MP_QSTR_profile), MP_ROM_PTR(&pb_type_System_profile_obj) },
+    #if PBDRV_CONFIG_NUM_MOTOR_CONTROLLER != 0
+    { MP_ROM_QSTR(MP_QSTR_control_stats), MP_ROM_PTR(&pb_type_System_control_stats_obj) },
+    #endif
+    #if PBDRV_CONFIG_PWM_FRAME
+    { MP_ROM_QSTR(MP_QSTR_pwm_transfers), MP_ROM_PTR(&pb_type_System_pwm_transfers_obj) },
+    #endif
+    #endif
 };
 STATIC MP_DEFINE_CONST_DICT(common_System_locals_dict, common_System_locals_dict_table);
 
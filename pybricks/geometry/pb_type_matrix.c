@@ -10,6 +10,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "py/gc.h"
+
 #include <pybricks/geometry.h>
 
 #include <pybricks/util_mp/pb_kwarg_helper.h>
@@ -18,6 +20,16 @@
 
 #if MICROPY_PY_BUILTINS_FLOAT
 
+// Distance in data between two scalars in the same column (row stride) or in
+// the same row (column stride). Transposed attribute tells us whether data is
+// stored row by row or column by column.
+#define ROW_STRIDE(mat) ((mat)->transposed ? 1 : (mat)->n)
+#define COL_STRIDE(mat) ((mat)->transposed ? (mat)->m : 1)
+
+// Largest result of an in-place operation that can be computed when the output
+// shares data with one of the operands.
+#define TMP_SIZE (16)
+
 // pybricks.geometry.Matrix.__init__
 STATIC mp_obj_t pb_type_Matrix_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     PB_PARSE_ARGS_CLASS(n_args, n_kw, args,
@@ -178,6 +190,67 @@ void pb_type_Matrix_print(const mp_print_t *print, mp_obj_t self_in, mp_print_ki
     mp_print_str(print, "])");
 }
 
+// Computes dest = lhs + rhs with the given scale for rhs, row by row. This is
+// lhs - rhs if rhs_scale is the negated scale of rhs. dest may be the data of
+// either operand if that operand is not transposed.
+STATIC void pb_type_Matrix__add_data(float *dest, const pb_type_Matrix_obj_t *lhs, const pb_type_Matrix_obj_t *rhs, float rhs_scale) {
+
+    size_t lhs_rs = ROW_STRIDE(lhs);
+    size_t lhs_cs = COL_STRIDE(lhs);
+    size_t rhs_rs = ROW_STRIDE(rhs);
+    size_t rhs_cs = COL_STRIDE(rhs);
+
+    // Add the matrices by looping over rows and columns
+    for (size_t r = 0; r < lhs->m; r++) {
+        for (size_t c = 0; c < lhs->n; c++) {
+            dest[r * lhs->n + c] = lhs->data[r * lhs_rs + c * lhs_cs] * lhs->scale + rhs->data[r * rhs_rs + c * rhs_cs] * rhs_scale;
+        }
+    }
+}
+
+// Computes dest = lhs * rhs * scale + addend row by row. The addend is
+// optional. dest must not be the data of lhs or rhs. It may be the data of the
+// addend if the addend is not transposed.
+STATIC void pb_type_Matrix__mul_data(float *dest, const pb_type_Matrix_obj_t *lhs, const pb_type_Matrix_obj_t *rhs, float scale, const pb_type_Matrix_obj_t *addend) {
+
+    const float *a = lhs->data;
+    const float *b = rhs->data;
+    size_t a_rs = ROW_STRIDE(lhs);
+    size_t a_cs = COL_STRIDE(lhs);
+    size_t b_rs = ROW_STRIDE(rhs);
+    size_t b_cs = COL_STRIDE(rhs);
+    size_t m = lhs->m;
+    size_t n = rhs->n;
+
+    for (size_t c = 0; c < n; c++) {
+        for (size_t r = 0; r < m; r++) {
+            float sum;
+
+            if (lhs->n == 3) {
+                // Rotations and cross products multiply by 3x3 matrices, so
+                // unroll the inner product for this common case.
+                const float *ar = a + r * a_rs;
+                const float *bc = b + c * b_cs;
+                sum = ar[0] * bc[0] + ar[a_cs] * bc[b_rs] + ar[2 * a_cs] * bc[2 * b_rs];
+            } else {
+                // This entry is obtained as the sum of the products of the entries
+                // of the r'th row of lhs and the c'th column of rhs, so size lhs->n.
+                sum = 0;
+                for (size_t k = 0; k < lhs->n; k++) {
+                    sum += a[r * a_rs + k * a_cs] * b[k * b_rs + c * b_cs];
+                }
+            }
+
+            size_t idx = r * n + c;
+            if (addend) {
+                dest[idx] = sum * scale + addend->data[r * ROW_STRIDE(addend) + c * COL_STRIDE(addend)] * addend->scale;
+            } else {
+                dest[idx] = sum * scale;
+            }
+        }
+    }
+}
+
 // pybricks.geometry.Matrix._add
 STATIC mp_obj_t pb_type_Matrix__add(mp_obj_t lhs_obj, mp_obj_t rhs_obj, bool add) {
 
@@ -197,28 +270,12 @@ STATIC mp_obj_t pb_type_Matrix__add(mp_obj_t lhs_obj, mp_obj_t rhs_obj, bool add
     ret->n = rhs->n;
     ret->data = m_new(float, ret->m * ret->n);
 
-    // Scale must be reset; it has been and multiplied out above
+    // Scale must be reset; it is multiplied out in the sum
     ret->scale = 1;
     ret->transposed = false;
 
-    // Add the matrices by looping over rows and columns
-    for (size_t r = 0; r < ret->m; r++) {
-        for (size_t c = 0; c < ret->n; c++) {
-            // This entry is obtained as the sum of scalars of both matrices
-            // First find the index of sources and destination.
-            size_t ret_idx = r * ret->n + c;
-            size_t lhs_idx = lhs->transposed ? c * ret->m + r : ret_idx;
-            size_t rhs_idx = rhs->transposed ? c * ret->m + r : ret_idx;
-
-            // Either add or subtract to get result.
-            if (add) {
-                ret->data[ret_idx] = lhs->data[lhs_idx] * lhs->scale + rhs->data[rhs_idx] * rhs->scale;
-            } else {
-                ret->data[ret_idx] = lhs->data[lhs_idx] * lhs->scale - rhs->data[rhs_idx] * rhs->scale;
-            }
-
-        }
-    }
+    // Either add or subtract to get result.
+    pb_type_Matrix__add_data(ret->data, lhs, rhs, add ? rhs->scale : -rhs->scale);
 
     return MP_OBJ_FROM_PTR(ret);
 }
@@ -246,22 +303,8 @@ STATIC mp_obj_t pb_type_Matrix__mul(mp_obj_t lhs_in, mp_obj_t rhs_in) {
     ret->scale = lhs->scale * rhs->scale;
     ret->transposed = false;
 
-    // Multiply the matrices by looping over rows and columns
-    for (size_t r = 0; r < ret->m; r++) {
-        for (size_t c = 0; c < ret->n; c++) {
-            // This entry is obtained as the sum of the products of the entries
-            // of the r'th row of lhs and the c'th column of rhs, so size lhs->n.
-            float sum = 0;
-            for (size_t k = 0; k < lhs->n; k++) {
-                // k'th entry on the r'th row (i = r, j = k)
-                size_t lhs_idx = lhs->transposed ? k * lhs->m + r : r * lhs->n + k;
-                // k'th entry on the c'th column  (i = k, j = c)
-                size_t rhs_idx = rhs->transposed ? c * rhs->m + k : k * rhs->n + c;
-                sum += lhs->data[lhs_idx] * rhs->data[rhs_idx];
-            }
-            ret->data[ret->n * r + c] = sum;
-        }
-    }
+    // Multiply the matrices
+    pb_type_Matrix__mul_data(ret->data, lhs, rhs, 1, NULL);
 
     // If the result is a 1x1, return as scalar. This solves all the
     // usual matrix library problems where you have to type things like
@@ -320,6 +363,155 @@ STATIC mp_obj_t pb_type_Matrix__T(mp_obj_t self_in) {
     return MP_OBJ_FROM_PTR(copy);
 }
 
+// Gets a matrix argument of an in-place operation.
+STATIC pb_type_Matrix_obj_t *pb_type_Matrix__get_arg(mp_obj_t arg_in) {
+    if (!mp_obj_is_type(arg_in, &pb_type_Matrix)) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    return MP_OBJ_TO_PTR(arg_in);
+}
+
+// Gets the output of an in-place operation, which must have the shape of the
+// result. Constant matrices such as Axis.X are not on the heap, so they can't
+// be used as output.
+STATIC pb_type_Matrix_obj_t *pb_type_Matrix__get_out(mp_obj_t out_in, size_t m, size_t n) {
+    pb_type_Matrix_obj_t *out = pb_type_Matrix__get_arg(out_in);
+    if (out->m != m || out->n != n || gc_nbytes(out->data) == 0) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    return out;
+}
+
+// Gets where to compute the result of an in-place operation. That is the data
+// of the output, unless the operands must be read after that data is written.
+// In that case, the result is computed in tmp first.
+STATIC float *pb_type_Matrix__get_dest(pb_type_Matrix_obj_t *out, bool overlap, float *tmp) {
+    if (!overlap) {
+        return out->data;
+    }
+    if (out->m * out->n > TMP_SIZE) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    return tmp;
+}
+
+// Stores the result of an in-place operation in the output. The result is
+// stored row by row and already includes the scale.
+STATIC mp_obj_t pb_type_Matrix__set_out(pb_type_Matrix_obj_t *out, const float *dest) {
+    if (dest != out->data) {
+        memcpy(out->data, dest, out->m * out->n * sizeof(float));
+    }
+    out->scale = 1;
+    out->transposed = false;
+    return MP_OBJ_FROM_PTR(out);
+}
+
+// Checks if the output of an in-place operation would overwrite an operand
+// before it is read element by element.
+STATIC bool pb_type_Matrix__overlaps(const pb_type_Matrix_obj_t *out, const pb_type_Matrix_obj_t *arg) {
+    return arg->data == out->data && arg->transposed;
+}
+
+// pybricks.geometry.Matrix._add_into
+STATIC mp_obj_t pb_type_Matrix__add_into(mp_obj_t self_in, mp_obj_t other_in, mp_obj_t out_in, bool add) {
+    pb_type_Matrix_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    pb_type_Matrix_obj_t *other = pb_type_Matrix__get_arg(other_in);
+
+    if (self->m != other->m || self->n != other->n) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+    pb_type_Matrix_obj_t *out = pb_type_Matrix__get_out(out_in, self->m, self->n);
+
+    float tmp[TMP_SIZE];
+    float *dest = pb_type_Matrix__get_dest(out, pb_type_Matrix__overlaps(out, self) || pb_type_Matrix__overlaps(out, other), tmp);
+    pb_type_Matrix__add_data(dest, self, other, add ? other->scale : -other->scale);
+    return pb_type_Matrix__set_out(out, dest);
+}
+
+// pybricks.geometry.Matrix.add_into
+STATIC mp_obj_t pb_type_Matrix_add_into(mp_obj_t self_in, mp_obj_t other_in, mp_obj_t out_in) {
+    return pb_type_Matrix__add_into(self_in, other_in, out_in, true);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(pb_type_Matrix_add_into_obj, pb_type_Matrix_add_into);
+
+// pybricks.geometry.Matrix.sub_into
+STATIC mp_obj_t pb_type_Matrix_sub_into(mp_obj_t self_in, mp_obj_t other_in, mp_obj_t out_in) {
+    return pb_type_Matrix__add_into(self_in, other_in, out_in, false);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(pb_type_Matrix_sub_into_obj, pb_type_Matrix_sub_into);
+
+// pybricks.geometry.Matrix._mul_into
+STATIC mp_obj_t pb_type_Matrix__mul_into(mp_obj_t self_in, mp_obj_t other_in, mp_obj_t addend_in, mp_obj_t out_in) {
+    pb_type_Matrix_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    pb_type_Matrix_obj_t *other = pb_type_Matrix__get_arg(other_in);
+
+    if (self->n != other->m) {
+        pb_assert(PBIO_ERROR_INVALID_ARG);
+    }
+
+    pb_type_Matrix_obj_t *addend = NULL;
+    if (addend_in != MP_OBJ_NULL) {
+        addend = pb_type_Matrix__get_arg(addend_in);
+        if (addend->m != self->m || addend->n != other->n) {
+            pb_assert(PBIO_ERROR_INVALID_ARG);
+        }
+    }
+    pb_type_Matrix_obj_t *out = pb_type_Matrix__get_out(out_in, self->m, other->n);
+
+    // Each scalar of the operands is read several times, so the output may
+    // not share data with them at all.
+    bool overlap = self->data == out->data || other->data == out->data || (addend && pb_type_Matrix__overlaps(out, addend));
+
+    float tmp[TMP_SIZE];
+    float *dest = pb_type_Matrix__get_dest(out, overlap, tmp);
+    pb_type_Matrix__mul_data(dest, self, other, self->scale * other->scale, addend);
+    return pb_type_Matrix__set_out(out, dest);
+}
+
+// pybricks.geometry.Matrix.mul_into
+STATIC mp_obj_t pb_type_Matrix_mul_into(mp_obj_t self_in, mp_obj_t other_in, mp_obj_t out_in) {
+    return pb_type_Matrix__mul_into(self_in, other_in, MP_OBJ_NULL, out_in);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(pb_type_Matrix_mul_into_obj, pb_type_Matrix_mul_into);
+
+// pybricks.geometry.Matrix.mul_add_into
+STATIC mp_obj_t pb_type_Matrix_mul_add_into(size_t n_args, const mp_obj_t *args) {
+    return pb_type_Matrix__mul_into(args[0], args[1], args[2], args[3]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(pb_type_Matrix_mul_add_into_obj, 4, 4, pb_type_Matrix_mul_add_into);
+
+// pybricks.geometry.Matrix.transpose_into
+STATIC mp_obj_t pb_type_Matrix_transpose_into(mp_obj_t self_in, mp_obj_t out_in) {
+    pb_type_Matrix_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    pb_type_Matrix_obj_t *out = pb_type_Matrix__get_out(out_in, self->n, self->m);
+
+    // Vectors have the same data when transposed, but other matrices are
+    // read in a different order than they are written.
+    bool overlap = self->data == out->data && self->m != 1 && self->n != 1;
+
+    float tmp[TMP_SIZE];
+    float *dest = pb_type_Matrix__get_dest(out, overlap, tmp);
+    size_t rs = ROW_STRIDE(self);
+    size_t cs = COL_STRIDE(self);
+    for (size_t r = 0; r < out->m; r++) {
+        for (size_t c = 0; c < out->n; c++) {
+            dest[r * out->n + c] = self->data[c * rs + r * cs] * self->scale;
+        }
+    }
+    return pb_type_Matrix__set_out(out, dest);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(pb_type_Matrix_transpose_into_obj, pb_type_Matrix_transpose_into);
+
+// dir(pybricks.geometry.Matrix)
+STATIC const mp_rom_map_elem_t pb_type_Matrix_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_add_into),       MP_ROM_PTR(&pb_type_Matrix_add_into_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_sub_into),       MP_ROM_PTR(&pb_type_Matrix_sub_into_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_mul_into),       MP_ROM_PTR(&pb_type_Matrix_mul_into_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_mul_add_into),   MP_ROM_PTR(&pb_type_Matrix_mul_add_into_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_transpose_into), MP_ROM_PTR(&pb_type_Matrix_transpose_into_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(pb_type_Matrix_locals_dict, pb_type_Matrix_locals_dict_table);
+
 STATIC void pb_type_Matrix_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
     // Read only
     if (dest[0] == MP_OBJ_NULL) {
@@ -340,6 +532,8 @@ STATIC void pb_type_Matrix_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
             dest[0] = mp_obj_new_tuple(2, shape);
             return;
         }
+        // Continue lookup in locals dict
+        dest[1] = MP_OBJ_SENTINEL;
     }
 }
 
@@ -478,6 +672,7 @@ const mp_obj_type_t pb_type_Matrix = {
     .unary_op = pb_type_Matrix_unary_op,
     .binary_op = pb_type_Matrix_binary_op,
     .subscr = pb_type_Matrix_subscr,
+    .locals_dict = (mp_obj_dict_t *)&pb_type_Matrix_locals_dict,
 };
 
 // pybricks.geometry._make_vector
@@ -62,7 +62,7 @@ STATIC mp_obj_t iodevices_Ev3devSensor_read(size_t n_args, const mp_obj_t *pos_a
     mp_obj_t objs[PBIO_IODEV_MAX_DATA_SIZE];
     pb_device_get_values(self->pbdev, mode_idx, data);
 
-    uint8_t num_values = pb_device_get_num_values(self->pbdev);
+    uint8_t num_values = pb_device_get_num_values(self->pbdev, mode_idx);
 
     // Return as MicroPython objects
     for (uint8_t i = 0; i < num_values; i++) {
@@ -51,10 +51,11 @@ STATIC mp_obj_t iodevices_LUMPDevice_read(size_t n_args, const mp_obj_t *pos_arg
     // Get data already in correct data format
     int32_t data[PBIO_IODEV_MAX_DATA_SIZE];
     mp_obj_t objs[PBIO_IODEV_MAX_DATA_SIZE];
-    pb_device_get_values(self->pbdev, mp_obj_get_int(mode_in), data);
+    uint8_t mode = mp_obj_get_int(mode_in);
+    pb_device_get_values(self->pbdev, mode, data);
 
     // Get info about the sensor and its mode
-    uint8_t num_values = pb_device_get_num_values(self->pbdev);
+    uint8_t num_values = pb_device_get_num_values(self->pbdev, mode);
 
     // Return as MicroPython objects
     for (uint8_t i = 0; i < num_values; i++) {
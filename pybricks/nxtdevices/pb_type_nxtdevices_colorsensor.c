@@ -17,7 +17,7 @@
 // pybricks.nxtdevices.ColorSensor class object. Note: first two members must match pb_ColorSensor_obj_t
 typedef struct _nxtdevices_ColorSensor_obj_t {
     mp_obj_base_t base;
-    mp_obj_t color_map;
+    pb_color_map_t *color_map;
     mp_obj_t light;
     pb_device_t *pbdev;
 } nxtdevices_ColorSensor_obj_t;
@@ -137,7 +137,7 @@ STATIC mp_obj_t nxtdevices_ColorSensor_color(mp_obj_t self_in) {
     color_map_rgb_to_hsv(&rgb, &hsv);
 
     // Get and return discretized color based on HSV
-    return pb_color_map_get_color(&self->color_map, &hsv);
+    return pb_color_map_get_color(self->color_map, &hsv);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(nxtdevices_ColorSensor_color_obj, nxtdevices_ColorSensor_color);
 
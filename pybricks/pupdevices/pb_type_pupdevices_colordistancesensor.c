@@ -20,7 +20,7 @@
 // Class structure for ColorDistanceSensor. Note: first two members must match pb_ColorSensor_obj_t
 typedef struct _pupdevices_ColorDistanceSensor_obj_t {
     mp_obj_base_t base;
-    mp_obj_t color_map;
+    pb_color_map_t *color_map;
     pb_device_t *pbdev;
     mp_obj_t light;
 } pupdevices_ColorDistanceSensor_obj_t;
@@ -103,7 +103,7 @@ STATIC mp_obj_t pupdevices_ColorDistanceSensor_color(mp_obj_t self_in) {
     pupdevices_ColorDistanceSensor__hsv(self, &hsv);
 
     // Get and return discretized color based on HSV
-    return pb_color_map_get_color(&self->color_map, &hsv);
+    return pb_color_map_get_color(self->color_map, &hsv);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(pupdevices_ColorDistanceSensor_color_obj, pupdevices_ColorDistanceSensor_color);
 
@@ -20,7 +20,7 @@
 // Class structure for ColorSensor. Note: first two members must match pb_ColorSensor_obj_t
 typedef struct _pupdevices_ColorSensor_obj_t {
     mp_obj_base_t base;
-    mp_obj_t color_map;
+    pb_color_map_t *color_map;
     pb_device_t *pbdev;
     mp_obj_t lights;
 } pupdevices_ColorSensor_obj_t;
@@ -122,7 +122,7 @@ STATIC mp_obj_t pupdevices_ColorSensor_color(size_t n_args, const mp_obj_t *pos_
     }
 
     // Get and return discretized color
-    return pb_color_map_get_color(&self->color_map, &hsv);
+    return pb_color_map_get_color(self->color_map, &hsv);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(pupdevices_ColorSensor_color_obj, 1, pupdevices_ColorSensor_color);
 
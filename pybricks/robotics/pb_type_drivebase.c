@@ -14,6 +14,7 @@
 
 #include <pybricks/common.h>
 #include <pybricks/parameters.h>
+#include <pybricks/tools.h>
 
 #include <pybricks/util_mp/pb_kwarg_helper.h>
 #include <pybricks/util_mp/pb_obj_helper.h>
@@ -45,6 +46,8 @@ STATIC mp_obj_t robotics_DriveBase_reset(mp_obj_t self_in) {
     self->initial_distance = distance;
     self->initial_heading = angle;
 
+    pb_assert(pbio_drivebase_reset_pose(self->db));
+
     return mp_const_none;
 }
 MP_DEFINE_CONST_FUN_OBJ_1(robotics_DriveBase_reset_obj, robotics_DriveBase_reset);
@@ -117,9 +120,11 @@ STATIC mp_obj_t robotics_DriveBase_straight(size_t n_args, const mp_obj_t *pos_a
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion_drivebase(self->db);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_drivebase(self->db);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(robotics_DriveBase_straight_obj, 1, robotics_DriveBase_straight);
 
@@ -139,9 +144,11 @@ STATIC mp_obj_t robotics_DriveBase_turn(size_t n_args, const mp_obj_t *pos_args,
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion_drivebase(self->db);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_drivebase(self->db);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(robotics_DriveBase_turn_obj, 1, robotics_DriveBase_turn);
 
@@ -162,9 +169,11 @@ STATIC mp_obj_t robotics_DriveBase_curve(size_t n_args, const mp_obj_t *pos_args
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion_drivebase(self->db);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_drivebase(self->db);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(robotics_DriveBase_curve_obj, 1, robotics_DriveBase_curve);
 
@@ -232,6 +241,39 @@ STATIC mp_obj_t robotics_DriveBase_state(mp_obj_t self_in) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(robotics_DriveBase_state_obj, robotics_DriveBase_state);
 
+// pybricks.robotics.DriveBase.pose
+STATIC mp_obj_t robotics_DriveBase_pose(mp_obj_t self_in) {
+    robotics_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    int32_t x, y, heading;
+    pb_assert(pbio_drivebase_get_pose_user(self->db, &x, &y, &heading));
+
+    mp_obj_t ret[3];
+    ret[0] = mp_obj_new_int(x);
+    ret[1] = mp_obj_new_int(y);
+    ret[2] = mp_obj_new_int(heading);
+
+    return mp_obj_new_tuple(3, ret);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(robotics_DriveBase_pose_obj, robotics_DriveBase_pose);
+
+#if PYBRICKS_PY_COMMON_IMU
+// pybricks.robotics.DriveBase.use_gyro
+STATIC mp_obj_t robotics_DriveBase_use_gyro(mp_obj_t self_in, mp_obj_t use_gyro_in) {
+    robotics_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    // The gyro may not have a sample yet right after boot
+    pbio_error_t err;
+    while ((err = pbio_drivebase_set_use_gyro(self->db, mp_obj_is_true(use_gyro_in))) == PBIO_ERROR_AGAIN) {
+        mp_hal_delay_ms(5);
+    }
+    pb_assert(err);
+
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(robotics_DriveBase_use_gyro_obj, robotics_DriveBase_use_gyro);
+#endif // PYBRICKS_PY_COMMON_IMU
+
 // pybricks.robotics.DriveBase.busy
 STATIC mp_obj_t robotics_DriveBase_busy(mp_obj_t self_in) {
     robotics_DriveBase_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -298,8 +340,12 @@ STATIC const mp_rom_map_elem_t robotics_DriveBase_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_angle),            MP_ROM_PTR(&robotics_DriveBase_angle_obj)    },
     { MP_ROM_QSTR(MP_QSTR_busy),             MP_ROM_PTR(&robotics_DriveBase_busy_obj)     },
     { MP_ROM_QSTR(MP_QSTR_state),            MP_ROM_PTR(&robotics_DriveBase_state_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_pose),             MP_ROM_PTR(&robotics_DriveBase_pose_obj)     },
     { MP_ROM_QSTR(MP_QSTR_reset),            MP_ROM_PTR(&robotics_DriveBase_reset_obj)    },
     { MP_ROM_QSTR(MP_QSTR_settings),         MP_ROM_PTR(&robotics_DriveBase_settings_obj) },
+    #if PYBRICKS_PY_COMMON_IMU
+    { MP_ROM_QSTR(MP_QSTR_use_gyro),         MP_ROM_PTR(&robotics_DriveBase_use_gyro_obj) },
+    #endif
 };
 STATIC MP_DEFINE_CONST_DICT(robotics_DriveBase_locals_dict, robotics_DriveBase_locals_dict_table);
 
@@ -14,6 +14,7 @@
 
 #include <pybricks/common.h>
 #include <pybricks/parameters.h>
+#include <pybricks/tools.h>
 
 #include <pybricks/util_mp/pb_kwarg_helper.h>
 #include <pybricks/util_mp/pb_obj_helper.h>
@@ -85,9 +86,11 @@ STATIC mp_obj_t robotics_SpikeBase_tank_move_for_degrees(size_t n_args, const mp
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion_drivebase(self->db);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_drivebase(self->db);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(robotics_SpikeBase_tank_move_for_degrees_obj, 1, robotics_SpikeBase_tank_move_for_degrees);
 
@@ -111,9 +114,11 @@ STATIC mp_obj_t robotics_SpikeBase_tank_move_for_time(size_t n_args, const mp_ob
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion_drivebase(self->db);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_drivebase(self->db);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(robotics_SpikeBase_tank_move_for_time_obj, 1, robotics_SpikeBase_tank_move_for_time);
 
@@ -142,9 +147,11 @@ STATIC mp_obj_t robotics_SpikeBase_steering_move_for_degrees(size_t n_args, cons
 
     if (mp_obj_is_true(wait_in)) {
         wait_for_completion_drivebase(self->db);
+        return mp_const_none;
     }
 
-    return mp_const_none;
+    // Return a task that can be polled or awaited
+    return pb_type_Task_new_drivebase(self->db);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(robotics_SpikeBase_steering_move_for_degrees_obj, 1, robotics_SpikeBase_steering_move_for_degrees);
 
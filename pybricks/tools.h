@@ -12,6 +12,16 @@
 
 extern const mp_obj_type_t pb_type_StopWatch;
 
+#if PYBRICKS_PY_COMMON_MOTORS
+#include <pbio/servo.h>
+mp_obj_t pb_type_Task_new_servo(pbio_servo_t *srv);
+#endif
+
+#if PYBRICKS_PY_COMMON_MOTORS && PYBRICKS_PY_ROBOTICS
+#include <pbio/drivebase.h>
+mp_obj_t pb_type_Task_new_drivebase(pbio_drivebase_t *db);
+#endif
+
 extern const mp_obj_module_t pb_module_tools;
 
 #endif // PYBRICKS_PY_TOOLS
@@ -26,9 +26,38 @@ STATIC mp_obj_t tools_wait(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(tools_wait_obj, 0, tools_wait);
 
+// Runs tasks, generators and coroutines side by side until all of them are done
+STATIC mp_obj_t tools_wait_all(size_t n_args, const mp_obj_t *args) {
+    mp_obj_t *iters = m_new(mp_obj_t, n_args);
+    size_t busy = n_args;
+
+    for (size_t i = 0; i < n_args; i++) {
+        iters[i] = mp_getiter(args[i], NULL);
+    }
+
+    for (;;) {
+        // Give each unfinished one a turn
+        for (size_t i = 0; i < n_args; i++) {
+            if (iters[i] != MP_OBJ_NULL && mp_iternext(iters[i]) == MP_OBJ_STOP_ITERATION) {
+                iters[i] = MP_OBJ_NULL;
+                busy--;
+            }
+        }
+        if (busy == 0) {
+            break;
+        }
+        mp_hal_delay_ms(5);
+    }
+
+    m_del(mp_obj_t, iters, n_args);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR(tools_wait_all_obj, 0, tools_wait_all);
+
 STATIC const mp_rom_map_elem_t tools_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),    MP_ROM_QSTR(MP_QSTR_tools)      },
     { MP_ROM_QSTR(MP_QSTR_wait),        MP_ROM_PTR(&tools_wait_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_wait_all),    MP_ROM_PTR(&tools_wait_all_obj) },
     { MP_ROM_QSTR(MP_QSTR_StopWatch),   MP_ROM_PTR(&pb_type_StopWatch)  },
 };
 STATIC MP_DEFINE_CONST_DICT(pb_module_tools_globals, tools_globals_table);
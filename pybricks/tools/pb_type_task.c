@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2021 The Pybricks Authors
+
+#include "py/mpconfig.h"
+
+#if PYBRICKS_PY_TOOLS && PYBRICKS_PY_COMMON_MOTORS
+
+#include <pbio/control_task.h>
+#include <pbio/drivebase.h>
+#include <pbio/servo.h>
+#include <pbio/task.h>
+
+#include "py/mphal.h"
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include <pybricks/tools.h>
+
+#include <pybricks/util_pb/pb_error.h>
+
+// pybricks.tools.Task class object
+typedef struct _tools_Task_obj_t {
+    mp_obj_base_t base;
+    pbio_control_task_t ct;
+    pbio_servo_t *srv;
+    pbio_drivebase_t *db;
+} tools_Task_obj_t;
+
+// Runs the task if it is still going and returns true once it is done
+STATIC bool tools_Task_poll(tools_Task_obj_t *self) {
+    if (self->ct.task.status == PBIO_ERROR_AGAIN) {
+        pbio_task_run_once(&self->ct.task);
+    }
+    return self->ct.task.status != PBIO_ERROR_AGAIN;
+}
+
+// Raises an exception if the maneuver ended because the device went away
+STATIC void tools_Task_assert_running(tools_Task_obj_t *self) {
+    #if PYBRICKS_PY_ROBOTICS
+    if (self->db && !pbio_drivebase_update_loop_is_running(self->db)) {
+        pb_assert(PBIO_ERROR_NO_DEV);
+    }
+    #endif
+    if (self->srv && !pbio_servo_update_loop_is_running(self->srv)) {
+        pb_assert(PBIO_ERROR_NO_DEV);
+    }
+}
+
+// pybricks.tools.Task.done
+STATIC mp_obj_t tools_Task_done(mp_obj_t self_in) {
+    tools_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!tools_Task_poll(self)) {
+        return mp_const_false;
+    }
+    tools_Task_assert_running(self);
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(tools_Task_done_obj, tools_Task_done);
+
+// pybricks.tools.Task.wait
+STATIC mp_obj_t tools_Task_wait(mp_obj_t self_in) {
+    tools_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    while (!tools_Task_poll(self)) {
+        mp_hal_delay_ms(5);
+    }
+    tools_Task_assert_running(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(tools_Task_wait_obj, tools_Task_wait);
+
+// Each step of iteration runs the task once, so it can be used with
+// "yield from" in generators, "await" in coroutines and wait_all().
+STATIC mp_obj_t tools_Task_iternext(mp_obj_t self_in) {
+    tools_Task_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!tools_Task_poll(self)) {
+        return mp_const_none;
+    }
+    tools_Task_assert_running(self);
+    return MP_OBJ_STOP_ITERATION;
+}
+
+// dir(pybricks.tools.Task)
+STATIC const mp_rom_map_elem_t tools_Task_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_done), MP_ROM_PTR(&tools_Task_done_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&tools_Task_wait_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(tools_Task_locals_dict, tools_Task_locals_dict_table);
+
+// type(pybricks.tools.Task)
+STATIC const mp_obj_type_t tools_Task_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Task,
+    .getiter = mp_identity_getiter,
+    .iternext = tools_Task_iternext,
+    .locals_dict = (mp_obj_dict_t *)&tools_Task_locals_dict,
+};
+
+STATIC tools_Task_obj_t *tools_Task_new(pbio_control_t *ctl_a, pbio_control_t *ctl_b) {
+    tools_Task_obj_t *self = m_new_obj(tools_Task_obj_t);
+    self->base.type = &tools_Task_type;
+    self->srv = NULL;
+    self->db = NULL;
+    pbio_control_task_init(&self->ct, ctl_a, ctl_b);
+    return self;
+}
+
+// Makes a task that completes when the ongoing servo maneuver is done
+mp_obj_t pb_type_Task_new_servo(pbio_servo_t *srv) {
+    tools_Task_obj_t *self = tools_Task_new(&srv->control, NULL);
+    self->srv = srv;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+#if PYBRICKS_PY_ROBOTICS
+// Makes a task that completes when the ongoing drive base maneuver is done
+mp_obj_t pb_type_Task_new_drivebase(pbio_drivebase_t *db) {
+    tools_Task_obj_t *self = tools_Task_new(&db->control_distance, &db->control_heading);
+    self->db = db;
+    return MP_OBJ_FROM_PTR(self);
+}
+#endif // PYBRICKS_PY_ROBOTICS
+
+#endif // PYBRICKS_PY_TOOLS && PYBRICKS_PY_COMMON_MOTORS
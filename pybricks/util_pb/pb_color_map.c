@@ -49,6 +49,25 @@ void color_map_rgb_to_hsv(const pbio_color_rgb_t *rgb, pbio_color_hsv_t *hsv) {
     hsv->v = hsv->v * (200 - hsv->v) / 100;
 }
 
+// A color of the map
+typedef struct {
+    // The color object
+    mp_obj_t color;
+    // Its hsv values, so they don't have to be looked up for every match
+    pbio_color_hsv_t hsv;
+    // Position in the map given by the user
+    size_t order;
+} pb_color_map_entry_t;
+
+struct _pb_color_map_t {
+    // The map given by the user
+    mp_obj_t colors;
+    // Number of entries
+    size_t n;
+    // The colors, sorted by value
+    pb_color_map_entry_t entries[];
+};
+
 STATIC const mp_rom_obj_tuple_t pb_color_map_default = {
     {&mp_type_tuple},
     6,
@@ -62,9 +81,40 @@ STATIC const mp_rom_obj_tuple_t pb_color_map_default = {
     }
 };
 
+// Compile a tuple or list of colors into a map
+STATIC pb_color_map_t *pb_color_map_compile(mp_obj_t colors_in) {
+
+    // Unpack the main list
+    mp_obj_t *colors;
+    size_t n;
+    mp_obj_get_array(colors_in, &n, &colors);
+
+    pb_color_map_t *map = m_new_obj_var(pb_color_map_t, pb_color_map_entry_t, n);
+    map->colors = colors_in;
+    map->n = n;
+
+    // Insert the colors sorted by value. Colors with equal value stay in the
+    // order given by the user.
+    for (size_t i = 0; i < n; i++) {
+        pb_color_map_entry_t entry = {
+            .color = colors[i],
+            .hsv = *pb_type_Color_get_hsv(colors[i]),
+            .order = i,
+        };
+        size_t j = i;
+        while (j > 0 && map->entries[j - 1].hsv.v > entry.hsv.v) {
+            map->entries[j] = map->entries[j - 1];
+            j--;
+        }
+        map->entries[j] = entry;
+    }
+
+    return map;
+}
+
 // Set initial default map
-void pb_color_map_save_default(mp_obj_t *color_map) {
-    *color_map = MP_OBJ_FROM_PTR(&pb_color_map_default);
+void pb_color_map_save_default(pb_color_map_t **color_map) {
+    *color_map = pb_color_map_compile(MP_OBJ_FROM_PTR(&pb_color_map_default));
 }
 
 // Cost function between two colors a and b. The lower, the closer they are.
@@ -96,31 +146,67 @@ static int32_t get_hsv_cost(const pbio_color_hsv_t *x, const pbio_color_hsv_t *c
 }
 
 // Get a discrete color that matches the given hsv values most closely
-mp_obj_t pb_color_map_get_color(mp_obj_t *color_map, pbio_color_hsv_t *hsv) {
-
-    // Unpack the main list
-    mp_obj_t *colors;
-    size_t n;
-    mp_obj_get_array(*color_map, &n, &colors);
+mp_obj_t pb_color_map_get_color(pb_color_map_t *color_map, pbio_color_hsv_t *hsv) {
+
+    const pb_color_map_entry_t *entries = color_map->entries;
+    size_t n = color_map->n;
+
+    // Find the first color with at least the given value
+    size_t lower = 0;
+    size_t upper = n;
+    while (lower < upper) {
+        size_t mid = (lower + upper) / 2;
+        if (entries[mid].hsv.v < hsv->v) {
+            lower = mid + 1;
+        } else {
+            upper = mid;
+        }
+    }
 
     // Initialize minimal cost to maximum
-    mp_obj_t match = mp_const_none;
-    int32_t cost_now = INT32_MAX;
+    const pb_color_map_entry_t *match = NULL;
     int32_t cost_min = INT32_MAX;
 
-    // Compute cost for each candidate
-    for (size_t i = 0; i < n; i++) {
+    // Visit the colors in order of value error, starting from the closest one
+    // below and above the given value. The value error alone adds
+    // 2 * value_error^2 to the cost, so once that exceeds the cost of the
+    // best match so far, no remaining color can be better.
+    size_t below = upper;
+    size_t above = upper;
+    while (below > 0 || above < n) {
+
+        // Pick the nearest remaining color below or above
+        const pb_color_map_entry_t *entry;
+        int32_t value_error;
+        if (above == n || (below > 0 && hsv->v - entries[below - 1].hsv.v < entries[above].hsv.v - hsv->v)) {
+            entry = &entries[--below];
+            value_error = hsv->v - entry->hsv.v;
+        } else {
+            entry = &entries[above++];
+            value_error = entry->hsv.v - hsv->v;
+        }
+
+        if (2 * value_error * value_error > cost_min) {
+            // Colors further away can't be a better match either
+            if (entry->hsv.v < hsv->v) {
+                below = 0;
+            } else {
+                above = n;
+            }
+            continue;
+        }
 
         // Evaluate the cost function
-        cost_now = get_hsv_cost(hsv, pb_type_Color_get_hsv(colors[i]));
+        int32_t cost_now = get_hsv_cost(hsv, &entry->hsv);
 
-        // If cost is less than before, update the minimum and the match
-        if (cost_now < cost_min) {
+        // If cost is less than before, update the minimum and the match. On a
+        // tie, the color that comes first in the user's map wins.
+        if (cost_now < cost_min || (cost_now == cost_min && entry->order < match->order)) {
             cost_min = cost_now;
-            match = colors[i];
+            match = entry;
         }
     }
-    return match;
+    return match ? match->color : mp_const_none;
 }
 
 // Generic class structure for ColorDistanceSensor
@@ -128,7 +214,7 @@ mp_obj_t pb_color_map_get_color(mp_obj_t *color_map, pbio_color_hsv_t *hsv) {
 // must have base and color_map as the first two members.
 typedef struct _pb_ColorSensor_obj_t {
     mp_obj_base_t base;
-    mp_obj_t color_map;
+    pb_color_map_t *color_map;
 } pb_ColorSensor_obj_t;
 
 // pybricks._common.ColorDistanceSensor.detectable_colors
@@ -139,19 +225,12 @@ STATIC mp_obj_t pupdevices_ColorDistanceSensor_detectable_colors(size_t n_args,
 
     // If no arguments are given, return current map
     if (colors_in == mp_const_none) {
-        return self->color_map;
-    }
-
-    // If arguments given, ensure all tuple elements have the right type
-    mp_obj_t *color_objs;
-    size_t n;
-    mp_obj_get_array(colors_in, &n, &color_objs);
-    for (size_t i = 0; i < n; i++) {
-        pb_assert_type(color_objs[i], &pb_type_Color);
+        return self->color_map->colors;
     }
 
-    // Save the given map
-    self->color_map = colors_in;
+    // Save the given map, compiled for faster matching. This also ensures
+    // all tuple elements have the right type.
+    self->color_map = pb_color_map_compile(colors_in);
 
     return mp_const_none;
 }
@@ -8,11 +8,14 @@
 
 #include "py/obj.h"
 
+// Detectable colors of a color sensor, compiled for fast matching.
+typedef struct _pb_color_map_t pb_color_map_t;
+
 void color_map_rgb_to_hsv(const pbio_color_rgb_t *rgb, pbio_color_hsv_t *hsv);
 
-void pb_color_map_save_default(mp_obj_t *color_map);
+void pb_color_map_save_default(pb_color_map_t **color_map);
 
-mp_obj_t pb_color_map_get_color(mp_obj_t *color_map, pbio_color_hsv_t *hsv);
+mp_obj_t pb_color_map_get_color(pb_color_map_t *color_map, pbio_color_hsv_t *hsv);
 
 MP_DECLARE_CONST_FUN_OBJ_KW(pb_ColorSensor_detectable_colors_obj);
 
@@ -24,7 +24,7 @@ pbio_iodev_type_id_t pb_device_get_id(pb_device_t *pbdev);
 
 uint8_t pb_device_get_mode(pb_device_t *pbdev);
 
-uint8_t pb_device_get_num_values(pb_device_t *pbdev);
+uint8_t pb_device_get_num_values(pb_device_t *pbdev, uint8_t mode);
 
 int8_t pb_device_get_mode_id_from_str(pb_device_t *pbdev, const char *mode_str);
 
@@ -7,6 +7,7 @@
 #include <pbdrv/motor.h>
 #include <pbio/color.h>
 #include <pbio/iodev.h>
+#include <pbio/util.h>
 
 #include "py/mphal.h"
 #include "py/mphal.h"
@@ -58,7 +59,8 @@ static uint32_t get_mode_switch_delay(pbio_iodev_type_id_t id, uint8_t mode) {
 static void set_mode(pbio_iodev_t *iodev, uint8_t new_mode) {
     pbio_error_t err;
 
-    if (iodev->mode == new_mode) {
+    // Selecting the current mode again is needed to get out of combi-mode
+    if (iodev->mode == new_mode && !iodev->combo_modes) {
         return;
     }
 
@@ -105,29 +107,40 @@ void pb_device_get_values(pb_device_t *pbdev, uint8_t mode, int32_t *values) {
     uint8_t len;
     pbio_iodev_data_type_t type;
 
-    set_mode(iodev, mode);
+    // Modes that the device can send together are read from combi-mode data,
+    // so alternating between them does not need a mode switch each time.
+    pbio_error_t err = pbio_iodev_get_combo_data(iodev, mode, &data);
+    if (err == PBIO_ERROR_AGAIN) {
+        set_mode(iodev, PBIO_IODEV_MODE_COMBO);
+        pb_assert(pbio_iodev_get_combo_data(iodev, mode, &data));
+    } else if (err == PBIO_ERROR_NOT_SUPPORTED) {
+        set_mode(iodev, mode);
+        pb_assert(pbio_iodev_get_data(iodev, &data));
+    } else {
+        pb_assert(err);
+    }
 
-    pb_assert(pbio_iodev_get_data(iodev, &data));
-    pb_assert(pbio_iodev_get_data_format(iodev, iodev->mode, &len, &type));
+    pb_assert(pbio_iodev_get_data_format(iodev, mode, &len, &type));
 
     if (len == 0) {
         pb_assert(PBIO_ERROR_IO);
     }
 
+    // Combi-mode data is not aligned, so values are read byte by byte
     for (uint8_t i = 0; i < len; i++) {
         switch (type & PBIO_IODEV_DATA_TYPE_MASK) {
             case PBIO_IODEV_DATA_TYPE_INT8:
                 values[i] = *((int8_t *)(data + i * 1));
                 break;
             case PBIO_IODEV_DATA_TYPE_INT16:
-                values[i] = *((int16_t *)(data + i * 2));
+                values[i] = (int16_t)pbio_get_uint16_le(data + i * 2);
                 break;
             case PBIO_IODEV_DATA_TYPE_INT32:
-                values[i] = *((int32_t *)(data + i * 4));
+                values[i] = (int32_t)pbio_get_uint32_le(data + i * 4);
                 break;
             #if MICROPY_PY_BUILTINS_FLOAT
             case PBIO_IODEV_DATA_TYPE_FLOAT:
-                *(float *)(values + i) = *((float *)(data + i * 4));
+                memcpy(values + i, data + i * 4, sizeof(float));
                 break;
             #endif
             default:
@@ -205,8 +218,8 @@ uint8_t pb_device_get_mode(pb_device_t *pbdev) {
     return pbdev->iodev.mode;
 }
 
-uint8_t pb_device_get_num_values(pb_device_t *pbdev) {
-    return pbdev->iodev.info->mode_info[pbdev->iodev.mode].num_values;
+uint8_t pb_device_get_num_values(pb_device_t *pbdev, uint8_t mode) {
+    return pbdev->iodev.info->mode_info[mode].num_values;
 }
 
 int8_t pb_device_get_mode_id_from_str(pb_device_t *pbdev, const char *mode_str) {
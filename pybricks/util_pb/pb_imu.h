@@ -8,6 +8,8 @@
 
 #include "py/obj.h"
 
+#include <pbdrv/imu.h>
+
 typedef struct _pb_imu_dev_t pb_imu_dev_t;
 
 void pb_imu_get_imu(pb_imu_dev_t **imu_dev);
@@ -18,6 +20,8 @@ void pb_imu_accel_read(pb_imu_dev_t *imu_dev, float_t *values);
 
 void pb_imu_gyro_read(pb_imu_dev_t *imu_dev, float_t *values);
 
+uint32_t pb_imu_samples_read(pb_imu_dev_t *imu_dev, pbdrv_imu_sample_t *samples, uint32_t num);
+
 #endif // PYBRICKS_PY_COMMON && PYBRICKS_PY_COMMON_IMU
 
 #endif // _PB_IMU_H_
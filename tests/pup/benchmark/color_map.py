@@ -0,0 +1,47 @@
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2021 The Pybricks Authors
+
+"""
+Hardware Module: Any hub with a ColorSensor on Port B.
+
+Description: Measures how fast color() matches a measurement with maps of
+different sizes.
+
+Each map has evenly spread hues at a few saturations and values, like a map
+of calibrated colors. The sensor measurement does not matter, but point the
+sensor at a colored surface to make it realistic.
+"""
+
+from pybricks.pupdevices import ColorSensor
+from pybricks.parameters import Port, Color
+from pybricks.tools import StopWatch
+
+COUNT = 1000
+
+sensor = ColorSensor(Port.B)
+watch = StopWatch()
+
+
+def make_map(size):
+    colors = [Color.NONE, Color.WHITE]
+    i = 0
+    while len(colors) < size:
+        colors.append(Color(i * 360 // (size - 2), 100 - i % 3 * 20, 100 - i % 4 * 15))
+        i += 1
+    return colors
+
+
+def measure(size):
+    sensor.detectable_colors(make_map(size))
+
+    i = 0
+    watch.reset()
+    while i < COUNT:
+        sensor.color()
+        i += 1
+    return watch.time()
+
+
+for size in (6, 12, 18, 24, 30):
+    time = measure(size)
+    print("{0} colors: {1} reads in {2} ms, {3} us/read".format(size, COUNT, time, time * 1000 // COUNT))
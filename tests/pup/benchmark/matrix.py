@@ -0,0 +1,127 @@
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2021 The Pybricks Authors
+
+"""
+Hardware Module: Any hub with pybricks.geometry.
+
+Description: Measures Matrix arithmetic with and without allocation.
+
+Each workload is run with the operators, which make a new Matrix for every
+result, and with the in-place methods, which write into an existing Matrix.
+The in-place workloads run with the heap locked, so the script stops with a
+MemoryError if any of them allocates memory.
+"""
+
+from micropython import heap_lock, heap_unlock
+
+from pybricks.geometry import Matrix
+from pybricks.tools import StopWatch
+
+COUNT = 2000
+
+watch = StopWatch()
+
+R = Matrix([[0, -1, 0], [1, 0, 0], [0, 0, 1]])
+S = Matrix([[1, 2, 3], [4, 5, 6], [7, 8, 9]])
+v = Matrix([[1], [2], [3]])
+w = Matrix([[4], [5], [6]])
+
+v_out = Matrix([[0], [0], [0]])
+m_out = Matrix([[0, 0, 0], [0, 0, 0], [0, 0, 0]])
+
+
+def alloc_mul_3x1():
+    i = 0
+    while i < COUNT:
+        R * v
+        i += 1
+
+
+def alloc_mul_3x3():
+    i = 0
+    while i < COUNT:
+        R * S
+        i += 1
+
+
+def alloc_mul_add():
+    i = 0
+    while i < COUNT:
+        R * v + w
+        i += 1
+
+
+def alloc_add():
+    i = 0
+    while i < COUNT:
+        v + w
+        i += 1
+
+
+def inplace_mul_3x1():
+    i = 0
+    while i < COUNT:
+        R.mul_into(v, v_out)
+        i += 1
+
+
+def inplace_mul_3x3():
+    i = 0
+    while i < COUNT:
+        R.mul_into(S, m_out)
+        i += 1
+
+
+def inplace_mul_add():
+    i = 0
+    while i < COUNT:
+        R.mul_add_into(v, w, v_out)
+        i += 1
+
+
+def inplace_add():
+    i = 0
+    while i < COUNT:
+        v.add_into(w, v_out)
+        i += 1
+
+
+def inplace_transpose():
+    i = 0
+    while i < COUNT:
+        S.transpose_into(m_out)
+        i += 1
+
+
+def measure(func, locked):
+    watch.reset()
+    if locked:
+        heap_lock()
+    try:
+        func()
+    finally:
+        if locked:
+            heap_unlock()
+    return watch.time()
+
+
+results = [
+    ("alloc_mul_3x1", measure(alloc_mul_3x1, False)),
+    ("alloc_mul_3x3", measure(alloc_mul_3x3, False)),
+    ("alloc_mul_add", measure(alloc_mul_add, False)),
+    ("alloc_add", measure(alloc_add, False)),
+    ("inplace_mul_3x1", measure(inplace_mul_3x1, True)),
+    ("inplace_mul_3x3", measure(inplace_mul_3x3, True)),
+    ("inplace_mul_add", measure(inplace_mul_add, True)),
+    ("inplace_add", measure(inplace_add, True)),
+    ("inplace_transpose", measure(inplace_transpose, True)),
+]
+
+# The in-place results must match the operators
+R.mul_add_into(v, w, v_out)
+assert abs(v_out - (R * v + w)) < 1e-6
+S.transpose_into(m_out)
+assert m_out[0, 1] == S[1, 0]
+
+for name, time in results:
+    print("{0}: {1} ops in {2} ms, {3} us/op".format(name, COUNT, time, time * 1000 // COUNT))
@@ -0,0 +1,127 @@
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2021 The Pybricks Authors
+
+"""
+Hardware Module: Technic Hub, City Hub, Prime Hub, Inventor Hub, or
+Essential Hub.
+
+Description: Measures the speedup of native and viper code over bytecode.
+
+Each workload is a tight integer loop like those used to process sensor
+data. It runs once as bytecode, once with @micropython.native, and once with
+@micropython.viper, and the results must match. The script prints the loop
+rate of each variant and the speedup over bytecode, so the numbers can be
+compared between hubs.
+"""
+
+import micropython
+
+from pybricks.tools import StopWatch
+
+LOOPS = 50
+SIZE = 200
+
+watch = StopWatch()
+
+# Samples to process, like a buffer of sensor readings.
+data = bytearray((i * 37 + 11) % 256 for i in range(SIZE))
+
+
+def smooth_bytecode(data, loops):
+    total = 0
+    for _ in range(loops):
+        avg = 0
+        for x in data:
+            avg = (avg * 7 + x) >> 3
+        total += avg
+    return total
+
+
+@micropython.native
+def smooth_native(data, loops):
+    total = 0
+    for _ in range(loops):
+        avg = 0
+        for x in data:
+            avg = (avg * 7 + x) >> 3
+        total += avg
+    return total
+
+
+@micropython.viper
+def smooth_viper(data, loops: int) -> int:
+    buf = ptr8(data)  # noqa: F821
+    size = int(len(data))
+    total = 0
+    for _ in range(loops):
+        avg = 0
+        for i in range(size):
+            avg = (avg * 7 + buf[i]) >> 3
+        total += avg
+    return total
+
+
+def edges_bytecode(data, loops):
+    count = 0
+    for _ in range(loops):
+        prev = data[0]
+        for x in data:
+            if (x > 127) != (prev > 127):
+                count += 1
+            prev = x
+    return count
+
+
+@micropython.native
+def edges_native(data, loops):
+    count = 0
+    for _ in range(loops):
+        prev = data[0]
+        for x in data:
+            if (x > 127) != (prev > 127):
+                count += 1
+            prev = x
+    return count
+
+
+@micropython.viper
+def edges_viper(data, loops: int) -> int:
+    buf = ptr8(data)  # noqa: F821
+    size = int(len(data))
+    count = 0
+    for _ in range(loops):
+        prev = buf[0]
+        for i in range(size):
+            x = buf[i]
+            if (x > 127) != (prev > 127):
+                count += 1
+            prev = x
+    return count
+
+
+def measure(func):
+    watch.reset()
+    result = func(data, LOOPS)
+    return result, watch.time()
+
+
+def benchmark(name, variants):
+    print(name)
+    expected, base = measure(variants[0][1])
+    for label, func in variants:
+        result, time = measure(func)
+        if result != expected:
+            raise RuntimeError("{0} result {1} != {2}".format(label, result, expected))
+        rate = LOOPS * SIZE * 1000 // max(time, 1)
+        speedup = base / max(time, 1)
+        print("  {0:8} {1:6} ms {2:8} loops/s {3:5.1f}x".format(label, time, rate, speedup))
+
+
+benchmark(
+    "smooth",
+    [("bytecode", smooth_bytecode), ("native", smooth_native), ("viper", smooth_viper)],
+)
+benchmark(
+    "edges",
+    [("bytecode", edges_bytecode), ("native", edges_native), ("viper", edges_viper)],
+)
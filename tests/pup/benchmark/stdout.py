@@ -0,0 +1,60 @@
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2021 The Pybricks Authors
+
+"""
+Hardware Module: Any hub.
+
+Description: Measures how fast print() output is sent to the computer.
+
+Each workload prints about the same number of bytes with lines of a different
+length. Once the output buffer is full, print() waits for Bluetooth, so the
+result is the throughput of the connection. Run it with a few different
+computers, since the connection interval that they choose affects the result.
+"""
+
+from pybricks.tools import StopWatch
+
+TOTAL_BYTES = 20000
+
+watch = StopWatch()
+
+
+def measure(name, line):
+    # Each print adds a newline
+    size = len(line) + 1
+    count = TOTAL_BYTES // size
+
+    # Start with an empty output buffer
+    print()
+    watch.reset()
+    for _ in range(count):
+        print(line)
+    time = watch.time()
+
+    return name, count * size, time
+
+
+def measure_numbers():
+    count = 2000
+    size = 0
+
+    print()
+    watch.reset()
+    for i in range(count):
+        text = "{0} {1}".format(i, i * i)
+        print(text)
+        size += len(text) + 1
+    time = watch.time()
+
+    return "numbers", size, time
+
+
+results = [
+    measure("short", "x" * 9),
+    measure("medium", "x" * 49),
+    measure("long", "x" * 149),
+    measure_numbers(),
+]
+
+for name, size, time in results:
+    print("{0}: {1} bytes in {2} ms, {3} bytes/s".format(name, size, time, size * 1000 // max(time, 1)))
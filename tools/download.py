@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2021 The Pybricks Authors
+
+"""Reference sender and benchmark for the windowed program download.
+
+The program is split into blocks that fill one write to the Pybricks control
+characteristic. Each block is sent as a write without response::
+
+    command     1 byte      2 (write block)
+    index       2 bytes     block index, little-endian
+    crc         4 bytes     CRC32 of the block data, little-endian
+    data        n bytes     block data, where n = MTU - 3 - 7 except for the last block
+
+It is preceded by a start command with the size of the program and of the
+blocks. The hub replies with status notifications::
+
+    event       1 byte      2 (download status)
+    status      1 byte      result of the last command (0 is success)
+    base        2 bytes     index of the first block that has not been received
+    received    4 bytes     bit n is set if block base + 1 + n has been received
+
+The sender may have blocks up to ``base + WINDOW_SIZE`` in flight. Blocks
+that are bad or lost are not marked in the status, so only those are sent
+again. The download is done when ``base`` equals the number of blocks.
+
+The sender is independent of the Bluetooth library. Write the bytes from
+:meth:`Sender.start` and :meth:`Sender.poll` to the characteristic and pass
+each status notification to :meth:`Sender.handle_status`.
+
+Running this script compares the time it takes to download a program with
+this scheme and with the older scheme, where each 100 byte chunk is written
+to the UART service and the sender waits for the XOR checksum to come back.
+It uses a simple model of a BLE link where time advances in connection events.
+"""
+
+import argparse
+import binascii
+import random
+import struct
+
+COMMAND_START_DOWNLOAD = 1
+COMMAND_WRITE_BLOCK = 2
+EVENT_DOWNLOAD_STATUS = 2
+
+WRITE_BLOCK_HEADER_SIZE = 7
+WINDOW_SIZE = 32
+
+# Overhead of a write to a characteristic
+ATT_HEADER_SIZE = 3
+
+# Chunk size of the older scheme in bricks/stm32/main.c
+LEGACY_CHUNK_SIZE = 100
+
+
+def block_size_for_mtu(mtu):
+    """Gets the largest block size that fits in one write."""
+    return mtu - ATT_HEADER_SIZE - WRITE_BLOCK_HEADER_SIZE
+
+
+def encode_start(size, block_size):
+    """Encodes the start download command."""
+    return struct.pack("<BIH", COMMAND_START_DOWNLOAD, size, block_size)
+
+
+def encode_block(index, data):
+    """Encodes the write block command."""
+    return struct.pack("<BHI", COMMAND_WRITE_BLOCK, index, binascii.crc32(data)) + data
+
+
+def decode_status(event):
+    """Decodes the download status event.
+
+    Returns
+    -------
+    tuple
+        The status, the index of the first missing block and the flags of
+        received blocks after it.
+    """
+    if len(event) < 8 or event[0] != EVENT_DOWNLOAD_STATUS:
+        raise ValueError("Not a download status event")
+    _, status, base, received = struct.unpack_from("<BBHI", event)
+    return status, base, received
+
+
+class Sender:
+    """Sends a program with the windowed download.
+
+    Parameters
+    ----------
+    data : bytes
+        The program.
+    mtu : int
+        The negotiated ATT MTU.
+    timeout : float
+        Time after which a block that was not reported as received is sent
+        again, in the same unit as the ``now`` arguments.
+    """
+
+    def __init__(self, data, mtu, timeout):
+        self.data = data
+        self.block_size = block_size_for_mtu(mtu)
+        self.num_blocks = (len(data) + self.block_size - 1) // self.block_size
+        self.timeout = timeout
+        self.base = 0
+        self.received = set()
+        self.sent_at = {}
+        self.started = False
+        self.retransmits = 0
+
+    @property
+    def done(self):
+        """True if the hub has all blocks."""
+        return self.base == self.num_blocks
+
+    def start(self):
+        """Gets the command that starts the download."""
+        return encode_start(len(self.data), self.block_size)
+
+    def handle_status(self, event):
+        """Updates which blocks the hub has from a status notification."""
+        status, base, received = decode_status(event)
+        self.started = True
+        if base < self.base:
+            # Older than what we know, so it was reordered or the hub restarted
+            return
+        self.base = base
+        self.received = {i for i in self.received if i >= base}
+        self.received.update(base + 1 + n for n in range(WINDOW_SIZE) if received & (1 << n))
+
+    def poll(self, now, max_count):
+        """Gets the blocks that should be sent now.
+
+        Parameters
+        ----------
+        now : float
+            The current time.
+        max_count : int
+            The maximum number of blocks to return.
+
+        Returns
+        -------
+        list
+            Write block commands.
+        """
+        commands = []
+        if not self.started:
+            return commands
+        end = min(self.base + WINDOW_SIZE + 1, self.num_blocks)
+        for index in range(self.base, end):
+            if len(commands) == max_count:
+                break
+            if index in self.received:
+                continue
+            sent_at = self.sent_at.get(index)
+            if sent_at is not None and now - sent_at < self.timeout:
+                continue
+            if sent_at is not None:
+                self.retransmits += 1
+            self.sent_at[index] = now
+            offset = index * self.block_size
+            commands.append(encode_block(index, self.data[offset : offset + self.block_size]))
+        return commands
+
+
+class Receiver:
+    """Model of the hub side in lib/pbio/src/protocol/download.c."""
+
+    def __init__(self):
+        self.buf = None
+        self.size = 0
+        self.block_size = 0
+        self.num_blocks = 0
+        self.base = 0
+        self.received = 0
+        self.status = 0
+
+    def handle(self, command):
+        """Handles a command and returns the status event."""
+        if command[0] == COMMAND_START_DOWNLOAD:
+            _, self.size, self.block_size = struct.unpack_from("<BIH", command)
+            self.num_blocks = (self.size + self.block_size - 1) // self.block_size
+            self.buf = bytearray(self.size)
+            self.base = self.received = self.status = 0
+        elif command[0] == COMMAND_WRITE_BLOCK:
+            self.status = self._write_block(command)
+        return struct.pack("<BBHI", EVENT_DOWNLOAD_STATUS, self.status, self.base, self.received)
+
+    def _write_block(self, command):
+        _, index, crc = struct.unpack_from("<BHI", command)
+        block = command[WRITE_BLOCK_HEADER_SIZE:]
+        if index >= self.num_blocks or index > self.base + WINDOW_SIZE:
+            return 2  # PBIO_ERROR_INVALID_ARG
+        offset = index * self.block_size
+        if len(block) != min(self.size - offset, self.block_size):
+            return 2  # PBIO_ERROR_INVALID_ARG
+        if binascii.crc32(block) != crc:
+            return 4  # PBIO_ERROR_IO
+        if index < self.base or (index > self.base and self.received & (1 << (index - self.base - 1))):
+            return 0
+        self.buf[offset : offset + len(block)] = block
+        if index > self.base:
+            self.received |= 1 << (index - self.base - 1)
+            return 0
+        self.base += 1
+        while self.received & 1:
+            self.received >>= 1
+            self.base += 1
+        self.received >>= 1
+        return 0
+
+
+class Link:
+    """Model of a BLE link.
+
+    Time advances in connection events. In each event, the host can write a
+    limited number of packets, and each packet is lost with some probability.
+    Notifications from the hub reach the host application a number of events
+    later, which models the latency of the Bluetooth stacks.
+
+    Parameters
+    ----------
+    interval : float
+        Connection interval in milliseconds.
+    packets_per_event : int
+        Number of packets the host can write in one connection event.
+    latency : int
+        Number of connection events before the host can react to a notification.
+    loss : float
+        Probability that a packet is lost or corrupted.
+    seed : int
+        Seed of the random generator, so runs can be compared.
+    """
+
+    def __init__(self, interval, packets_per_event, latency, loss, seed):
+        self.interval = interval
+        self.packets_per_event = packets_per_event
+        self.latency = latency
+        self.loss = loss
+        self.random = random.Random(seed)
+
+    def corrupt(self, packet):
+        """Returns the packet as the hub receives it, or None if it is lost."""
+        if self.random.random() >= self.loss:
+            return packet
+        if self.random.random() < 0.5:
+            return None
+        packet = bytearray(packet)
+        packet[-1] ^= 0x01
+        return bytes(packet)
+
+
+def simulate_windowed(data, link, mtu, max_events=1000000):
+    """Simulates the windowed download.
+
+    Returns
+    -------
+    tuple
+        The number of connection events and the number of sent blocks again.
+    """
+    sender = Sender(data, mtu, timeout=link.latency + 2)
+    receiver = Receiver()
+    pending = []  # (event when host sees it, notification)
+
+    for event in range(max_events):
+        # Notifications that reached the host
+        for _, notification in [p for p in pending if p[0] <= event]:
+            sender.handle_status(notification)
+        pending = [p for p in pending if p[0] > event]
+
+        if sender.done:
+            assert bytes(receiver.buf) == data
+            return event, sender.retransmits
+
+        if event == 0:
+            commands = [sender.start()]
+        else:
+            commands = sender.poll(event, link.packets_per_event)
+
+        # The hub sends one status per event at most, with the latest state
+        status = None
+        for command in commands:
+            packet = command if command[0] == COMMAND_START_DOWNLOAD else link.corrupt(command)
+            if packet is not None:
+                status = receiver.handle(packet)
+        if status is not None:
+            pending.append((event + link.latency, status))
+
+    raise RuntimeError("Download did not finish")
+
+
+def simulate_legacy(data, link, mtu, max_events=1000000):
+    """Simulates the older download, which waits for a checksum per chunk.
+
+    Packet loss would make this scheme lose sync with the hub, so this
+    optimistically assumes that a lost chunk can be sent again after a timeout.
+
+    Returns
+    -------
+    tuple
+        The number of connection events and the number of sent chunks again.
+    """
+    payload = mtu - ATT_HEADER_SIZE
+    retransmits = 0
+    event = 1  # The size is sent first, like the start command
+    offset = 0
+
+    while offset < len(data):
+        chunk = data[offset : offset + LEGACY_CHUNK_SIZE]
+        packets = (len(chunk) + payload - 1) // payload
+        event += (packets + link.packets_per_event - 1) // link.packets_per_event
+        if any(link.corrupt(b"\0") != b"\0" for _ in range(packets)):
+            # No checksum or a wrong one, so wait and send it again
+            retransmits += 1
+            event += link.latency + 2
+            continue
+        event += link.latency
+        offset += len(chunk)
+        if event > max_events:
+            raise RuntimeError("Download did not finish")
+
+    return event, retransmits
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the windowed download with the older scheme.")
+    parser.add_argument("--size", type=int, default=20000, help="program size in bytes (default: %(default)s)")
+    parser.add_argument("--mtu", type=int, default=158, help="ATT MTU (default: %(default)s)")
+    parser.add_argument("--interval", type=float, default=15, help="connection interval in ms (default: %(default)s)")
+    parser.add_argument(
+        "--packets-per-event", type=int, default=4, help="packets per connection event (default: %(default)s)"
+    )
+    parser.add_argument("--latency", type=int, default=2, help="notification latency in events (default: %(default)s)")
+    parser.add_argument("--loss", type=float, default=0.0, help="packet loss probability (default: %(default)s)")
+    parser.add_argument("--seed", type=int, default=1, help="random seed (default: %(default)s)")
+    args = parser.parse_args()
+
+    data = random.Random(args.seed).randbytes(args.size)
+
+    def link():
+        return Link(args.interval, args.packets_per_event, args.latency, args.loss, args.seed)
+
+    legacy_events, legacy_retransmits = simulate_legacy(data, link(), args.mtu)
+    windowed_events, windowed_retransmits = simulate_windowed(data, link(), args.mtu)
+
+    for name, events, retransmits in (
+        ("legacy", legacy_events, legacy_retransmits),
+        ("windowed", windowed_events, windowed_retransmits),
+    ):
+        seconds = events * args.interval / 1000
+        print(
+            "{0:>8}: {1:7.2f} s {2:7.1f} kB/s {3:5} sent again".format(
+                name, seconds, args.size / seconds / 1000, retransmits
+            )
+        )
+
+    print("{0:>8}: {1:7.1f}x".format("speedup", legacy_events / windowed_events))
+
+
+if __name__ == "__main__":
+    main()
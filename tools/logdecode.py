@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+
+# SPDX-License-Identifier: MIT
+# Copyright (c) 2021 The Pybricks Authors
+
+"""Decode binary log files made by ``Logger.save(path, binary=True)``.
+
+The file starts with a header::
+
+    magic       4 bytes     b"PBLG"
+    version     1 byte      format version, currently 1
+    columns     1 byte      number of values per row
+    rows        varint      number of rows
+    names_len   varint      length of the column names
+    names       names_len   comma separated "name:unit" for each column
+
+This is followed by ``rows * columns`` values. Each value is the difference
+with the value in the same column of the previous row, stored as a zigzag
+encoded LEB128 varint. The row before the first row is all zeros.
+
+On hubs, the binary data is printed as base64 text. Both the raw binary file
+and the base64 text are accepted by this tool.
+"""
+
+import argparse
+import base64
+import binascii
+import csv
+import sys
+
+MAGIC = b"PBLG"
+VERSION = 1
+
+
+def read_varint(data, pos):
+    """Reads an unsigned LEB128 varint.
+
+    Parameters
+    ----------
+    data : bytes
+        The encoded data.
+    pos : int
+        The position of the first byte of the varint.
+
+    Returns
+    -------
+    tuple
+        The value and the position of the next byte.
+    """
+    value = 0
+    shift = 0
+    while True:
+        try:
+            byte = data[pos]
+        except IndexError:
+            raise ValueError("Unexpected end of log data")
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def to_int32(value):
+    """Wraps a value around to a signed 32-bit integer."""
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def decode(data):
+    """Decodes a binary log.
+
+    Parameters
+    ----------
+    data : bytes
+        The binary log, or the base64 text printed by the hub.
+
+    Returns
+    -------
+    tuple
+        A list of (name, unit) tuples for each column and a list of rows.
+    """
+    if not data.startswith(MAGIC):
+        try:
+            data = base64.b64decode(b"".join(data.split()), validate=True)
+        except binascii.Error:
+            raise ValueError("Not a binary log file")
+        if not data.startswith(MAGIC):
+            raise ValueError("Not a binary log file")
+
+    pos = len(MAGIC)
+    version, num_values = data[pos], data[pos + 1]
+    if version != VERSION:
+        raise ValueError("Unsupported log version {0}".format(version))
+    pos += 2
+
+    num_rows, pos = read_varint(data, pos)
+    names_len, pos = read_varint(data, pos)
+    names = data[pos : pos + names_len].decode()
+    pos += names_len
+
+    columns = [tuple(col.split(":", 1)) for col in names.split(",")]
+    if len(columns) != num_values:
+        raise ValueError("Header describes {0} columns instead of {1}".format(len(columns), num_values))
+
+    rows = []
+    prev = [0] * num_values
+    for _ in range(num_rows):
+        row = []
+        for i in range(num_values):
+            zigzag, pos = read_varint(data, pos)
+            delta = (zigzag >> 1) ^ -(zigzag & 1)
+            prev[i] = to_int32(prev[i] + delta)
+            row.append(prev[i])
+        rows.append(row)
+
+    return columns, rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a binary log file to CSV.")
+    parser.add_argument("log", metavar="<log-file>", type=argparse.FileType("rb"), help="binary log file")
+    parser.add_argument(
+        "-o",
+        "--output",
+        metavar="<csv-file>",
+        type=argparse.FileType("w"),
+        default=sys.stdout,
+        help="output file (default: stdout)",
+    )
+    parser.add_argument(
+        "--no-header", action="store_true", help="omit the column names, giving the same output as Logger.save()"
+    )
+    args = parser.parse_args()
+
+    columns, rows = decode(args.log.read())
+
+    writer = csv.writer(args.output, lineterminator="\n")
+    if not args.no_header:
+        writer.writerow("{0} ({1})".format(name, unit) if unit else name for name, unit in columns)
+    writer.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()